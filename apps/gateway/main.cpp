@@ -0,0 +1,83 @@
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <optional>
+#include <string>
+
+#include <chronex/gateway/Gateway.hpp>
+#include <chronex/handlers/CommandFlushingEventHandler.hpp>
+#include <chronex/handlers/EventBusEventHandler.hpp>
+#include <chronex/ipc/EventBus.hpp>
+
+/*
+ * Accepts order-entry sessions (see gateway/Protocol.hpp and
+ *  gateway/GatewayClient.hpp) for an engine with the given number of
+ *  symbols, named S0, S1, ... If a bus name is given, the events of the
+ *  engine are published to it as well, for chronex-store to serve.
+ *
+ *  Usage: chronex-gateway <socket path> <symbols count> [bus name]
+ */
+
+namespace {
+
+std::atomic<bool> is_running { true };
+
+void stop(int) { is_running.store(false, std::memory_order_relaxed); }
+
+template <typename Gateway, typename Func>
+int run(std::optional<Gateway> gateway, const uint32_t symbols_count, Func&& after_poll) {
+    if (!gateway) {
+        std::perror("Can't listen on the socket");
+        return EXIT_FAILURE;
+    }
+
+    for (uint32_t id = 0; id < symbols_count; id++) {
+        char name[16];
+        std::snprintf(name, sizeof(name), "S%u", id);
+        gateway->engine().add_new_orderbook(chronex::Symbol { chronex::SymbolId { id }, name });
+    }
+
+    std::signal(SIGINT, stop);
+    std::signal(SIGTERM, stop);
+
+    while (is_running.load(std::memory_order_relaxed)) {
+        (void)gateway->poll(100);
+        after_poll(*gateway);
+    }
+
+    std::printf("Handled %lu requests, %lu rejected, %lu reports dropped\n",
+                static_cast<unsigned long>(gateway->requests_count()),
+                static_cast<unsigned long>(gateway->rejects_count()),
+                static_cast<unsigned long>(gateway->dropped_reports()));
+    return EXIT_SUCCESS;
+}
+
+}
+
+int main(const int argc, char** argv) {
+    using namespace chronex;
+
+    if (argc < 3) {
+        std::fprintf(stderr, "Usage: %s <socket path> <symbols count> [bus name]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    auto symbols_count = static_cast<uint32_t>(std::stoul(argv[2]));
+
+    if (argc < 4) {
+        return run(gateway::Gateway<>::create(argv[1]), symbols_count, [] (auto&) { });
+    }
+
+    auto bus = ipc::EventBusWriter<handlers::EventRecord>::create(argv[3], 1 << 20, 8, 1 << 20);
+    if (!bus) {
+        std::perror("Can't create the event bus");
+        return EXIT_FAILURE;
+    }
+
+    using Handler = handlers::CommandFlushingEventHandler<handlers::EventBusEventHandler>;
+    auto gateway = gateway::Gateway<Order, Handler>::create(argv[1], { }, Handler { handlers::EventBusEventHandler { &*bus } });
+    return run(std::move(gateway), symbols_count, [&bus] (auto& running) {
+        handlers::serve_snapshot(running.engine(), *bus);
+    });
+}
@@ -0,0 +1,64 @@
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include <chronex/generator/OrderFlowGenerator.hpp>
+#include <chronex/matching/CommandFile.hpp>
+
+/*
+ * Writes a command file (see matching/CommandFile.hpp) of synthetic order
+ *  flow (see generator::OrderFlowGenerator), e.g. for chronex-replay. The
+ *  same arguments write the same file. The flow is generated as it's
+ *  written, so files of billions of commands take no more memory than small
+ *  ones, only the disk space (128 bytes per command).
+ *
+ *  Usage: chronex-generate <command file> <commands count> [symbols count] [seed]
+ */
+
+int main(const int argc, char** argv) {
+    using namespace chronex;
+
+    if (argc < 3) {
+        std::fprintf(stderr, "Usage: %s <command file> <commands count> [symbols count] [seed]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    auto commands_count = std::stoull(argv[2]);
+    generator::GeneratorConfig config;
+    if (argc > 3) config.symbols_count = static_cast<uint32_t>(std::stoul(argv[3]));
+    if (argc > 4) config.seed = std::stoull(argv[4]);
+
+    auto writer = commands::CommandFileWriter::create(argv[1]);
+    if (!writer) {
+        std::perror("Can't create the command file");
+        return EXIT_FAILURE;
+    }
+
+    generator::OrderFlowGenerator<> generator { config };
+    std::array<size_t, commands::CommandTypesCount> counts { };
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < commands_count; i++) {
+        auto record = commands::make_command_record(generator.next(), generator.timestamp());
+        ++counts[static_cast<size_t>(record.type)];
+        writer->write(record);
+    }
+    // Waits for the writer to finish
+    writer.reset();
+    auto elapsed = std::chrono::duration<double> { std::chrono::steady_clock::now() - start }.count();
+
+    std::printf("Generated %llu commands in %.3f seconds: %.0f commands/sec, spanning %.3f seconds of flow\n",
+                static_cast<unsigned long long>(commands_count), elapsed, static_cast<double>(commands_count) / elapsed,
+                static_cast<double>(generator.timestamp()) / 1e9);
+    std::printf("Add orderbook %lu, add order %lu, remove order %lu, replace order %lu, modify order %lu\n",
+                static_cast<unsigned long>(counts[static_cast<size_t>(commands::CommandType::ADD_NEW_ORDERBOOK)]),
+                static_cast<unsigned long>(counts[static_cast<size_t>(commands::CommandType::ADD_ORDER)]),
+                static_cast<unsigned long>(counts[static_cast<size_t>(commands::CommandType::REMOVE_ORDER)]),
+                static_cast<unsigned long>(counts[static_cast<size_t>(commands::CommandType::REPLACE_ORDER)]),
+                static_cast<unsigned long>(counts[static_cast<size_t>(commands::CommandType::MODIFY_ORDER)]));
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,64 @@
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include <chronex/itch/BookBuilder.hpp>
+#include <chronex/matching/MatchingEngine.hpp>
+#include <chronex/utils/MappedFile.hpp>
+
+/*
+ * Builds the books of a NASDAQ TotalView-ITCH 5.0 file (e.g. one of the
+ *  daily files NASDAQ publishes, decompressed), and reports how fast they
+ *  were built. The file is memory-mapped, and paged in before the clock
+ *  starts, so that the throughput is that of building the books rather
+ *  than that of the disk.
+ *
+ *  Usage: chronex-itch <ITCH 5.0 file>
+ */
+
+int main(const int argc, char** argv) {
+    using namespace chronex;
+
+    if (argc < 2) {
+        std::fprintf(stderr, "Usage: %s <ITCH 5.0 file>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    auto file = utils::MappedFile::open(argv[1]);
+    if (!file) {
+        std::perror("Can't map the file");
+        return EXIT_FAILURE;
+    }
+
+    // A byte per page is enough to fault all of them in
+    volatile std::byte sink { };
+    for (size_t i = 0; i < file->size(); i += 4096) {
+        sink = file->data()[i];
+    }
+    (void)sink;
+
+    MatchingEngine<> engine;
+    itch::BookBuilder builder { engine };
+
+    auto start = std::chrono::steady_clock::now();
+    auto result = builder.replay(file->bytes());
+    auto elapsed = std::chrono::duration<double> { std::chrono::steady_clock::now() - start }.count();
+
+    if (result.is_malformed) {
+        std::fprintf(stderr, "Stopped at a malformed message, at byte %lu\n", static_cast<unsigned long>(result.size));
+    } else if (result.size != file->size()) {
+        std::fprintf(stderr, "The file ends in the middle of a message, at byte %lu\n", static_cast<unsigned long>(result.size));
+    }
+
+    std::printf("Replayed %lu messages in %.3f seconds: %.0f messages/sec, %.1f MB/sec\n",
+                static_cast<unsigned long>(builder.messages_count()), elapsed,
+                static_cast<double>(builder.messages_count()) / elapsed,
+                static_cast<double>(result.size) / elapsed / 1e6);
+    std::printf("Built %lu books, skipped %lu messages about unknown orders\n",
+                static_cast<unsigned long>(builder.orderbooks_count()),
+                static_cast<unsigned long>(builder.unknown_orders_count()));
+
+    return result.is_malformed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,195 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include <unistd.h>
+
+#include <chronex/handlers/BufferedTextEventHandler.hpp>
+#include <chronex/handlers/CommandFlushingEventHandler.hpp>
+#include <chronex/handlers/ExecutionReportEventHandler.hpp>
+#include <chronex/handlers/MarketByPriceEventHandler.hpp>
+#include <chronex/handlers/NullEventHandler.hpp>
+#include <chronex/handlers/TopOfBookEventHandler.hpp>
+#include <chronex/matching/CommandFile.hpp>
+#include <chronex/matching/Commands.hpp>
+#include <chronex/matching/MatchingEngine.hpp>
+
+/*
+ * Replays a command file (see matching/CommandFile.hpp) against the matching
+ *  engine, with the given event handler, and reports the throughput, and the
+ *  latency percentiles of each command type:
+ *
+ *  - null:    handlers::NullEventHandler, the engine alone (the default)
+ *  - reports: handlers::ExecutionReportEventHandler, as the gateway runs it
+ *  - top:     handlers::TopOfBookEventHandler, flushed after each command
+ *  - mbp:     handlers::MarketByPriceEventHandler, flushed after each command
+ *  - text:    handlers::BufferedTextEventHandler, with the events on stdout
+ *
+ * The file is memory-mapped, and paged in before the clock starts. Timing
+ *  each command costs two reads of the clock, so --no-latency leaves them out
+ *  for the throughput alone. The report goes to stderr, so that the events of
+ *  the text handler can be redirected on their own.
+ *
+ *  Usage: chronex-replay <command file> [null|reports|top|mbp|text] [--no-latency]
+ */
+
+namespace {
+
+using namespace chronex;
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::array<std::string_view, commands::CommandTypesCount> CommandNames {
+    "add orderbook", "remove orderbook", "add order", "remove order", "reduce order",
+    "modify order", "mitigate order", "replace order", "execute order", "match"
+};
+
+// Counts what the market data handlers publish, in place of a transport
+struct CountingPublisher {
+    template <typename T>
+    void operator()(const T&) noexcept { ++published; }
+    size_t published = 0;
+};
+
+struct ReplayStats {
+    size_t applied = 0;
+    // Commands about orders that were gone, orders that were invalid or
+    //  had the ID of a live one, and records of unknown types
+    size_t dropped = 0;
+    double elapsed = 0;
+    std::array<std::vector<uint64_t>, commands::CommandTypesCount> latencies;
+};
+
+// `after_command` is called after each command, outside of the timing
+template <bool measure_latency, typename Engine, typename Func>
+ReplayStats replay(Engine& engine, const std::span<const commands::CommandRecord> records, Func&& after_command) {
+    ReplayStats stats;
+    if constexpr (measure_latency) {
+        // So that nothing is allocated while replaying
+        std::array<size_t, commands::CommandTypesCount> counts { };
+        for (auto& record : records) {
+            if (static_cast<size_t>(record.type) < counts.size()) ++counts[static_cast<size_t>(record.type)];
+        }
+        for (size_t i = 0; i < counts.size(); i++) stats.latencies[i].reserve(counts[i]);
+    }
+
+    auto start = Clock::now();
+    for (auto& record : records) {
+        [[maybe_unused]] auto command_start = Clock::time_point { };
+        if constexpr (measure_latency) command_start = Clock::now();
+
+        auto command = commands::make_command(record);
+        auto is_applied = command.has_value() && commands::apply(engine, std::move(*command));
+
+        if constexpr (measure_latency) {
+            if (command.has_value()) {
+                auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - command_start);
+                stats.latencies[static_cast<size_t>(record.type)].push_back(static_cast<uint64_t>(latency.count()));
+            }
+        }
+        stats.applied += is_applied;
+        stats.dropped += !is_applied;
+        after_command(engine);
+    }
+    stats.elapsed = std::chrono::duration<double> { Clock::now() - start }.count();
+    return stats;
+}
+
+void print_latencies(ReplayStats& stats) {
+    std::fprintf(stderr, "%-18s %10s %8s %8s %8s %8s %10s\n", "command (ns)", "count", "p50", "p90", "p99", "p99.9", "max");
+    for (size_t type = 0; type < stats.latencies.size(); type++) {
+        auto& latencies = stats.latencies[type];
+        if (latencies.empty()) continue;
+        std::sort(latencies.begin(), latencies.end());
+        auto percentile = [&] (const double p) {
+            auto index = static_cast<size_t>(p * static_cast<double>(latencies.size() - 1));
+            return static_cast<unsigned long>(latencies[index]);
+        };
+        std::fprintf(stderr, "%-18s %10lu %8lu %8lu %8lu %8lu %10lu\n", CommandNames[type].data(),
+                     static_cast<unsigned long>(latencies.size()), percentile(0.5), percentile(0.9),
+                     percentile(0.99), percentile(0.999), static_cast<unsigned long>(latencies.back()));
+    }
+}
+
+template <typename Handler, typename Func>
+int run(const std::span<const commands::CommandRecord> records, const bool measure_latency, Handler handler,
+        Func&& after_command) {
+    MatchingEngine<Order, Handler> engine { std::move(handler) };
+    auto stats = measure_latency ? replay<true>(engine, records, after_command)
+                                 : replay<false>(engine, records, after_command);
+
+    std::fprintf(stderr, "Replayed %lu commands in %.3f seconds: %.0f commands/sec\n",
+                 static_cast<unsigned long>(records.size()), stats.elapsed,
+                 static_cast<double>(records.size()) / stats.elapsed);
+    std::fprintf(stderr, "Applied %lu, dropped %lu about missing, invalid, or duplicate orders, or of unknown types\n",
+                 static_cast<unsigned long>(stats.applied), static_cast<unsigned long>(stats.dropped));
+    if (measure_latency) print_latencies(stats);
+    return EXIT_SUCCESS;
+}
+
+}
+
+int main(const int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "Usage: %s <command file> [null|reports|top|mbp|text] [--no-latency]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::string_view handler = "null";
+    auto measure_latency = true;
+    for (int i = 2; i < argc; i++) {
+        if (std::strcmp(argv[i], "--no-latency") == 0) {
+            measure_latency = false;
+        } else {
+            handler = argv[i];
+        }
+    }
+
+    auto file = commands::CommandFile::open(argv[1]);
+    if (!file) {
+        std::perror("Can't open the command file");
+        return EXIT_FAILURE;
+    }
+    auto records = file->records();
+
+    // A byte per page is enough to fault all of them in
+    volatile uint8_t sink { };
+    auto bytes = std::as_bytes(records);
+    for (size_t i = 0; i < bytes.size(); i += 4096) {
+        sink = static_cast<uint8_t>(bytes[i]);
+    }
+    (void)sink;
+
+    if (handler == "null") {
+        return run(records, measure_latency, handlers::NullEventHandler { }, [] (auto&) { });
+    }
+    if (handler == "reports") {
+        // Far more than a single command reports
+        std::vector<handlers::ExecutionReport> buffer(1 << 16);
+        using Handler = handlers::ExecutionReportEventHandler;
+        return run(records, measure_latency, Handler { buffer },
+                   [] (MatchingEngine<Order, Handler>& engine) { engine.event_handler().reset(); });
+    }
+    if (handler == "top") {
+        return run(records, measure_latency,
+                   handlers::CommandFlushingEventHandler<handlers::TopOfBookEventHandler<CountingPublisher>> { }, [] (auto&) { });
+    }
+    if (handler == "mbp") {
+        return run(records, measure_latency,
+                   handlers::CommandFlushingEventHandler<handlers::MarketByPriceEventHandler<CountingPublisher>> { }, [] (auto&) { });
+    }
+    if (handler == "text") {
+        return run(records, measure_latency, handlers::BufferedTextEventHandler { STDOUT_FILENO }, [] (auto&) { });
+    }
+
+    std::fprintf(stderr, "Unknown event handler %s, expected one of null, reports, top, mbp, text\n", handler.data());
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,64 @@
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include <chronex/handlers/EventRecord.hpp>
+#include <chronex/ipc/EventBus.hpp>
+#include <chronex/store/OrderBooksStore.hpp>
+
+/*
+ * Serves the books of a matching engine that publishes its events to an
+ *  event bus (see handlers::EventBusEventHandler and serve_snapshot), to
+ *  local clients (see store/Protocol.hpp and store/StoreClient.hpp).
+ *
+ *  Usage: chronex-store <bus name> <socket path> [depth]
+ */
+
+namespace {
+
+std::atomic<bool> is_running { true };
+
+void stop(int) { is_running.store(false, std::memory_order_relaxed); }
+
+}
+
+int main(const int argc, char** argv) {
+    using namespace chronex;
+
+    if (argc < 3) {
+        std::fprintf(stderr, "Usage: %s <bus name> <socket path> [depth]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    store::OrderBooksStoreConfig config;
+    if (argc > 3) {
+        config.depth = std::stoul(argv[3]);
+    }
+
+    auto bus = ipc::EventBusReader<handlers::EventRecord>::open(argv[1]);
+    if (!bus) {
+        std::fprintf(stderr, "Can't open the event bus %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    auto store = store::OrderBooksStore<>::create(std::move(*bus), argv[2], config);
+    if (!store) {
+        std::perror("Can't listen on the socket");
+        return EXIT_FAILURE;
+    }
+
+    std::signal(SIGINT, stop);
+    std::signal(SIGTERM, stop);
+
+    while (is_running.load(std::memory_order_relaxed)) {
+        (void)store->poll(100);
+    }
+
+    std::printf("Served up to record %lu, %lu clients connected, %lu resyncs, %lu truncated snapshots\n",
+                static_cast<unsigned long>(store->position()),
+                static_cast<unsigned long>(store->clients_count()),
+                static_cast<unsigned long>(store->resyncs()),
+                static_cast<unsigned long>(store->truncated_snapshots()));
+}
@@ -0,0 +1,219 @@
+#include <cstdint>
+#include <memory>
+
+#include <benchmark/benchmark.h>
+
+#include "Fixtures.hpp"
+
+/*
+ * The hot paths of the matching engine, each with every event handler
+ *  (see Fixtures.hpp), over books of 1 to 1000 levels a side. The argument
+ *  of a benchmark is that depth, or for the matching benchmarks, how many
+ *  levels or orders a single command goes through.
+ */
+
+namespace chronex::benchmarks {
+
+namespace {
+
+constexpr int64_t BatchSize = 1024;
+
+// The matching benchmarks use up the book they match against, so they're
+//  batched over books of their own, all rebuilt at once
+constexpr uint32_t BooksPerBatch = 64;
+
+// A limit order that rests at one of the levels of its side, without matching
+template <typename Handler>
+void BM_AddOrderResting(benchmark::State& state) {
+    auto depth = state.range(0);
+    auto engine = make_engine<Handler>();
+    auto first_id = fill_book(*engine, depth);
+    uint64_t id = first_id;
+
+    run_batched(state, BatchSize, [&] {
+        // The orders of the last batch
+        while (id > first_id) engine->remove_order(OrderId { --id });
+    }, [&] (const int64_t i) {
+        auto price = MidPrice - 1 - uint64_t(i % depth);
+        engine->add_order(Order::buy_limit(id++, Symbol0, price, 10));
+    });
+}
+
+template <typename Handler>
+void BM_CancelOrder(benchmark::State& state) {
+    auto depth = state.range(0);
+    auto engine = make_engine<Handler>();
+    auto first_id = fill_book(*engine, depth);
+
+    run_batched(state, BatchSize, [&] {
+        for (int64_t i = 0; i < BatchSize; i++) {
+            engine->add_order(Order::buy_limit(first_id + uint64_t(i), Symbol0, MidPrice - 1 - uint64_t(i % depth), 10));
+        }
+    }, [&] (const int64_t i) {
+        engine->remove_order(OrderId { first_id + uint64_t(i) });
+    });
+}
+
+// Of an order in the middle of its level, and of the book
+template <typename Handler>
+void BM_ReduceOrder(benchmark::State& state) {
+    auto depth = state.range(0);
+    auto engine = make_engine<Handler>();
+    auto price = MidPrice - 1 - uint64_t(depth / 2);
+    auto id = fill_book(*engine, depth, 2);
+    // Never reduced to zero, so the book stays as it is
+    auto leaves_quantity = uint64_t { 1 } << 60;
+    engine->add_order(Order::buy_limit(id, Symbol0, price, leaves_quantity));
+    engine->add_order(Order::buy_limit(id + 1, Symbol0, price, 10));
+
+    for (auto _ : state) {
+        engine->reduce_order(OrderId { id }, Quantity { --leaves_quantity });
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Moves an order back and forth between the best level and the deepest one
+template <typename Handler>
+void BM_ModifyOrder(benchmark::State& state) {
+    auto depth = state.range(0);
+    auto engine = make_engine<Handler>();
+    auto id = fill_book(*engine, depth);
+    engine->add_order(Order::buy_limit(id, Symbol0, MidPrice - 1, 10));
+
+    uint64_t prices[] { MidPrice - uint64_t(depth), MidPrice - 1 };
+    uint64_t i = 0;
+    for (auto _ : state) {
+        engine->modify_order(OrderId { id }, Price { prices[i++ & 1] }, Quantity { 10 });
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Like modify, with a new ID each time
+template <typename Handler>
+void BM_ReplaceOrder(benchmark::State& state) {
+    auto depth = state.range(0);
+    auto engine = make_engine<Handler>();
+    auto id = fill_book(*engine, depth);
+    engine->add_order(Order::buy_limit(id, Symbol0, MidPrice - 1, 10));
+
+    uint64_t prices[] { MidPrice - uint64_t(depth), MidPrice - 1 };
+    for (auto _ : state) {
+        engine->replace_order(OrderId { id }, OrderId { id + 1 }, Price { prices[id & 1] }, Quantity { 10 });
+        ++id;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// A market order that takes all of the asks, a level at a time
+template <typename Handler>
+void BM_SweepLevels(benchmark::State& state) {
+    auto levels = state.range(0);
+    auto engine = make_engine<Handler>(BooksPerBatch);
+    uint64_t id = 1;
+    for (uint32_t book = 0; book < BooksPerBatch; book++) {
+        id = fill_side(*engine, OrderSide::BUY, levels, 1, id, 10, Symbol0 + book);
+    }
+
+    run_batched(state, BooksPerBatch, [&] {
+        for (uint32_t book = 0; book < BooksPerBatch; book++) {
+            id = fill_side(*engine, OrderSide::SELL, levels, 1, id, 10, Symbol0 + book);
+        }
+    }, [&] (const int64_t i) {
+        engine->add_order(Order::buy_market(id++, Symbol0 + uint32_t(i), uint64_t(levels) * 10));
+    });
+    // The first book is the first one matched after each rebuild
+    if (engine->orderbook_at(SymbolId { Symbol0 }).asks().orders_count() != 0) state.SkipWithError("The asks weren't swept");
+    state.counters["levels/s"] = benchmark::Counter(double(state.iterations() * levels), benchmark::Counter::kIsRate);
+}
+
+// An AON order that's only filled by all of the AON orders resting against it
+template <typename Handler>
+void BM_MatchAONChain(benchmark::State& state) {
+    auto chain = state.range(0);
+    auto engine = make_engine<Handler>(BooksPerBatch);
+    uint64_t id = 1;
+    for (uint32_t book = 0; book < BooksPerBatch; book++) {
+        id = fill_side(*engine, OrderSide::BUY, chain, 1, id, 10, Symbol0 + book);
+    }
+
+    run_batched(state, BooksPerBatch, [&] {
+        for (uint32_t book = 0; book < BooksPerBatch; book++) {
+            for (int64_t i = 0; i < chain; i++) {
+                engine->add_order(Order::sell_limit(id++, Symbol0 + book, MidPrice + 1, 10, TimeInForce::AON));
+            }
+        }
+    }, [&] (const int64_t i) {
+        engine->add_order(Order::buy_limit(id++, Symbol0 + uint32_t(i), MidPrice + 1, uint64_t(chain) * 10, TimeInForce::AON));
+    });
+    if (engine->orderbook_at(SymbolId { Symbol0 }).asks().orders_count() != 0) state.SkipWithError("The chain wasn't matched");
+}
+
+// A market order that triggers stop orders, each of which trades at the next level down
+template <typename Handler>
+void BM_StopCascade(benchmark::State& state) {
+    auto stops = state.range(0);
+    auto engine = make_engine<Handler>(BooksPerBatch);
+    uint64_t id = 1;
+
+    run_batched(state, BooksPerBatch, [&] {
+        // A level of bids for each stop order, and one more. The stops are at the second
+        //  level, which the market order trades at, and each of them takes the next level,
+        //  except for the last one, which has no bid left to take.
+        for (uint32_t book = 0; book < BooksPerBatch; book++) {
+            id = fill_side(*engine, OrderSide::BUY, stops + 1, 1, id, 10, Symbol0 + book);
+            for (int64_t i = 0; i < stops; i++) {
+                engine->add_order(Order::sell_stop(id++, Symbol0 + book, MidPrice - 2, 10));
+            }
+        }
+    }, [&] (const int64_t i) {
+        engine->add_order(Order::sell_market(id++, Symbol0 + uint32_t(i), 20));
+    });
+    auto& orderbook = engine->orderbook_at(SymbolId { Symbol0 });
+    if (int(orderbook.bids().orders_count() != 0) | int(orderbook.template levels<OrderType::STOP, OrderSide::SELL>().orders_count() != 0)) {
+        state.SkipWithError("The cascade didn't go all the way");
+    }
+    state.counters["stops/s"] = benchmark::Counter(double(state.iterations() * stops), benchmark::Counter::kIsRate);
+}
+
+// Raises the best bid by a tick, which moves the stop prices of all of the trailing sell stops
+template <typename Handler>
+void BM_RepriceTrailingStops(benchmark::State& state) {
+    auto stops = state.range(0);
+    std::unique_ptr<Engine<Handler>> engine;
+    uint64_t id = 1;
+    uint64_t price = MidPrice;
+    OrderId stop_id { 0 };
+    Price first_stop_price { 0 };
+
+    run_batched(state, BatchSize, [&] {
+        engine = make_engine<Handler>();
+        price = MidPrice;
+        engine->add_order(Order::buy_limit(id++, Symbol0, price, 10));
+        for (int64_t i = 0; i < stops; i++) {
+            engine->add_order(Order::trailing_sell_stop(id++, Symbol0, 0, 10, TrailingDistance::from_price(Price { 100 }, Price { 1 })));
+        }
+        stop_id = OrderId { id - 1 };
+        first_stop_price = engine->order_at(stop_id)->stop_price();
+    }, [&] (int64_t) {
+        // Trades at the new price, and leaves half of the bid there
+        ++price;
+        engine->add_order(Order::buy_limit(id++, Symbol0, price, 20));
+        engine->add_order(Order::sell_limit(id++, Symbol0, price, 10));
+    });
+    if (engine->order_at(stop_id)->stop_price() <= first_stop_price) state.SkipWithError("The trailing stops didn't move");
+    state.counters["stops/s"] = benchmark::Counter(double(state.iterations() * stops), benchmark::Counter::kIsRate);
+}
+
+}
+
+CHRONEX_ENGINE_BENCHMARK(BM_AddOrderResting);
+CHRONEX_ENGINE_BENCHMARK(BM_CancelOrder);
+CHRONEX_ENGINE_BENCHMARK(BM_ReduceOrder);
+CHRONEX_ENGINE_BENCHMARK(BM_ModifyOrder);
+CHRONEX_ENGINE_BENCHMARK(BM_ReplaceOrder);
+CHRONEX_ENGINE_BENCHMARK(BM_SweepLevels);
+CHRONEX_ENGINE_BENCHMARK(BM_MatchAONChain);
+CHRONEX_ENGINE_BENCHMARK(BM_StopCascade);
+CHRONEX_ENGINE_BENCHMARK(BM_RepriceTrailingStops);
+
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include <benchmark/benchmark.h>
+
+#include <chronex/handlers/CommandFlushingEventHandler.hpp>
+#include <chronex/handlers/MarketByPriceEventHandler.hpp>
+#include <chronex/handlers/NullEventHandler.hpp>
+#include <chronex/handlers/TopOfBookEventHandler.hpp>
+#include <chronex/matching/MatchingEngine.hpp>
+
+namespace chronex::benchmarks {
+
+// Stands in for a transport, without being optimized out
+struct SinkPublisher {
+    template <typename T>
+    void operator()(const T& update) noexcept { benchmark::DoNotOptimize(&update); }
+};
+
+// The event handlers each benchmark runs with, from none to full market data
+using NullHandler = handlers::NullEventHandler;
+using TopOfBookHandler = handlers::CommandFlushingEventHandler<handlers::TopOfBookEventHandler<SinkPublisher>>;
+using MarketByPriceHandler = handlers::CommandFlushingEventHandler<handlers::MarketByPriceEventHandler<SinkPublisher>>;
+
+template <typename Handler>
+using Engine = MatchingEngine<Order, Handler>;
+
+constexpr uint32_t Symbol0 = 0;
+
+// The resting orders are priced away from here, bids below and asks above
+constexpr uint64_t MidPrice = 1'000'000;
+
+// Fixtures are rebuilt from scratch, so they live on the heap to keep the stack small.
+//  The books are of the symbols from Symbol0 on.
+template <typename Handler>
+[[nodiscard]] std::unique_ptr<Engine<Handler>> make_engine(const uint32_t books_count = 1) {
+    auto engine = std::make_unique<Engine<Handler>>();
+    for (uint32_t book = 0; book < books_count; book++) {
+        engine->add_new_orderbook(Symbol { Symbol0 + book, "BENCH" });
+    }
+    return engine;
+}
+
+// Rests `levels` levels of `orders_per_level` orders each on a side, starting
+//  a tick away from the mid, with IDs from `first_id` on. Returns the next free ID.
+template <typename Handler>
+uint64_t fill_side(Engine<Handler>& engine, const OrderSide side, const int64_t levels, const int64_t orders_per_level,
+                   uint64_t first_id, const uint64_t quantity = 10, const uint32_t symbol = Symbol0) {
+    for (int64_t level = 1; level <= levels; level++) {
+        auto price = side == OrderSide::BUY ? MidPrice - uint64_t(level) : MidPrice + uint64_t(level);
+        for (int64_t i = 0; i < orders_per_level; i++) {
+            engine.add_order(Order::limit(first_id++, symbol, side, price, quantity));
+        }
+    }
+    return first_id;
+}
+
+// Both sides, `levels` deep, as a book would look before the benchmarked command
+template <typename Handler>
+uint64_t fill_book(Engine<Handler>& engine, const int64_t levels, const int64_t orders_per_level = 1, const uint64_t first_id = 1) {
+    auto next_id = fill_side(engine, OrderSide::BUY, levels, orders_per_level, first_id);
+    return fill_side(engine, OrderSide::SELL, levels, orders_per_level, next_id);
+}
+
+/*
+ * Runs `body(i)` for each iteration, timed, and `setup()` before every
+ *  `batch_size` of them, with the clock stopped. For commands that change
+ *  the book, `setup` brings it back to where it was, so that each iteration
+ *  sees the same book, and the cost of stopping the clock (a few hundred
+ *  nanoseconds) is spread over the batch.
+ */
+template <typename Setup, typename Body>
+void run_batched(benchmark::State& state, const int64_t batch_size, Setup&& setup, Body&& body) {
+    int64_t i = 0;
+    for (auto _ : state) {
+        if (i == 0) {
+            state.PauseTiming();
+            setup();
+            state.ResumeTiming();
+        }
+        body(i);
+        if (++i == batch_size) i = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+}
+
+// Every engine benchmark runs with each of the handlers, over books of 1 to 1000 levels
+#define CHRONEX_ENGINE_BENCHMARK(NAME)                                                                      \
+    BENCHMARK_TEMPLATE(NAME, chronex::benchmarks::NullHandler)->RangeMultiplier(10)->Range(1, 1000);          \
+    BENCHMARK_TEMPLATE(NAME, chronex::benchmarks::TopOfBookHandler)->RangeMultiplier(10)->Range(1, 1000);     \
+    BENCHMARK_TEMPLATE(NAME, chronex::benchmarks::MarketByPriceHandler)->RangeMultiplier(10)->Range(1, 1000)
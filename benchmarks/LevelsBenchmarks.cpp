@@ -0,0 +1,80 @@
+#include <algorithm>
+#include <cstdint>
+
+#include <benchmark/benchmark.h>
+
+#include <chronex/orderbook/levels/Levels.hpp>
+
+#include "Fixtures.hpp"
+
+/*
+ * The price levels of a side on their own, with 1 to 10000 levels. The
+ *  levels are a tick apart, and the inserted and erased ones go in between
+ *  them, so that they land anywhere in the levels, not only at their ends.
+ */
+
+namespace chronex::benchmarks {
+
+namespace {
+
+constexpr int64_t BatchSize = 1024;
+
+// The existing levels are at the even ticks, the inserted ones at the odd ticks
+constexpr Price level_price(const int64_t i) noexcept { return Price { MidPrice + 2 * uint64_t(i) }; }
+constexpr Price gap_price(const int64_t i) noexcept { return Price { MidPrice + 2 * uint64_t(i) + 1 }; }
+
+void fill_levels(AscendingLevels<Order>& levels, const int64_t count) {
+    for (int64_t i = 0; i < count; i++) (void)levels.add_level(level_price(i));
+}
+
+void BM_LevelsFind(benchmark::State& state) {
+    auto count = state.range(0);
+    AscendingLevels<Order> levels;
+    fill_levels(levels, count);
+
+    int64_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(levels.find(level_price(i)));
+        if (++i == count) i = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// New levels only, so a batch is at most as big as the levels, to not insert the same level twice
+void BM_LevelsInsert(benchmark::State& state) {
+    auto count = state.range(0);
+    auto batch_size = std::min(count, BatchSize);
+    AscendingLevels<Order> levels;
+    fill_levels(levels, count);
+
+    run_batched(state, batch_size, [&] {
+        for (int64_t i = 0; i < batch_size; i++) {
+            auto level_it = levels.find(gap_price(i));
+            if (level_it != levels.end()) levels.remove_level(level_it);
+        }
+    }, [&] (const int64_t i) {
+        benchmark::DoNotOptimize(levels.add_level(gap_price(i)));
+    });
+}
+
+// By price, the way a level is removed once its last order is gone
+void BM_LevelsErase(benchmark::State& state) {
+    auto count = state.range(0);
+    auto batch_size = std::min(count, BatchSize);
+    AscendingLevels<Order> levels;
+    fill_levels(levels, count);
+
+    run_batched(state, batch_size, [&] {
+        for (int64_t i = 0; i < batch_size; i++) (void)levels.add_level(gap_price(i));
+    }, [&] (const int64_t i) {
+        benchmark::DoNotOptimize(levels.remove_level(levels.find(gap_price(i))));
+    });
+}
+
+}
+
+BENCHMARK(BM_LevelsFind)->RangeMultiplier(10)->Range(1, 10'000);
+BENCHMARK(BM_LevelsInsert)->RangeMultiplier(10)->Range(1, 10'000);
+BENCHMARK(BM_LevelsErase)->RangeMultiplier(10)->Range(1, 10'000);
+
+}
@@ -4,6 +4,7 @@
 #include <algorithm>
 #include <cassert>
 #include <type_traits>
+#include <utility>
 
 namespace chronex::ds {
 
@@ -16,6 +17,11 @@ struct LinkedListNode {
     constexpr LinkedListNode(LinkedListNode* prev = nullptr, LinkedListNode* next = nullptr, Args&&... args)
         : _prev(prev), _next(next), _data(std::forward<Args>(args)...) {}
 
+    // Constructs the data in-place from what `make` returns, without any moves
+    template <typename Func>
+    constexpr LinkedListNode(std::in_place_t, Func&& make)
+        : _data(std::forward<Func>(make)()) {}
+
     T&       data()       noexcept { return _data; }
     const T& data() const noexcept { return _data; }
 
@@ -118,6 +124,7 @@ class LinkedList : private Allocator<LinkedListNode<T>> {
 public:
 
     using value_type = T;
+    using node_type = Node;
     using iterator = Iterator<Node, NextFunc, PrevFunc>;
     using const_iterator = Iterator<const Node, NextFunc, PrevFunc>;
     using reverse_iterator = Iterator<Node, PrevFunc, NextFunc>;
@@ -300,6 +307,16 @@ public:
         AllocTraits::deallocate(*this, node, 1);
     }
 
+    // Frees a node that isn't linked into any list. The allocator
+    //  is stateless, so it doesn't matter which list it came from.
+    template <typename Iter>
+    static constexpr void dispose(Iter pos) noexcept {
+        Allocator<Node> allocator;
+        Node* node = pos.node();
+        AllocTraits::destroy(allocator, node);
+        AllocTraits::deallocate(allocator, node, 1);
+    }
+
     template <typename Iter>
     constexpr iterator erase(Iter pos) noexcept {
         assert(pos.node() != &dummy_head() && pos.node() != &dummy_tail() && "Cannot erase at the end() or rend() iterator");
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include <chronex/utils/Threading.hpp>
+
+namespace chronex::ds {
+
+/*
+ * A fixed-capacity, lock-free, single-producer single-consumer ring.
+ *
+ * Head and tail grow monotonically and are masked on access, so the
+ *  capacity must be a power of two. Each side keeps a cached copy of
+ *  the other side's index and only reloads it when the cached value
+ *  says the ring is full (or empty), which keeps the shared cache
+ *  lines from bouncing between the two cores on every operation.
+ */
+template <typename T>
+class SPSCQueue {
+
+    // Raw storage so that T doesn't have to be default-constructible
+    struct Slot {
+        alignas(T) std::byte data[sizeof(T)];
+    };
+
+public:
+
+    using value_type = T;
+
+    explicit SPSCQueue(const size_t capacity)
+        : _mask(capacity - 1), _slots(std::make_unique_for_overwrite<Slot[]>(capacity)) {
+        assert(std::has_single_bit(capacity) && "SPSCQueue capacity must be a power of two");
+    }
+
+    SPSCQueue(const SPSCQueue&) = delete;
+    SPSCQueue& operator=(const SPSCQueue&) = delete;
+
+    SPSCQueue(SPSCQueue&&) = delete;
+    SPSCQueue& operator=(SPSCQueue&&) = delete;
+
+    ~SPSCQueue() noexcept {
+        consume([](T&) { });
+    }
+
+    [[nodiscard]] constexpr size_t capacity() const noexcept { return _mask + 1; }
+
+    // Only exact when called from either the producer or the consumer
+    //  while the other side is idle. Good enough for monitoring.
+    [[nodiscard]] size_t size() const noexcept {
+        return _tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire);
+    }
+
+    [[nodiscard]] bool is_empty() const noexcept { return size() == 0; }
+
+    // Producer side
+
+    /*
+     * Constructs the element without making it visible to the consumer.
+     *  A batch of deferred elements is published at once by commit(),
+     *  so the consumer sees one index update instead of one per element.
+     */
+    template <typename... Args>
+    [[nodiscard]] bool try_emplace_deferred(Args&&... args) noexcept(std::is_nothrow_constructible_v<T, Args...>) {
+        const auto tail = _pending_tail;
+        if (tail - _cached_head > _mask) {
+            _cached_head = _head.load(std::memory_order_acquire);
+            if (tail - _cached_head > _mask) return false;
+        }
+        std::construct_at(slot(tail), std::forward<Args>(args)...);
+        _pending_tail = tail + 1;
+        return true;
+    }
+
+    // Returns the element, which can still be filled in until it's committed
+    template <typename... Args>
+    T& emplace_deferred(Args&&... args) noexcept(std::is_nothrow_constructible_v<T, Args...>) {
+        utils::Backoff backoff;
+        while (!try_emplace_deferred(std::forward<Args>(args)...)) {
+            // The consumer can't free anything it hasn't seen yet
+            commit();
+            backoff.pause();
+        }
+        return *slot(_pending_tail - 1);
+    }
+
+    void commit() noexcept {
+        _tail.store(_pending_tail, std::memory_order_release);
+    }
+
+    template <typename... Args>
+    [[nodiscard]] bool try_emplace(Args&&... args) noexcept(std::is_nothrow_constructible_v<T, Args...>) {
+        if (!try_emplace_deferred(std::forward<Args>(args)...)) return false;
+        commit();
+        return true;
+    }
+
+    [[nodiscard]] bool try_push(T&& value) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        return try_emplace(std::move(value));
+    }
+
+    // Spins while the ring is full. The arguments are only consumed on
+    //  the successful attempt, so forwarding them again is fine.
+    template <typename... Args>
+    void emplace(Args&&... args) noexcept(std::is_nothrow_constructible_v<T, Args...>) {
+        utils::Backoff backoff;
+        while (!try_emplace(std::forward<Args>(args)...)) {
+            backoff.pause();
+        }
+    }
+
+    void push(T&& value) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        emplace(std::move(value));
+    }
+
+    // Consumer side
+
+    [[nodiscard]] T* front() noexcept {
+        const auto head = _head.load(std::memory_order_relaxed);
+        if (head == _cached_tail) {
+            _cached_tail = _tail.load(std::memory_order_acquire);
+            if (head == _cached_tail) return nullptr;
+        }
+        return slot(head);
+    }
+
+    void pop() noexcept {
+        const auto head = _head.load(std::memory_order_relaxed);
+        assert(head != _tail.load(std::memory_order_relaxed) && "Popping from an empty SPSCQueue");
+        std::destroy_at(slot(head));
+        _head.store(head + 1, std::memory_order_release);
+    }
+
+    /*
+     * Hands up to `max_batch` elements to `func` (which may move from
+     *  them), then releases all of their slots with a single store. This
+     *  is the preferred way of draining the queue, since the producer
+     *  only observes one index update per batch instead of per element.
+     */
+    template <typename Func>
+    size_t consume(Func&& func, const size_t max_batch = std::numeric_limits<size_t>::max()) {
+        const auto head = _head.load(std::memory_order_relaxed);
+        _cached_tail = _tail.load(std::memory_order_acquire);
+        const auto count = std::min(_cached_tail - head, max_batch);
+
+        for (size_t i = 0; i < count; i++) {
+            auto* element = slot(head + i);
+            func(*element);
+            std::destroy_at(element);
+        }
+
+        if (count != 0) {
+            _head.store(head + count, std::memory_order_release);
+        }
+
+        return count;
+    }
+
+private:
+
+    [[nodiscard]] T* slot(const size_t index) const noexcept {
+        return std::launder(reinterpret_cast<T*>(_slots[index & _mask].data));
+    }
+
+    // Consumer-owned
+    alignas(utils::CacheLineSize) std::atomic<size_t> _head { 0 };
+    size_t _cached_tail { 0 };
+
+    // Producer-owned
+    alignas(utils::CacheLineSize) std::atomic<size_t> _tail { 0 };
+    size_t _pending_tail { 0 };
+    size_t _cached_head { 0 };
+
+    // Read-only after construction
+    alignas(utils::CacheLineSize) const size_t _mask;
+    std::unique_ptr<Slot[]> _slots;
+};
+
+}
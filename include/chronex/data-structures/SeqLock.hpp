@@ -0,0 +1,115 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <type_traits>
+
+#include <chronex/utils/Threading.hpp>
+
+namespace chronex::ds {
+
+/*
+ * A single-writer, multiple-readers sequence lock around a small trivially
+ *  copyable value. The writer never waits on the readers, and the readers
+ *  never write to shared memory, so any number of them can poll the value
+ *  without slowing the writer down (other than by pulling its cache line).
+ *
+ * The sequence is odd while a store is in progress. A reader copies the
+ *  value between two reads of the sequence and only accepts the copy if
+ *  both reads are the same even number. try_load() makes a single attempt
+ *  and is wait-free, load() retries until it gets a consistent copy, which
+ *  only takes more than one attempt if it races with a store.
+ *
+ * The value is kept as relaxed atomic words rather than a plain T, so that
+ *  the racy copies of the readers are not data races.
+ */
+template <typename T>
+class alignas(utils::CacheLineSize) SeqLock {
+
+    static_assert(std::is_trivially_copyable_v<T>, "SeqLock values are copied word by word");
+
+    constexpr static size_t WordsCount = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    using Words = std::array<uint64_t, WordsCount>;
+
+public:
+
+    using value_type = T;
+
+    SeqLock() noexcept requires std::default_initializable<T> : SeqLock(T { }) { }
+
+    explicit SeqLock(const T& value) noexcept { write_words(value); }
+
+    SeqLock(const SeqLock&) = delete;
+    SeqLock& operator=(const SeqLock&) = delete;
+
+    // Writer side. Only one thread may store at a time.
+    void store(const T& value) noexcept {
+        const auto sequence = _sequence.load(std::memory_order_relaxed);
+        _sequence.store(sequence + 1, std::memory_order_relaxed);
+        // Keeps the stores of the words from moving above the odd sequence
+        std::atomic_thread_fence(std::memory_order_release);
+        write_words(value);
+        _sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    // The last stored value. Only the writer can read it without the sequence.
+    [[nodiscard]] T peek() const noexcept { return read_words(); }
+
+    // Reader side
+
+    // Empty if a store is in progress
+    [[nodiscard]] std::optional<T> try_load() const noexcept {
+        const auto before = _sequence.load(std::memory_order_acquire);
+        if (before & 1) return std::nullopt;
+        auto value = read_words();
+        // Keeps the loads of the words from moving below the second read
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (_sequence.load(std::memory_order_relaxed) != before) return std::nullopt;
+        return value;
+    }
+
+    [[nodiscard]] T load() const noexcept {
+        auto value = try_load();
+        while (!value) {
+            utils::cpu_relax();
+            value = try_load();
+        }
+        return *value;
+    }
+
+    // Increases by 2 with each store
+    [[nodiscard]] uint64_t sequence() const noexcept { return _sequence.load(std::memory_order_acquire); }
+
+private:
+
+    void write_words(const T& value) noexcept {
+        Words words { };
+        std::memcpy(words.data(), &value, sizeof(T));
+        for (size_t i = 0; i < WordsCount; i++) {
+            _words[i].store(words[i], std::memory_order_relaxed);
+        }
+    }
+
+    [[nodiscard]] T read_words() const noexcept {
+        Words words;
+        for (size_t i = 0; i < WordsCount; i++) {
+            words[i] = _words[i].load(std::memory_order_relaxed);
+        }
+        // T doesn't have to be default-constructible
+        std::array<std::byte, sizeof(T)> bytes;
+        std::memcpy(bytes.data(), words.data(), sizeof(T));
+        return std::bit_cast<T>(bytes);
+    }
+
+    std::atomic<uint64_t> _sequence { 0 };
+    std::array<std::atomic<uint64_t>, WordsCount> _words;
+};
+
+}
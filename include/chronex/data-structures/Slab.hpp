@@ -0,0 +1,172 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+
+namespace chronex::ds {
+
+/*
+ * A fixed number of pre-allocated, uninitialized slots of T, shared
+ *  between threads. Any thread can acquire and release slots. The
+ *  free slots form a lock-free stack of indices; the head carries a
+ *  version tag next to the index, so that a slot being released and
+ *  acquired again between a load and a CAS is not mistaken for the
+ *  same state (the ABA problem).
+ *
+ * The slab only hands out raw storage. Constructing and destroying
+ *  the objects is up to the user.
+ */
+template <typename T>
+class Slab {
+
+    struct Slot {
+        alignas(T) std::byte data[sizeof(T)];
+    };
+
+public:
+
+    constexpr static uint32_t NoSlot = std::numeric_limits<uint32_t>::max();
+
+    explicit Slab(const uint32_t capacity)
+        : _capacity(capacity)
+        , _slots(std::make_unique_for_overwrite<Slot[]>(capacity))
+        , _next(std::make_unique<std::atomic<uint32_t>[]>(capacity)) {
+        assert(capacity < NoSlot && "Slab capacity is too big");
+        for (uint32_t i = 0; i < capacity; i++) {
+            _next[i].store(i + 1 == capacity ? NoSlot : i + 1, std::memory_order_relaxed);
+        }
+        _head.store(pack(0, capacity == 0 ? NoSlot : 0), std::memory_order_release);
+    }
+
+    Slab(const Slab&) = delete;
+    Slab& operator=(const Slab&) = delete;
+
+    Slab(Slab&&) = delete;
+    Slab& operator=(Slab&&) = delete;
+
+    [[nodiscard]] constexpr uint32_t capacity() const noexcept { return _capacity; }
+
+    // Returns nullptr if all slots are in use
+    [[nodiscard]] T* try_acquire() noexcept {
+        auto head = _head.load(std::memory_order_acquire);
+        while (true) {
+            auto index = head_index(head);
+            if (index == NoSlot) return nullptr;
+            // Might read the link of a slot that's concurrently acquired, in
+            //  which case the tag of the head has changed and the CAS fails
+            auto next = _next[index].load(std::memory_order_relaxed);
+            if (_head.compare_exchange_weak(head, pack(head_tag(head) + 1, next), std::memory_order_acq_rel, std::memory_order_acquire)) {
+                return at(index);
+            }
+        }
+    }
+
+    void release(T* slot) noexcept {
+        assert(owns(slot) && "Releasing a slot that doesn't belong to this slab");
+        auto index = index_of(slot);
+        auto head = _head.load(std::memory_order_relaxed);
+        do {
+            _next[index].store(head_index(head), std::memory_order_relaxed);
+        } while (!_head.compare_exchange_weak(head, pack(head_tag(head) + 1, index), std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    // Walks the free slots, so it's only exact while no other thread uses the slab
+    [[nodiscard]] uint32_t free_count() const noexcept {
+        uint32_t count = 0;
+        for (auto index = head_index(_head.load(std::memory_order_acquire)); index != NoSlot; index = _next[index].load(std::memory_order_relaxed)) {
+            ++count;
+        }
+        return count;
+    }
+
+    [[nodiscard]] bool owns(const T* pointer) const noexcept {
+        auto* p = reinterpret_cast<const std::byte*>(pointer);
+        auto* begin = _slots[0].data;
+        auto* end = begin + sizeof(Slot) * _capacity;
+        // std::less gives a total order even for unrelated pointers
+        return !std::less<const std::byte*>{ }(p, begin) && std::less<const std::byte*>{ }(p, end);
+    }
+
+    [[nodiscard]] T* at(const uint32_t index) const noexcept {
+        assert(index < _capacity && "Slot index out of range");
+        return reinterpret_cast<T*>(_slots[index].data);
+    }
+
+    [[nodiscard]] uint32_t index_of(const T* slot) const noexcept {
+        assert(owns(slot) && "The slot doesn't belong to this slab");
+        auto offset = reinterpret_cast<const std::byte*>(slot) - _slots[0].data;
+        return static_cast<uint32_t>(static_cast<size_t>(offset) / sizeof(Slot));
+    }
+
+private:
+
+    [[nodiscard]] constexpr static uint64_t pack(const uint32_t tag, const uint32_t index) noexcept {
+        return (static_cast<uint64_t>(tag) << 32) | index;
+    }
+
+    [[nodiscard]] constexpr static uint32_t head_tag(const uint64_t head) noexcept { return static_cast<uint32_t>(head >> 32); }
+
+    [[nodiscard]] constexpr static uint32_t head_index(const uint64_t head) noexcept { return static_cast<uint32_t>(head); }
+
+    const uint32_t _capacity;
+    std::unique_ptr<Slot[]> _slots;
+    std::unique_ptr<std::atomic<uint32_t>[]> _next;
+
+    alignas(64) std::atomic<uint64_t> _head { pack(0, NoSlot) };
+};
+
+/*
+ * A stateless allocator that serves single objects from the slab installed
+ *  for T, and falls back to std::allocator when there is none, when it's
+ *  exhausted, or for arrays. Memory coming from the slab goes back to it
+ *  no matter which thread or container frees it, which is what lets
+ *  an object built in a slab slot by one thread be adopted (and later
+ *  freed) by a container on another thread.
+ *
+ * The installed slab must outlive every object allocated from it.
+ */
+template <typename T>
+struct SlabAllocator {
+    using value_type = T;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+
+    constexpr SlabAllocator() noexcept = default;
+
+    template <typename U>
+    constexpr SlabAllocator(const SlabAllocator<U>&) noexcept { }
+
+    [[nodiscard]] T* allocate(const size_t n) {
+        if (auto* slab = installed(); slab != nullptr && n == 1) {
+            if (auto* slot = slab->try_acquire(); slot != nullptr) return slot;
+        }
+        return std::allocator<T>{ }.allocate(n);
+    }
+
+    void deallocate(T* pointer, const size_t n) noexcept {
+        if (auto* slab = installed(); slab != nullptr && slab->owns(pointer)) {
+            return slab->release(pointer);
+        }
+        std::allocator<T>{ }.deallocate(pointer, n);
+    }
+
+    static void install(Slab<T>* slab) noexcept {
+        [[maybe_unused]] auto* previous = _slab.exchange(slab, std::memory_order_acq_rel);
+        assert((previous == nullptr || slab == nullptr) && "Another slab is already installed for this type");
+    }
+
+    [[nodiscard]] static Slab<T>* installed() noexcept { return _slab.load(std::memory_order_acquire); }
+
+    friend constexpr bool operator==(const SlabAllocator&, const SlabAllocator&) noexcept { return true; }
+
+private:
+
+    inline static std::atomic<Slab<T>*> _slab { nullptr };
+};
+
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+// SSE2 is a part of x86-64, so it's there without any flags
+#if defined(__x86_64__)
+#include <emmintrin.h>
+#endif
+
+namespace chronex::fix {
+
+// The field delimiter
+constexpr char Soh = '\x01';
+
+constexpr std::string_view BeginString = "8=FIX.4.4\x01";
+
+/*
+ * Finds the delimiters of a buffer, 16 bytes at a time. A chunk is loaded
+ *  and compared once, and its delimiters are taken from the mask one after
+ *  the other, so the fields of a message (a handful of bytes each) are
+ *  delimited with a load every two or three fields, rather than a compare
+ *  per byte. Buffers that don't fill a chunk are scanned a byte at a time.
+ */
+class DelimiterScanner {
+public:
+
+    constexpr DelimiterScanner(const char* begin, const char* end) noexcept : _chunk(begin), _end(end) { }
+
+    // The next delimiter, or nullptr if there is none
+    [[nodiscard]] const char* next() noexcept {
+        while (_mask == 0) {
+            if (_chunk >= _end) return nullptr;
+#if defined(__x86_64__)
+            if (_end - _chunk >= ChunkSize) {
+                auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_chunk));
+                auto matches = _mm_cmpeq_epi8(chunk, _mm_set1_epi8(Soh));
+                _mask = static_cast<uint32_t>(_mm_movemask_epi8(matches));
+                _base = _chunk;
+                _chunk += ChunkSize;
+                continue;
+            }
+#endif
+            auto found = static_cast<const char*>(std::memchr(_chunk, Soh, size_t(_end - _chunk)));
+            _chunk = found == nullptr ? _end : found + 1;
+            return found;
+        }
+        auto result = _base + std::countr_zero(_mask);
+        _mask &= _mask - 1;
+        return result;
+    }
+
+private:
+
+    constexpr static ptrdiff_t ChunkSize = 16;
+
+    const char* _chunk;
+    const char* _end;
+    const char* _base = nullptr;
+    uint32_t _mask = 0;
+};
+
+// The sum of the bytes, modulo 256, as the CheckSum(10) field has it
+[[nodiscard]] inline uint8_t checksum(const char* begin, const char* end) noexcept {
+    uint64_t sum = 0;
+#if defined(__x86_64__)
+    // Sums of absolute differences against zero add up 8 bytes into each half
+    auto sums = _mm_setzero_si128();
+    for (; end - begin >= 16; begin += 16) {
+        auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+        sums = _mm_add_epi64(sums, _mm_sad_epu8(chunk, _mm_setzero_si128()));
+    }
+    sum += static_cast<uint64_t>(_mm_cvtsi128_si64(sums)) + static_cast<uint64_t>(_mm_cvtsi128_si64(_mm_unpackhi_epi64(sums, sums)));
+#endif
+    for (; begin != end; ++begin) sum += static_cast<uint8_t>(*begin);
+    return static_cast<uint8_t>(sum);
+}
+
+}
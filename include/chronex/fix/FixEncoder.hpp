@@ -0,0 +1,254 @@
+#pragma once
+
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <chronex/fix/Common.hpp>
+
+#include <chronex/handlers/ExecutionReportEventHandler.hpp>
+
+#include <chronex/orderbook/OrderUtils.hpp>
+
+namespace chronex::fix {
+
+struct EncoderConfig {
+    std::string sender_comp_id;
+    std::string target_comp_id;
+    // Prices are in units of 10^-price_decimals, as make_request takes them
+    uint32_t price_decimals = 0;
+};
+
+// What an encoder can't tell from a single report, for the callers that keep track of it
+struct OrderTotals {
+    uint64_t cum_quantity = 0;
+    uint64_t avg_price = 0;
+};
+
+/*
+ * A fill is a single report for both orders of a trade (see
+ *  handlers::ExecutionReport), from the aggressor's side. This is the
+ *  same fill from the resting order's side, given what's left of it (e.g.
+ *  from the engine, after the command). Resting orders are limit orders,
+ *  since stop orders are limit or market orders once they are triggered.
+ */
+[[nodiscard]] constexpr handlers::ExecutionReport resting_side(const handlers::ExecutionReport& fill,
+                                                               const uint64_t leaves_quantity) noexcept {
+    auto result = fill;
+    result.order_id = fill.other_order_id;
+    result.other_order_id = fill.order_id;
+    result.leaves_quantity = leaves_quantity;
+    result.order_type = OrderType::LIMIT;
+    result.side = fill.side == OrderSide::BUY ? OrderSide::SELL : OrderSide::BUY;
+    return result;
+}
+
+/*
+ * Encodes the reports of the engine into FIX 4.4 ExecutionReport(8)
+ *  messages, for a single session, e.g. from an ExecutionReportEventHandler
+ *  after each command:
+ *
+ *      for (auto& report : handler.reports()) {
+ *          output += encoder.encode(output_buffer.subspan(output), report, symbol_of(report.symbol_id));
+ *      }
+ *
+ * The messages are written straight into the caller's buffer, with the
+ *  numbers formatted in place and the checksum taken with SIMD, so nothing
+ *  is allocated. The encoder keeps the MsgSeqNum(34) and ExecID(17) of the
+ *  session, and a SendingTime(52) that's formatted once per set_sending_time
+ *  rather than once per message, since the clock is the slowest part of it.
+ *
+ * The ClOrdID(11) and the OrderID(37) are both the ID of the order, the
+ *  way make_request has them. The CumQty(14) and AvgPx(6) are taken from
+ *  the totals, and are zero unless given.
+ */
+class ExecutionReportEncoder {
+public:
+
+    explicit ExecutionReportEncoder(EncoderConfig config) noexcept : _config(std::move(config)) {
+        set_sending_time(std::chrono::system_clock::now());
+    }
+
+    void set_sending_time(const std::chrono::system_clock::time_point time) noexcept {
+        auto since_epoch = time.time_since_epoch();
+        auto seconds = std::chrono::duration_cast<std::chrono::seconds>(since_epoch);
+        auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(since_epoch - seconds).count();
+        auto calendar_time = static_cast<std::time_t>(seconds.count());
+        std::tm utc { };
+        ::gmtime_r(&calendar_time, &utc);
+        // YYYYMMDD-HH:MM:SS.sss
+        std::snprintf(_sending_time.data(), _sending_time.size(), "%04d%02d%02d-%02d:%02d:%02d.%03d",
+                      utc.tm_year + 1900, utc.tm_mon + 1, utc.tm_mday, utc.tm_hour, utc.tm_min, utc.tm_sec,
+                      static_cast<int>(millis));
+    }
+
+    /*
+     * Writes the message of the report at the front of `output`, and
+     *  returns its size. If it doesn't fit, nothing is written (or rather,
+     *  nothing of it is valid), the sequence numbers stay as they are, and
+     *  0 is returned.
+     */
+    [[nodiscard]] size_t encode(const std::span<char> output, const handlers::ExecutionReport& report,
+                                const std::string_view symbol, const OrderTotals totals = { }) noexcept {
+        // The body is written after the longest header, then the header right before it
+        constexpr size_t HeaderCapacity = BeginString.size() + 2 + MaxLengthDigits + 1;
+        if (output.size() < HeaderCapacity) return 0;
+
+        Writer body { output.data() + HeaderCapacity, output.data() + output.size() };
+        body.field("35", "8");
+        body.field("49", _config.sender_comp_id);
+        body.field("56", _config.target_comp_id);
+        body.field("34", _next_sequence);
+        body.field("52", std::string_view { _sending_time.data(), SendingTimeSize });
+        body.field("37", report.order_id);
+        body.field("11", report.order_id);
+        body.field("17", _next_exec_id);
+        body.field("150", exec_type(report.type));
+        body.field("39", order_status(report));
+        body.field("55", symbol);
+        body.field("54", report.side == OrderSide::BUY ? "1" : "2");
+        body.field("40", order_type(report.order_type));
+        if (report.type == handlers::ExecutionReportType::FILL) {
+            body.field("32", report.quantity);
+            body.price_field("31", report.price, _config.price_decimals);
+        }
+        body.field("151", leaves_quantity(report));
+        body.field("14", totals.cum_quantity);
+        body.price_field("6", totals.avg_price, _config.price_decimals);
+        if (body.is_full()) return 0;
+
+        auto body_length = static_cast<size_t>(body.position - (output.data() + HeaderCapacity));
+        char length[MaxLengthDigits];
+        auto length_end = std::to_chars(length, length + MaxLengthDigits, body_length).ptr;
+        if (length_end == length + MaxLengthDigits) return 0;
+        auto length_size = static_cast<size_t>(length_end - length);
+
+        // Moved to the front along with the body, which is a short copy next to a send
+        auto header_size = BeginString.size() + 2 + length_size + 1;
+        auto message = output.data() + HeaderCapacity - header_size;
+        std::memcpy(message, BeginString.data(), BeginString.size());
+        std::memcpy(message + BeginString.size(), "9=", 2);
+        std::memcpy(message + BeginString.size() + 2, length, length_size);
+        message[header_size - 1] = Soh;
+
+        auto size = header_size + body_length;
+        std::memmove(output.data(), message, size);
+
+        Writer trailer { output.data() + size, output.data() + output.size() };
+        auto sum = checksum(output.data(), output.data() + size);
+        char digits[3] = { char('0' + sum / 100), char('0' + sum / 10 % 10), char('0' + sum % 10) };
+        trailer.field("10", std::string_view { digits, 3 });
+        if (trailer.is_full()) return 0;
+
+        ++_next_sequence;
+        ++_next_exec_id;
+        return size + TrailerSize;
+    }
+
+    [[nodiscard]] uint64_t next_sequence() const noexcept { return _next_sequence; }
+
+    // E.g. to carry on with the sequence of a session that reconnected
+    void set_next_sequence(const uint64_t sequence) noexcept { _next_sequence = sequence; }
+
+    [[nodiscard]] const EncoderConfig& config() const noexcept { return _config; }
+
+private:
+
+    constexpr static size_t MaxLengthDigits = 6;
+    constexpr static size_t TrailerSize = 7;
+    constexpr static size_t SendingTimeSize = 21;
+
+    // Appends fields, until it runs out of room
+    struct Writer {
+        void field(const std::string_view tag, const std::string_view value) noexcept {
+            auto size = tag.size() + value.size() + 2;
+            if (static_cast<size_t>(end - position) < size) {
+                position = end;
+                _is_full = true;
+                return;
+            }
+            std::memcpy(position, tag.data(), tag.size());
+            position[tag.size()] = '=';
+            std::memcpy(position + tag.size() + 1, value.data(), value.size());
+            position[size - 1] = Soh;
+            position += size;
+        }
+
+        void field(const std::string_view tag, const uint64_t value) noexcept {
+            char digits[20];
+            auto digits_end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+            field(tag, std::string_view { digits, static_cast<size_t>(digits_end - digits) });
+        }
+
+        void price_field(const std::string_view tag, const uint64_t value, const uint32_t decimals) noexcept {
+            if (decimals == 0) return field(tag, value);
+            // Zeros in front, so that there are digits on both sides of the point
+            char digits[48];
+            auto digits_end = std::to_chars(digits + 24, digits + sizeof(digits), value).ptr;
+            auto digits_begin = digits + 24;
+            while (static_cast<size_t>(digits_end - digits_begin) <= decimals) *--digits_begin = '0';
+            auto integer_size = static_cast<size_t>(digits_end - digits_begin) - decimals;
+            std::memmove(digits_begin - 1, digits_begin, integer_size);
+            digits_begin[integer_size - 1] = '.';
+            field(tag, std::string_view { digits_begin - 1, static_cast<size_t>(digits_end - digits_begin) + 1 });
+        }
+
+        [[nodiscard]] bool is_full() const noexcept { return _is_full; }
+
+        char* position;
+        char* end;
+        bool _is_full = false;
+    };
+
+    // ExecType(150)
+    [[nodiscard]] constexpr static std::string_view exec_type(const handlers::ExecutionReportType type) noexcept {
+        switch (type) {
+            case handlers::ExecutionReportType::REST:    return "0";
+            case handlers::ExecutionReportType::FILL:    return "F";
+            case handlers::ExecutionReportType::CANCEL:  return "4";
+            case handlers::ExecutionReportType::TRIGGER: return "L";
+        }
+        return "0";
+    }
+
+    // OrdStatus(39)
+    [[nodiscard]] constexpr static std::string_view order_status(const handlers::ExecutionReport& report) noexcept {
+        switch (report.type) {
+            case handlers::ExecutionReportType::FILL:   return report.leaves_quantity == 0 ? "2" : "1";
+            case handlers::ExecutionReportType::CANCEL: return "4";
+            default:                                    return "0";
+        }
+    }
+
+    // OrdType(40), with the trailing stops as stops, as make_order_type takes them
+    [[nodiscard]] constexpr static std::string_view order_type(const OrderType type) noexcept {
+        if (is_market(type) & !is_stop(type)) return "1";
+        if (is_limit(type) & !is_stop(type)) return "2";
+        return is_limit(type) ? "4" : "3";
+    }
+
+    // LeavesQty(151)
+    [[nodiscard]] constexpr static uint64_t leaves_quantity(const handlers::ExecutionReport& report) noexcept {
+        switch (report.type) {
+            case handlers::ExecutionReportType::FILL:   return report.leaves_quantity;
+            case handlers::ExecutionReportType::CANCEL: return 0;
+            default:                                    return report.quantity;
+        }
+    }
+
+    EncoderConfig _config;
+    std::array<char, SendingTimeSize + 1> _sending_time { };
+    uint64_t _next_sequence = 1;
+    uint64_t _next_exec_id = 1;
+};
+
+}
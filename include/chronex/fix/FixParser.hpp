@@ -0,0 +1,338 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string_view>
+
+#include <chronex/fix/Common.hpp>
+
+#include <chronex/gateway/Protocol.hpp>
+
+#include <chronex/orderbook/OrderUtils.hpp>
+
+namespace chronex::fix {
+
+/*
+ * The fields of a message that order entry uses, as views into the buffer
+ *  the message was parsed from, so they are valid for as long as the buffer
+ *  is. Nothing is copied or converted until the message is made into a
+ *  request (see make_request). Fields that aren't in the message are
+ *  empty, and fields that aren't listed here are skipped.
+ */
+struct Message {
+    std::string_view msg_type;                 // 35
+    std::string_view msg_seq_num;              // 34
+    std::string_view sender_comp_id;           // 49
+    std::string_view target_comp_id;           // 56
+    std::string_view cl_ord_id;                // 11
+    std::string_view orig_cl_ord_id;           // 41
+    std::string_view symbol;                   // 55
+    std::string_view side;                     // 54
+    std::string_view order_qty;                // 38
+    std::string_view ord_type;                 // 40
+    std::string_view price;                    // 44
+    std::string_view stop_px;                  // 99
+    std::string_view time_in_force;            // 59
+    std::string_view exec_inst;                // 18
+    std::string_view max_floor;                // 111
+    std::string_view peg_offset_value;         // 211
+    std::string_view mass_cancel_request_type; // 530
+
+    constexpr void set(const uint32_t tag, const std::string_view value) noexcept {
+        switch (tag) {
+            case 35:  msg_type = value; break;
+            case 34:  msg_seq_num = value; break;
+            case 49:  sender_comp_id = value; break;
+            case 56:  target_comp_id = value; break;
+            case 11:  cl_ord_id = value; break;
+            case 41:  orig_cl_ord_id = value; break;
+            case 55:  symbol = value; break;
+            case 54:  side = value; break;
+            case 38:  order_qty = value; break;
+            case 40:  ord_type = value; break;
+            case 44:  price = value; break;
+            case 99:  stop_px = value; break;
+            case 59:  time_in_force = value; break;
+            case 18:  exec_inst = value; break;
+            case 111: max_floor = value; break;
+            case 211: peg_offset_value = value; break;
+            case 530: mass_cancel_request_type = value; break;
+            default: break;
+        }
+    }
+};
+
+enum class ParseStatus : uint8_t {
+    COMPLETE,
+    // The buffer ends before the message does
+    INCOMPLETE,
+    // Not a FIX 4.4 message, or its length or checksum are off. Nothing
+    //  after it can be trusted to start at a message.
+    MALFORMED,
+};
+
+struct ParseResult {
+    ParseStatus status;
+    // The bytes the message takes at the front of the buffer, when complete
+    size_t size;
+};
+
+// Digits only, without a sign
+[[nodiscard]] constexpr std::optional<uint64_t> parse_uint(const std::string_view text) noexcept {
+    // Any 19 digits fit
+    if (int(text.empty()) | int(text.size() > 19)) return std::nullopt;
+    uint64_t value = 0;
+    for (auto c : text) {
+        auto digit = static_cast<unsigned>(c - '0');
+        if (digit > 9) return std::nullopt;
+        value = value * 10 + digit;
+    }
+    return value;
+}
+
+/*
+ * A decimal in units of 10^-decimals, e.g. "100.25" is 10025 with 2
+ *  decimals. Digits past the decimals can only be zeros, since they would
+ *  be lost otherwise.
+ */
+[[nodiscard]] constexpr std::optional<uint64_t> parse_decimal(const std::string_view text, const uint32_t decimals) noexcept {
+    auto point = text.find('.');
+    auto integer = text.substr(0, point);
+    auto fraction = point == std::string_view::npos ? std::string_view { } : text.substr(point + 1);
+    if (int(integer.size() + decimals > 19) | int(integer.empty() & fraction.empty())) return std::nullopt;
+
+    uint64_t value = 0;
+    if (!integer.empty()) {
+        auto parsed = parse_uint(integer);
+        if (!parsed) return std::nullopt;
+        value = *parsed;
+    }
+    for (uint32_t i = 0; i < decimals; i++) {
+        auto digit = i < fraction.size() ? static_cast<unsigned>(fraction[i] - '0') : 0u;
+        if (digit > 9) return std::nullopt;
+        value = value * 10 + digit;
+    }
+    for (size_t i = decimals; i < fraction.size(); i++) {
+        if (fraction[i] != '0') return std::nullopt;
+    }
+    return value;
+}
+
+/*
+ * Parses the message at the front of `buffer` into `message`, e.g. for
+ *  a session reading from a socket:
+ *
+ *      auto result = parse_message(buffer, message);
+ *      while (result.status == ParseStatus::COMPLETE) {
+ *          ...
+ *          buffer.remove_prefix(result.size);
+ *          result = parse_message(buffer, message);
+ *      }
+ *
+ * The BeginString(8), BodyLength(9), and CheckSum(10) are checked before
+ *  the body is looked at, so an incomplete message costs a few compares.
+ *  The body is then split into fields with a DelimiterScanner, and the tags
+ *  are read on the way to the '=' of each field.
+ */
+[[nodiscard]] inline ParseResult parse_message(const std::string_view buffer, Message& message) noexcept {
+    constexpr ParseResult Incomplete { ParseStatus::INCOMPLETE, 0 };
+    constexpr ParseResult Malformed { ParseStatus::MALFORMED, 0 };
+    constexpr std::string_view Header = "8=FIX.4.4\x01" "9=";
+    constexpr std::string_view Trailer = "10=";
+    // Bodies are well under a megabyte
+    constexpr size_t MaxLengthDigits = 6;
+    // "10=" with 3 digits and a delimiter
+    constexpr size_t TrailerSize = 7;
+
+    if (buffer.size() < Header.size()) return Header.starts_with(buffer) ? Incomplete : Malformed;
+    if (!buffer.starts_with(Header)) return Malformed;
+
+    auto length = buffer.substr(Header.size(), MaxLengthDigits + 1);
+    auto length_end = length.find(Soh);
+    if (length_end == std::string_view::npos) return length.size() <= MaxLengthDigits ? Incomplete : Malformed;
+    auto body_length = parse_uint(length.substr(0, length_end));
+    if (!body_length) return Malformed;
+
+    auto body_begin = Header.size() + length_end + 1;
+    auto body_end = body_begin + *body_length;
+    auto size = body_end + TrailerSize;
+    if (buffer.size() < size) return Incomplete;
+
+    auto trailer = buffer.substr(body_end, TrailerSize);
+    if (int(!trailer.starts_with(Trailer)) | int(trailer.back() != Soh)) return Malformed;
+    auto expected_checksum = parse_uint(trailer.substr(Trailer.size(), 3));
+    if (int(!expected_checksum) || int(*expected_checksum != checksum(buffer.data(), buffer.data() + body_end))) return Malformed;
+
+    message = Message { };
+    auto field = buffer.data() + body_begin;
+    DelimiterScanner scanner { field, buffer.data() + body_end };
+    while (auto end = scanner.next()) {
+        // Tags are short, so they are read a byte at a time
+        uint32_t tag = 0;
+        auto position = field;
+        for (; int(position != end) & int(*position != '='); ++position) {
+            auto digit = static_cast<unsigned>(*position - '0');
+            if (int(digit > 9) | int(position - field >= 9)) return Malformed;
+            tag = tag * 10 + digit;
+        }
+        if (int(position == end) | int(position == field)) return Malformed;
+        // The MsgType(35) comes first
+        if (int(field == buffer.data() + body_begin) & int(tag != 35)) return Malformed;
+        message.set(tag, std::string_view { position + 1, static_cast<size_t>(end - position - 1) });
+        field = end + 1;
+    }
+    // The body ends with a delimiter
+    if (int(field != buffer.data() + body_end) | int(message.msg_type.empty())) return Malformed;
+
+    return { ParseStatus::COMPLETE, size };
+}
+
+// Side(54). The sell shorts are sells, as far as matching goes.
+[[nodiscard]] constexpr std::optional<OrderSide> make_side(const std::string_view value) noexcept {
+    if (value == "1") return OrderSide::BUY;
+    if (int(value == "2") | int(value == "5") | int(value == "6")) return OrderSide::SELL;
+    return std::nullopt;
+}
+
+/*
+ * OrdType(40), with the trailing stop peg of ExecInst(18) making stops
+ *  into trailing stops. FIX 4.4 has no order type of its own for those.
+ */
+[[nodiscard]] constexpr std::optional<OrderType> make_order_type(const std::string_view value, const bool is_trailing) noexcept {
+    if (value == "1") return is_trailing ? std::nullopt : std::optional { OrderType::MARKET };
+    if (value == "2") return is_trailing ? std::nullopt : std::optional { OrderType::LIMIT };
+    if (value == "3") return is_trailing ? OrderType::TRAILING_STOP : OrderType::STOP;
+    if (value == "4") return is_trailing ? OrderType::TRAILING_STOP_LIMIT : OrderType::STOP_LIMIT;
+    return std::nullopt;
+}
+
+/*
+ * TimeInForce(59). The engine has no trading sessions, so day orders are
+ *  good till cancelled. The all or none of ExecInst(18) takes the place of
+ *  the time in force, which is how the engine has it. Orders without a time
+ *  in force are day orders, except for market orders, which can't rest.
+ */
+[[nodiscard]] constexpr std::optional<TimeInForce> make_time_in_force(const std::string_view value, const bool is_all_or_none,
+                                                                      const bool is_market) noexcept {
+    auto result = [&] () -> std::optional<TimeInForce> {
+        if (value.empty()) return is_market ? TimeInForce::IOC : TimeInForce::GTC;
+        if (int(value == "0") | int(value == "1")) return TimeInForce::GTC;
+        if (value == "3") return TimeInForce::IOC;
+        if (value == "4") return TimeInForce::FOK;
+        return std::nullopt;
+    }();
+    if (int(is_all_or_none) & int(result == TimeInForce::GTC)) return TimeInForce::AON;
+    return result;
+}
+
+/*
+ * Makes a NewOrderSingle(D), an OrderCancelRequest(F), an
+ *  OrderCancelReplaceRequest(G), or an OrderMassCancelRequest(q) into the
+ *  request the gateway takes, which holds the arguments of the Order
+ *  factories (see gateway::Request). Empty if the message is of another
+ *  type, or its fields don't make a request.
+ *
+ * The engine's order IDs are numbers, so the ClOrdID(11) of a new order
+ *  has to be one, and the OrigClOrdID(41) of a cancel or a replace names
+ *  the order. A replace enters its ClOrdID as the new order, with the
+ *  OrderQty(38) as its quantity. Prices are taken in units of
+ *  10^-price_decimals, and the PegOffsetValue(211) of a trailing stop is
+ *  its distance from the market, in the same units.
+ *
+ * `symbol_id_of` maps a Symbol(55) to the ID of its orderbook, or to an
+ *  empty optional if there is no such symbol.
+ *
+ * The requests aren't checked any further than the fields they take. The
+ *  gateway does the rest, just as it does for its own protocol.
+ */
+template <typename SymbolResolver>
+[[nodiscard]] constexpr std::optional<gateway::Request> make_request(const Message& message, SymbolResolver&& symbol_id_of,
+                                                                     const uint32_t price_decimals = 0) noexcept {
+    // Optional fields take the given value when they aren't there
+    auto parse_optional = [&] (const std::string_view value, const uint32_t decimals, const uint64_t otherwise) {
+        return value.empty() ? std::optional { otherwise } : parse_decimal(value, decimals);
+    };
+
+    auto request = gateway::Request { };
+    auto& type = message.msg_type;
+
+    if (type == "D") {
+        auto is_trailing = message.exec_inst.find('a') != std::string_view::npos;
+        auto is_all_or_none = message.exec_inst.find('G') != std::string_view::npos;
+        auto id = parse_uint(message.cl_ord_id);
+        auto symbol_id = symbol_id_of(message.symbol);
+        auto side = make_side(message.side);
+        auto order_type = make_order_type(message.ord_type, is_trailing);
+        if (int(!id) | int(!symbol_id) | int(!side) | int(!order_type)) return std::nullopt;
+
+        auto time_in_force = make_time_in_force(message.time_in_force, is_all_or_none, *order_type == OrderType::MARKET);
+        auto quantity = parse_decimal(message.order_qty, 0);
+        auto max_visible_quantity = parse_optional(message.max_floor, 0, Quantity::max().value);
+        auto price = parse_optional(message.price, price_decimals, Price::invalid().value);
+        auto stop_price = parse_optional(message.stop_px, price_decimals, Price::invalid().value);
+        if (int(!time_in_force) | int(!quantity) | int(!max_visible_quantity) | int(!price) | int(!stop_price)) return std::nullopt;
+
+        int64_t trailing_distance = 0;
+        if (is_trailing) {
+            // The sign is the direction of the peg, which the side already tells
+            auto offset = message.peg_offset_value;
+            if (offset.starts_with('-')) offset.remove_prefix(1);
+            auto distance = parse_decimal(offset, price_decimals);
+            if (int(!distance) || int(*distance > uint64_t(std::numeric_limits<int32_t>::max()))) return std::nullopt;
+            trailing_distance = int64_t(*distance);
+        }
+
+        request.type = gateway::RequestType::NEW_ORDER;
+        request.order_type = *order_type;
+        request.side = *side;
+        request.time_in_force = *time_in_force;
+        request.symbol_id = *symbol_id;
+        request.order_id = *id;
+        request.price = *price;
+        request.stop_price = *stop_price;
+        request.quantity = *quantity;
+        request.max_visible_quantity = *max_visible_quantity;
+        request.trailing_distance = static_cast<int32_t>(trailing_distance);
+        return request;
+    }
+
+    if (type == "F") {
+        auto id = parse_uint(message.orig_cl_ord_id);
+        if (!id) return std::nullopt;
+        request.type = gateway::RequestType::CANCEL;
+        request.order_id = *id;
+        return request;
+    }
+
+    if (type == "G") {
+        auto id = parse_uint(message.orig_cl_ord_id);
+        auto new_id = parse_uint(message.cl_ord_id);
+        auto price = parse_decimal(message.price, price_decimals);
+        auto quantity = parse_decimal(message.order_qty, 0);
+        if (int(!id) | int(!new_id) | int(!price) | int(!quantity)) return std::nullopt;
+        request.type = gateway::RequestType::REPLACE;
+        request.order_id = *id;
+        request.new_order_id = *new_id;
+        request.price = *price;
+        request.quantity = *quantity;
+        return request;
+    }
+
+    if (type == "q") {
+        // Cancel all orders for a security (1), or all orders (7)
+        auto scope = message.mass_cancel_request_type;
+        std::optional<uint32_t> symbol_id;
+        if (scope == "1") symbol_id = symbol_id_of(message.symbol);
+        if (scope == "7") symbol_id = gateway::AllSymbols;
+        if (!symbol_id) return std::nullopt;
+        request.type = gateway::RequestType::MASS_CANCEL;
+        request.symbol_id = *symbol_id;
+        return request;
+    }
+
+    return std::nullopt;
+}
+
+}
@@ -0,0 +1,550 @@
+#pragma once
+
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <sys/epoll.h>
+
+#include <chronex/Symbol.hpp>
+
+#include <chronex/concepts/Order.hpp>
+
+#include <chronex/gateway/Protocol.hpp>
+
+#include <chronex/handlers/CompositeEventHandler.hpp>
+#include <chronex/handlers/EventRecord.hpp>
+#include <chronex/handlers/ExecutionReportEventHandler.hpp>
+#include <chronex/handlers/NullEventHandler.hpp>
+
+#include <chronex/ipc/Epoll.hpp>
+#include <chronex/ipc/UnixSocket.hpp>
+
+#include <chronex/matching/MatchingEngine.hpp>
+
+#include <chronex/orderbook/Order.hpp>
+#include <chronex/orderbook/OrderUtils.hpp>
+
+namespace chronex::gateway {
+
+struct GatewayConfig {
+    // The reports a single request can produce, at most. The rest are dropped
+    //  (see Gateway::dropped_reports), so it should cover the deepest sweep.
+    size_t reports_capacity = 1 << 16;
+    // A session whose responses pile up past this (e.g. a client that
+    //  doesn't read) is disconnected, rather than buffered for forever
+    size_t max_session_backlog = 16 << 20;
+    // Reserved upfront for each session, so that responses aren't allocated
+    size_t session_output_capacity = 64 << 10;
+    // The ready descriptors handled per round, at most
+    size_t events_batch = 256;
+    // Whether the orders of a session are cancelled when it disconnects
+    bool cancel_on_disconnect = true;
+};
+
+/*
+ * Drives a matching engine from order-entry sessions over a Unix domain
+ *  socket (see Protocol.hpp), and sends the execution reports back on the
+ *  sessions of the orders they are about. The engine runs in the thread of
+ *  the gateway, so a request is matched as soon as it's read, which is what
+ *  makes the gateway fit for measuring tick-to-trade latency end-to-end.
+ *
+ * The sessions are multiplexed with edge-triggered epoll. Each session is
+ *  read until the socket is drained, straight into a fixed buffer, and the
+ *  requests are handled in place. The responses of a round are appended to
+ *  a buffer of the session that's reserved upfront, and sent with a single
+ *  send() per session at the end of the round. Nothing is allocated per
+ *  request, except for the engine's own bookkeeping and the order index of
+ *  the gateway.
+ *
+ * The engine reports to an ExecutionReportEventHandler, and to
+ *  `EventHandler` as well (e.g. an EventBusEventHandler, to feed an
+ *  OrderBooksStore). Orderbooks are added through engine(), and removed
+ *  through remove_orderbook(), so that the gateway forgets their orders.
+ */
+template <
+    concepts::Order Order = Order,
+    typename EventHandler = handlers::NullEventHandler
+>
+class Gateway {
+
+    using Handler = handlers::CompositeEventHandler<handlers::ExecutionReportEventHandler, EventHandler>;
+
+public:
+
+    using Engine = MatchingEngine<Order, Handler>;
+
+private:
+
+    constexpr static size_t InputCapacity = 256 * sizeof(Request);
+
+    struct Session {
+        Session(ipc::UnixSocket _socket, const uint32_t _slot, const uint32_t _generation, const size_t output_capacity)
+            : socket(std::move(_socket)), slot(_slot), generation(_generation) {
+            output.reserve(output_capacity);
+        }
+
+        [[nodiscard]] uint64_t key() const noexcept { return (uint64_t { generation } << 32) | slot; }
+
+        ipc::UnixSocket socket;
+        uint32_t slot;
+        uint32_t generation;
+
+        // A partial request is kept at the front, waiting for the rest of it
+        std::array<std::byte, InputCapacity> input;
+        size_t input_size = 0;
+
+        std::vector<std::byte> output;
+        size_t output_sent = 0;
+        bool is_dirty = false;
+
+        uint64_t sequence = 0;
+    };
+
+    constexpr static uint64_t ListenerKey = std::numeric_limits<uint64_t>::max();
+
+public:
+
+    // The path of the socket is replaced if it exists, and removed with the gateway
+    [[nodiscard]] static std::optional<Gateway> create(std::string socket_path, GatewayConfig config = { },
+                                                       EventHandler event_handler = { }) {
+        auto listener = ipc::UnixListener::create(std::move(socket_path));
+        if (!listener) return std::nullopt;
+        auto epoll = ipc::Epoll::create();
+        if (!epoll || !epoll->add(listener->fd(), EPOLLIN | EPOLLET, ListenerKey)) return std::nullopt;
+        return Gateway { std::move(*listener), std::move(*epoll), config, std::move(event_handler) };
+    }
+
+    Gateway(const Gateway&) = delete;
+    Gateway& operator=(const Gateway&) = delete;
+
+    Gateway(Gateway&&) noexcept = default;
+    Gateway& operator=(Gateway&&) noexcept = default;
+
+    /*
+     * One round: waits up to `timeout_ms` for the sockets, handles the
+     *  connections and the requests, then sends out the responses.
+     *
+     * Returns the number of requests handled.
+     */
+    size_t poll(const int timeout_ms) {
+        auto requests = _requests_count;
+
+        auto count = _epoll.wait(_events, timeout_ms);
+        for (int i = 0; i < count; i++) {
+            auto& event = _events[static_cast<size_t>(i)];
+            if (event.data.u64 == ListenerKey) {
+                accept_sessions();
+                continue;
+            }
+            auto* session = find_session(event.data.u64);
+            if (session == nullptr) continue;
+
+            if (event.events & EPOLLOUT) {
+                mark_dirty(*session);
+            }
+            if (event.events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+                read_requests(*session);
+            }
+        }
+
+        flush();
+        return _requests_count - requests;
+    }
+
+    // Along with the orders of the book, which leave without being reported to their sessions
+    void remove_orderbook(const Symbol symbol) {
+        std::erase_if(_owners, [&] (const auto& entry) {
+            return !_engine->has_order(entry.first) || _engine->order_at(entry.first)->symbol_id() == symbol.id;
+        });
+        _engine->remove_orderbook(symbol);
+    }
+
+    [[nodiscard]] Engine& engine() noexcept { return *_engine; }
+    [[nodiscard]] const Engine& engine() const noexcept { return *_engine; }
+
+    [[nodiscard]] size_t sessions_count() const noexcept { return _sessions.size() - _free_slots.size(); }
+
+    [[nodiscard]] uint64_t requests_count() const noexcept { return _requests_count; }
+
+    [[nodiscard]] uint64_t rejects_count() const noexcept { return _rejects_count; }
+
+    // Reports that didn't fit in GatewayConfig::reports_capacity, and never made it to the sessions
+    [[nodiscard]] uint64_t dropped_reports() const noexcept { return _dropped_reports; }
+
+    [[nodiscard]] const std::string& path() const noexcept { return _listener.path(); }
+
+private:
+
+    Gateway(ipc::UnixListener listener, ipc::Epoll epoll, const GatewayConfig config, EventHandler event_handler)
+        : _listener(std::move(listener)), _epoll(std::move(epoll)), _config(config),
+          _reports(config.reports_capacity), _events(config.events_batch) {
+        // The books point to the engine, so it stays put when the gateway moves
+        _engine = std::make_unique<Engine>(Handler { handlers::ExecutionReportEventHandler { _reports }, std::move(event_handler) });
+    }
+
+    [[nodiscard]] handlers::ExecutionReportEventHandler& reporter() noexcept {
+        return _engine->event_handler().template get<0>();
+    }
+
+    void accept_sessions() {
+        // Edge-triggered, so everything pending is taken
+        while (auto socket = _listener.accept()) {
+            uint32_t slot;
+            if (!_free_slots.empty()) {
+                slot = _free_slots.back();
+                _free_slots.pop_back();
+            } else {
+                slot = static_cast<uint32_t>(_sessions.size());
+                _sessions.emplace_back();
+            }
+            auto session = std::make_unique<Session>(std::move(*socket), slot, ++_generation, _config.session_output_capacity);
+            // Registered for both directions once, the edges tell when each of them is ready
+            if (!_epoll.add(session->socket.fd(), EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET, session->key())) {
+                _free_slots.push_back(slot);
+                continue;
+            }
+            _sessions[slot] = std::move(session);
+        }
+    }
+
+    // nullptr if the session is gone, even if another one took its slot since
+    [[nodiscard]] Session* find_session(const uint64_t key) const noexcept {
+        auto slot = static_cast<uint32_t>(key);
+        if (slot >= _sessions.size() || _sessions[slot] == nullptr || _sessions[slot]->key() != key) return nullptr;
+        return _sessions[slot].get();
+    }
+
+    void disconnect(Session& session) {
+        (void)_epoll.remove(session.socket.fd());
+        if (_config.cancel_on_disconnect) {
+            (void)cancel_orders(session, AllSymbols);
+        }
+        auto slot = session.slot;
+        _sessions[slot].reset();
+        _free_slots.push_back(slot);
+    }
+
+    void read_requests(Session& session) {
+        // Drained until EAGAIN, or the edge would be lost
+        while (true) {
+            auto free = std::span { session.input }.subspan(session.input_size);
+            auto received = session.socket.recv(free);
+            if (received > 0) {
+                session.input_size += static_cast<size_t>(received);
+                handle_requests(session);
+                continue;
+            }
+            if (received == -1 && errno == EINTR) continue;
+            if (received == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+            // Gone, or broken
+            disconnect(session);
+            return;
+        }
+    }
+
+    void handle_requests(Session& session) {
+        size_t offset = 0;
+        for (; session.input_size - offset >= sizeof(Request); offset += sizeof(Request)) {
+            Request request;
+            std::memcpy(&request, session.input.data() + offset, sizeof(Request));
+            handle(session, request);
+        }
+        std::memmove(session.input.data(), session.input.data() + offset, session.input_size - offset);
+        session.input_size -= offset;
+    }
+
+    void handle(Session& session, const Request& request) {
+        ++_requests_count;
+        switch (request.type) {
+            case RequestType::NEW_ORDER:
+                return new_order(session, request);
+            case RequestType::CANCEL:
+                if (!is_owned(session, request.order_id)) return reject(session, request, request.order_id, RejectReason::UNKNOWN_ORDER);
+                return execute([&] { _engine->remove_order(OrderId { request.order_id }); });
+            case RequestType::MODIFY:
+                if (!is_owned(session, request.order_id)) return reject(session, request, request.order_id, RejectReason::UNKNOWN_ORDER);
+                if (!is_valid_amendment(request)) {
+                    return reject(session, request, request.order_id, RejectReason::INVALID_ORDER);
+                }
+                return execute([&] { _engine->modify_order(OrderId { request.order_id }, Price { request.price }, Quantity { request.quantity }); });
+            case RequestType::REPLACE:
+                return replace_order(session, request);
+            case RequestType::MASS_CANCEL: {
+                auto count = cancel_orders(session, request.symbol_id);
+                auto response = make_response(ResponseType::MASS_CANCEL_DONE, RejectReason::NONE);
+                response.report.symbol_id = request.symbol_id;
+                response.report.quantity = count;
+                return respond(session, response);
+            }
+            default:
+                return reject(session, request, request.order_id, RejectReason::BAD_REQUEST);
+        }
+    }
+
+    void new_order(Session& session, const Request& request) {
+        if (!_engine->has_orderbook(SymbolId { request.symbol_id })) {
+            return reject(session, request, request.order_id, RejectReason::UNKNOWN_SYMBOL);
+        }
+
+        // Normalized, so that the fields the type doesn't use can't leak into the order
+        auto has_price = has_limit_price(request.order_type);
+        auto has_stop_price = is_stop(request.order_type);
+        auto record = handlers::OrderRecord {
+            .id = request.order_id,
+            .leaves_quantity = request.quantity,
+            .filled_quantity = 0,
+            .max_visible_quantity = request.max_visible_quantity,
+            .price = has_price ? request.price : Price::invalid().value,
+            .stop_price = has_stop_price ? request.stop_price : Price::invalid().value,
+            .slippage = Price::invalid().value,
+            .trailing_distance = request.trailing_distance,
+            .trailing_step = request.trailing_step,
+            .account_id = AccountId::invalid().value,
+            .type = request.order_type,
+            .side = request.side,
+            .time_in_force = request.time_in_force,
+            .padding = 0
+        };
+
+        if (!handlers::is_valid_order(record)) {
+            return reject(session, request, request.order_id, RejectReason::INVALID_ORDER);
+        }
+        if (int(_engine->has_order(OrderId { request.order_id })) | int(request.order_id == OrderId::invalid().value)) {
+            return reject(session, request, request.order_id, RejectReason::DUPLICATE_ORDER_ID);
+        }
+
+        auto order = handlers::make_order<Order>(record, SymbolId { request.symbol_id });
+
+        auto leftover = make_cancel(request.order_id, request.quantity, request.symbol_id, request.order_type, request.side);
+        _owners[order.id()] = session.key();
+        execute([&] { _engine->add_order(std::move(order)); }, leftover);
+    }
+
+    void replace_order(Session& session, const Request& request) {
+        if (!is_owned(session, request.order_id)) return reject(session, request, request.order_id, RejectReason::UNKNOWN_ORDER);
+        if (int(_engine->has_order(OrderId { request.new_order_id })) | int(request.new_order_id == OrderId::invalid().value)) {
+            return reject(session, request, request.new_order_id, RejectReason::DUPLICATE_ORDER_ID);
+        }
+        if (!is_valid_amendment(request)) {
+            return reject(session, request, request.new_order_id, RejectReason::INVALID_ORDER);
+        }
+        auto& order = *_engine->order_at(OrderId { request.order_id });
+        auto leftover = make_cancel(request.new_order_id, request.quantity, order.symbol_id().value, order.type(), order.side());
+        _owners[OrderId { request.new_order_id }] = session.key();
+        execute([&] {
+            _engine->replace_order(OrderId { request.order_id }, OrderId { request.new_order_id }, Price { request.price }, Quantity { request.quantity });
+        }, leftover);
+    }
+
+    // Returns the number of orders cancelled
+    uint64_t cancel_orders(Session& session, const uint32_t symbol_id) {
+        auto key = session.key();
+        _cancels.clear();
+        forget_gone_orders();
+        for (auto& [id, owner] : _owners) {
+            if (owner != key) continue;
+            if (int(symbol_id != AllSymbols) & int(_engine->order_at(id)->symbol_id().value != symbol_id)) continue;
+            _cancels.push_back(id);
+        }
+        for (auto id : _cancels) {
+            execute([&] { _engine->remove_order(id); });
+        }
+        return _cancels.size();
+    }
+
+    // The bounds handlers::is_valid_order checks, for the price and quantity of a modify or a replace
+    [[nodiscard]] static bool is_valid_amendment(const Request& request) noexcept {
+        return !(int(request.quantity == 0) | int(request.quantity >= Quantity::invalid().value) | int(request.price == Price::invalid().value));
+    }
+
+    // Forgets the order if it left the engine without a report (see forget_gone_orders)
+    [[nodiscard]] bool is_owned(const Session& session, const uint64_t order_id) noexcept {
+        auto it = _owners.find(OrderId { order_id });
+        if (it == _owners.end()) return false;
+        if (!_engine->has_order(it->first)) [[unlikely]] {
+            _owners.erase(it);
+            return false;
+        }
+        return it->second == session.key();
+    }
+
+    // Orders leave the engine without a report when their book is removed through
+    //  engine(), or when their reports are dropped (see GatewayConfig::reports_capacity)
+    void forget_gone_orders() {
+        std::erase_if(_owners, [this] (const auto& entry) { return !_engine->has_order(entry.first); });
+    }
+
+    // The cancel of an order that's entered, for whatever is left of it if it doesn't rest
+    [[nodiscard]] static handlers::ExecutionReport make_cancel(const uint64_t order_id, const uint64_t quantity, const uint32_t symbol_id,
+                                                               const OrderType order_type, const OrderSide side) noexcept {
+        return handlers::ExecutionReport {
+            .order_id = order_id,
+            .other_order_id = 0,
+            .price = 0,
+            .quantity = quantity,
+            .leaves_quantity = 0,
+            .symbol_id = symbol_id,
+            .type = handlers::ExecutionReportType::CANCEL,
+            .order_type = order_type,
+            .side = side,
+            .flags = handlers::TradeBits::None
+        };
+    }
+
+    /*
+     * Runs a command on the engine, and sends its reports. For a command
+     *  that enters an order, `leftover` is the cancel the order gets if it
+     *  leaves the engine without resting, and without being filled.
+     */
+    template <typename Func>
+    void execute(Func&& command, std::optional<handlers::ExecutionReport> leftover = std::nullopt) {
+        auto& handler = reporter();
+        handler.reset();
+        command();
+        _dropped_reports += handler.dropped();
+        if (handler.dropped() != 0) [[unlikely]] {
+            forget_gone_orders();
+        }
+
+        auto reports = handler.reports();
+        for (auto& report : reports) {
+            auto owner = send_to_owner(report.order_id, report);
+            if (int(report.type == handlers::ExecutionReportType::FILL) & int(report.other_order_id != 0)) {
+                (void)send_to_owner(report.other_order_id, report, owner);
+            }
+        }
+
+        if (int(leftover.has_value()) && int(!_engine->has_order(OrderId { leftover->order_id }))) {
+            auto is_reported = false;
+            for (auto& report : reports) {
+                if (report.order_id != leftover->order_id) continue;
+                if (report.type == handlers::ExecutionReportType::FILL) leftover->quantity = report.leaves_quantity;
+                if (report.type == handlers::ExecutionReportType::CANCEL) is_reported = true;
+            }
+            if (int(leftover->quantity != 0) & int(!is_reported)) {
+                (void)send_to_owner(leftover->order_id, *leftover);
+            }
+            _owners.erase(OrderId { leftover->order_id });
+        }
+
+        // Forgets the orders that are gone
+        for (auto& report : reports) {
+            for (auto id : { report.order_id, report.other_order_id }) {
+                if (int(id != 0) & int(!_engine->has_order(OrderId { id }))) {
+                    _owners.erase(OrderId { id });
+                }
+            }
+        }
+    }
+
+    // Returns the owner, unless it's `skip` (e.g. both orders of a trade are of the same session)
+    uint64_t send_to_owner(const uint64_t order_id, const handlers::ExecutionReport& report, const uint64_t skip = ListenerKey) {
+        auto it = _owners.find(OrderId { order_id });
+        if (it == _owners.end() || it->second == skip) return ListenerKey;
+        if (auto* session = find_session(it->second); session != nullptr) {
+            auto response = make_response(ResponseType::EXECUTION_REPORT, RejectReason::NONE);
+            response.report = report;
+            respond(*session, response);
+        }
+        return it->second;
+    }
+
+    void reject(Session& session, const Request& request, const uint64_t order_id, const RejectReason reason) {
+        ++_rejects_count;
+        auto response = make_response(ResponseType::REJECT, reason);
+        response.report.order_id = order_id;
+        response.report.symbol_id = request.symbol_id;
+        response.report.order_type = request.order_type;
+        response.report.side = request.side;
+        respond(session, response);
+    }
+
+    [[nodiscard]] static Response make_response(const ResponseType type, const RejectReason reason) noexcept {
+        Response response;
+        std::memset(&response, 0, sizeof(response));
+        response.type = type;
+        response.reason = reason;
+        return response;
+    }
+
+    void respond(Session& session, Response& response) {
+        response.sequence = ++session.sequence;
+        auto offset = session.output.size();
+        session.output.resize(offset + sizeof(Response));
+        std::memcpy(session.output.data() + offset, &response, sizeof(Response));
+        mark_dirty(session);
+    }
+
+    void mark_dirty(Session& session) {
+        if (session.is_dirty) return;
+        session.is_dirty = true;
+        _dirty.push_back(session.key());
+    }
+
+    void flush() {
+        // Disconnecting a session can cancel its orders, which can send more responses
+        for (size_t i = 0; i < _dirty.size(); i++) {
+            // Gone in the middle of the round
+            auto* session = find_session(_dirty[i]);
+            if (session == nullptr) continue;
+            session->is_dirty = false;
+            send_output(*session);
+        }
+        _dirty.clear();
+    }
+
+    void send_output(Session& session) {
+        while (session.output_sent < session.output.size()) {
+            auto sent = session.socket.send(std::span { session.output }.subspan(session.output_sent));
+            if (sent == -1) {
+                if (errno == EINTR) continue;
+                // Full: the rest goes out on the next EPOLLOUT edge. Broken: noticed by the next read.
+                if (session.output.size() - session.output_sent > _config.max_session_backlog) {
+                    disconnect(session);
+                }
+                return;
+            }
+            session.output_sent += static_cast<size_t>(sent);
+        }
+        // Keeps the capacity
+        session.output.clear();
+        session.output_sent = 0;
+    }
+
+    ipc::UnixListener _listener;
+    ipc::Epoll _epoll;
+    GatewayConfig _config;
+
+    // Written by the engine's ExecutionReportEventHandler
+    std::vector<handlers::ExecutionReport> _reports;
+    std::unique_ptr<Engine> _engine;
+
+    // The session of each order in the engine, by key
+    unordered_map<OrderId, uint64_t> _owners;
+    std::vector<OrderId> _cancels;
+
+    // By slot. A slot is reused once its session is gone, with a new generation.
+    std::vector<std::unique_ptr<Session>> _sessions;
+    std::vector<uint32_t> _free_slots;
+    uint32_t _generation = 0;
+    // The keys of the sessions with responses to send
+    std::vector<uint64_t> _dirty;
+
+    std::vector<epoll_event> _events;
+
+    uint64_t _requests_count = 0;
+    uint64_t _rejects_count = 0;
+    uint64_t _dropped_reports = 0;
+};
+
+}
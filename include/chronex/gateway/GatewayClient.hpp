@@ -0,0 +1,51 @@
+#pragma once
+
+#include <optional>
+#include <span>
+#include <string>
+#include <utility>
+
+#include <chronex/gateway/Protocol.hpp>
+
+#include <chronex/ipc/UnixSocket.hpp>
+
+namespace chronex::gateway {
+
+/*
+ * A blocking order-entry session with a Gateway, e.g. for tools, tests,
+ *  and load tests. Requests can be sent in batches, with a single send.
+ */
+class GatewayClient {
+public:
+
+    [[nodiscard]] static std::optional<GatewayClient> connect(const std::string& path) noexcept {
+        auto socket = ipc::UnixSocket::connect(path);
+        if (!socket) return std::nullopt;
+        return GatewayClient { std::move(*socket) };
+    }
+
+    [[nodiscard]] bool send(const Request& request) const noexcept {
+        return send(std::span { &request, 1 });
+    }
+
+    [[nodiscard]] bool send(const std::span<const Request> requests) const noexcept {
+        return _socket.send_all(std::as_bytes(requests));
+    }
+
+    // Blocks until the next response. Empty if the gateway is gone.
+    [[nodiscard]] std::optional<Response> receive() const noexcept {
+        Response response;
+        if (!_socket.recv_all(std::as_writable_bytes(std::span { &response, 1 }))) return std::nullopt;
+        return response;
+    }
+
+    [[nodiscard]] const ipc::UnixSocket& socket() const noexcept { return _socket; }
+
+private:
+
+    explicit GatewayClient(ipc::UnixSocket socket) noexcept : _socket(std::move(socket)) { }
+
+    ipc::UnixSocket _socket;
+};
+
+}
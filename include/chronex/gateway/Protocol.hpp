@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#include <chronex/handlers/ExecutionReportEventHandler.hpp>
+
+#include <chronex/orderbook/OrderUtils.hpp>
+
+namespace chronex::gateway {
+
+/*
+ * The order-entry protocol of the gateway. Like the store's, everything
+ *  is fixed-size, trivially copyable, and in the host's byte order, since
+ *  the clients are local (Unix domain sockets). Both directions are made of
+ *  64-byte messages, back to back, so there is no framing to parse.
+ *
+ * Order IDs are chosen by the clients, and are global to the engine. A
+ *  session can only cancel, modify, and replace the orders it entered.
+ */
+
+enum class RequestType : uint8_t {
+    NEW_ORDER,
+    CANCEL,
+    // Moves the order to a new price with a new leaves quantity, losing its priority
+    MODIFY,
+    // Cancels the order and enters a copy of it, with a new ID, price, and quantity
+    REPLACE,
+    // Cancels all of the orders of the session in a symbol, or in all of them (see AllSymbols)
+    MASS_CANCEL,
+};
+
+constexpr uint32_t AllSymbols = std::numeric_limits<uint32_t>::max();
+
+/*
+ * Which fields are used depends on the type:
+ *
+ *  - new order:   all but new_order_id. The prices, the visible quantity,
+ *                 and the trailing distance as the Order factories take
+ *                 them, depending on the order type.
+ *  - cancel:      order_id
+ *  - modify:      order_id, price, quantity
+ *  - replace:     order_id, new_order_id, price, quantity
+ *  - mass cancel: symbol_id
+ */
+struct Request {
+    RequestType type;
+    OrderType order_type;
+    OrderSide side;
+    TimeInForce time_in_force;
+    uint32_t symbol_id;
+    uint64_t order_id;
+    uint64_t new_order_id;
+    uint64_t price;
+    uint64_t stop_price;
+    uint64_t quantity;
+    uint64_t max_visible_quantity;
+    // See TrailingDistance
+    int32_t trailing_distance;
+    int32_t trailing_step;
+};
+
+enum class ResponseType : uint8_t {
+    EXECUTION_REPORT,
+    // The request was refused before reaching the engine, see RejectReason
+    REJECT,
+    // All of the cancels of a mass cancel were reported. The report has
+    //  the symbol_id of the request, and the number of orders cancelled as
+    //  the quantity.
+    MASS_CANCEL_DONE,
+};
+
+enum class RejectReason : uint8_t {
+    NONE,
+    BAD_REQUEST,
+    UNKNOWN_SYMBOL,
+    DUPLICATE_ORDER_ID,
+    // Never entered, already gone, or entered by another session
+    UNKNOWN_ORDER,
+    // The fields don't make an order of the requested type
+    INVALID_ORDER,
+};
+
+/*
+ * The reports of the engine are sent to the sessions of the orders they
+ *  are about (see handlers::ExecutionReport), and a fill is sent to both
+ *  sessions of the trade. An order that leaves the engine without being
+ *  filled or resting (e.g. an IOC order, or a market order on an empty
+ *  book) gets a cancel for what's left of it.
+ *
+ * A reject carries the order_id (or the new_order_id of a replace),
+ *  symbol_id, order_type, and side of the request.
+ */
+struct Response {
+    ResponseType type;
+    RejectReason reason;
+    uint8_t padding[6];
+    // Of the responses of the session, starting from 1
+    uint64_t sequence;
+    handlers::ExecutionReport report;
+};
+
+static_assert(std::is_trivially_copyable_v<Request>);
+static_assert(std::is_trivially_copyable_v<Response>);
+static_assert(sizeof(Request) == 64);
+static_assert(sizeof(Response) == 64);
+
+}
@@ -0,0 +1,373 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <numbers>
+#include <vector>
+
+#include <chronex/Symbol.hpp>
+
+#include <chronex/concepts/Order.hpp>
+
+#include <chronex/matching/Commands.hpp>
+
+#include <chronex/orderbook/Order.hpp>
+#include <chronex/orderbook/OrderUtils.hpp>
+
+namespace chronex::generator {
+
+// All of the ratios are probabilities, in [0, 1]
+struct GeneratorConfig {
+    uint64_t seed = 42;
+    uint32_t symbols_count = 16;
+
+    // Commands arrive as a Poisson process over all of the symbols, which
+    //  only sets the timestamps, since the flow is generated at once
+    double arrivals_per_second = 1'000'000;
+
+    // Each symbol's mid starts here (in ticks), and takes a step of a tick,
+    //  up or down, with drift_ratio on each arrival
+    uint64_t initial_mid = 10'000;
+    uint64_t tick_size = 1;
+    double drift_ratio = 0.05;
+    // Orders are priced away from the mid by an exponentially distributed
+    //  number of ticks, towards the market with marketable_ratio
+    double mean_price_offset = 8;
+    double marketable_ratio = 0.1;
+
+    // Quantities are a uniform number of lots, in [1, max_lots]
+    uint64_t lot_size = 100;
+    uint64_t max_lots = 20;
+
+    // Of the arrivals, the rest are new orders
+    double cancel_ratio = 0.35;
+    double replace_ratio = 0.05;
+    double modify_ratio = 0.05;
+
+    // Of the new orders, the rest are limit orders
+    double market_ratio = 0.02;
+    double stop_ratio = 0.01;
+    double stop_limit_ratio = 0.01;
+    double trailing_stop_ratio = 0.005;
+    double trailing_stop_limit_ratio = 0.005;
+    // Of the trailing stops, the rest trail by an absolute distance
+    double percentage_trailing_ratio = 0.5;
+
+    // Of the limit orders, the rest are GTC
+    double ioc_ratio = 0.05;
+    double fok_ratio = 0.01;
+    double aon_ratio = 0.01;
+    // Of the GTC limit orders
+    double iceberg_ratio = 0.05;
+
+    // The orders that can be cancelled, replaced, or modified are tracked,
+    //  up to this many per symbol, after which the oldest are cancelled to
+    //  make room. Keeps the memory constant however long the flow goes on.
+    uint32_t max_live_orders = 4096;
+};
+
+/*
+ * Generates a seeded, endless, and realistic enough flow of engine commands,
+ *  for load testing and benchmarks, when production captures can't be shared.
+ *  The same config generates the same flow, since the random numbers come from
+ *  a generator of its own (xoshiro256**), and are shaped without the
+ *  distributions or the math functions of the standard library, which differ
+ *  between implementations.
+ *
+ * The first commands add the books of the symbols (named S0, S1, ...). Then
+ *  each command is for a uniformly chosen symbol, and is one of:
+ *
+ *  - a new order, of any type, time in force, iceberg or not, priced around
+ *    the symbol's mid, which drifts as a random walk
+ *  - a cancel, replace (with a new ID), or modify of a tracked order
+ *
+ * The generator doesn't see the engine, so some of the tracked orders may be
+ *  filled already by the time they are cancelled, replaced, or modified, and
+ *  commands::apply() drops those, as it would for a cancel that lost a race
+ *  with a fill. Nothing is allocated after construction.
+ *
+ *      OrderFlowGenerator generator { config };
+ *      while (...) {
+ *          auto command = generator.next();
+ *          writer.write(command, generator.timestamp());
+ *      }
+ */
+template <concepts::Order Order = Order>
+class OrderFlowGenerator {
+
+    struct LiveOrder {
+        uint64_t id;
+        OrderSide side;
+        // Stops can only be replaced, since a modify sets the limit price
+        bool is_limit;
+    };
+
+    struct SymbolState {
+        uint64_t mid;
+        // A ring, roughly oldest first
+        std::vector<LiveOrder> live_orders;
+        size_t first = 0;
+        size_t size = 0;
+    };
+
+public:
+
+    explicit OrderFlowGenerator(const GeneratorConfig config = { }) : _config(config), _symbols(config.symbols_count) {
+        assert(config.symbols_count > 0 && config.max_live_orders > 0 && config.max_lots > 0 && "Nothing to generate");
+        assert(config.cancel_ratio + config.replace_ratio + config.modify_ratio <= 1 && "The ratios exceed 1");
+        // splitmix64, to spread the seed over the state
+        auto seed = config.seed;
+        for (auto& word : _state) {
+            seed += 0x9E3779B97F4A7C15;
+            auto z = seed;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+            word = z ^ (z >> 31);
+        }
+        for (auto& symbol : _symbols) {
+            symbol.mid = std::max(config.initial_mid, min_mid());
+            symbol.live_orders.resize(config.max_live_orders);
+        }
+    }
+
+    [[nodiscard]] commands::Command<Order> next() {
+        ++_commands_count;
+        _timestamp += exponential(1e9 / _config.arrivals_per_second);
+
+        if (_next_orderbook < _symbols.size()) {
+            char name[sizeof(Symbol::name)];
+            std::snprintf(name, sizeof(name), "S%u", _next_orderbook);
+            return commands::AddNewOrderBook { Symbol { SymbolId { _next_orderbook++ }, name } };
+        }
+
+        auto symbol_id = static_cast<uint32_t>(uniform(_symbols.size()));
+        auto& symbol = _symbols[symbol_id];
+        if (chance(_config.drift_ratio)) {
+            symbol.mid = chance(0.5) ? symbol.mid + 1 : std::max(symbol.mid - 1, min_mid());
+        }
+
+        // Makes room for the new orders that rest
+        if (symbol.size == symbol.live_orders.size()) {
+            return commands::RemoveOrder { OrderId { pop(symbol, 0).id } };
+        }
+
+        auto action = uniform01();
+        if (symbol.size != 0) {
+            if (action < _config.cancel_ratio) {
+                return commands::RemoveOrder { OrderId { pop(symbol, uniform(symbol.size)).id } };
+            }
+            action -= _config.cancel_ratio;
+            if (action < _config.replace_ratio + _config.modify_ratio) {
+                auto& order = at(symbol, uniform(symbol.size));
+                if (int(action >= _config.replace_ratio) & int(order.is_limit)) {
+                    return commands::ModifyOrder { OrderId { order.id }, Price { limit_price(symbol, order.side) }, Quantity { quantity() } };
+                }
+                auto id = order.id;
+                order.id = _next_order_id++;
+                order.is_limit = true;
+                return commands::ReplaceOrder<Order> {
+                    OrderId { id }, Order::limit(order.id, symbol_id, order.side, limit_price(symbol, order.side), quantity())
+                };
+            }
+        }
+
+        return commands::AddOrder<Order> { new_order(symbol_id, symbol) };
+    }
+
+    // Of the last command, in nanoseconds since the start of the flow
+    [[nodiscard]] uint64_t timestamp() const noexcept { return static_cast<uint64_t>(_timestamp); }
+
+    [[nodiscard]] uint64_t commands_count() const noexcept { return _commands_count; }
+
+    [[nodiscard]] const GeneratorConfig& config() const noexcept { return _config; }
+
+private:
+
+    [[nodiscard]] Order new_order(const uint32_t symbol_id, SymbolState& symbol) {
+        auto id = _next_order_id++;
+        auto side = chance(0.5) ? OrderSide::BUY : OrderSide::SELL;
+        auto is_buy = side == OrderSide::BUY;
+        auto quantity = this->quantity();
+
+        // Above the market for buys, below it for sells
+        auto stop_price = [&] { return price_of(is_buy ? symbol.mid + 1 + ticks() : below(symbol.mid - 1, ticks())); };
+        // Past the stop price, so that the order is marketable once triggered
+        auto stop_limit_price = [&] (const uint64_t stop) {
+            auto stop_ticks = stop / _config.tick_size;
+            return price_of(is_buy ? stop_ticks + ticks() : below(stop_ticks, ticks()));
+        };
+        auto trailing_distance = [&] {
+            if (chance(_config.percentage_trailing_ratio)) {
+                // 0.05% to 2%, trailing by a tenth of that, in the negative units of percentages
+                auto distance = static_cast<int64_t>(5 + uniform(196));
+                return TrailingDistance::from_percentage_units(-distance, -std::max<int64_t>(distance / 10, 1));
+            }
+            // Farther than the step of a tick
+            auto distance = (2 + ticks()) * _config.tick_size;
+            return TrailingDistance::from_price(Price { distance }, Price { _config.tick_size });
+        };
+
+        auto type = uniform01();
+        if ((type -= _config.market_ratio) < 0) {
+            return Order::market(id, symbol_id, side, quantity);
+        }
+        if ((type -= _config.stop_ratio) < 0) {
+            track(symbol, id, side, false);
+            return Order::stop(id, symbol_id, side, stop_price(), quantity);
+        }
+        if ((type -= _config.stop_limit_ratio) < 0) {
+            track(symbol, id, side, false);
+            auto stop = stop_price();
+            return Order::stop_limit(id, symbol_id, side, stop, stop_limit_price(stop), quantity);
+        }
+        if ((type -= _config.trailing_stop_ratio) < 0) {
+            track(symbol, id, side, false);
+            return Order::trailing_stop(id, symbol_id, side, stop_price(), quantity, trailing_distance());
+        }
+        if ((type -= _config.trailing_stop_limit_ratio) < 0) {
+            track(symbol, id, side, false);
+            auto stop = stop_price();
+            // The engine trails the limit price at its offset from the stop price, which it takes to be
+            //  at or above the stop price, for either side
+            auto price = stop + ticks() * _config.tick_size;
+            return Order::trailing_stop_limit(id, symbol_id, side, stop, price, quantity, trailing_distance());
+        }
+
+        auto price = limit_price(symbol, side);
+        auto time_in_force = uniform01();
+        if ((time_in_force -= _config.ioc_ratio) < 0) {
+            return Order::limit(id, symbol_id, side, price, quantity, TimeInForce::IOC);
+        }
+        if ((time_in_force -= _config.fok_ratio) < 0) {
+            return Order::limit(id, symbol_id, side, price, quantity, TimeInForce::FOK);
+        }
+        track(symbol, id, side, true);
+        if ((time_in_force -= _config.aon_ratio) < 0) {
+            return Order::limit(id, symbol_id, side, price, quantity, TimeInForce::AON);
+        }
+        if (chance(_config.iceberg_ratio)) {
+            // Shows a few lots at a time
+            auto visible = std::min(quantity, (1 + uniform(3)) * _config.lot_size);
+            return Order::limit(id, symbol_id, side, price, quantity, TimeInForce::GTC, visible);
+        }
+        return Order::limit(id, symbol_id, side, price, quantity);
+    }
+
+    [[nodiscard]] uint64_t limit_price(const SymbolState& symbol, const OrderSide side) noexcept {
+        auto offset = ticks();
+        // Buys below the mid and sells above it, unless marketable
+        auto is_below = (side == OrderSide::BUY) != chance(_config.marketable_ratio);
+        return price_of(is_below ? below(symbol.mid, offset) : symbol.mid + offset);
+    }
+
+    // Keeps the prices off zero, however far the offset goes
+    [[nodiscard]] static uint64_t below(const uint64_t ticks, const uint64_t offset) noexcept {
+        return ticks - std::min(offset, ticks - 1);
+    }
+
+    [[nodiscard]] uint64_t price_of(const uint64_t ticks) const noexcept { return ticks * _config.tick_size; }
+
+    [[nodiscard]] uint64_t ticks() noexcept { return static_cast<uint64_t>(exponential(_config.mean_price_offset)); }
+
+    [[nodiscard]] uint64_t quantity() noexcept { return (1 + uniform(_config.max_lots)) * _config.lot_size; }
+
+    // Leaves room for the prices below the mid
+    [[nodiscard]] uint64_t min_mid() const noexcept { return static_cast<uint64_t>(_config.mean_price_offset * 16) + 2; }
+
+    // The live orders of a symbol
+
+    [[nodiscard]] LiveOrder& at(SymbolState& symbol, const size_t index) noexcept {
+        return symbol.live_orders[(symbol.first + index) % symbol.live_orders.size()];
+    }
+
+    void track(SymbolState& symbol, const uint64_t id, const OrderSide side, const bool is_limit) noexcept {
+        at(symbol, symbol.size++) = LiveOrder { id, side, is_limit };
+    }
+
+    // The last one takes the place of the removed one, so the order of the rest isn't kept
+    LiveOrder pop(SymbolState& symbol, const size_t index) noexcept {
+        auto order = at(symbol, index);
+        if (index == 0) {
+            symbol.first = (symbol.first + 1) % symbol.live_orders.size();
+        } else {
+            at(symbol, index) = at(symbol, symbol.size - 1);
+        }
+        --symbol.size;
+        return order;
+    }
+
+    // Random numbers
+
+    // xoshiro256**
+    [[nodiscard]] uint64_t random() noexcept {
+        auto result = std::rotl(_state[1] * 5, 7) * 9;
+        auto t = _state[1] << 17;
+        _state[2] ^= _state[0];
+        _state[3] ^= _state[1];
+        _state[1] ^= _state[2];
+        _state[0] ^= _state[3];
+        _state[2] ^= t;
+        _state[3] = std::rotl(_state[3], 45);
+        return result;
+    }
+
+    // In [0, 1), from the upper 53 bits
+    [[nodiscard]] double uniform01() noexcept { return static_cast<double>(random() >> 11) * 0x1.0p-53; }
+
+    // In [0, n). The bias of the modulo is negligible for the small ranges here.
+    [[nodiscard]] uint64_t uniform(const uint64_t n) noexcept { return random() % n; }
+
+    [[nodiscard]] bool chance(const double ratio) noexcept { return uniform01() < ratio; }
+
+    // The inverse CDF, -ln(1 - u), in fixed point. Math functions like std::log
+    //  are only as exact as each standard library makes them, and a single ulp
+    //  of difference in a timestamp or a price would fork the flow.
+    [[nodiscard]] double exponential(const double mean) noexcept {
+        // 1 - u, scaled to (0, 2^53], as e + log2(the mantissa)
+        auto x = (uint64_t { 1 } << 53) - (random() >> 11);
+        auto e = static_cast<uint64_t>(std::bit_width(x) - 1);
+        auto mantissa = x << (63 - e);
+        auto index = (mantissa >> 55) & 0xFF;
+        auto fraction = (mantissa >> 23) & 0xFFFF'FFFF;
+        auto log2_x = (e << 32) + Log2Table[index] + (((Log2Table[index + 1] - Log2Table[index]) * fraction) >> 32);
+        auto log2_inverse = static_cast<double>((uint64_t { 53 } << 32) - log2_x) * 0x1.0p-32;
+        return mean * (std::numbers::ln2 * log2_inverse);
+    }
+
+    // log2(1 + i / 256) in Q32, interpolated linearly in between, which is
+    //  within 3e-6 of the exact value. Computed by repeated squaring, so
+    //  with integers only.
+    constexpr static auto Log2Table = [] {
+        std::array<uint64_t, 257> table { };
+        for (uint64_t i = 0; i < 256; i++) {
+            // In Q31, so that the squares fit
+            auto y = (uint64_t { 1 } << 31) + (i << 23);
+            uint64_t log2 = 0;
+            for (int bit = 31; bit >= 0; bit--) {
+                y = (y * y) >> 31;
+                if (y >= (uint64_t { 1 } << 32)) {
+                    y >>= 1;
+                    log2 |= uint64_t { 1 } << bit;
+                }
+            }
+            table[i] = log2;
+        }
+        table[256] = uint64_t { 1 } << 32;
+        return table;
+    }();
+
+    GeneratorConfig _config;
+    std::vector<SymbolState> _symbols;
+    uint64_t _state[4];
+    uint32_t _next_orderbook = 0;
+    uint64_t _next_order_id = 1;
+    uint64_t _commands_count = 0;
+    double _timestamp = 0;
+};
+
+}
@@ -0,0 +1,225 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <thread>
+#include <utility>
+
+#include <chronex/Symbol.hpp>
+
+#include <chronex/data-structures/SPSCQueue.hpp>
+
+#include <chronex/handlers/EventRecord.hpp>
+
+#include <chronex/orderbook/OrderUtils.hpp>
+
+#include <chronex/utils/Threading.hpp>
+
+namespace chronex::handlers {
+
+/*
+ * Writes every event as an EventRecord into a ring, leaving the formatting,
+ *  logging, publishing, ... to whoever consumes it (see BinaryRingConsumer),
+ *  preferably on another core. An event costs the engine's thread a handful
+ *  of stores into a slot of the ring. Add, stop price update, and trigger
+ *  events also copy the order, since the consumer can't look it up.
+ *
+ * The records are only made visible to the consumer on flush(), which is
+ *  meant to be called once per command (see CommandFlushingEventHandler),
+ *  or per batch of commands (the Pipeline does that after each batch of
+ *  its match stage). When the ring is full, the handler publishes what it
+ *  has and waits for the consumer.
+ *
+ * Any ring with the producer side of SPSCQueue (emplace_deferred() and
+ *  commit()) will do, e.g. an ipc::EventBusWriter to reach other processes.
+ */
+template <typename RingType>
+class BasicBinaryRingEventHandler {
+public:
+
+    using Ring = RingType;
+
+    explicit BasicBinaryRingEventHandler(Ring* ring) noexcept : _ring(ring) { }
+
+    // OrderBooks
+    template <typename T>
+    void on_add_new_orderbook(T& orderbook) noexcept { write_orderbook(EventType::ADD_NEW_ORDERBOOK, orderbook); }
+    template <typename T>
+    void on_add_orderbook(T& orderbook) noexcept { write_orderbook(EventType::ADD_ORDERBOOK, orderbook); }
+    template <typename T>
+    void on_remove_orderbook(T& orderbook) noexcept { write_orderbook(EventType::REMOVE_ORDERBOOK, orderbook); }
+
+    // Levels
+    template <OrderType type, OrderSide side, typename T, typename U>
+    void on_add_level(T& orderbook, U& price) noexcept {
+        auto& record = emplace(EventType::ADD_LEVEL, type, side, orderbook.symbol_id());
+        record.price = price.value;
+    }
+    template <OrderType type, OrderSide side, typename T, typename U>
+    void on_remove_level(T& orderbook, U& price) noexcept {
+        auto& record = emplace(EventType::REMOVE_LEVEL, type, side, orderbook.symbol_id());
+        record.price = price.value;
+    }
+
+    // Orders
+    template <OrderType type, OrderSide side, typename T, typename U>
+    void on_add_order(T& orderbook, U& order) noexcept {
+        write_order(EventType::ADD_ORDER, type, side, orderbook, order);
+    }
+    template <OrderType type, OrderSide side, typename T, typename U>
+    void on_remove_order(T& orderbook, U& order) noexcept {
+        auto& record = emplace(EventType::REMOVE_ORDER, type, side, orderbook.symbol_id());
+        record.order_id = order.id().value;
+        record.quantity = order.leaves_quantity().value;
+    }
+    template <OrderType type, OrderSide side, typename T, typename U, typename Q>
+    void on_reduce_order(T& orderbook, U& order, Q& quantity) noexcept {
+        auto& record = emplace(EventType::REDUCE_ORDER, type, side, orderbook.symbol_id());
+        record.order_id = order.id().value;
+        record.quantity = quantity.value;
+    }
+    template <OrderSide side, typename T, typename U, typename V, typename P>
+    void on_execute_order(T& orderbook, U& order, V quantity, P price) noexcept {
+        auto& record = emplace(EventType::EXECUTE_ORDER, order.type(), side, orderbook.symbol_id());
+        record.order_id = order.id().value;
+        record.quantity = quantity.value;
+        record.price = price.value;
+    }
+    template <OrderSide executing_side, OrderSide reducing_side, typename T, typename U, typename V>
+    void on_match_order(T& orderbook, U& executing_order, V& reducing_order) noexcept {
+        auto& record = emplace(EventType::MATCH_ORDER, executing_order.type(), executing_side, orderbook.symbol_id());
+        record.other_side = reducing_side;
+        record.order_id = executing_order.id().value;
+        record.other_order_id = reducing_order.id().value;
+    }
+    template <OrderSide side, typename T, typename U>
+    void on_update_stop_price(T& orderbook, U& order) noexcept {
+        write_order(EventType::UPDATE_STOP_PRICE, order.type(), side, orderbook, order);
+    }
+    template <OrderType type, OrderSide side, typename T, typename U>
+    void on_trigger_stop_order(T& orderbook, U& order) noexcept {
+        write_order(EventType::TRIGGER_STOP_ORDER, type, side, orderbook, order);
+    }
+
+    // Commands. Only written when the handler is told about them (e.g. through
+    //  a CommandFlushingEventHandler). The type, side, and symbol are meaningless.
+    void on_command_begin(const uint64_t sequence) noexcept {
+        emplace(EventType::COMMAND_BEGIN, OrderType::MARKET, OrderSide::BUY, SymbolId { 0 }).order_id = sequence;
+    }
+    void on_command_end(const uint64_t sequence) noexcept {
+        emplace(EventType::COMMAND_END, OrderType::MARKET, OrderSide::BUY, SymbolId { 0 }).order_id = sequence;
+    }
+
+    // Makes the records written so far visible to the consumer
+    void flush() noexcept { _ring->commit(); }
+
+    [[nodiscard]] Ring* ring() const noexcept { return _ring; }
+
+private:
+
+    EventRecord& emplace(const EventType event, const OrderType type, const OrderSide side, const SymbolId symbol) noexcept {
+        auto& record = _ring->emplace_deferred(event, type, side, symbol);
+        record.sequence = ++_sequence;
+        return record;
+    }
+
+    template <typename T>
+    void write_orderbook(const EventType event, T& orderbook) noexcept {
+        // Some of the orderbook events report the symbol rather than the book
+        const Symbol* symbol;
+        if constexpr (requires { orderbook.symbol(); }) {
+            symbol = &orderbook.symbol();
+        } else {
+            symbol = &orderbook;
+        }
+        // The type and side are meaningless here
+        auto& record = emplace(event, OrderType::MARKET, OrderSide::BUY, symbol->id);
+        std::copy_n(symbol->name, sizeof(record.symbol_name), record.symbol_name);
+    }
+
+    template <typename T, typename U>
+    void write_order(const EventType event, const OrderType type, const OrderSide side, T& orderbook, U& order) noexcept {
+        auto& record = emplace(event, type, side, orderbook.symbol_id());
+        record.order_id = order.id().value;
+        record.order = make_order_record(order);
+    }
+
+    Ring* _ring;
+    // Of the last record written
+    uint64_t _sequence = 0;
+};
+
+using BinaryRingEventHandler = BasicBinaryRingEventHandler<ds::SPSCQueue<EventRecord>>;
+
+/*
+ * Drains a ring of EventRecords on its own thread (pinned to `core` if
+ *  provided), handing each record to `func`. Whatever is still in the ring
+ *  when the consumer is destroyed is drained before the thread exits, as
+ *  long as the producer flushed it.
+ */
+template <typename Func>
+class BinaryRingConsumer {
+public:
+
+    using Ring = ds::SPSCQueue<EventRecord>;
+
+    BinaryRingConsumer(Ring* ring, Func func, const std::optional<size_t> core = std::nullopt, const size_t batch_size = 256)
+        : _ring(ring), _func(std::move(func)), _batch_size(batch_size) {
+        _thread = std::jthread([this, core] (std::stop_token token) { run(token, core); });
+    }
+
+    BinaryRingConsumer(const BinaryRingConsumer&) = delete;
+    BinaryRingConsumer& operator=(const BinaryRingConsumer&) = delete;
+
+    ~BinaryRingConsumer() {
+        _thread.request_stop();
+        _thread.join();
+    }
+
+    [[nodiscard]] uint64_t consumed_count() const noexcept { return _consumed.load(std::memory_order_acquire); }
+
+    // Blocks until `count` records in total have been consumed
+    void wait_for(const uint64_t count) const noexcept {
+        utils::Backoff backoff;
+        while (consumed_count() < count) {
+            backoff.pause();
+        }
+    }
+
+private:
+
+    void run(const std::stop_token& token, const std::optional<size_t> core) {
+        if (core.has_value()) {
+            utils::pin_current_thread(*core);
+        }
+
+        utils::Backoff backoff;
+        while (!token.stop_requested()) {
+            if (consume() == 0) {
+                backoff.pause();
+            } else {
+                backoff.reset();
+            }
+        }
+
+        while (consume() != 0) { }
+    }
+
+    size_t consume() {
+        auto count = _ring->consume([this] (EventRecord& record) { _func(record); }, _batch_size);
+        _consumed.fetch_add(count, std::memory_order_release);
+        return count;
+    }
+
+    Ring* _ring;
+    Func _func;
+    size_t _batch_size;
+
+    std::atomic<uint64_t> _consumed { 0 };
+
+    std::jthread _thread;
+};
+
+}
@@ -0,0 +1,221 @@
+#pragma once
+
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string_view>
+
+#include <unistd.h>
+
+#include <chronex/Symbol.hpp>
+
+#include <chronex/orderbook/OrderUtils.hpp>
+
+#include <chronex/utils/BufferedWriter.hpp>
+
+namespace chronex::handlers {
+
+/*
+ * Produces the same text as StreamEventHandler, byte for byte, without going
+ *  through std::ostream. Each event is formatted with to_chars straight into
+ *  a large buffer, and the writes happen on a background thread (see
+ *  utils::BufferedWriter), so the engine's thread never waits on the file
+ *  unless all of the buffers are waiting to be written.
+ *
+ * The text only reaches the file when a buffer fills up, on flush(), or on
+ *  destruction. Nothing else should write to the same file descriptor in
+ *  the meantime (e.g. std::cout, for the default of writing to stdout).
+ */
+class BufferedTextEventHandler {
+
+// Same as StreamEventHandler, with the size known at compile-time
+#define TEXT_EVENT_NAME std::string_view { &__FUNCTION__[3], sizeof(__FUNCTION__) - 4 }
+
+    // Longer than the longest line, which is a match event
+    //  with three 20-digit numbers and a full symbol name
+    constexpr static size_t MaxLineSize = 256;
+
+    class Line {
+    public:
+
+        explicit Line(char* begin) noexcept : _begin(begin), _end(begin) { }
+
+        Line& operator<<(const std::string_view text) noexcept {
+            std::memcpy(_end, text.data(), text.size());
+            _end += text.size();
+            return *this;
+        }
+
+        Line& operator<<(const char* text) noexcept { return *this << std::string_view { text }; }
+
+        Line& operator<<(const char c) noexcept {
+            *_end++ = c;
+            return *this;
+        }
+
+        Line& operator<<(const uint64_t value) noexcept {
+            _end = std::to_chars(_end, _end + 20, value).ptr;
+            return *this;
+        }
+
+        Line& operator<<(const Price price) noexcept { return *this << price.value; }
+
+        Line& operator<<(const Quantity quantity) noexcept { return *this << quantity.value; }
+
+        Line& operator<<(const Symbol& symbol) noexcept { return *this << std::string_view { symbol.name }; }
+
+        Line& operator<<(const OrderSide side) noexcept { return *this << (side == OrderSide::BUY ? "Buy" : "Sell"); }
+
+        Line& operator<<(const OrderType type) noexcept {
+            switch (type) {
+                case OrderType::MARKET:              return *this << "Market";
+                case OrderType::LIMIT:               return *this << "Limit";
+                case OrderType::STOP:                return *this << "Stop";
+                case OrderType::STOP_LIMIT:          return *this << "Stop Limit";
+                case OrderType::TRAILING_STOP:       return *this << "Trailing Stop";
+                case OrderType::TRAILING_STOP_LIMIT: return *this << "Trailing Stop Limit";
+                default:                             return *this << "Unknown";
+            }
+        }
+
+        template <typename OrderBook>
+        Line& orderbook(const OrderBook& orderbook) noexcept {
+            return *this << "OrderBook { Symbol = " << orderbook.symbol() << " }";
+        }
+
+        template <typename Order>
+        Line& order(const Order& order) noexcept {
+            return *this << "Order { ID = " << order.id().value << " }";
+        }
+
+        [[nodiscard]] size_t size() const noexcept { return static_cast<size_t>(_end - _begin); }
+
+    private:
+        char* _begin;
+        char* _end;
+    };
+
+public:
+
+    explicit BufferedTextEventHandler(const int fd = STDOUT_FILENO, utils::BufferedWriterConfig config = { })
+        : _writer(std::make_unique<utils::BufferedWriter>(fd, std::move(config))) { }
+
+    // OrderBooks
+
+    void on_add_new_orderbook(auto& symbol) noexcept {
+        write(TEXT_EVENT_NAME, [&] (Line& line) { line << '\t' << symbol << '\n'; });
+    }
+
+    void on_add_orderbook(auto& symbol) noexcept {
+        write(TEXT_EVENT_NAME, [&] (Line& line) { line << '\t' << symbol << '\n'; });
+    }
+
+    void on_remove_orderbook(auto& orderbook) noexcept {
+        write(TEXT_EVENT_NAME, [&] (Line& line) { line << '\t'; line.orderbook(orderbook) << '\n'; });
+    }
+
+    // Levels
+
+    template <OrderType type, OrderSide side>
+    void on_add_level(auto& orderbook, const Price price) noexcept {
+        write(TEXT_EVENT_NAME, [&] (Line& line) {
+            line << "\t\t\t(" << type << ", " << side << ")\t\t";
+            line.orderbook(orderbook) << "\tPrice = " << price << '\n';
+        });
+    }
+
+    template <OrderType type, OrderSide side>
+    void on_remove_level(auto& orderbook, const Price price) noexcept {
+        write(TEXT_EVENT_NAME, [&] (Line& line) {
+            line << "\t\t(" << type << ", " << side << ")\t\t";
+            line.orderbook(orderbook) << "\tPrice = " << price << '\n';
+        });
+    }
+
+    // Orders
+
+    template <OrderType type, OrderSide side>
+    void on_add_order(auto& orderbook, auto& order) noexcept {
+        write_order_event(TEXT_EVENT_NAME, "\t\t\t(", type, side, orderbook, order);
+    }
+
+    template <OrderType type, OrderSide side>
+    void on_remove_order(auto& orderbook, auto& order) noexcept {
+        write_order_event(TEXT_EVENT_NAME, "\t\t(", type, side, orderbook, order);
+    }
+
+    template <OrderSide side>
+    void on_execute_order(auto& orderbook, auto& order, const Quantity quantity, const Price price) noexcept {
+        write(TEXT_EVENT_NAME, [&] (Line& line) {
+            line << "\t\t(" << order.type() << ", " << side << ")\t\t";
+            line.orderbook(orderbook) << '\t';
+            line.order(order) << "\tQuantity = " << quantity << "\tPrice = " << price << '\n';
+        });
+    }
+
+    template <OrderType type, OrderSide side>
+    void on_reduce_order(auto& orderbook, auto& order, Quantity quantity) noexcept {
+        write(TEXT_EVENT_NAME, [&] (Line& line) {
+            line << "\t\t(" << type << ", " << side << ")\t\t";
+            line.orderbook(orderbook) << '\t';
+            line.order(order) << "\tQuantity = " << quantity << '\n';
+        });
+    }
+
+    template <OrderSide side1, OrderSide side2>
+    void on_match_order(auto& orderbook, auto& executing_order, auto& reducing_order) noexcept {
+        write(TEXT_EVENT_NAME, [&] (Line& line) {
+            line << "\t\t\t(" << side1 << ", " << side2 << ")\t\t";
+            line.orderbook(orderbook) << '\t';
+            line.order(executing_order) << '\t';
+            line.order(reducing_order) << '\n';
+        });
+    }
+
+    template <OrderSide side>
+    void on_update_stop_price(auto& orderbook, auto& order) noexcept {
+        write_order_event(TEXT_EVENT_NAME, "\t\t\t(", order.type(), side, orderbook, order);
+    }
+
+    template <OrderType type, OrderSide side>
+    void on_trigger_stop_order(auto& orderbook, auto& order) noexcept {
+        write_order_event(TEXT_EVENT_NAME, "\t\t\t(", type, side, orderbook, order);
+    }
+
+#undef TEXT_EVENT_NAME
+
+    // Hands what's buffered so far to the writer thread, without waiting for
+    //  it. Returns false if a write has failed so far.
+    bool flush() noexcept { return _writer->flush(); }
+
+    // Blocks until everything reported so far is written. Returns false if it wasn't.
+    bool sync() noexcept { return _writer->sync(); }
+
+    // The errno of the first failed write, 0 if none has failed
+    [[nodiscard]] int error() const noexcept { return _writer->error(); }
+
+private:
+
+    // The name is taken outside of the lambdas, where __FUNCTION__ is the event's name
+    template <typename Func>
+    void write(const std::string_view name, Func&& format) noexcept {
+        Line line { _writer->reserve(MaxLineSize) };
+        line << name;
+        format(line);
+        _writer->advance(line.size());
+    }
+
+    void write_order_event(const std::string_view name, const std::string_view separator, const OrderType type, const OrderSide side, auto& orderbook, auto& order) noexcept {
+        write(name, [&] (Line& line) {
+            line << separator << type << ", " << side << ")\t\t";
+            line.orderbook(orderbook) << '\t';
+            line.order(order) << '\n';
+        });
+    }
+
+    // Behind a pointer, so that the handler can be moved into the engine
+    std::unique_ptr<utils::BufferedWriter> _writer;
+};
+
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+
+#include <chronex/handlers/EventMask.hpp>
+
+namespace chronex::handlers {
+
+/*
+ * Flushes the handler at the end of every command, so that what a command
+ *  did is published at once, as soon as it's done, and nothing of a command
+ *  is published before the rest of it. Fits the handlers that buffer their
+ *  output until flush() (e.g. MarketByPriceEventHandler, BinaryRingEventHandler,
+ *  CompositeEventHandler), and that would otherwise be flushed by hand.
+ *
+ * The command events are forwarded to the handler if it implements them,
+ *  even if it doesn't ask for them on its own (e.g. BinaryRingEventHandler,
+ *  which only writes the command records when it's told the commands).
+ */
+template <typename Handler>
+class CommandFlushingEventHandler : public Handler {
+public:
+
+    constexpr static EventMask event_mask = event_mask_v<Handler> | EventBits::Commands;
+
+    constexpr CommandFlushingEventHandler() = default;
+
+    constexpr explicit CommandFlushingEventHandler(Handler handler) noexcept : Handler(std::move(handler)) { }
+
+    void on_command_begin(const uint64_t sequence) noexcept {
+        if constexpr (requires (Handler& handler) { handler.on_command_begin(sequence); }) {
+            Handler::on_command_begin(sequence);
+        }
+    }
+
+    void on_command_end(const uint64_t sequence) noexcept {
+        if constexpr (requires (Handler& handler) { handler.on_command_end(sequence); }) {
+            Handler::on_command_end(sequence);
+        }
+        this->flush();
+    }
+};
+
+}
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <chronex/handlers/EventMask.hpp>
+#include <chronex/handlers/NullEventHandler.hpp>
+
+#include <chronex/orderbook/OrderUtils.hpp>
+
+namespace chronex::handlers {
+
+/*
+ * Forwards every event to each of the handlers that asks for it (see
+ *  event_mask_v), in order, without any virtual dispatch. Callbacks that a
+ *  handler doesn't implement (the ones it inherits from NullEventHandler,
+ *  which return NoOp) are skipped at compile-time, and if none of the
+ *  handlers implements a callback, the composite's own callback returns NoOp
+ *  as well, so that composites can be nested and still be recognized as
+ *  doing nothing for that event.
+ *
+ * The return types are spelled out rather than deduced, so that checking
+ *  the EventHandler concept doesn't instantiate the bodies of the handlers.
+ */
+template <typename... Handlers>
+class CompositeEventHandler {
+
+    template <typename... Results>
+    using ForwardResult = std::conditional_t<(is_no_op_v<Results> && ...), NoOp, void>;
+
+public:
+
+    // Whatever any of the handlers wants. If some of them want the trades and others want
+    //  the events trades are made of, the composite asks for both, and for the trade scopes
+    //  telling which executions and removals are part of a trade, to keep them from the
+    //  handlers that only want the trades.
+    constexpr static EventMask event_mask = [] {
+        constexpr auto mask = (EventBits::None | ... | event_mask_v<Handlers>);
+        constexpr bool details = (false || ... || (int(event_mask_v<Handlers> != EventBits::None) & int(reports_trade_details<Handlers>())));
+        constexpr bool mixed = int((mask & EventBits::Trade) != 0) & int(details);
+        return mixed ? mask | EventBits::TradeDetails | EventBits::TradeScope : mask;
+    }();
+
+    constexpr CompositeEventHandler() = default;
+
+    constexpr explicit CompositeEventHandler(Handlers... handlers) noexcept
+        : _handlers(std::move(handlers)...) { }
+
+    template <size_t I, typename Self>
+    [[nodiscard]] constexpr auto& get(this Self&& self) noexcept { return std::get<I>(self._handlers); }
+
+    template <typename Handler, typename Self>
+    [[nodiscard]] constexpr auto& get(this Self&& self) noexcept { return std::get<Handler>(self._handlers); }
+
+    // OrderBooks
+    template <typename T>
+    auto on_add_new_orderbook(T& symbol) noexcept
+        -> ForwardResult<decltype(std::declval<Handlers&>().on_add_new_orderbook(symbol))...> {
+        return forward<EventBits::AddNewOrderBook>([&] (auto& handler) { return handler.on_add_new_orderbook(symbol); });
+    }
+    template <typename T>
+    auto on_add_orderbook(T& symbol) noexcept
+        -> ForwardResult<decltype(std::declval<Handlers&>().on_add_orderbook(symbol))...> {
+        return forward<EventBits::AddOrderBook>([&] (auto& handler) { return handler.on_add_orderbook(symbol); });
+    }
+    template <typename T>
+    auto on_remove_orderbook(T& orderbook) noexcept
+        -> ForwardResult<decltype(std::declval<Handlers&>().on_remove_orderbook(orderbook))...> {
+        return forward<EventBits::RemoveOrderBook>([&] (auto& handler) { return handler.on_remove_orderbook(orderbook); });
+    }
+
+    // Levels
+    template <OrderType type, OrderSide side, typename T, typename U>
+    auto on_add_level(T& orderbook, U& price) noexcept
+        -> ForwardResult<decltype(std::declval<Handlers&>().template on_add_level<type, side>(orderbook, price))...> {
+        return forward<EventBits::AddLevel>([&] (auto& handler) { return handler.template on_add_level<type, side>(orderbook, price); });
+    }
+    template <OrderType type, OrderSide side, typename T, typename U>
+    auto on_remove_level(T& orderbook, U& price) noexcept
+        -> ForwardResult<decltype(std::declval<Handlers&>().template on_remove_level<type, side>(orderbook, price))...> {
+        return forward<EventBits::RemoveLevel>([&] (auto& handler) { return handler.template on_remove_level<type, side>(orderbook, price); });
+    }
+
+    // Orders
+    template <OrderType type, OrderSide side, typename T, typename U>
+    auto on_add_order(T& orderbook, U& order) noexcept
+        -> ForwardResult<decltype(std::declval<Handlers&>().template on_add_order<type, side>(orderbook, order))...> {
+        return forward<EventBits::AddOrder>([&] (auto& handler) { return handler.template on_add_order<type, side>(orderbook, order); });
+    }
+    template <OrderType type, OrderSide side, typename T, typename U>
+    auto on_remove_order(T& orderbook, U& order) noexcept
+        -> ForwardResult<decltype(std::declval<Handlers&>().template on_remove_order<type, side>(orderbook, order))...> {
+        return forward<EventBits::RemoveOrder>([&] (auto& handler) { return handler.template on_remove_order<type, side>(orderbook, order); });
+    }
+    template <OrderType type, OrderSide side, typename T, typename U, typename Q>
+    auto on_reduce_order(T& orderbook, U& order, Q& quantity) noexcept
+        -> ForwardResult<decltype(std::declval<Handlers&>().template on_reduce_order<type, side>(orderbook, order, quantity))...> {
+        return forward<EventBits::ReduceOrder>([&] (auto& handler) { return handler.template on_reduce_order<type, side>(orderbook, order, quantity); });
+    }
+    template <OrderSide side, typename T, typename U, typename V, typename P>
+    auto on_execute_order(T& orderbook, U& order, V quantity, P price) noexcept
+        -> ForwardResult<decltype(std::declval<Handlers&>().template on_execute_order<side>(orderbook, order, quantity, price))...> {
+        return forward<EventBits::ExecuteOrder>([&] (auto& handler) { return handler.template on_execute_order<side>(orderbook, order, quantity, price); });
+    }
+    template <OrderSide side1, OrderSide side2, typename T, typename U, typename V>
+    auto on_match_order(T& orderbook, U& executing_order, V& reducing_order) noexcept
+        -> ForwardResult<decltype(std::declval<Handlers&>().template on_match_order<side1, side2>(orderbook, executing_order, reducing_order))...> {
+        return forward<EventBits::MatchOrder>([&] (auto& handler) { return handler.template on_match_order<side1, side2>(orderbook, executing_order, reducing_order); });
+    }
+    template <OrderSide side, typename T, typename U>
+    auto on_update_stop_price(T& orderbook, U& order) noexcept
+        -> ForwardResult<decltype(std::declval<Handlers&>().template on_update_stop_price<side>(orderbook, order))...> {
+        return forward<EventBits::UpdateStopPrice>([&] (auto& handler) { return handler.template on_update_stop_price<side>(orderbook, order); });
+    }
+    template <OrderType type, OrderSide side, typename T, typename U>
+    auto on_trigger_stop_order(T& orderbook, U& order) noexcept
+        -> ForwardResult<decltype(std::declval<Handlers&>().template on_trigger_stop_order<type, side>(orderbook, order))...> {
+        return forward<EventBits::TriggerStopOrder>([&] (auto& handler) { return handler.template on_trigger_stop_order<type, side>(orderbook, order); });
+    }
+
+    // Trades are only forwarded to the handlers that ask for them
+    template <OrderSide side, typename T, typename U, typename Q, typename P, typename F>
+    void on_trade(T& orderbook, U& aggressor, U& resting, Q quantity, P price, F flags) noexcept {
+        forward_to<EventBits::Trade>([&] (auto& handler) {
+            handler.template on_trade<side>(orderbook, aggressor, resting, quantity, price, flags);
+        });
+    }
+
+    // Trade scopes as well, for the nested composites
+    void on_trade_scope_begin() noexcept {
+        _in_trade_scope = true;
+        forward_to<EventBits::TradeScope>([&] (auto& handler) { handler.on_trade_scope_begin(); });
+    }
+    void on_trade_scope_end() noexcept {
+        _in_trade_scope = false;
+        forward_to<EventBits::TradeScope>([&] (auto& handler) { handler.on_trade_scope_end(); });
+    }
+
+    // Commands are only forwarded to the handlers that ask for them
+    void on_command_begin(const uint64_t sequence) noexcept {
+        forward_to<EventBits::CommandBegin>([&] (auto& handler) { handler.on_command_begin(sequence); });
+    }
+    void on_command_end(const uint64_t sequence) noexcept {
+        forward_to<EventBits::CommandEnd>([&] (auto& handler) { handler.on_command_end(sequence); });
+    }
+
+    // Lets the handlers that buffer their output (e.g. into a ring) publish it
+    void flush() noexcept {
+        std::apply([] (auto&... handlers) {
+            ([&] {
+                if constexpr (requires { handlers.flush(); }) {
+                    handlers.flush();
+                }
+            }(), ...);
+        }, _handlers);
+    }
+
+private:
+
+    // Within a trade scope, the events are the details of a trade,
+    //  which the handlers that only want the trades don't get
+    template <EventMask event, typename Func>
+    auto forward(Func&& func) noexcept {
+        if constexpr ((is_no_op_v<decltype(func(std::declval<Handlers&>()))> && ...)) {
+            return NoOp { };
+        } else {
+            std::apply([&] (auto&... handlers) {
+                ([&] {
+                    using Handler = std::remove_cvref_t<decltype(handlers)>;
+                    if constexpr (int(!is_no_op_v<decltype(func(handlers))>) & int(reports<Handler>(event))) {
+                        if constexpr (reports_trade_details<Handler>()) {
+                            func(handlers);
+                        } else if (!_in_trade_scope) {
+                            func(handlers);
+                        }
+                    }
+                }(), ...);
+            }, _handlers);
+        }
+    }
+
+    // For the events that are not in EventBits::All, which
+    //  the handlers don't have to implement unless they ask for them
+    template <EventMask event, typename Func>
+    void forward_to(Func&& func) noexcept {
+        std::apply([&] (auto&... handlers) {
+            ([&] {
+                if constexpr (reports<std::remove_cvref_t<decltype(handlers)>>(event)) {
+                    func(handlers);
+                }
+            }(), ...);
+        }, _handlers);
+    }
+
+    std::tuple<Handlers...> _handlers;
+
+    // Only ever set when the composite asks for the trade scopes
+    bool _in_trade_scope = false;
+};
+
+}
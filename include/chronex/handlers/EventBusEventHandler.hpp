@@ -0,0 +1,69 @@
+#pragma once
+
+#include <algorithm>
+
+#include <chronex/handlers/BinaryRingEventHandler.hpp>
+#include <chronex/handlers/EventRecord.hpp>
+
+#include <chronex/ipc/EventBus.hpp>
+
+#include <chronex/orderbook/OrderUtils.hpp>
+
+namespace chronex::handlers {
+
+/*
+ * Writes every event as an EventRecord into an event bus in shared memory,
+ *  for readers in other processes (see ipc::EventBusReader<EventRecord>).
+ *  Like BinaryRingEventHandler, the records are only published on flush().
+ *
+ * As long as the handler is the only one writing to the bus, the sequence
+ *  of a record is its position in the bus plus 1.
+ */
+using EventBusEventHandler = BasicBinaryRingEventHandler<ipc::EventBusWriter<EventRecord>>;
+
+/*
+ * Serves the snapshot requests of the readers of the bus, if there are any.
+ *  Meant to be called by the engine's thread between commands, once the
+ *  handler is flushed (e.g. along with the flush of each command or batch).
+ *  Costs a single load when there are no requests.
+ *
+ * A snapshot is an ADD_ORDERBOOK record per orderbook, followed by an
+ *  ADD_ORDER record per order of the book, level by level, from the best
+ *  level to the worst one, and in the order of priority within a level.
+ *  Limit orders come first, then stop orders, then trailing stop orders.
+ *  The records of a snapshot are not numbered (their sequence is 0).
+ */
+template <typename Engine>
+void serve_snapshot(Engine& engine, ipc::EventBusWriter<EventRecord>& bus) {
+    if (!bus.is_snapshot_requested()) [[likely]] return;
+
+    bus.begin_snapshot();
+    engine.for_each_orderbook([&bus] (const auto& orderbook) {
+        auto& symbol = orderbook.symbol();
+        EventRecord record { EventType::ADD_ORDERBOOK, OrderType::MARKET, OrderSide::BUY, symbol.id };
+        record.sequence = 0;
+        std::copy_n(symbol.name, sizeof(record.symbol_name), record.symbol_name);
+        if (!bus.add_to_snapshot(record)) return;
+
+        auto add_levels = [&] <OrderType type, OrderSide side> {
+            for (auto& [price, level] : orderbook.template levels<type, side>()) {
+                for (auto& order : level) {
+                    EventRecord order_record { EventType::ADD_ORDER, order.type(), side, symbol.id };
+                    order_record.sequence = 0;
+                    order_record.order_id = order.id().value;
+                    order_record.order = make_order_record(order);
+                    if (!bus.add_to_snapshot(order_record)) return;
+                }
+            }
+        };
+        add_levels.template operator()<OrderType::LIMIT, OrderSide::BUY>();
+        add_levels.template operator()<OrderType::LIMIT, OrderSide::SELL>();
+        add_levels.template operator()<OrderType::STOP, OrderSide::BUY>();
+        add_levels.template operator()<OrderType::STOP, OrderSide::SELL>();
+        add_levels.template operator()<OrderType::TRAILING_STOP, OrderSide::BUY>();
+        add_levels.template operator()<OrderType::TRAILING_STOP, OrderSide::SELL>();
+    });
+    bus.end_snapshot();
+}
+
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <concepts>
+#include <cstdint>
+#include <type_traits>
+
+#include <chronex/handlers/NullEventHandler.hpp>
+
+namespace chronex::handlers {
+
+using EventMask = uint32_t;
+
+// One bit per callback of the event handlers
+struct EventBits {
+    constexpr static EventMask AddNewOrderBook  = 1u << 0;
+    constexpr static EventMask AddOrderBook     = 1u << 1;
+    constexpr static EventMask RemoveOrderBook  = 1u << 2;
+
+    constexpr static EventMask AddLevel         = 1u << 3;
+    constexpr static EventMask RemoveLevel      = 1u << 4;
+
+    constexpr static EventMask AddOrder         = 1u << 5;
+    constexpr static EventMask RemoveOrder      = 1u << 6;
+    constexpr static EventMask ReduceOrder      = 1u << 7;
+    constexpr static EventMask ExecuteOrder     = 1u << 8;
+    constexpr static EventMask MatchOrder       = 1u << 9;
+    constexpr static EventMask UpdateStopPrice  = 1u << 10;
+    constexpr static EventMask TriggerStopOrder = 1u << 11;
+
+    // See on_trade in NullEventHandler
+    constexpr static EventMask Trade            = 1u << 12;
+    constexpr static EventMask TradeDetails     = 1u << 13;
+
+    constexpr static EventMask CommandBegin     = 1u << 14;
+    constexpr static EventMask CommandEnd       = 1u << 15;
+
+    // See on_trade_scope_begin in NullEventHandler
+    constexpr static EventMask TradeScope       = 1u << 16;
+
+    constexpr static EventMask OrderBooks = AddNewOrderBook | AddOrderBook | RemoveOrderBook;
+    constexpr static EventMask Levels     = AddLevel | RemoveLevel;
+    constexpr static EventMask Orders     = AddOrder | RemoveOrder | ReduceOrder | ExecuteOrder | MatchOrder | UpdateStopPrice | TriggerStopOrder;
+    constexpr static EventMask Commands   = CommandBegin | CommandEnd;
+
+    constexpr static EventMask None = 0;
+    // Trades, commands, and trade scopes are only reported to the handlers that ask for them
+    constexpr static EventMask All  = OrderBooks | Levels | Orders;
+};
+
+/*
+ * The events a handler wants to be reported. A handler declares them with
+ *  a `constexpr static EventMask event_mask` member. Handlers that don't
+ *  are reported everything, except for NullEventHandler itself, which is
+ *  reported nothing. Handlers deriving from NullEventHandler are reported
+ *  everything as well, unless they declare their own mask.
+ *
+ * The engine and the books check the mask with `if constexpr` before each
+ *  callback, so the arguments of an event nobody listens to (and the checks
+ *  deciding whether to report it) are never computed.
+ */
+template <typename EventHandler>
+constexpr EventMask event_mask_v = [] {
+    if constexpr (requires { { EventHandler::event_mask } -> std::convertible_to<EventMask>; }) {
+        return EventMask { EventHandler::event_mask };
+    } else if constexpr (std::is_same_v<EventHandler, NullEventHandler>) {
+        return EventBits::None;
+    } else {
+        return EventBits::All;
+    }
+}();
+
+// Whether the handler wants any of the given events
+template <typename EventHandler>
+[[nodiscard]] constexpr bool reports(const EventMask events) noexcept {
+    return (event_mask_v<EventHandler> & events) != 0;
+}
+
+/*
+ * Whether the handler wants the fine-grained events a trade is made of: the
+ *  executions of both orders, their match, and the removals of the orders
+ *  it fills and the levels it empties. Handlers that ask for Trade get all
+ *  of that in a single on_trade, and get the rest only with TradeDetails.
+ *  For the other handlers, nothing changes.
+ */
+template <typename EventHandler>
+[[nodiscard]] constexpr bool reports_trade_details() noexcept {
+    return !reports<EventHandler>(EventBits::Trade) || reports<EventHandler>(EventBits::TradeDetails);
+}
+
+}
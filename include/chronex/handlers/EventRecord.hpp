@@ -0,0 +1,208 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+#include <chronex/Symbol.hpp>
+
+#include <chronex/orderbook/OrderUtils.hpp>
+
+namespace chronex::handlers {
+
+enum class EventType : uint8_t {
+    // OrderBooks
+    ADD_NEW_ORDERBOOK,
+    ADD_ORDERBOOK,
+    REMOVE_ORDERBOOK,
+
+    // Levels
+    ADD_LEVEL,
+    REMOVE_LEVEL,
+
+    // Orders
+    ADD_ORDER,
+    REMOVE_ORDER,
+    REDUCE_ORDER,
+    EXECUTE_ORDER,
+    MATCH_ORDER,
+    UPDATE_STOP_PRICE,
+    TRIGGER_STOP_ORDER,
+
+    // Commands
+    COMMAND_BEGIN,
+    COMMAND_END,
+};
+
+// Everything needed to rebuild an order on the consumer's side
+struct OrderRecord {
+    uint64_t id;
+    uint64_t leaves_quantity;
+    uint64_t filled_quantity;
+    uint64_t max_visible_quantity;
+    uint64_t price;
+    uint64_t stop_price;
+    uint64_t slippage;
+    int64_t trailing_distance;
+    int64_t trailing_step;
+    uint32_t account_id;
+    OrderType type;
+    OrderSide side;
+    TimeInForce time_in_force;
+    uint8_t padding;
+};
+
+template <typename T>
+[[nodiscard]] constexpr OrderRecord make_order_record(const T& order) noexcept {
+    return OrderRecord {
+        .id = order.id().value,
+        .leaves_quantity = order.leaves_quantity().value,
+        .filled_quantity = order.filled_quantity().value,
+        .max_visible_quantity = order.max_visible_quantity().value,
+        .price = order.price().value,
+        .stop_price = order.stop_price().value,
+        .slippage = order.slippage().value,
+        .trailing_distance = order.trailing_distance().raw_distance(),
+        .trailing_step = order.trailing_distance().raw_step(),
+        .account_id = order.account_id().value,
+        .type = order.type(),
+        .side = order.side(),
+        .time_in_force = order.time_in_force(),
+        .padding = 0
+    };
+}
+
+// Rebuilds the order a record was made of. The initial stop price
+//  isn't recorded, so it's taken to be the current one.
+template <typename T>
+[[nodiscard]] constexpr T make_order(const OrderRecord& record, const SymbolId symbol_id) noexcept {
+    auto trailing_distance = TrailingDistance::from_percentage_units(record.trailing_distance, record.trailing_step);
+    auto order = [&] {
+        switch (record.type) {
+            case OrderType::LIMIT:
+                return T::limit(record.id, symbol_id.value, record.side, record.price, record.leaves_quantity,
+                                record.time_in_force, record.max_visible_quantity);
+            case OrderType::STOP:
+                return T::stop(record.id, symbol_id.value, record.side, record.stop_price, record.leaves_quantity,
+                               record.time_in_force, record.slippage);
+            case OrderType::STOP_LIMIT:
+                return T::stop_limit(record.id, symbol_id.value, record.side, record.stop_price, record.price,
+                                     record.leaves_quantity, record.time_in_force, record.max_visible_quantity);
+            case OrderType::TRAILING_STOP:
+                return T::trailing_stop(record.id, symbol_id.value, record.side, record.stop_price, record.leaves_quantity,
+                                        trailing_distance, record.time_in_force, record.slippage);
+            case OrderType::TRAILING_STOP_LIMIT:
+                return T::trailing_stop_limit(record.id, symbol_id.value, record.side, record.stop_price, record.price,
+                                              record.leaves_quantity, trailing_distance, record.time_in_force,
+                                              record.max_visible_quantity);
+            default:
+                return T::market(record.id, symbol_id.value, record.side, record.leaves_quantity, record.slippage);
+        }
+    }();
+    // Whatever the factories don't take
+    order.set_price(Price { record.price });
+    order.set_stop_price(Price { record.stop_price });
+    order.set_time_in_force(record.time_in_force);
+    order.increase_filled_quantity(Quantity { record.filled_quantity });
+    order.set_account_id(AccountId { record.account_id });
+    return order;
+}
+
+/*
+ * The checks the engine only asserts (see Order::is_valid), for orders that
+ *  come from outside (e.g. through the gateway or the pipeline). These hold
+ *  in release builds as well. The ID is left to the caller, since a bad ID
+ *  is usually reported apart from a bad order.
+ */
+[[nodiscard]] constexpr bool is_valid_order(const OrderRecord& record) noexcept {
+    auto type = record.type;
+    switch (type) {
+        case OrderType::MARKET:
+        case OrderType::LIMIT:
+        case OrderType::STOP:
+        case OrderType::STOP_LIMIT:
+        case OrderType::TRAILING_STOP:
+        case OrderType::TRAILING_STOP_LIMIT:
+            break;
+        default:
+            return false;
+    }
+    if (int(record.side != OrderSide::BUY) & int(record.side != OrderSide::SELL)) return false;
+    if (record.time_in_force > TimeInForce::AON) return false;
+    if (int(record.leaves_quantity == 0) | int(record.leaves_quantity >= Quantity::invalid().value)) return false;
+
+    auto is_iceberg = record.max_visible_quantity < record.leaves_quantity;
+    if (int(has_limit_price(type)) & int(record.price == Price::invalid().value)) return false;
+    if (int(has_limit_price(type)) & int(record.slippage != Price::invalid().value)) return false;
+    if (int(is_stop(type)) & int(record.stop_price == Price::invalid().value)) return false;
+
+    if (is_market(type)) {
+        return int(record.time_in_force == TimeInForce::IOC || record.time_in_force == TimeInForce::FOK) & int(!is_iceberg);
+    }
+    if (int(is_stop(type)) & int(!has_limit_price(type))) {
+        if (int(record.time_in_force == TimeInForce::AON) | int(is_iceberg)) return false;
+    }
+    if (is_trailing(type)) {
+        auto distance = record.trailing_distance;
+        auto step = record.trailing_step;
+        if (distance > 0) return int(step >= 0) & int(step < distance);
+        if (distance < 0) return int(distance >= -1000) & int(step <= 0) & int(step > distance);
+        return false;
+    }
+    return true;
+}
+
+template <typename T>
+[[nodiscard]] constexpr bool is_valid_order(const T& order) noexcept {
+    return is_valid_order(make_order_record(order));
+}
+
+/*
+ * A fixed-size, POD record of a single engine event. The header (event,
+ *  type, side, symbol, and sequence) is always set. Which of the other fields are
+ *  set depends on the event, and the rest are left uninitialized:
+ *
+ *  - orderbook events:  symbol_name
+ *  - level events:      price
+ *  - add order:         order_id, order
+ *  - remove order:      order_id, quantity (the leaves quantity)
+ *  - reduce order:      order_id, quantity
+ *  - execute order:     order_id, quantity, price
+ *  - match order:       order_id (executing), other_order_id (reducing), other_side
+ *  - update stop price: order_id, order
+ *  - trigger stop:      order_id, order
+ *  - command events:    order_id (the command's sequence)
+ *
+ * `sequence` numbers the records of a ring from 1, without gaps, so that a
+ *  consumer can tell if it missed any.
+ *
+ * `type` and `side` are the ones the event was reported with, which is not
+ *  always the order's current type (e.g. right before a stop is triggered).
+ */
+struct EventRecord {
+    constexpr EventRecord(const EventType _event, const OrderType _type, const OrderSide _side, const SymbolId _symbol_id) noexcept
+        : event(_event), type(_type), side(_side), symbol_id(_symbol_id.value) { }
+
+    EventType event;
+    OrderType type;
+    OrderSide side;
+    OrderSide other_side;
+    uint32_t symbol_id;
+
+    uint64_t sequence;
+
+    uint64_t order_id;
+    uint64_t other_order_id;
+    uint64_t price;
+    uint64_t quantity;
+
+    union {
+        OrderRecord order;
+        char symbol_name[sizeof(Symbol::name)];
+    };
+};
+
+static_assert(std::is_trivially_copyable_v<EventRecord>);
+static_assert(std::is_trivially_destructible_v<EventRecord>);
+static_assert(sizeof(EventRecord) <= 2 * 64, "An EventRecord should fit in two cache lines");
+
+}
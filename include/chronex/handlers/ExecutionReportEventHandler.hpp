@@ -0,0 +1,202 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <type_traits>
+
+#include <chronex/handlers/EventMask.hpp>
+#include <chronex/handlers/TradeFlags.hpp>
+
+#include <chronex/orderbook/OrderUtils.hpp>
+
+namespace chronex::handlers {
+
+enum class ExecutionReportType : uint8_t {
+    // The order was added to the book (or to the stop orders, depending on order_type)
+    REST,
+    // A part of the order was executed
+    FILL,
+    // The rest of the order was removed before being filled
+    CANCEL,
+    // A stop order (of order_type) was triggered, and carries on as a market or a limit order
+    TRIGGER,
+};
+
+/*
+ * What happened to an order, in 48 bytes. Which fields are set depends on
+ *  the type:
+ *
+ *  - rest:    order_id, price, quantity (the leaves quantity)
+ *  - fill:    order_id, other_order_id (the resting order, 0 if the order was
+ *             executed by hand), price, quantity, leaves_quantity, flags
+ *  - cancel:  order_id, quantity (the leaves quantity that was removed)
+ *  - trigger: order_id, price, quantity (the leaves quantity)
+ *
+ * A fill is a single report for both orders of a trade. order_id is the
+ *  aggressor, and `flags` tells which of the two were filled.
+ */
+struct ExecutionReport {
+    uint64_t order_id;
+    uint64_t other_order_id;
+    uint64_t price;
+    uint64_t quantity;
+    uint64_t leaves_quantity;
+    uint32_t symbol_id;
+    ExecutionReportType type;
+    OrderType order_type;
+    OrderSide side;
+    TradeFlags flags;
+};
+
+static_assert(std::is_trivially_copyable_v<ExecutionReport>);
+static_assert(sizeof(ExecutionReport) == 48);
+
+/*
+ * Appends an ExecutionReport per fill, rest, cancel, and trigger to
+ *  a buffer provided by the caller, for in-process users (backtesters,
+ *  simulators, ...) that would rather go over the results of a command (or
+ *  a batch of commands) in a loop afterwards than handle the events as they
+ *  come:
+ *
+ *      handler.reset(buffer);
+ *      engine.add_order(order);
+ *      for (auto& report : handler.reports()) { ... }
+ *
+ * Nothing is allocated. When the buffer is full, the rest of the reports are
+ *  dropped and counted (see dropped()), so the buffer should be sized for the
+ *  largest command (or batch) expected.
+ *
+ * The handler asks for trades rather than the executions and removals they
+ *  are made of, which is what makes a crossing of two orders a single report.
+ */
+class ExecutionReportEventHandler {
+public:
+
+    constexpr static EventMask event_mask =
+        EventBits::Trade | EventBits::AddOrder | EventBits::RemoveOrder | EventBits::ExecuteOrder |
+        EventBits::TriggerStopOrder;
+
+    constexpr ExecutionReportEventHandler() noexcept = default;
+
+    constexpr explicit ExecutionReportEventHandler(const std::span<ExecutionReport> buffer) noexcept : _buffer(buffer) { }
+
+    // OrderBooks
+    template <typename T>
+    void on_add_new_orderbook(T&) const noexcept { }
+    template <typename T>
+    void on_add_orderbook(T&) const noexcept { }
+    template <typename T>
+    void on_remove_orderbook(T&) const noexcept { }
+
+    // Levels
+    template <OrderType, OrderSide, typename T, typename U>
+    void on_add_level(T&, U&) const noexcept { }
+    template <OrderType, OrderSide, typename T, typename U>
+    void on_remove_level(T&, U&) const noexcept { }
+
+    // Orders
+    template <OrderType type, OrderSide side, typename T, typename U>
+    void on_add_order(T& orderbook, U& order) noexcept {
+        write(ExecutionReportType::REST, type, side, orderbook, order, order.price().value, order.leaves_quantity().value);
+    }
+    template <OrderType type, OrderSide side, typename T, typename U>
+    void on_remove_order(T& orderbook, U& order) noexcept {
+        // Filled orders are already reported by their last fill. Orders executed by hand are
+        //  removed before their execution is applied, right after the fill that empties them.
+        auto filled = int(order.leaves_quantity().value == 0) | int(order.id().value == _filled_id);
+        _filled_id = 0;
+        if (filled) return;
+        write(ExecutionReportType::CANCEL, type, side, orderbook, order, 0, order.leaves_quantity().value);
+    }
+    template <OrderType, OrderSide, typename T, typename U, typename Q>
+    void on_reduce_order(T&, U&, Q&) const noexcept { }
+    template <OrderSide side, typename T, typename U, typename V, typename P>
+    void on_execute_order(T& orderbook, U& order, V quantity, P price) noexcept {
+        // Only executions outside of trades (e.g. execute_order) are reported here
+        _filled_id = quantity == order.leaves_quantity() ? order.id().value : 0;
+        auto report = write(ExecutionReportType::FILL, order.type(), side, orderbook, order, price.value, quantity.value);
+        if (report != nullptr) report->leaves_quantity = order.leaves_quantity().value - quantity.value;
+    }
+    template <OrderSide, OrderSide, typename T, typename U, typename V>
+    void on_match_order(T&, U&, V&) const noexcept { }
+    template <OrderSide, typename T, typename U>
+    void on_update_stop_price(T&, U&) const noexcept { }
+    template <OrderType type, OrderSide side, typename T, typename U>
+    void on_trigger_stop_order(T& orderbook, U& order) noexcept {
+        write(ExecutionReportType::TRIGGER, type, side, orderbook, order, order.price().value, order.leaves_quantity().value);
+    }
+
+    // Trades
+    template <OrderSide side, typename T, typename U, typename Q, typename P, typename F>
+    void on_trade(T& orderbook, U& aggressor, U& resting, Q quantity, P price, F flags) noexcept {
+        // Reported before the orders are executed
+        auto report = write(ExecutionReportType::FILL, aggressor.type(), side, orderbook, aggressor, price.value, quantity.value);
+        if (report == nullptr) return;
+        report->other_order_id = resting.id().value;
+        report->leaves_quantity = aggressor.leaves_quantity().value - quantity.value;
+        report->flags = flags;
+    }
+
+    // Starts over at the beginning of the given buffer
+    void reset(const std::span<ExecutionReport> buffer) noexcept {
+        _buffer = buffer;
+        reset();
+    }
+
+    // Starts over at the beginning of the same buffer
+    void reset() noexcept {
+        _size = 0;
+        _dropped = 0;
+        _filled_id = 0;
+    }
+
+    // The number of reports written since the last reset
+    [[nodiscard]] size_t size() const noexcept { return _size; }
+
+    [[nodiscard]] std::span<const ExecutionReport> reports() const noexcept { return _buffer.first(_size); }
+
+    // The number of reports that didn't fit in the buffer since the last reset
+    [[nodiscard]] size_t dropped() const noexcept { return _dropped; }
+
+    // Returns the number of reports written, and starts over. The reports
+    //  stay at the beginning of the buffer until they're overwritten.
+    size_t take() noexcept {
+        auto count = _size;
+        reset();
+        return count;
+    }
+
+private:
+
+    template <typename T, typename U>
+    ExecutionReport* write(const ExecutionReportType type, const OrderType order_type, const OrderSide side,
+                           T& orderbook, U& order, const uint64_t price, const uint64_t quantity) noexcept {
+        if (_size == _buffer.size()) [[unlikely]] {
+            ++_dropped;
+            return nullptr;
+        }
+        auto& report = _buffer[_size++];
+        report = ExecutionReport {
+            .order_id = order.id().value,
+            .other_order_id = 0,
+            .price = price,
+            .quantity = quantity,
+            .leaves_quantity = order.leaves_quantity().value,
+            .symbol_id = orderbook.symbol_id().value,
+            .type = type,
+            .order_type = order_type,
+            .side = side,
+            .flags = TradeBits::None
+        };
+        return &report;
+    }
+
+    std::span<ExecutionReport> _buffer;
+    size_t _size = 0;
+    size_t _dropped = 0;
+
+    // The order the last execution outside of a trade filled, which is removed right after it
+    uint64_t _filled_id = 0;
+};
+
+}
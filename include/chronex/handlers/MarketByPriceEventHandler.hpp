@@ -0,0 +1,200 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <chronex/handlers/EventMask.hpp>
+
+#include <chronex/orderbook/OrderUtils.hpp>
+
+namespace chronex::handlers {
+
+// The new state of one price level. A level that's gone has no volume and no orders.
+struct PriceLevelUpdate {
+    // Per symbol, starting from 1. A gap means a lost update.
+    uint64_t sequence;
+    uint64_t price;
+    uint64_t visible_volume;
+    // Includes hidden orders
+    uint32_t orders_count;
+    uint32_t symbol_id;
+    OrderSide side;
+};
+
+/*
+ * A conflated, market-by-price (L2) incremental feed. Instead of an update
+ *  per order event, the handler only notes which (side, price) levels were
+ *  touched, and on flush() (meant to be called at the end of each command)
+ *  reads the resulting state of each of them from the book, and publishes
+ *  one update per level whose visible volume or order count changed. A
+ *  sweep of 20 orders over 3 levels is 3 updates.
+ *
+ * Only the price levels are published, stop orders are not visible. The
+ *  books must stay where they are between an event and the next flush.
+ *
+ * `publisher(const PriceLevelUpdate&)` is called on the engine's thread,
+ *  so it should be cheap (e.g. pushing into a ring).
+ */
+template <typename Publisher>
+class MarketByPriceEventHandler {
+
+    struct LevelState {
+        uint64_t visible_volume;
+        uint32_t orders_count;
+        constexpr bool operator==(const LevelState&) const noexcept = default;
+    };
+
+    using LevelReader = LevelState (*)(const void* orderbook, OrderSide side, Price price);
+
+    struct TouchedLevel {
+        const void* orderbook;
+        LevelReader read;
+        uint32_t symbol_id;
+        OrderSide side;
+        Price price;
+    };
+
+    struct BookState {
+        uint64_t sequence = 0;
+        // The last published state of each level, by price
+        std::unordered_map<uint64_t, LevelState> bids;
+        std::unordered_map<uint64_t, LevelState> asks;
+
+        auto& levels(const OrderSide side) noexcept { return side == OrderSide::BUY ? bids : asks; }
+    };
+
+public:
+
+    constexpr static EventMask event_mask =
+        EventBits::RemoveOrderBook | EventBits::Levels | EventBits::AddOrder | EventBits::RemoveOrder |
+        EventBits::ReduceOrder | EventBits::ExecuteOrder;
+
+    explicit MarketByPriceEventHandler(Publisher publisher = { }) : _publisher(std::move(publisher)) { }
+
+    // OrderBooks
+    template <typename T>
+    void on_add_new_orderbook(T&) const noexcept { }
+    template <typename T>
+    void on_add_orderbook(T&) const noexcept { }
+    template <typename T>
+    void on_remove_orderbook(T& orderbook) {
+        std::erase_if(_touched, [&] (const TouchedLevel& level) { return level.orderbook == &orderbook; });
+
+        // Everything the consumers know of the book is gone
+        auto symbol = orderbook.symbol_id().value;
+        auto it = _books.find(symbol);
+        if (it == _books.end()) return;
+        for (auto side : { OrderSide::BUY, OrderSide::SELL }) {
+            for (auto& [price, state] : it->second.levels(side)) {
+                publish(it->second, symbol, side, Price { price }, LevelState { 0, 0 });
+            }
+        }
+        _books.erase(it);
+    }
+
+    // Levels
+    template <OrderType type, OrderSide side, typename T, typename U>
+    void on_add_level(T& orderbook, U& price) { touch<type, side>(orderbook, price); }
+    template <OrderType type, OrderSide side, typename T, typename U>
+    void on_remove_level(T& orderbook, U& price) { touch<type, side>(orderbook, price); }
+
+    // Orders
+    template <OrderType type, OrderSide side, typename T, typename U>
+    void on_add_order(T& orderbook, U& order) { touch<type, side>(orderbook, order.price()); }
+    template <OrderType type, OrderSide side, typename T, typename U>
+    void on_remove_order(T& orderbook, U& order) { touch<type, side>(orderbook, order.price()); }
+    template <OrderType type, OrderSide side, typename T, typename U, typename Q>
+    void on_reduce_order(T& orderbook, U& order, Q&) { touch<type, side>(orderbook, order.price()); }
+    template <OrderSide side, typename T, typename U, typename V, typename P>
+    void on_execute_order(T& orderbook, U& order, V, P) {
+        // Also reported for incoming orders that aren't in a level. Touching
+        //  a level that didn't and doesn't exist publishes nothing.
+        touch<OrderType::LIMIT, side>(orderbook, order.price());
+    }
+    template <OrderSide, OrderSide, typename T, typename U, typename V>
+    void on_match_order(T&, U&, V&) const noexcept { }
+    template <OrderSide, typename T, typename U>
+    void on_update_stop_price(T&, U&) const noexcept { }
+    template <OrderType, OrderSide, typename T, typename U>
+    void on_trigger_stop_order(T&, U&) const noexcept { }
+
+    // Publishes the levels that changed since the last flush
+    void flush() {
+        for (auto& level : _touched) {
+            auto& book = _books[level.symbol_id];
+            auto& levels = book.levels(level.side);
+            auto state = level.read(level.orderbook, level.side, level.price);
+
+            auto it = levels.find(level.price.value);
+            if (it == levels.end()) {
+                if (state.orders_count == 0) continue;
+                levels.emplace(level.price.value, state);
+            } else {
+                if (it->second == state) continue;
+                if (state.orders_count == 0) {
+                    levels.erase(it);
+                } else {
+                    it->second = state;
+                }
+            }
+
+            publish(book, level.symbol_id, level.side, level.price, state);
+        }
+        _touched.clear();
+    }
+
+    [[nodiscard]] Publisher& publisher() noexcept { return _publisher; }
+
+private:
+
+    template <OrderType type, OrderSide side, typename OrderBook>
+    void touch(OrderBook& orderbook, const Price price) {
+        if constexpr (type == OrderType::LIMIT) {
+            auto symbol = orderbook.symbol_id().value;
+            // Few levels are touched by a command, a linear search is fine
+            auto it = std::find_if(_touched.begin(), _touched.end(), [&] (const TouchedLevel& level) {
+                return int(level.price == price) & int(level.side == side) & int(level.symbol_id == symbol);
+            });
+            if (it == _touched.end()) {
+                _touched.push_back(TouchedLevel { &orderbook, &read_level<OrderBook>, symbol, side, price });
+            }
+        }
+    }
+
+    template <typename OrderBook>
+    static LevelState read_level(const void* pointer, const OrderSide side, const Price price) {
+        auto& orderbook = *static_cast<const OrderBook*>(pointer);
+        if (side == OrderSide::BUY) {
+            return read_level(orderbook.template levels<OrderType::LIMIT, OrderSide::BUY>(), price);
+        }
+        return read_level(orderbook.template levels<OrderType::LIMIT, OrderSide::SELL>(), price);
+    }
+
+    template <typename Levels>
+    static LevelState read_level(const Levels& levels, const Price price) {
+        auto it = levels.find(price);
+        if (it == levels.end()) return LevelState { 0, 0 };
+        return LevelState { it->second.visible_volume().value, static_cast<uint32_t>(it->second.size()) };
+    }
+
+    void publish(BookState& book, const uint32_t symbol, const OrderSide side, const Price price, const LevelState state) {
+        _publisher(PriceLevelUpdate {
+            .sequence = ++book.sequence,
+            .price = price.value,
+            .visible_volume = state.visible_volume,
+            .orders_count = state.orders_count,
+            .symbol_id = symbol,
+            .side = side
+        });
+    }
+
+    Publisher _publisher;
+
+    std::vector<TouchedLevel> _touched;
+    std::unordered_map<uint32_t, BookState> _books;
+};
+
+}
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstdint>
+#include <type_traits>
+
 namespace chronex {
     enum class OrderType : uint8_t;
     enum class OrderSide : uint8_t;
@@ -7,37 +10,74 @@ namespace chronex {
 
 namespace chronex::handlers {
 
+// Returned by callbacks that do nothing, so that they can be told apart at
+//  compile-time (e.g. to skip them in a CompositeEventHandler). Handlers
+//  deriving from NullEventHandler only have to override what they handle.
+struct NoOp { };
+
+template <typename T>
+constexpr bool is_no_op_v = std::is_same_v<T, NoOp>;
+
 class NullEventHandler {
 public:
     // OrderBooks
     template <typename T>
-    void on_add_new_orderbook(T&) const noexcept { }
+    NoOp on_add_new_orderbook(T&) const noexcept { return { }; }
     template <typename T>
-    void on_add_orderbook(T&) const noexcept { }
+    NoOp on_add_orderbook(T&) const noexcept { return { }; }
     template <typename T>
-    void on_remove_orderbook(T&) const noexcept { }
+    NoOp on_remove_orderbook(T&) const noexcept { return { }; }
 
     // Levels
     template <OrderType, OrderSide, typename T, typename U>
-    void on_add_level(T&, U&) const noexcept { }
+    NoOp on_add_level(T&, U&) const noexcept { return { }; }
     template <OrderType, OrderSide, typename T, typename U>
-    void on_remove_level(T&, U&) const noexcept { }
+    NoOp on_remove_level(T&, U&) const noexcept { return { }; }
 
     // Orders
     template <OrderType, OrderSide, typename T, typename U>
-    void on_add_order(T&, U&) const noexcept { }
+    NoOp on_add_order(T&, U&) const noexcept { return { }; }
     template <OrderType, OrderSide, typename T, typename U>
-    void on_remove_order(T&, U&) const noexcept { }
+    NoOp on_remove_order(T&, U&) const noexcept { return { }; }
     template <OrderType, OrderSide, typename T, typename U, typename Q>
-    void on_reduce_order(T&, U&, Q&) const noexcept { }
+    NoOp on_reduce_order(T&, U&, Q&) const noexcept { return { }; }
     template <OrderSide, typename T, typename U, typename V, typename P>
-    void on_execute_order(T&, U&, V, P) const noexcept { }
+    NoOp on_execute_order(T&, U&, V, P) const noexcept { return { }; }
     template <OrderSide, OrderSide, typename T, typename U, typename V>
-    void on_match_order(T&, U&, V&) const noexcept { }
+    NoOp on_match_order(T&, U&, V&) const noexcept { return { }; }
     template <OrderSide, typename T, typename U>
-    void on_update_stop_price(T&, U&) const noexcept { }
+    NoOp on_update_stop_price(T&, U&) const noexcept { return { }; }
     template <OrderType, OrderSide, typename T, typename U>
-    void on_trigger_stop_order(T&, U&) const noexcept { };
+    NoOp on_trigger_stop_order(T&, U&) const noexcept { return { }; }
+
+    /*
+     * Trades, only reported to the handlers that ask for EventBits::Trade.
+     *  One crossing of two orders is one trade, reported before it happens,
+     *  with the side of the aggressor and a set of TradeBits, instead of an
+     *  execution per order, a match, and the removals of the filled orders
+     *  and the emptied levels (see reports_trade_details). An aggressor that
+     *  doesn't rest is still reported removed once it's done.
+     */
+    template <OrderSide, typename T, typename U, typename Q, typename P, typename F>
+    NoOp on_trade(T&, U&, U&, Q, P, F) const noexcept { return { }; }
+
+    /*
+     * Commands, only reported to the handlers that ask for EventBits::Commands.
+     *  Every event of a command is reported between the two, and the commands
+     *  are numbered from 1 without gaps, so the end of a command is the place
+     *  to publish what it did, and a gap means a lost command.
+     */
+    NoOp on_command_begin(uint64_t) const noexcept { return { }; }
+    NoOp on_command_end(uint64_t) const noexcept { return { }; }
+
+    /*
+     * Trade scopes, only reported to the handlers that ask for
+     *  EventBits::TradeScope. Every event reported in between is a trade or
+     *  part of one, which lets a handler that gets both the trades and their
+     *  details (e.g. CompositeEventHandler) tell the details apart.
+     */
+    NoOp on_trade_scope_begin() const noexcept { return { }; }
+    NoOp on_trade_scope_end() const noexcept { return { }; }
 };
 
 }
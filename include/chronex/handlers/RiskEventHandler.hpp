@@ -0,0 +1,172 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include <chronex/handlers/EventMask.hpp>
+
+#include <chronex/orderbook/Order.hpp>
+#include <chronex/orderbook/OrderUtils.hpp>
+
+#include <chronex/risk/RiskChecker.hpp>
+
+namespace chronex::handlers {
+
+/*
+ * Keeps the open notional counters of a RiskChecker up to date with what
+ *  the engine does to the orders it accepted, and publishes the market
+ *  prices the checker collars against at the end of each command, once the
+ *  book is up to date.
+ *
+ * An order gives back its notional as it trades or gets executed, and
+ *  whatever is left when it's removed. Two patterns in the engine's reports
+ *  need care:
+ *  - A full execution of an order in the book (execute_order) is followed
+ *    by the removal of the order, still reporting its pre-execution
+ *    quantity. That removal is skipped. Trades report fills as TradeBits
+ *    instead, without removals.
+ *  - Modifying, triggering, and re-pricing an order unlink it first, which
+ *    is reported as a removal. If the order shows up again in the same
+ *    command, it's still alive, and its (possibly updated) notional is
+ *    reserved back. A cascade can have several orders unlinked at once,
+ *    which are remembered in a small ring rather than allocated.
+ *  - Removing a book doesn't report its orders, whose notional is released
+ *    with the book.
+ */
+template <concepts::Order Order = Order>
+class RiskEventHandler {
+public:
+
+    constexpr static EventMask event_mask = EventBits::RemoveOrderBook | (EventBits::Orders & ~EventBits::MatchOrder) | EventBits::Trade | EventBits::CommandEnd;
+
+    explicit RiskEventHandler(risk::RiskChecker<Order>* risk) noexcept : _risk(risk) { }
+
+    // OrderBooks
+    template <typename T>
+    void on_add_new_orderbook(T&) const noexcept { }
+    template <typename T>
+    void on_add_orderbook(T&) const noexcept { }
+    template <typename T>
+    void on_remove_orderbook(T& orderbook) noexcept {
+        // Reported before the book is cleared, which removes its orders silently
+        orderbook.for_each_order([this] (auto order_it) {
+            _risk->release(*order_it, order_it->leaves_quantity());
+        });
+        _orderbook = nullptr;
+    }
+
+    // Levels
+    template <OrderType, OrderSide, typename T, typename U>
+    void on_add_level(T&, U&) const noexcept { }
+    template <OrderType, OrderSide, typename T, typename U>
+    void on_remove_level(T&, U&) const noexcept { }
+
+    // Orders
+    template <OrderType, OrderSide, typename T, typename U>
+    void on_add_order(T& orderbook, U& order) noexcept {
+        restore_if_unlinked(order);
+        touch(orderbook);
+    }
+    template <OrderType, OrderSide, typename T, typename U>
+    void on_remove_order(T& orderbook, U& order) noexcept {
+        if (order.id() == _fully_executed) {
+            _fully_executed = OrderId::invalid();
+        } else {
+            _risk->release(order, order.leaves_quantity());
+            _unlinked[_unlinked_count++ % MaxUnlinked] = order.id().value;
+        }
+        touch(orderbook);
+    }
+    template <OrderType, OrderSide, typename T, typename U, typename Q>
+    void on_reduce_order(T& orderbook, U& order, Q& quantity) noexcept {
+        restore_if_unlinked(order);
+        // The quantity is the new leaves quantity, reported before the update
+        if (quantity < order.leaves_quantity()) {
+            _risk->release(order, order.leaves_quantity() - quantity);
+        }
+        touch(orderbook);
+    }
+    template <OrderSide, typename T, typename U, typename V, typename P>
+    void on_execute_order(T& orderbook, U& order, V quantity, P) noexcept {
+        // Only the executions outside of trades, which are reported before the update
+        restore_if_unlinked(order);
+        _risk->release(order, quantity);
+        if (quantity == order.leaves_quantity()) {
+            _fully_executed = order.id();
+        }
+        touch(orderbook);
+    }
+    template <OrderSide, OrderSide, typename T, typename U, typename V>
+    void on_match_order(T&, U&, V&) const noexcept { }
+    template <OrderSide, typename T, typename U>
+    void on_update_stop_price(T&, U& order) noexcept { restore_if_unlinked(order); }
+    template <OrderType, OrderSide, typename T, typename U>
+    void on_trigger_stop_order(T&, U& order) noexcept { restore_if_unlinked(order); }
+
+    // Trades
+    template <OrderSide, typename T, typename U, typename Q, typename P, typename F>
+    void on_trade(T& orderbook, U& aggressor, U& resting, Q quantity, P, F) noexcept {
+        // A triggered stop order trades right after being unlinked
+        restore_if_unlinked(aggressor);
+        _risk->release(aggressor, quantity);
+        _risk->release(resting, quantity);
+        touch(orderbook);
+    }
+
+    // Commands
+    void on_command_end(uint64_t) noexcept {
+        if (_orderbook != nullptr) {
+            _update_reference_prices(_risk, _orderbook);
+            _orderbook = nullptr;
+        }
+        // What wasn't linked back by now is gone
+        _unlinked_count = 0;
+        _fully_executed = OrderId::invalid();
+    }
+
+private:
+
+    void restore_if_unlinked(const Order& order) noexcept {
+        if (_unlinked_count == 0) {
+            return;
+        }
+        // Newest first, since an order is linked back right after its unlink
+        auto count = std::min(_unlinked_count, MaxUnlinked);
+        for (size_t i = 1; i <= count; ++i) {
+            auto& id = _unlinked[(_unlinked_count - i) % MaxUnlinked];
+            if (id == order.id().value) {
+                _risk->reserve(order, order.leaves_quantity());
+                id = OrderId::invalid().value;
+                return;
+            }
+        }
+    }
+
+    // The book is only known to the events, so the prices to publish at the
+    //  end of the command are remembered along with how to read them
+    template <typename T>
+    void touch(const T& orderbook) noexcept {
+        _orderbook = &orderbook;
+        _update_reference_prices = [] (risk::RiskChecker<Order>* risk, const void* book) {
+            risk->update_reference_prices(*static_cast<const T*>(book));
+        };
+    }
+
+    risk::RiskChecker<Order>* _risk;
+
+    // The engine links an order back right after unlinking it, so the ring
+    //  only needs to hold the few removals in between. The ones that fall out
+    //  of it were of orders that are gone.
+    constexpr static size_t MaxUnlinked = 16;
+
+    OrderId _fully_executed = OrderId::invalid();
+    std::array<uint64_t, MaxUnlinked> _unlinked { };
+    size_t _unlinked_count = 0;
+
+    const void* _orderbook = nullptr;
+    void (*_update_reference_prices)(risk::RiskChecker<Order>*, const void*) = nullptr;
+};
+
+}
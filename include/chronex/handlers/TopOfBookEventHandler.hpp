@@ -0,0 +1,163 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <chronex/Symbol.hpp>
+
+#include <chronex/handlers/EventMask.hpp>
+
+#include <chronex/orderbook/OrderUtils.hpp>
+
+namespace chronex::handlers {
+
+// Best bid and offer of a symbol. An empty side has a price and a volume of 0.
+struct TopOfBook {
+    // Per symbol, incremented on each change
+    uint64_t sequence;
+    uint64_t bid_price;
+    uint64_t bid_volume;
+    uint64_t ask_price;
+    uint64_t ask_volume;
+    uint32_t symbol_id;
+
+    [[nodiscard]] constexpr bool same_top(const TopOfBook& other) const noexcept {
+        return int(bid_price == other.bid_price) & int(bid_volume == other.bid_volume) &
+               int(ask_price == other.ask_price) & int(ask_volume == other.ask_volume);
+    }
+};
+
+/*
+ * Publishes the best bid and offer (price and visible volume) of a book
+ *  only when it actually changes. The events only mark the books they
+ *  touch, and on flush() (meant to be called at the end of each command)
+ *  the top of each touched book is read with best_visible_level(), compared
+ *  against the last one published, and if it differs, the symbol's slot is
+ *  overwritten and `publisher(const TopOfBook&)` is called. So a command
+ *  publishes at most one record per symbol, however many orders it touches.
+ *
+ * Levels without visible volume (hidden orders only) are skipped. The
+ *  books must stay where they are between an event and the next flush.
+ */
+template <typename Publisher>
+class TopOfBookEventHandler {
+
+    using TopReader = TopOfBook (*)(const void* orderbook);
+
+    struct TouchedBook {
+        const void* orderbook;
+        TopReader read;
+    };
+
+public:
+
+    constexpr static EventMask event_mask =
+        EventBits::RemoveOrderBook | EventBits::Levels | EventBits::AddOrder | EventBits::RemoveOrder |
+        EventBits::ReduceOrder | EventBits::ExecuteOrder;
+
+    explicit TopOfBookEventHandler(Publisher publisher = { }) : _publisher(std::move(publisher)) { }
+
+    // OrderBooks
+    template <typename T>
+    void on_add_new_orderbook(T&) const noexcept { }
+    template <typename T>
+    void on_add_orderbook(T&) const noexcept { }
+    template <typename T>
+    void on_remove_orderbook(T& orderbook) {
+        std::erase_if(_touched, [&] (const TouchedBook& book) { return book.orderbook == &orderbook; });
+        auto symbol = orderbook.symbol_id().value;
+        if (symbol < _slots.size() && _slots[symbol].sequence != 0) {
+            update(TopOfBook { 0, 0, 0, 0, 0, symbol });
+        }
+    }
+
+    // Levels
+    template <OrderType type, OrderSide, typename T, typename U>
+    void on_add_level(T& orderbook, U&) { touch<type>(orderbook); }
+    template <OrderType type, OrderSide, typename T, typename U>
+    void on_remove_level(T& orderbook, U&) { touch<type>(orderbook); }
+
+    // Orders
+    template <OrderType type, OrderSide, typename T, typename U>
+    void on_add_order(T& orderbook, U&) { touch<type>(orderbook); }
+    template <OrderType type, OrderSide, typename T, typename U>
+    void on_remove_order(T& orderbook, U&) { touch<type>(orderbook); }
+    template <OrderType type, OrderSide, typename T, typename U, typename Q>
+    void on_reduce_order(T& orderbook, U&, Q&) { touch<type>(orderbook); }
+    template <OrderSide, typename T, typename U, typename V, typename P>
+    void on_execute_order(T& orderbook, U&, V, P) { touch<OrderType::LIMIT>(orderbook); }
+    template <OrderSide, OrderSide, typename T, typename U, typename V>
+    void on_match_order(T&, U&, V&) const noexcept { }
+    template <OrderSide, typename T, typename U>
+    void on_update_stop_price(T&, U&) const noexcept { }
+    template <OrderType, OrderSide, typename T, typename U>
+    void on_trigger_stop_order(T&, U&) const noexcept { }
+
+    // Publishes the tops that changed since the last flush
+    void flush() {
+        for (auto& book : _touched) {
+            update(book.read(book.orderbook));
+        }
+        _touched.clear();
+    }
+
+    // The last published top of the symbol. Its sequence is 0 if nothing was published.
+    [[nodiscard]] const TopOfBook& top(const SymbolId symbol) const noexcept {
+        constexpr static TopOfBook Empty { };
+        return symbol.value < _slots.size() ? _slots[symbol.value] : Empty;
+    }
+
+    [[nodiscard]] Publisher& publisher() noexcept { return _publisher; }
+
+private:
+
+    template <OrderType type, typename OrderBook>
+    void touch(OrderBook& orderbook) {
+        if constexpr (type == OrderType::LIMIT) {
+            // Usually the same book over and over within a command
+            if (!_touched.empty() && _touched.back().orderbook == &orderbook) return;
+            auto it = std::find_if(_touched.begin(), _touched.end(), [&] (const TouchedBook& book) {
+                return book.orderbook == &orderbook;
+            });
+            if (it == _touched.end()) {
+                _touched.push_back(TouchedBook { &orderbook, &read_top<OrderBook> });
+            }
+        }
+    }
+
+    template <typename OrderBook>
+    static TopOfBook read_top(const void* pointer) {
+        auto& orderbook = *static_cast<const OrderBook*>(pointer);
+        auto [bid_price, bid_volume] = read_side<OrderSide::BUY>(orderbook);
+        auto [ask_price, ask_volume] = read_side<OrderSide::SELL>(orderbook);
+        return TopOfBook { 0, bid_price, bid_volume, ask_price, ask_volume, orderbook.symbol_id().value };
+    }
+
+    template <OrderSide side, typename OrderBook>
+    static std::pair<uint64_t, uint64_t> read_side(const OrderBook& orderbook) {
+        auto it = orderbook.template best_visible_level<side>();
+        if (it == orderbook.template levels<OrderType::LIMIT, side>().end()) return { 0, 0 };
+        return { it->first.value, it->second.visible_volume().value };
+    }
+
+    void update(TopOfBook top) {
+        if (top.symbol_id >= _slots.size()) {
+            _slots.resize(top.symbol_id + 1, TopOfBook { });
+        }
+        auto& slot = _slots[top.symbol_id];
+        if (slot.same_top(top)) return;
+        top.sequence = slot.sequence + 1;
+        slot = top;
+        _publisher(slot);
+    }
+
+    Publisher _publisher;
+
+    std::vector<TouchedBook> _touched;
+    // Indexed by symbol ID
+    std::vector<TopOfBook> _slots;
+};
+
+}
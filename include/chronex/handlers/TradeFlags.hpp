@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+
+namespace chronex::handlers {
+
+using TradeFlags = uint8_t;
+
+// What a trade did to the book, so that the handlers of on_trade
+//  don't need the removal events to keep track of it
+struct TradeBits {
+    constexpr static TradeFlags None                  = 0;
+
+    constexpr static TradeFlags AggressorFilled       = 1u << 0;
+    constexpr static TradeFlags RestingFilled         = 1u << 1;
+    // The order was the last one in its level, which is removed
+    constexpr static TradeFlags AggressorLevelEmptied = 1u << 2;
+    constexpr static TradeFlags RestingLevelEmptied   = 1u << 3;
+
+    // Both orders were resting in the book (e.g. when matching is enabled
+    //  again), so neither of them is really the aggressor. The buy order
+    //  is reported as the aggressor.
+    constexpr static TradeFlags Crossed               = 1u << 4;
+};
+
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <span>
+
+#include <sys/epoll.h>
+
+#include <chronex/ipc/UnixSocket.hpp>
+
+namespace chronex::ipc {
+
+/*
+ * An epoll instance. Each descriptor is registered along with a 64-bit
+ *  key of the caller's choosing (e.g. an index into its own table), which
+ *  is what wait() hands back for the descriptors that are ready.
+ *
+ * The methods return false on failure, and errno tells why.
+ */
+class Epoll {
+public:
+
+    [[nodiscard]] static std::optional<Epoll> create() noexcept {
+        FileDescriptor fd { ::epoll_create1(EPOLL_CLOEXEC) };
+        if (!fd.is_valid()) return std::nullopt;
+        return Epoll { std::move(fd) };
+    }
+
+    bool add(const int fd, const uint32_t events, const uint64_t key) const noexcept {
+        return control(EPOLL_CTL_ADD, fd, events, key);
+    }
+
+    bool modify(const int fd, const uint32_t events, const uint64_t key) const noexcept {
+        return control(EPOLL_CTL_MOD, fd, events, key);
+    }
+
+    bool remove(const int fd) const noexcept {
+        return ::epoll_ctl(_fd.get(), EPOLL_CTL_DEL, fd, nullptr) == 0;
+    }
+
+    // The number of ready descriptors written to `events`, 0 on timeout, or -1 on failure
+    [[nodiscard]] int wait(const std::span<epoll_event> events, const int timeout_ms) const noexcept {
+        return ::epoll_wait(_fd.get(), events.data(), static_cast<int>(events.size()), timeout_ms);
+    }
+
+private:
+
+    explicit Epoll(FileDescriptor fd) noexcept : _fd(std::move(fd)) { }
+
+    bool control(const int operation, const int fd, const uint32_t events, const uint64_t key) const noexcept {
+        epoll_event event { };
+        event.events = events;
+        event.data.u64 = key;
+        return ::epoll_ctl(_fd.get(), operation, fd, &event) == 0;
+    }
+
+    FileDescriptor _fd;
+};
+
+}
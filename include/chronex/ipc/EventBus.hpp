@@ -0,0 +1,590 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <new>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <chronex/ipc/SharedMemory.hpp>
+
+#include <chronex/utils/Threading.hpp>
+
+namespace chronex::ipc {
+
+/*
+ * The layout of an event bus in shared memory:
+ *
+ *  | header | a cursor per reader | capacity slots of T |
+ *
+ * Everything the writer and the readers share is either written once before
+ *  the magic is published, or is a lock-free atomic, which works across
+ *  processes as long as it's address-free (which lock-free atomics are).
+ */
+struct EventBusHeader {
+    constexpr static uint64_t Magic = 0x5355424e45524843;  // "CHRENBUS"
+    constexpr static uint32_t Version = 1;
+
+    // Set last by the writer, once the rest is initialized
+    std::atomic<uint64_t> magic;
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t capacity;
+    uint64_t max_readers;
+    uint64_t snapshot_capacity;
+
+    // The number of records published so far
+    alignas(utils::CacheLineSize) std::atomic<uint64_t> tail;
+
+    // Snapshots (see EventBusWriter::begin_snapshot). Readers take tickets
+    //  from `requested`, and wait for `served` to reach theirs.
+    alignas(utils::CacheLineSize) std::atomic<uint64_t> requested;
+    alignas(utils::CacheLineSize) std::atomic<uint64_t> served;
+    // Odd while a snapshot is being written
+    std::atomic<uint64_t> snapshot_version;
+    // The number of records published before the snapshot was taken
+    std::atomic<uint64_t> snapshot_position;
+    std::atomic<uint64_t> snapshot_size;
+    std::atomic<uint32_t> snapshot_truncated;
+};
+
+// A snapshot copied by a reader (see EventBusReader::try_read_snapshot)
+struct EventBusSnapshot {
+    // The snapshot is the state after the first `position` records of the bus
+    uint64_t position;
+    // Some of the snapshot didn't fit in the snapshot area of the bus
+    bool is_truncated;
+};
+
+struct alignas(utils::CacheLineSize) EventBusCursor {
+    constexpr static uint32_t Free    = 0;
+    constexpr static uint32_t Joining = 1;
+    constexpr static uint32_t Active  = 2;
+    // Fell behind by more than the capacity of the ring, and is left behind
+    constexpr static uint32_t Evicted = 3;
+
+    // The number of records the reader is done with. Written by the reader only.
+    std::atomic<uint64_t> head;
+    std::atomic<uint32_t> state;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+              "The atomics of the event bus are shared between processes");
+
+template <typename T>
+struct EventBusLayout {
+
+    static_assert(std::is_trivially_copyable_v<T>, "The records of an event bus are shared between processes");
+    static_assert(alignof(T) <= utils::CacheLineSize);
+
+    constexpr static size_t CursorsOffset = sizeof(EventBusHeader);
+
+    [[nodiscard]] constexpr static size_t slots_offset(const size_t max_readers) noexcept {
+        return CursorsOffset + max_readers * sizeof(EventBusCursor);
+    }
+
+    [[nodiscard]] constexpr static size_t snapshot_offset(const size_t capacity, const size_t max_readers) noexcept {
+        return slots_offset(max_readers) + capacity * sizeof(T);
+    }
+
+    [[nodiscard]] constexpr static size_t size(const size_t capacity, const size_t max_readers, const size_t snapshot_capacity) noexcept {
+        return snapshot_offset(capacity, max_readers) + snapshot_capacity * sizeof(T);
+    }
+
+    explicit EventBusLayout(std::byte* data) noexcept
+        : header(std::launder(reinterpret_cast<EventBusHeader*>(data))),
+          cursors(std::launder(reinterpret_cast<EventBusCursor*>(data + CursorsOffset))),
+          slots(data + slots_offset(header->max_readers)),
+          snapshot(data + snapshot_offset(header->capacity, header->max_readers)),
+          mask(header->capacity - 1),
+          max_readers(header->max_readers) { }
+
+    [[nodiscard]] T* slot(const uint64_t index) const noexcept {
+        return std::launder(reinterpret_cast<T*>(slots + (index & mask) * sizeof(T)));
+    }
+
+    // The slots and the snapshot are read while they may be rewritten (and
+    //  the reader then throws its copy away), so readers access them as
+    //  relaxed atomic words, like the value of a SeqLock, rather than as
+    //  plain Ts
+    [[nodiscard]] uint64_t* slot_words(const uint64_t index) const noexcept {
+        return std::launder(reinterpret_cast<uint64_t*>(slots + (index & mask) * sizeof(T)));
+    }
+
+    [[nodiscard]] uint64_t* snapshot_words(const uint64_t index) const noexcept {
+        return std::launder(reinterpret_cast<uint64_t*>(snapshot + index * sizeof(T)));
+    }
+
+    constexpr static size_t WordsCount = sizeof(T) / sizeof(uint64_t);
+
+    // T doesn't have to be default-constructible
+    [[nodiscard]] static T load(uint64_t* source) noexcept {
+        static_assert(sizeof(T) % sizeof(uint64_t) == 0 && alignof(T) >= alignof(uint64_t),
+                      "Records are copied word by word");
+        std::array<uint64_t, WordsCount> words;
+        for (size_t i = 0; i < words.size(); i++) {
+            words[i] = std::atomic_ref(source[i]).load(std::memory_order_relaxed);
+        }
+        return std::bit_cast<T>(words);
+    }
+
+    EventBusHeader* header;
+    EventBusCursor* cursors;
+    std::byte* slots;
+    std::byte* snapshot;
+    uint64_t mask;
+    uint64_t max_readers;
+};
+
+/*
+ * The writer side of a single-producer, multiple-consumers ring in shared
+ *  memory (a disruptor, more or less). Every reader gets every record, at
+ *  its own pace, from its own process, straight out of the shared memory:
+ *  no syscalls and no copies other than the write itself.
+ *
+ * The producer side looks like SPSCQueue's (records are written in place,
+ *  and published in batches by commit()), so the writer fits where an
+ *  SPSCQueue does, e.g. in a BasicBinaryRingEventHandler. A record's slot
+ *  is only reused once every active reader is done with it, except that
+ *  the writer never waits for a reader: a reader that's more than the
+ *  capacity of the ring behind when the writer needs its slot is evicted,
+ *  and the writer goes on as if it wasn't there. Once it notices, the
+ *  reader can join again, and ask for a snapshot to start over from (see
+ *  begin_snapshot()). So what a reader does never costs the writer more
+ *  than a look at its cursor.
+ *
+ * The bus is removed from /dev/shm when the writer is destroyed. Readers
+ *  that are still attached keep their mapping, but see no new records.
+ */
+template <typename T>
+class EventBusWriter {
+
+    using Layout = EventBusLayout<T>;
+
+public:
+
+    using value_type = T;
+
+    constexpr static size_t DefaultMaxReaders = 16;
+
+    // The name is the one of the shared memory object (e.g. "/chronex-events")
+    //  The snapshots can be as large as `snapshot_capacity` records.
+    [[nodiscard]] static std::optional<EventBusWriter> create(std::string name, const size_t capacity,
+                                                              const size_t max_readers = DefaultMaxReaders,
+                                                              const size_t snapshot_capacity = 0) noexcept {
+        assert(std::has_single_bit(capacity) && "EventBus capacity must be a power of two");
+        auto memory = SharedMemory::create(std::move(name), Layout::size(capacity, max_readers, snapshot_capacity));
+        if (!memory) return std::nullopt;
+
+        auto* data = memory->data();
+        auto* header = std::construct_at(reinterpret_cast<EventBusHeader*>(data));
+        header->version = EventBusHeader::Version;
+        header->record_size = sizeof(T);
+        header->capacity = capacity;
+        header->max_readers = max_readers;
+        header->snapshot_capacity = snapshot_capacity;
+        header->tail.store(0, std::memory_order_relaxed);
+        header->requested.store(0, std::memory_order_relaxed);
+        header->served.store(0, std::memory_order_relaxed);
+        header->snapshot_version.store(0, std::memory_order_relaxed);
+        header->snapshot_position.store(0, std::memory_order_relaxed);
+        header->snapshot_size.store(0, std::memory_order_relaxed);
+        header->snapshot_truncated.store(0, std::memory_order_relaxed);
+        auto* cursors = reinterpret_cast<EventBusCursor*>(data + Layout::CursorsOffset);
+        for (size_t i = 0; i < max_readers; i++) {
+            std::construct_at(cursors + i);
+            cursors[i].head.store(0, std::memory_order_relaxed);
+            cursors[i].state.store(EventBusCursor::Free, std::memory_order_relaxed);
+        }
+        header->magic.store(EventBusHeader::Magic, std::memory_order_release);
+
+        return EventBusWriter { std::move(*memory) };
+    }
+
+    EventBusWriter(const EventBusWriter&) = delete;
+    EventBusWriter& operator=(const EventBusWriter&) = delete;
+
+    // The mapping doesn't move with the object
+    EventBusWriter(EventBusWriter&&) noexcept = default;
+    EventBusWriter& operator=(EventBusWriter&&) noexcept = default;
+
+    [[nodiscard]] size_t capacity() const noexcept { return _layout.mask + 1; }
+
+    [[nodiscard]] const std::string& name() const noexcept { return _memory.name(); }
+
+    // The number of records published so far
+    [[nodiscard]] uint64_t published() const noexcept { return _layout.header->tail.load(std::memory_order_relaxed); }
+
+    [[nodiscard]] size_t readers_count() const noexcept {
+        return static_cast<size_t>(std::count_if(_layout.cursors, _layout.cursors + _layout.max_readers, [] (const EventBusCursor& cursor) {
+            return cursor.state.load(std::memory_order_acquire) == EventBusCursor::Active;
+        }));
+    }
+
+    // The position of the slowest active reader, or of the writer if there are none
+    [[nodiscard]] uint64_t slowest_position() const noexcept {
+        auto position = _layout.header->tail.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < _layout.max_readers; i++) {
+            auto& cursor = _layout.cursors[i];
+            if (cursor.state.load(std::memory_order_acquire) == EventBusCursor::Active) {
+                position = std::min(position, cursor.head.load(std::memory_order_acquire));
+            }
+        }
+        return position;
+    }
+
+    // The number of times a reader was evicted
+    [[nodiscard]] uint64_t evictions() const noexcept { return _evictions; }
+
+    // Same as SPSCQueue::try_emplace_deferred, with the slowest reader as the consumer
+    template <typename... Args>
+    [[nodiscard]] bool try_emplace_deferred(Args&&... args) noexcept {
+        const auto tail = _pending_tail;
+        if (tail - _cached_head > _layout.mask) {
+            _cached_head = slowest_head();
+            if (tail - _cached_head > _layout.mask) return false;
+        }
+        std::construct_at(_layout.slot(tail), std::forward<Args>(args)...);
+        _pending_tail = tail + 1;
+        return true;
+    }
+
+    template <typename... Args>
+    T& emplace_deferred(Args&&... args) noexcept {
+        utils::Backoff backoff;
+        while (!try_emplace_deferred(std::forward<Args>(args)...)) {
+            // The readers can't be done with what they haven't seen yet
+            commit();
+            backoff.pause();
+        }
+        return *_layout.slot(_pending_tail - 1);
+    }
+
+    void commit() noexcept {
+        _layout.header->tail.store(_pending_tail, std::memory_order_release);
+    }
+
+    template <typename... Args>
+    [[nodiscard]] bool try_emplace(Args&&... args) noexcept {
+        if (!try_emplace_deferred(std::forward<Args>(args)...)) return false;
+        commit();
+        return true;
+    }
+
+    template <typename... Args>
+    void emplace(Args&&... args) noexcept {
+        emplace_deferred(std::forward<Args>(args)...);
+        commit();
+    }
+
+    /*
+     * Snapshots. Whoever owns what the records describe (e.g. the engine's
+     *  thread) checks for requests between records (e.g. after each command),
+     *  which costs a single load, and when there is one, writes the whole
+     *  state as records between begin_snapshot() and end_snapshot(). One
+     *  snapshot serves every request made before it began. A snapshot is
+     *  the state after the records published before it began, so the pending
+     *  records are published first.
+     */
+    [[nodiscard]] bool is_snapshot_requested() const noexcept {
+        return _layout.header->requested.load(std::memory_order_relaxed) != _served;
+    }
+
+    void begin_snapshot() noexcept {
+        commit();
+        _snapshot_ticket = _layout.header->requested.load(std::memory_order_acquire);
+        _snapshot_size = 0;
+        _is_snapshot_truncated = false;
+        auto& version = _layout.header->snapshot_version;
+        version.store(version.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        // Keeps the stores of the records from moving above the odd version
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    // Returns false if the record doesn't fit, and the snapshot is truncated
+    bool add_to_snapshot(const T& record) noexcept {
+        if (_snapshot_size == _layout.header->snapshot_capacity) [[unlikely]] {
+            _is_snapshot_truncated = true;
+            return false;
+        }
+        std::array<uint64_t, Layout::WordsCount> words;
+        std::memcpy(words.data(), &record, sizeof(T));
+        auto* destination = _layout.snapshot_words(_snapshot_size++);
+        for (size_t i = 0; i < words.size(); i++) {
+            std::atomic_ref(destination[i]).store(words[i], std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    void end_snapshot() noexcept {
+        auto& header = *_layout.header;
+        header.snapshot_position.store(header.tail.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        header.snapshot_size.store(_snapshot_size, std::memory_order_relaxed);
+        header.snapshot_truncated.store(_is_snapshot_truncated, std::memory_order_relaxed);
+        header.served.store(_snapshot_ticket, std::memory_order_relaxed);
+        header.snapshot_version.store(header.snapshot_version.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        _served = _snapshot_ticket;
+    }
+
+private:
+
+    explicit EventBusWriter(SharedMemory memory) noexcept : _memory(std::move(memory)), _layout(_memory.data()) { }
+
+    // Evicts the readers that hold back the slot of the next record
+    [[nodiscard]] uint64_t slowest_head() noexcept {
+        // Pairs with the fence of a joining reader (see EventBusReader::join),
+        //  so that either the reader is seen here, or it sees the records
+        //  published so far and starts after them
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        // Not the pending tail, a reader may still join before the pending records are published
+        auto head = _layout.header->tail.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < _layout.max_readers; i++) {
+            auto& cursor = _layout.cursors[i];
+            if (cursor.state.load(std::memory_order_acquire) != EventBusCursor::Active) continue;
+            auto cursor_head = cursor.head.load(std::memory_order_acquire);
+            if (_pending_tail - cursor_head > _layout.mask) {
+                // Fails if the reader leaves in the meantime, which is just as good
+                auto state = EventBusCursor::Active;
+                if (cursor.state.compare_exchange_strong(state, EventBusCursor::Evicted, std::memory_order_acq_rel)) {
+                    ++_evictions;
+                }
+                continue;
+            }
+            head = std::min(head, cursor_head);
+        }
+        return head;
+    }
+
+    SharedMemory _memory;
+    Layout _layout;
+
+    uint64_t _pending_tail = 0;
+    uint64_t _cached_head = 0;
+    uint64_t _evictions = 0;
+
+    // The last ticket served
+    uint64_t _served = 0;
+    uint64_t _snapshot_ticket = 0;
+    uint64_t _snapshot_size = 0;
+    bool _is_snapshot_truncated = false;
+};
+
+/*
+ * The reader side of an event bus, meant to live in another process than
+ *  the writer. A reader takes one of the cursors of the bus while it's open,
+ *  and starts with the first record published after it opened the bus. The
+ *  records are copied out of the ring, and only handed out once the copies
+ *  are known to be whole.
+ *
+ * A reader that falls too far behind is evicted by the writer (see
+ *  is_evicted()), and the consume() that notices hands nothing out. To start
+ *  over, the reader joins again, asks for
+ *  a snapshot, and keeps reading while it waits, so that it isn't evicted
+ *  again. The snapshot is taken after the reader joined again, so the
+ *  records up to the position of the snapshot are the ones to skip:
+ *
+ *      reader.rejoin();
+ *      auto ticket = reader.request_snapshot();
+ *      std::optional<EventBusSnapshot> snapshot;
+ *      while (!(snapshot = reader.try_read_snapshot(ticket, records))) {
+ *          reader.consume(...);  // Kept aside, or dropped and read again from the ring
+ *      }
+ *      // Apply the records, then the records after snapshot->position
+ */
+template <typename T>
+class EventBusReader {
+
+    using Layout = EventBusLayout<T>;
+
+public:
+
+    using value_type = T;
+
+    // Empty if there is no such bus, it's not a bus of T, or all of its cursors are taken
+    [[nodiscard]] static std::optional<EventBusReader> open(std::string name) noexcept {
+        auto memory = SharedMemory::open(std::move(name));
+        if (!memory || memory->size() < sizeof(EventBusHeader)) return std::nullopt;
+
+        auto* header = std::launder(reinterpret_cast<EventBusHeader*>(memory->data()));
+        if (header->magic.load(std::memory_order_acquire) != EventBusHeader::Magic) return std::nullopt;
+        if (header->version != EventBusHeader::Version || header->record_size != sizeof(T)) return std::nullopt;
+        if (memory->size() < Layout::size(header->capacity, header->max_readers, header->snapshot_capacity)) return std::nullopt;
+
+        Layout layout { memory->data() };
+        for (size_t i = 0; i < layout.max_readers; i++) {
+            auto& cursor = layout.cursors[i];
+            auto state = EventBusCursor::Free;
+            if (!cursor.state.compare_exchange_strong(state, EventBusCursor::Joining, std::memory_order_acq_rel)) continue;
+            auto head = join(layout, cursor);
+            return EventBusReader { std::move(*memory), &cursor, head };
+        }
+        return std::nullopt;
+    }
+
+    EventBusReader(const EventBusReader&) = delete;
+    EventBusReader& operator=(const EventBusReader&) = delete;
+
+    EventBusReader(EventBusReader&& other) noexcept
+        : _memory(std::move(other._memory)),
+          _layout(other._layout),
+          _cursor(std::exchange(other._cursor, nullptr)),
+          _head(other._head),
+          _cached_tail(other._cached_tail),
+          _copies(std::move(other._copies)) { }
+
+    EventBusReader& operator=(EventBusReader&& other) noexcept {
+        if (this != &other) {
+            leave();
+            _memory = std::move(other._memory);
+            _layout = other._layout;
+            _cursor = std::exchange(other._cursor, nullptr);
+            _head = other._head;
+            _cached_tail = other._cached_tail;
+            _copies = std::move(other._copies);
+        }
+        return *this;
+    }
+
+    ~EventBusReader() noexcept { leave(); }
+
+    [[nodiscard]] size_t capacity() const noexcept { return _layout.mask + 1; }
+
+    // The number of records this reader is done with, counting from the first
+    //  record of the bus (not from the first record the reader got)
+    [[nodiscard]] uint64_t position() const noexcept { return _head; }
+
+    // The number of records published but not yet read
+    [[nodiscard]] size_t available() const noexcept {
+        return _layout.header->tail.load(std::memory_order_acquire) - _head;
+    }
+
+    // Once evicted, the reader reads nothing until it joins again
+    [[nodiscard]] bool is_evicted() const noexcept {
+        return _cursor->state.load(std::memory_order_acquire) == EventBusCursor::Evicted;
+    }
+
+    // Takes the cursor back, starting with the first record published from now on
+    void rejoin() noexcept {
+        assert(is_evicted() && "Only an evicted reader can join again");
+        _cursor->state.store(EventBusCursor::Joining, std::memory_order_relaxed);
+        _head = join(_layout, *_cursor);
+        _cached_tail = _head;
+    }
+
+    // Returns the ticket to wait for with try_read_snapshot()
+    [[nodiscard]] uint64_t request_snapshot() noexcept {
+        return _layout.header->requested.fetch_add(1, std::memory_order_acq_rel) + 1;
+    }
+
+    /*
+     * Copies the snapshot into `records` if one was taken since the request
+     *  with the given ticket was made. Empty if not yet, or if the writer
+     *  started another one during the copy, in which case it's tried again
+     *  later.
+     */
+    [[nodiscard]] std::optional<EventBusSnapshot> try_read_snapshot(const uint64_t ticket, std::vector<T>& records) const {
+        auto& header = *_layout.header;
+        const auto version = header.snapshot_version.load(std::memory_order_acquire);
+        if ((version & 1) || header.served.load(std::memory_order_relaxed) < ticket) return std::nullopt;
+
+        EventBusSnapshot snapshot {
+            .position = header.snapshot_position.load(std::memory_order_relaxed),
+            .is_truncated = header.snapshot_truncated.load(std::memory_order_relaxed) != 0
+        };
+        const auto size = std::min(header.snapshot_size.load(std::memory_order_relaxed), header.snapshot_capacity);
+        records.clear();
+        records.reserve(size);
+        for (uint64_t i = 0; i < size; i++) {
+            records.push_back(Layout::load(_layout.snapshot_words(i)));
+        }
+
+        // Keeps the loads of the records from moving below the second read
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (header.snapshot_version.load(std::memory_order_relaxed) != version) return std::nullopt;
+        return snapshot;
+    }
+
+    /*
+     * Copies up to `max_batch` records out of the ring, hands them to `func`,
+     *  then lets the writer reuse all of their slots with a single store.
+     *  Returns the number of records handed out, or nothing if the reader is
+     *  evicted, in which case the batch may have been overwritten while it
+     *  was copied, and none of it is handed out.
+     */
+    template <typename Func>
+    std::optional<size_t> consume(Func&& func, const size_t max_batch = std::numeric_limits<size_t>::max()) {
+        if (is_evicted()) return std::nullopt;
+        _cached_tail = _layout.header->tail.load(std::memory_order_acquire);
+        const auto count = std::min<uint64_t>(_cached_tail - _head, max_batch);
+
+        _copies.clear();
+        for (uint64_t i = 0; i < count; i++) {
+            _copies.push_back(Layout::load(_layout.slot_words(_head + i)));
+        }
+
+        // The writer evicts a reader before reusing its slots, so if the
+        //  reader isn't evicted by now, the batch wasn't overwritten
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (is_evicted()) return std::nullopt;
+
+        for (auto& record : _copies) {
+            func(static_cast<const T&>(record));
+        }
+
+        if (count != 0) {
+            _head += count;
+            _cursor->head.store(_head, std::memory_order_release);
+        }
+
+        return count;
+    }
+
+private:
+
+    EventBusReader(SharedMemory memory, EventBusCursor* cursor, const uint64_t head) noexcept
+        : _memory(std::move(memory)), _layout(_memory.data()), _cursor(cursor), _head(head), _cached_tail(head) { }
+
+    // Returns the first record the reader gets
+    static uint64_t join(const Layout& layout, EventBusCursor& cursor) noexcept {
+        // The writer doesn't look at the cursor until it's active, and once it
+        //  does, the head can only move forward, so the first guess has to be
+        //  behind the records the writer may have published in the meantime.
+        cursor.head.store(layout.header->tail.load(std::memory_order_acquire), std::memory_order_relaxed);
+        cursor.state.store(EventBusCursor::Active, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto head = layout.header->tail.load(std::memory_order_relaxed);
+        cursor.head.store(head, std::memory_order_release);
+        return head;
+    }
+
+    void leave() noexcept {
+        if (_cursor != nullptr) {
+            _cursor->state.store(EventBusCursor::Free, std::memory_order_release);
+            _cursor = nullptr;
+        }
+    }
+
+    SharedMemory _memory;
+    Layout _layout;
+    EventBusCursor* _cursor;
+
+    // Owned by this reader, _cursor->head is its published copy
+    uint64_t _head;
+    uint64_t _cached_tail;
+
+    // The batch being consumed, copied out of the ring
+    std::vector<T> _copies;
+};
+
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace chronex::ipc {
+
+/*
+ * A named POSIX shared memory object (a file in /dev/shm on Linux), mapped
+ *  into the address space of the process. The process that creates it owns
+ *  the name, and unlinks it when the mapping is destroyed. The processes
+ *  that open it only unmap it, and keep their mapping even after the name
+ *  is unlinked.
+ *
+ * The factories return nothing on failure, and errno tells why.
+ */
+class SharedMemory {
+public:
+
+    // Replaces any object with the same name. The memory is zeroed.
+    [[nodiscard]] static std::optional<SharedMemory> create(std::string name, const size_t size) noexcept {
+        ::shm_unlink(name.c_str());
+        auto fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd == -1) return std::nullopt;
+        if (::ftruncate(fd, static_cast<off_t>(size)) == -1) {
+            ::close(fd);
+            ::shm_unlink(name.c_str());
+            return std::nullopt;
+        }
+        return map(std::move(name), fd, size, true);
+    }
+
+    [[nodiscard]] static std::optional<SharedMemory> open(std::string name) noexcept {
+        auto fd = ::shm_open(name.c_str(), O_RDWR, 0);
+        if (fd == -1) return std::nullopt;
+        struct stat status { };
+        if (::fstat(fd, &status) == -1) {
+            ::close(fd);
+            return std::nullopt;
+        }
+        return map(std::move(name), fd, static_cast<size_t>(status.st_size), false);
+    }
+
+    SharedMemory(const SharedMemory&) = delete;
+    SharedMemory& operator=(const SharedMemory&) = delete;
+
+    SharedMemory(SharedMemory&& other) noexcept
+        : _name(std::move(other._name)),
+          _data(std::exchange(other._data, nullptr)),
+          _size(std::exchange(other._size, 0)),
+          _is_owner(std::exchange(other._is_owner, false)) { }
+
+    SharedMemory& operator=(SharedMemory&& other) noexcept {
+        if (this != &other) {
+            release();
+            _name = std::move(other._name);
+            _data = std::exchange(other._data, nullptr);
+            _size = std::exchange(other._size, 0);
+            _is_owner = std::exchange(other._is_owner, false);
+        }
+        return *this;
+    }
+
+    ~SharedMemory() noexcept { release(); }
+
+    [[nodiscard]] std::byte* data() const noexcept { return _data; }
+    [[nodiscard]] size_t size() const noexcept { return _size; }
+    [[nodiscard]] const std::string& name() const noexcept { return _name; }
+    [[nodiscard]] bool is_owner() const noexcept { return _is_owner; }
+
+private:
+
+    SharedMemory(std::string name, std::byte* data, const size_t size, const bool is_owner) noexcept
+        : _name(std::move(name)), _data(data), _size(size), _is_owner(is_owner) { }
+
+    [[nodiscard]] static std::optional<SharedMemory> map(std::string name, const int fd, const size_t size, const bool is_owner) noexcept {
+        auto* data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        // The mapping stays valid after the descriptor is closed
+        ::close(fd);
+        if (data == MAP_FAILED) {
+            if (is_owner) ::shm_unlink(name.c_str());
+            return std::nullopt;
+        }
+        return SharedMemory { std::move(name), static_cast<std::byte*>(data), size, is_owner };
+    }
+
+    void release() noexcept {
+        if (_data != nullptr) {
+            ::munmap(_data, _size);
+            _data = nullptr;
+        }
+        if (_is_owner) {
+            ::shm_unlink(_name.c_str());
+            _is_owner = false;
+        }
+    }
+
+    std::string _name;
+    std::byte* _data = nullptr;
+    size_t _size = 0;
+    bool _is_owner = false;
+};
+
+}
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <string>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace chronex::ipc {
+
+// Closes the descriptor when destroyed
+class FileDescriptor {
+public:
+
+    constexpr FileDescriptor() noexcept = default;
+
+    constexpr explicit FileDescriptor(const int fd) noexcept : _fd(fd) { }
+
+    FileDescriptor(const FileDescriptor&) = delete;
+    FileDescriptor& operator=(const FileDescriptor&) = delete;
+
+    FileDescriptor(FileDescriptor&& other) noexcept : _fd(std::exchange(other._fd, -1)) { }
+
+    FileDescriptor& operator=(FileDescriptor&& other) noexcept {
+        if (this != &other) {
+            close();
+            _fd = std::exchange(other._fd, -1);
+        }
+        return *this;
+    }
+
+    ~FileDescriptor() noexcept { close(); }
+
+    [[nodiscard]] int get() const noexcept { return _fd; }
+
+    [[nodiscard]] bool is_valid() const noexcept { return _fd != -1; }
+
+    void close() noexcept {
+        if (_fd != -1) {
+            ::close(_fd);
+            _fd = -1;
+        }
+    }
+
+private:
+
+    int _fd = -1;
+};
+
+/*
+ * A connected, stream-oriented Unix domain socket. The sends never raise
+ *  SIGPIPE, a closed peer is an EPIPE instead.
+ *
+ * Like ::send() and ::recv(), the methods return the number of bytes
+ *  transferred, or -1 and errno tells why (EAGAIN and EWOULDBLOCK for
+ *  a non-blocking socket that would block). recv() returns 0 once the
+ *  peer is gone.
+ */
+class UnixSocket {
+public:
+
+    // A blocking socket, as clients usually want it
+    [[nodiscard]] static std::optional<UnixSocket> connect(const std::string& path) noexcept {
+        sockaddr_un address { };
+        if (!make_address(path, address)) return std::nullopt;
+        FileDescriptor fd { ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0) };
+        if (!fd.is_valid()) return std::nullopt;
+        if (::connect(fd.get(), reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == -1) return std::nullopt;
+        return UnixSocket { std::move(fd) };
+    }
+
+    explicit UnixSocket(FileDescriptor fd) noexcept : _fd(std::move(fd)) { }
+
+    [[nodiscard]] int fd() const noexcept { return _fd.get(); }
+
+    bool set_non_blocking() const noexcept {
+        auto flags = ::fcntl(fd(), F_GETFL);
+        return flags != -1 && ::fcntl(fd(), F_SETFL, flags | O_NONBLOCK) != -1;
+    }
+
+    [[nodiscard]] ssize_t send(const std::span<const std::byte> data) const noexcept {
+        return ::send(fd(), data.data(), data.size(), MSG_NOSIGNAL);
+    }
+
+    // Sends all of the buffers with a single syscall
+    [[nodiscard]] ssize_t send(const std::span<const iovec> buffers) const noexcept {
+        msghdr message { };
+        message.msg_iov = const_cast<iovec*>(buffers.data());
+        message.msg_iovlen = buffers.size();
+        return ::sendmsg(fd(), &message, MSG_NOSIGNAL);
+    }
+
+    [[nodiscard]] ssize_t recv(const std::span<std::byte> buffer) const noexcept {
+        return ::recv(fd(), buffer.data(), buffer.size(), 0);
+    }
+
+    // Blocks until all of the data is sent. Meant for blocking sockets.
+    [[nodiscard]] bool send_all(std::span<const std::byte> data) const noexcept {
+        while (!data.empty()) {
+            auto sent = send(data);
+            if (sent == -1) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            data = data.subspan(static_cast<size_t>(sent));
+        }
+        return true;
+    }
+
+    // Blocks until the buffer is full. Meant for blocking sockets.
+    [[nodiscard]] bool recv_all(std::span<std::byte> buffer) const noexcept {
+        while (!buffer.empty()) {
+            auto received = recv(buffer);
+            if (received == -1 && errno == EINTR) continue;
+            if (received <= 0) return false;
+            buffer = buffer.subspan(static_cast<size_t>(received));
+        }
+        return true;
+    }
+
+    // The sun_path of sockaddr_un is short (108 bytes on Linux)
+    [[nodiscard]] static bool make_address(const std::string& path, sockaddr_un& address) noexcept {
+        if (path.size() >= sizeof(address.sun_path)) {
+            errno = ENAMETOOLONG;
+            return false;
+        }
+        address.sun_family = AF_UNIX;
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+        return true;
+    }
+
+private:
+
+    FileDescriptor _fd;
+};
+
+/*
+ * A non-blocking listening Unix domain socket. Like SharedMemory, it owns
+ *  its path: an existing socket file with the same path is replaced, and
+ *  the file is removed when the listener is destroyed.
+ */
+class UnixListener {
+public:
+
+    [[nodiscard]] static std::optional<UnixListener> create(std::string path, const int backlog = SOMAXCONN) noexcept {
+        sockaddr_un address { };
+        if (!UnixSocket::make_address(path, address)) return std::nullopt;
+        FileDescriptor fd { ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0) };
+        if (!fd.is_valid()) return std::nullopt;
+        ::unlink(path.c_str());
+        if (::bind(fd.get(), reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == -1) return std::nullopt;
+        if (::listen(fd.get(), backlog) == -1) {
+            ::unlink(path.c_str());
+            return std::nullopt;
+        }
+        return UnixListener { std::move(path), std::move(fd) };
+    }
+
+    UnixListener(const UnixListener&) = delete;
+    UnixListener& operator=(const UnixListener&) = delete;
+
+    UnixListener(UnixListener&& other) noexcept : _path(std::move(other._path)), _fd(std::move(other._fd)) { }
+
+    UnixListener& operator=(UnixListener&& other) noexcept {
+        if (this != &other) {
+            release();
+            _path = std::move(other._path);
+            _fd = std::move(other._fd);
+        }
+        return *this;
+    }
+
+    ~UnixListener() noexcept { release(); }
+
+    [[nodiscard]] int fd() const noexcept { return _fd.get(); }
+
+    [[nodiscard]] const std::string& path() const noexcept { return _path; }
+
+    // A non-blocking socket of the next pending connection, if any
+    [[nodiscard]] std::optional<UnixSocket> accept() const noexcept {
+        auto fd = ::accept4(_fd.get(), nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd == -1) return std::nullopt;
+        return UnixSocket { FileDescriptor { fd } };
+    }
+
+private:
+
+    UnixListener(std::string path, FileDescriptor fd) noexcept : _path(std::move(path)), _fd(std::move(fd)) { }
+
+    void release() noexcept {
+        if (_fd.is_valid()) {
+            _fd.close();
+            ::unlink(_path.c_str());
+        }
+    }
+
+    std::string _path;
+    FileDescriptor _fd;
+};
+
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include <chronex/Symbol.hpp>
+
+#include <chronex/concepts/Order.hpp>
+
+#include <chronex/itch/ItchParser.hpp>
+
+#include <chronex/orderbook/Order.hpp>
+#include <chronex/orderbook/OrderUtils.hpp>
+
+namespace chronex::itch {
+
+/*
+ * Builds market-by-order books from an ITCH 5.0 feed, in the books of
+ *  a matching engine. The feed is the exchange's account of what happened
+ *  to each order, so matching is disabled, and the messages are mapped
+ *  onto the engine's commands as they are:
+ *
+ *  - stock directory:             add_new_orderbook, with the stock locate as the symbol ID
+ *  - add order:                   add_order, as a GTC limit order
+ *  - order executed (with price): execute_order
+ *  - order cancel:                reduce_order, to what's left of the order
+ *  - order delete:                remove_order
+ *  - order replace:               replace_order
+ *
+ * The order reference numbers of ITCH are unique for the day across all of
+ *  the stocks, so they are the IDs of the orders. Prices are kept in the
+ *  units of the feed (10^-4).
+ *
+ * Feeds recorded in the middle of the day have messages about orders added
+ *  before the recording started, and stocks without a directory message.
+ *  The former are skipped, and counted (see unknown_orders_count), and the
+ *  books of the latter are added with the first order of the stock.
+ */
+template <typename Engine, concepts::Order Order = Order>
+class BookBuilder {
+public:
+
+    explicit BookBuilder(Engine& engine) noexcept : _engine(&engine) {
+        _engine->disable_matching();
+    }
+
+    // Feeds the messages at the front of the buffer, e.g. a memory-mapped
+    //  file, or what's been read from the feed so far (see parse_messages)
+    ParseResult replay(const std::span<const std::byte> buffer) {
+        auto result = parse_messages(buffer, *this);
+        _messages_count += result.messages_count;
+        return result;
+    }
+
+    void on_stock_directory(const StockDirectory& message) {
+        add_orderbook(message.header.stock_locate, message.stock);
+    }
+
+    void on_add_order(const AddOrder& message) {
+        if (_engine->has_order(OrderId { message.order_reference })) return skip();
+        add_orderbook(message.header.stock_locate, message.stock);
+        _engine->add_order(Order::limit(message.order_reference, message.header.stock_locate, message.side,
+                                        message.price, message.shares));
+    }
+
+    void on_order_executed(const OrderExecuted& message) {
+        if (!_engine->has_order(OrderId { message.order_reference })) return skip();
+        _engine->execute_order(OrderId { message.order_reference }, Quantity { message.executed_shares });
+    }
+
+    void on_order_executed(const OrderExecutedWithPrice& message) {
+        if (!_engine->has_order(OrderId { message.order_reference })) return skip();
+        _engine->execute_order(OrderId { message.order_reference }, Quantity { message.executed_shares }, Price { message.price });
+    }
+
+    void on_order_cancel(const OrderCancel& message) {
+        auto id = OrderId { message.order_reference };
+        if (!_engine->has_order(id)) return skip();
+        // The engine takes the quantity that's left, rather than the one that's cancelled. Reducing
+        //  an order to nothing would leave it behind, so an order cancelled in full is removed.
+        auto leaves_quantity = _engine->order_at(id)->leaves_quantity();
+        if (Quantity { message.cancelled_shares } >= leaves_quantity) {
+            return _engine->remove_order(id);
+        }
+        _engine->reduce_order(id, leaves_quantity - Quantity { message.cancelled_shares });
+    }
+
+    void on_order_delete(const OrderDelete& message) {
+        if (!_engine->has_order(OrderId { message.order_reference })) return skip();
+        _engine->remove_order(OrderId { message.order_reference });
+    }
+
+    void on_order_replace(const OrderReplace& message) {
+        if (int(!_engine->has_order(OrderId { message.original_order_reference })) |
+            int(_engine->has_order(OrderId { message.new_order_reference }))) {
+            return skip();
+        }
+        _engine->replace_order(OrderId { message.original_order_reference }, OrderId { message.new_order_reference },
+                               Price { message.price }, Quantity { message.shares });
+    }
+
+    [[nodiscard]] Engine& engine() noexcept { return *_engine; }
+
+    // Of all types, including the ones that don't touch the books
+    [[nodiscard]] size_t messages_count() const noexcept { return _messages_count; }
+    [[nodiscard]] size_t orderbooks_count() const noexcept { return _orderbooks_count; }
+    // Messages about orders that the engine doesn't have, or already has (for new orders)
+    [[nodiscard]] size_t unknown_orders_count() const noexcept { return _unknown_orders_count; }
+
+private:
+
+    void skip() noexcept { ++_unknown_orders_count; }
+
+    void add_orderbook(const uint16_t stock_locate, const std::array<char, 8>& stock) {
+        if (_engine->has_orderbook(SymbolId { stock_locate })) return;
+        // Without the padding, and cut to fit a Symbol, with the null terminator
+        char name[sizeof(Symbol::name)] { };
+        auto size = std::min(sizeof(name) - 1, size_t(std::find(stock.begin(), stock.end(), ' ') - stock.begin()));
+        std::copy_n(stock.begin(), size, name);
+        _engine->add_new_orderbook(Symbol { SymbolId { stock_locate }, name });
+        ++_orderbooks_count;
+    }
+
+    Engine* _engine;
+    size_t _messages_count = 0;
+    size_t _orderbooks_count = 0;
+    size_t _unknown_orders_count = 0;
+};
+
+}
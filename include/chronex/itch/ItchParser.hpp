@@ -0,0 +1,289 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+#include <chronex/orderbook/OrderUtils.hpp>
+
+namespace chronex::itch {
+
+/*
+ * The messages of NASDAQ TotalView-ITCH 5.0 that build market-by-order
+ *  books, in the byte order of the host. On the wire (and in the files NASDAQ
+ *  publishes), each message is prefixed by its length in two bytes, and is
+ *  made of fixed-size big-endian fields at fixed offsets, with prices in
+ *  units of 10^-4.
+ */
+
+struct MessageHeader {
+    // The ID of the stock for the day, which the stock directory names
+    uint16_t stock_locate;
+    uint16_t tracking_number;
+    // Nanoseconds since midnight
+    uint64_t timestamp;
+};
+
+// R
+struct StockDirectory {
+    MessageHeader header;
+    // Padded with spaces
+    std::array<char, 8> stock;
+    char market_category;
+    uint32_t round_lot_size;
+};
+
+// A, and F with the attribution (blank for A)
+struct AddOrder {
+    MessageHeader header;
+    uint64_t order_reference;
+    OrderSide side;
+    uint32_t shares;
+    std::array<char, 8> stock;
+    uint32_t price;
+    std::array<char, 4> attribution;
+};
+
+// E, at the price of the order
+struct OrderExecuted {
+    MessageHeader header;
+    uint64_t order_reference;
+    uint32_t executed_shares;
+    uint64_t match_number;
+};
+
+// C
+struct OrderExecutedWithPrice {
+    MessageHeader header;
+    uint64_t order_reference;
+    uint32_t executed_shares;
+    uint64_t match_number;
+    bool is_printable;
+    uint32_t price;
+};
+
+// X, a partial cancel
+struct OrderCancel {
+    MessageHeader header;
+    uint64_t order_reference;
+    uint32_t cancelled_shares;
+};
+
+// D
+struct OrderDelete {
+    MessageHeader header;
+    uint64_t order_reference;
+};
+
+// U, the original order is gone, and the new one takes its side and stock
+struct OrderReplace {
+    MessageHeader header;
+    uint64_t original_order_reference;
+    uint64_t new_order_reference;
+    uint32_t shares;
+    uint32_t price;
+};
+
+struct ParseResult {
+    // The bytes of the whole messages that were parsed. The rest is the
+    //  beginning of a message that's cut short, or a malformed message.
+    size_t size;
+    // Of all types, including the ones that aren't decoded
+    size_t messages_count;
+    // Stopped at a message whose length doesn't match its type
+    bool is_malformed;
+};
+
+namespace detail {
+
+template <typename T>
+[[nodiscard]] inline T read(const std::byte* data) noexcept {
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    if constexpr (std::endian::native == std::endian::little) {
+        return std::byteswap(value);
+    } else {
+        return value;
+    }
+}
+
+template <size_t size>
+[[nodiscard]] inline std::array<char, size> read_text(const std::byte* data) noexcept {
+    std::array<char, size> text;
+    std::memcpy(text.data(), data, size);
+    return text;
+}
+
+// Six bytes
+[[nodiscard]] inline uint64_t read_timestamp(const std::byte* data) noexcept {
+    return (uint64_t { read<uint16_t>(data) } << 32) | read<uint32_t>(data + 2);
+}
+
+[[nodiscard]] inline MessageHeader read_header(const std::byte* message) noexcept {
+    return MessageHeader {
+        .stock_locate = read<uint16_t>(message + 1),
+        .tracking_number = read<uint16_t>(message + 3),
+        .timestamp = read_timestamp(message + 5)
+    };
+}
+
+// Each message goes to its method, if the handler has one
+#define CHRONEX_ITCH_DELIVER(MESSAGE, METHOD)                                                          \
+    template <typename Handler>                                                                        \
+    inline auto deliver(Handler& handler, const MESSAGE& message) -> decltype(handler.METHOD(message)) { \
+        return handler.METHOD(message);                                                                \
+    }
+
+CHRONEX_ITCH_DELIVER(StockDirectory, on_stock_directory)
+CHRONEX_ITCH_DELIVER(AddOrder, on_add_order)
+CHRONEX_ITCH_DELIVER(OrderExecuted, on_order_executed)
+CHRONEX_ITCH_DELIVER(OrderExecutedWithPrice, on_order_executed)
+CHRONEX_ITCH_DELIVER(OrderCancel, on_order_cancel)
+CHRONEX_ITCH_DELIVER(OrderDelete, on_order_delete)
+CHRONEX_ITCH_DELIVER(OrderReplace, on_order_replace)
+
+#undef CHRONEX_ITCH_DELIVER
+
+template <typename Handler, typename Message>
+concept Handles = requires (Handler& handler, const Message& message) { deliver(handler, message); };
+
+}
+
+/*
+ * Decodes the messages at the front of `buffer`, and hands each of them to
+ *  the matching method of `handler`:
+ *
+ *      on_stock_directory(const StockDirectory&)
+ *      on_add_order(const AddOrder&)
+ *      on_order_executed(const OrderExecuted&)
+ *      on_order_executed(const OrderExecutedWithPrice&)
+ *      on_order_cancel(const OrderCancel&)
+ *      on_order_delete(const OrderDelete&)
+ *      on_order_replace(const OrderReplace&)
+ *
+ * A handler only has the methods it needs, and only the fields of the
+ *  messages it has methods for are decoded. The rest of the message types
+ *  (system events, trades, imbalances, ...) are skipped by their length.
+ *
+ * The buffer is read in place, so a memory-mapped file is parsed without
+ *  copying it. A buffer that ends in the middle of a message stops before
+ *  it, and the message is parsed once the rest of it comes.
+ */
+template <typename Handler>
+[[nodiscard]] ParseResult parse_messages(const std::span<const std::byte> buffer, Handler& handler) {
+    constexpr size_t LengthSize = 2;
+
+    ParseResult result { 0, 0, false };
+    auto data = buffer.data();
+    auto size = buffer.size();
+
+    while (size - result.size >= LengthSize) {
+        auto position = data + result.size;
+        auto length = size_t { detail::read<uint16_t>(position) };
+        if (size - result.size - LengthSize < length) break;
+        auto message = position + LengthSize;
+
+        // The known types have a fixed length
+        auto expect_length = [&] (const size_t expected) {
+            if (length == expected) return true;
+            result.is_malformed = true;
+            return false;
+        };
+
+        switch (length == 0 ? '\0' : static_cast<char>(message[0])) {
+            case 'R':
+                if (!expect_length(39)) return result;
+                if constexpr (detail::Handles<Handler, StockDirectory>) {
+                    detail::deliver(handler, StockDirectory {
+                        .header = detail::read_header(message),
+                        .stock = detail::read_text<8>(message + 11),
+                        .market_category = static_cast<char>(message[19]),
+                        .round_lot_size = detail::read<uint32_t>(message + 21)
+                    });
+                }
+                break;
+            case 'A':
+            case 'F':
+                if (!expect_length(static_cast<char>(message[0]) == 'A' ? 36 : 40)) return result;
+                if constexpr (detail::Handles<Handler, AddOrder>) {
+                    detail::deliver(handler, AddOrder {
+                        .header = detail::read_header(message),
+                        .order_reference = detail::read<uint64_t>(message + 11),
+                        .side = static_cast<char>(message[19]) == 'B' ? OrderSide::BUY : OrderSide::SELL,
+                        .shares = detail::read<uint32_t>(message + 20),
+                        .stock = detail::read_text<8>(message + 24),
+                        .price = detail::read<uint32_t>(message + 32),
+                        .attribution = length == 40 ? detail::read_text<4>(message + 36) : std::array<char, 4> { ' ', ' ', ' ', ' ' }
+                    });
+                }
+                break;
+            case 'E':
+                if (!expect_length(31)) return result;
+                if constexpr (detail::Handles<Handler, OrderExecuted>) {
+                    detail::deliver(handler, OrderExecuted {
+                        .header = detail::read_header(message),
+                        .order_reference = detail::read<uint64_t>(message + 11),
+                        .executed_shares = detail::read<uint32_t>(message + 19),
+                        .match_number = detail::read<uint64_t>(message + 23)
+                    });
+                }
+                break;
+            case 'C':
+                if (!expect_length(36)) return result;
+                if constexpr (detail::Handles<Handler, OrderExecutedWithPrice>) {
+                    detail::deliver(handler, OrderExecutedWithPrice {
+                        .header = detail::read_header(message),
+                        .order_reference = detail::read<uint64_t>(message + 11),
+                        .executed_shares = detail::read<uint32_t>(message + 19),
+                        .match_number = detail::read<uint64_t>(message + 23),
+                        .is_printable = static_cast<char>(message[31]) == 'Y',
+                        .price = detail::read<uint32_t>(message + 32)
+                    });
+                }
+                break;
+            case 'X':
+                if (!expect_length(23)) return result;
+                if constexpr (detail::Handles<Handler, OrderCancel>) {
+                    detail::deliver(handler, OrderCancel {
+                        .header = detail::read_header(message),
+                        .order_reference = detail::read<uint64_t>(message + 11),
+                        .cancelled_shares = detail::read<uint32_t>(message + 19)
+                    });
+                }
+                break;
+            case 'D':
+                if (!expect_length(19)) return result;
+                if constexpr (detail::Handles<Handler, OrderDelete>) {
+                    detail::deliver(handler, OrderDelete {
+                        .header = detail::read_header(message),
+                        .order_reference = detail::read<uint64_t>(message + 11)
+                    });
+                }
+                break;
+            case 'U':
+                if (!expect_length(35)) return result;
+                if constexpr (detail::Handles<Handler, OrderReplace>) {
+                    detail::deliver(handler, OrderReplace {
+                        .header = detail::read_header(message),
+                        .original_order_reference = detail::read<uint64_t>(message + 11),
+                        .new_order_reference = detail::read<uint64_t>(message + 19),
+                        .shares = detail::read<uint32_t>(message + 27),
+                        .price = detail::read<uint32_t>(message + 31)
+                    });
+                }
+                break;
+            default:
+                break;
+        }
+
+        result.size += LengthSize + length;
+        ++result.messages_count;
+    }
+
+    return result;
+}
+
+}
@@ -0,0 +1,301 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <chronex/Symbol.hpp>
+
+#include <chronex/concepts/Order.hpp>
+
+#include <chronex/handlers/EventRecord.hpp>
+
+#include <chronex/matching/Commands.hpp>
+
+#include <chronex/orderbook/Order.hpp>
+#include <chronex/orderbook/OrderPool.hpp>
+#include <chronex/orderbook/OrderUtils.hpp>
+
+#include <chronex/utils/BufferedWriter.hpp>
+#include <chronex/utils/MappedFile.hpp>
+
+namespace chronex::commands {
+
+/*
+ * A file of engine commands, e.g. captured from production to be replayed
+ *  against new builds (see chronex-replay). The file is a header followed by
+ *  fixed-size records, back to back, in the byte order of the host:
+ *
+ *      CommandFileHeader
+ *      CommandRecord
+ *      CommandRecord
+ *      ...
+ *
+ * The records are fixed-size so that the file can be read in place once
+ *  it's mapped, and so that the N-th command is at a known offset.
+ */
+
+enum class CommandType : uint8_t {
+    ADD_NEW_ORDERBOOK,
+    REMOVE_ORDERBOOK,
+    // Of any order type, and adopted orders as well
+    ADD_ORDER,
+    REMOVE_ORDER,
+    REDUCE_ORDER,
+    MODIFY_ORDER,
+    MITIGATE_ORDER,
+    REPLACE_ORDER,
+    EXECUTE_ORDER,
+    MATCH,
+};
+
+constexpr size_t CommandTypesCount = static_cast<size_t>(CommandType::MATCH) + 1;
+
+/*
+ * Which fields are set depends on the type, and the rest are zero:
+ *
+ *  - add new orderbook, remove orderbook: symbol_id, symbol_name
+ *  - add order:                           symbol_id, order
+ *  - remove order:                        order_id
+ *  - reduce order:                        order_id, quantity (the new leaves quantity)
+ *  - modify order, mitigate order:        order_id, price, quantity
+ *  - replace order:                       order_id (of the replaced order), symbol_id, order
+ *  - execute order:                       order_id, quantity, price (Price::invalid() for the order's own)
+ *  - match:                               nothing
+ *
+ * The timestamp is when the command was captured (in nanoseconds, from
+ *  any epoch), or 0 if that's unknown.
+ */
+struct CommandRecord {
+    CommandType type;
+    uint8_t padding[3];
+    uint32_t symbol_id;
+    char symbol_name[8];
+    uint64_t order_id;
+    uint64_t price;
+    uint64_t quantity;
+    uint64_t timestamp;
+    handlers::OrderRecord order;
+};
+
+static_assert(std::is_trivially_copyable_v<CommandRecord>);
+static_assert(sizeof(CommandRecord) == 2 * 64, "A CommandRecord should fill two cache lines");
+
+struct CommandFileHeader {
+    char magic[8];
+    uint32_t version;
+    // So that readers of another version can tell the format apart
+    uint32_t record_size;
+};
+
+constexpr CommandFileHeader CurrentCommandFileHeader { { 'C', 'H', 'R', 'O', 'N', 'E', 'X', 'C' }, 1, sizeof(CommandRecord) };
+
+static_assert(sizeof(CommandFileHeader) == 16);
+
+template <concepts::Order Order = Order>
+[[nodiscard]] CommandRecord make_command_record(const Command<Order>& command, const uint64_t timestamp = 0) noexcept {
+    CommandRecord record { };
+    record.timestamp = timestamp;
+
+    auto set_symbol = [&record] (const Symbol& symbol) {
+        record.symbol_id = symbol.id.value;
+        std::memcpy(record.symbol_name, symbol.name, sizeof(record.symbol_name));
+    };
+    auto set_order = [&record] (const Order& order) {
+        record.symbol_id = order.symbol_id().value;
+        record.order = handlers::make_order_record(order);
+    };
+
+    std::visit([&] <typename T> (const T& cmd) {
+        if constexpr (std::is_same_v<T, AddNewOrderBook>) {
+            record.type = CommandType::ADD_NEW_ORDERBOOK;
+            set_symbol(cmd.symbol);
+        } else if constexpr (std::is_same_v<T, RemoveOrderBook>) {
+            record.type = CommandType::REMOVE_ORDERBOOK;
+            set_symbol(cmd.symbol);
+        } else if constexpr (std::is_same_v<T, AddOrder<Order>>) {
+            record.type = CommandType::ADD_ORDER;
+            set_order(cmd.order);
+        } else if constexpr (std::is_same_v<T, AdoptOrder>) {
+            // The order is only in the pool of this process, so it's recorded as an add
+            record.type = CommandType::ADD_ORDER;
+            set_order(*OrderPool<Order>::installed_iterator(cmd.handle));
+        } else if constexpr (std::is_same_v<T, RemoveOrder>) {
+            record.type = CommandType::REMOVE_ORDER;
+            record.order_id = cmd.id.value;
+        } else if constexpr (std::is_same_v<T, ReduceOrder>) {
+            record.type = CommandType::REDUCE_ORDER;
+            record.order_id = cmd.id.value;
+            record.quantity = cmd.quantity.value;
+        } else if constexpr (std::is_same_v<T, ModifyOrder> || std::is_same_v<T, MitigateOrder>) {
+            record.type = std::is_same_v<T, ModifyOrder> ? CommandType::MODIFY_ORDER : CommandType::MITIGATE_ORDER;
+            record.order_id = cmd.id.value;
+            record.price = cmd.price.value;
+            record.quantity = cmd.quantity.value;
+        } else if constexpr (std::is_same_v<T, ReplaceOrder<Order>>) {
+            record.type = CommandType::REPLACE_ORDER;
+            record.order_id = cmd.id.value;
+            set_order(cmd.order);
+        } else if constexpr (std::is_same_v<T, ExecuteOrder>) {
+            record.type = CommandType::EXECUTE_ORDER;
+            record.order_id = cmd.id.value;
+            record.price = cmd.price.value;
+            record.quantity = cmd.quantity.value;
+        } else {
+            record.type = CommandType::MATCH;
+        }
+    }, command);
+
+    return record;
+}
+
+// Empty if the record is of an unknown type, or carries an order the engine
+//  would only assert on (see handlers::is_valid_order), since files can come
+//  from anywhere
+template <concepts::Order Order = Order>
+[[nodiscard]] std::optional<Command<Order>> make_command(const CommandRecord& record) noexcept {
+    if (int(record.type == CommandType::ADD_ORDER) | int(record.type == CommandType::REPLACE_ORDER)) {
+        if (int(record.order.id == OrderId::invalid().value) | int(!handlers::is_valid_order(record.order))) {
+            return std::nullopt;
+        }
+    }
+
+    auto symbol = [&record] {
+        // Cut to fit a Symbol, with the null terminator, in case the file was written by other means
+        char name[sizeof(Symbol::name)] { };
+        std::memcpy(name, record.symbol_name, sizeof(name) - 1);
+        return Symbol { SymbolId { record.symbol_id }, name };
+    };
+    auto order = [&record] { return handlers::make_order<Order>(record.order, SymbolId { record.symbol_id }); };
+    auto id = OrderId { record.order_id };
+
+    switch (record.type) {
+        case CommandType::ADD_NEW_ORDERBOOK: return Command<Order> { AddNewOrderBook { symbol() } };
+        case CommandType::REMOVE_ORDERBOOK:  return Command<Order> { RemoveOrderBook { symbol() } };
+        case CommandType::ADD_ORDER:         return Command<Order> { AddOrder<Order> { order() } };
+        case CommandType::REMOVE_ORDER:      return Command<Order> { RemoveOrder { id } };
+        case CommandType::REDUCE_ORDER:      return Command<Order> { ReduceOrder { id, Quantity { record.quantity } } };
+        case CommandType::MODIFY_ORDER:      return Command<Order> { ModifyOrder { id, Price { record.price }, Quantity { record.quantity } } };
+        case CommandType::MITIGATE_ORDER:    return Command<Order> { MitigateOrder { id, Price { record.price }, Quantity { record.quantity } } };
+        case CommandType::REPLACE_ORDER:     return Command<Order> { ReplaceOrder<Order> { id, order() } };
+        case CommandType::EXECUTE_ORDER:     return Command<Order> { ExecuteOrder { id, Quantity { record.quantity }, Price { record.price } } };
+        case CommandType::MATCH:             return Command<Order> { Match { } };
+    }
+    return std::nullopt;
+}
+
+/*
+ * Appends commands to a file, off the thread that runs them (see
+ *  utils::BufferedWriter), so that capturing production flow costs a copy
+ *  of a record per command:
+ *
+ *      writer->write(command, timestamp);
+ *      commands::apply(engine, std::move(command));
+ *
+ * The factory returns nothing on failure, and errno tells why.
+ */
+class CommandFileWriter {
+public:
+
+    // The file is replaced if it exists
+    [[nodiscard]] static std::optional<CommandFileWriter> create(const std::string& path,
+                                                                utils::BufferedWriterConfig config = { }) {
+        auto fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd == -1) return std::nullopt;
+        if (::write(fd, &CurrentCommandFileHeader, sizeof(CommandFileHeader)) != sizeof(CommandFileHeader)) {
+            ::close(fd);
+            return std::nullopt;
+        }
+        return CommandFileWriter { fd, std::move(config) };
+    }
+
+    CommandFileWriter(CommandFileWriter&&) noexcept = default;
+    CommandFileWriter& operator=(CommandFileWriter&&) noexcept = default;
+
+    // The records are flushed before the file is closed
+    ~CommandFileWriter() noexcept {
+        if (_writer == nullptr) return;
+        _writer.reset();
+        ::close(_fd);
+    }
+
+    void write(const CommandRecord& record) noexcept {
+        std::memcpy(_writer->reserve(sizeof(CommandRecord)), &record, sizeof(CommandRecord));
+        _writer->advance(sizeof(CommandRecord));
+        ++_records_count;
+    }
+
+    template <concepts::Order Order>
+    void write(const Command<Order>& command, const uint64_t timestamp = 0) noexcept {
+        write(make_command_record<Order>(command, timestamp));
+    }
+
+    // Hands what's buffered to the writer thread. Returns false if a write has failed so far.
+    bool flush() noexcept { return _writer->flush(); }
+
+    // The errno of the first failed write, 0 if none has failed
+    [[nodiscard]] int error() const noexcept { return _writer->error(); }
+
+    [[nodiscard]] size_t records_count() const noexcept { return _records_count; }
+
+private:
+
+    CommandFileWriter(const int fd, utils::BufferedWriterConfig config)
+        : _fd(fd), _writer(std::make_unique<utils::BufferedWriter>(fd, std::move(config))) { }
+
+    int _fd;
+    // Not movable itself, since its thread refers to it
+    std::unique_ptr<utils::BufferedWriter> _writer;
+    size_t _records_count = 0;
+};
+
+/*
+ * A command file mapped into memory, with its records read in place.
+ *
+ * The factory returns nothing if the file can't be mapped (and errno tells
+ *  why), or if it isn't a command file of this version (and errno is EINVAL).
+ *  A file that ends in the middle of a record (e.g. of a process that was
+ *  killed while capturing) is cut at the last whole record.
+ */
+class CommandFile {
+public:
+
+    [[nodiscard]] static std::optional<CommandFile> open(const std::string& path) noexcept {
+        auto file = utils::MappedFile::open(path);
+        if (!file) return std::nullopt;
+        CommandFileHeader header { };
+        if (file->size() >= sizeof(header)) std::memcpy(&header, file->data(), sizeof(header));
+        if (int(file->size() < sizeof(header)) |
+            int(std::memcmp(header.magic, CurrentCommandFileHeader.magic, sizeof(header.magic)) != 0) |
+            int(header.version != CurrentCommandFileHeader.version) |
+            int(header.record_size != sizeof(CommandRecord))) {
+            errno = EINVAL;
+            return std::nullopt;
+        }
+        return CommandFile { std::move(*file) };
+    }
+
+    // The mapping is page-aligned, and the header keeps the records 16-byte aligned
+    [[nodiscard]] std::span<const CommandRecord> records() const noexcept {
+        auto count = (_file.size() - sizeof(CommandFileHeader)) / sizeof(CommandRecord);
+        return { reinterpret_cast<const CommandRecord*>(_file.data() + sizeof(CommandFileHeader)), count };
+    }
+
+private:
+
+    explicit CommandFile(utils::MappedFile file) noexcept : _file(std::move(file)) { }
+
+    utils::MappedFile _file;
+};
+
+}
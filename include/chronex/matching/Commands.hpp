@@ -0,0 +1,141 @@
+#pragma once
+
+#include <type_traits>
+#include <variant>
+
+#include <chronex/Symbol.hpp>
+
+#include <chronex/concepts/Order.hpp>
+
+#include <chronex/orderbook/Order.hpp>
+#include <chronex/orderbook/OrderPool.hpp>
+#include <chronex/orderbook/OrderUtils.hpp>
+
+namespace chronex::commands {
+
+/*
+ * Value types for every operation the matching engine accepts. These
+ *  are what gets queued when the caller and the engine are on different
+ *  threads, so they're kept as small as the engine API allows.
+ */
+
+struct AddNewOrderBook {
+    Symbol symbol;
+};
+
+struct RemoveOrderBook {
+    Symbol symbol;
+};
+
+template <concepts::Order Order = Order>
+struct AddOrder {
+    Order order;
+};
+
+// An order built in the installed OrderPool
+struct AdoptOrder {
+    OrderHandle handle;
+};
+
+struct RemoveOrder {
+    OrderId id;
+};
+
+struct ReduceOrder {
+    OrderId id;
+    Quantity quantity;
+};
+
+struct ModifyOrder {
+    OrderId id;
+    Price price;
+    Quantity quantity;
+};
+
+struct MitigateOrder {
+    OrderId id;
+    Price price;
+    Quantity quantity;
+};
+
+template <concepts::Order Order = Order>
+struct ReplaceOrder {
+    OrderId id;
+    Order order;
+};
+
+struct ExecuteOrder {
+    OrderId id;
+    Quantity quantity;
+    // Price::invalid() executes at the order's own price
+    Price price = Price::invalid();
+};
+
+struct Match { };
+
+template <concepts::Order Order = Order>
+using Command = std::variant<
+    AddNewOrderBook,
+    RemoveOrderBook,
+    AddOrder<Order>,
+    AdoptOrder,
+    RemoveOrder,
+    ReduceOrder,
+    ModifyOrder,
+    MitigateOrder,
+    ReplaceOrder<Order>,
+    ExecuteOrder,
+    Match
+>;
+
+/*
+ * Applies a command to the engine. Commands that refer to an order by its
+ *  ID are dropped if the order doesn't exist (anymore), since with queues
+ *  in between, a cancel can legitimately race with the fill that removed
+ *  the order. Orders with the ID of a live order are dropped as well, rather
+ *  than clobbering its entry in the engine. Returns whether the command was
+ *  applied.
+ */
+template <typename Engine, concepts::Order Order>
+constexpr bool apply(Engine& engine, Command<Order>&& command) {
+    return std::visit([&engine] <typename T> (T&& cmd) -> bool {
+        using C = std::remove_cvref_t<T>;
+        if constexpr (std::is_same_v<C, AddNewOrderBook>) {
+            engine.add_new_orderbook(cmd.symbol);
+        } else if constexpr (std::is_same_v<C, RemoveOrderBook>) {
+            engine.remove_orderbook(cmd.symbol);
+        } else if constexpr (std::is_same_v<C, AddOrder<Order>>) {
+            if (engine.has_order(cmd.order.id())) return false;
+            engine.add_order(std::move(cmd.order));
+        } else if constexpr (std::is_same_v<C, AdoptOrder>) {
+            engine.adopt_order(OrderPool<Order>::installed_iterator(cmd.handle));
+        } else if constexpr (std::is_same_v<C, Match>) {
+            engine.match();
+        } else {
+            if (!engine.has_order(cmd.id)) return false;
+
+            if constexpr (std::is_same_v<C, RemoveOrder>) {
+                engine.remove_order(cmd.id);
+            } else if constexpr (std::is_same_v<C, ReduceOrder>) {
+                engine.reduce_order(cmd.id, cmd.quantity);
+            } else if constexpr (std::is_same_v<C, ModifyOrder>) {
+                engine.modify_order(cmd.id, cmd.price, cmd.quantity);
+            } else if constexpr (std::is_same_v<C, MitigateOrder>) {
+                engine.mitigate_order(cmd.id, cmd.price, cmd.quantity);
+            } else if constexpr (std::is_same_v<C, ReplaceOrder<Order>>) {
+                // The replaced order is removed first, so it can hand down its ID
+                if (int(cmd.order.id() != cmd.id) & int(engine.has_order(cmd.order.id()))) return false;
+                engine.replace_order(cmd.id, std::move(cmd.order));
+            } else if constexpr (std::is_same_v<C, ExecuteOrder>) {
+                if (cmd.price == Price::invalid()) {
+                    engine.execute_order(cmd.id, cmd.quantity);
+                } else {
+                    engine.execute_order(cmd.id, cmd.quantity, cmd.price);
+                }
+            }
+        }
+        return true;
+    }, std::move(command));
+}
+
+}
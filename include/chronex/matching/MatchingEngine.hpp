@@ -7,10 +7,13 @@
 #include <chronex/concepts/OrderBook.hpp>
 #include <chronex/concepts/EventHandler.hpp>
 
+#include <chronex/handlers/EventMask.hpp>
 #include <chronex/handlers/NullEventHandler.hpp>
+#include <chronex/handlers/TradeFlags.hpp>
 
 #include <chronex/orderbook/Order.hpp>
 #include <chronex/orderbook/OrderBook.hpp>
+#include <chronex/orderbook/OrderPool.hpp>
 #include <chronex/orderbook/OrderUtils.hpp>
 
 namespace chronex {
@@ -18,6 +21,13 @@ namespace chronex {
 template <typename Key, typename Value>
 using unordered_map = std::unordered_map<Key, Value>;
 
+/*
+ * The list type of the levels is the OrderBook's, ds::LinkedList by default.
+ *  Engines that adopt orders built by other threads (see OrderPool) opt in to
+ *  PooledList through their OrderBook. Its nodes come from the installed
+ *  pool, so that adopting an order links its node as-is. Other engines move
+ *  adopted orders out of their nodes.
+ */
 template <
     concepts::Order Order = Order,
     concepts::EventHandler<OrderType> EventHandler = handlers::NullEventHandler,
@@ -28,6 +38,7 @@ class MatchingEngine {
 
     using OrderIterator = typename OrderBook::OrderIterator;
     using ConstOrderIterator = typename OrderBook::ConstOrderIterator;
+    using LevelQueueDataType = typename OrderBook::LevelQueueDataType;
 
     // TODO mark methods that allocate noexcept conditionally, conditioned that the allocation does throw or not
 
@@ -38,12 +49,82 @@ class MatchingEngine {
         NOT_TRIGGERED
     };
 
+    /*
+     * Brackets the events of a public command with on_command_begin and
+     *  on_command_end. Commands that call other commands (e.g. replace_order
+     *  calling add_order) are still a single command, only the outermost
+     *  scope reports. Compiled out for handlers that don't ask for commands.
+     */
+    class CommandScope {
+    public:
+        constexpr explicit CommandScope(MatchingEngine& engine) noexcept : _engine(engine) {
+            if constexpr (should_report<handlers::EventBits::Commands>()) {
+                if (_engine._command_depth++ == 0) {
+                    ++_engine._command_sequence;
+                    if constexpr (should_report<handlers::EventBits::CommandBegin>()) {
+                        _engine.event_handler().on_command_begin(_engine._command_sequence);
+                    }
+                }
+            }
+        }
+
+        constexpr ~CommandScope() noexcept {
+            if constexpr (should_report<handlers::EventBits::Commands>()) {
+                if (--_engine._command_depth == 0) {
+                    if constexpr (should_report<handlers::EventBits::CommandEnd>()) {
+                        _engine.event_handler().on_command_end(_engine._command_sequence);
+                    }
+                }
+            }
+        }
+
+        CommandScope(const CommandScope&) = delete;
+        CommandScope& operator=(const CommandScope&) = delete;
+
+    private:
+        MatchingEngine& _engine;
+    };
+
+    // Brackets the matching of orders (see on_trade_scope_begin). Compiled
+    //  out for handlers that don't ask for trade scopes.
+    class TradeScope {
+    public:
+        constexpr explicit TradeScope(MatchingEngine& engine) noexcept : _engine(engine) {
+            if constexpr (should_report<handlers::EventBits::TradeScope>()) {
+                _engine.event_handler().on_trade_scope_begin();
+            }
+        }
+
+        constexpr ~TradeScope() noexcept {
+            if constexpr (should_report<handlers::EventBits::TradeScope>()) {
+                _engine.event_handler().on_trade_scope_end();
+            }
+        }
+
+        TradeScope(const TradeScope&) = delete;
+        TradeScope& operator=(const TradeScope&) = delete;
+
+    private:
+        MatchingEngine& _engine;
+    };
+
 public:
 
+    constexpr MatchingEngine() = default;
+
+    // For event handlers that need to be wired to something (a queue,
+    //  a file, ...) before the engine starts reporting to them
+    constexpr explicit MatchingEngine(EventHandler event_handler) noexcept
+        : _event_handler(std::move(event_handler)) { }
+
     // This shouldn't affect performance since it's very predictable because
     //  the matching is typically enabled or disabled for the entire session
     constexpr bool is_matching_enabled() const noexcept { return _is_matching_enabled; }
-    constexpr void enable_matching() noexcept { _is_matching_enabled = true; match(); }
+    constexpr void enable_matching() noexcept {
+        CommandScope command { *this };
+        _is_matching_enabled = true;
+        match();
+    }
     constexpr void disable_matching() noexcept { _is_matching_enabled = false; }
 
     // TODO should these two methods be public? They're used in testing, but should they be exposed to users?
@@ -52,18 +133,40 @@ public:
         return orderbooks()[id.value];
     }
 
+    // Calls func with each of the orderbooks of the engine
+    template <typename Func>
+    constexpr void for_each_orderbook(Func&& func) {
+        for (auto& orderbook : orderbooks()) {
+            if (orderbook.is_valid()) {
+                func(orderbook);
+            }
+        }
+    }
+
+    [[nodiscard]] constexpr bool has_order(OrderId id) const noexcept {
+        return orders().contains(id);
+    }
+
+    [[nodiscard]] constexpr bool has_orderbook(const SymbolId id) const noexcept {
+        return is_symbol_taken(id);
+    }
+
     [[nodiscard]] constexpr ConstOrderIterator order_at(OrderId id) const noexcept {
         assert(orders().contains(id) && "Order with the given ID doesn't exists in the matching engine");
         return orders().find(id)->second;
     }
 
     constexpr void add_new_orderbook(Symbol symbol) {
-        event_handler().on_add_new_orderbook(symbol);
+        CommandScope command { *this };
+        if constexpr (should_report<handlers::EventBits::AddNewOrderBook>()) {
+            event_handler().on_add_new_orderbook(symbol);
+        }
         add_existing_orderbook(OrderBook { &orders(), symbol, &event_handler() }, false);
     }
 
     template <typename T>
     constexpr void add_existing_orderbook(T&& orderbook, const bool report = true) {
+        CommandScope command { *this };
         assert(!is_symbol_taken(orderbook.symbol_id()) &&
             "Symbol with the same ID already exists in the matching engine");
 
@@ -76,25 +179,65 @@ public:
 
         // TODO remove this conditional
         if (report) {
-            event_handler().on_add_orderbook(symbol);
+            if constexpr (should_report<handlers::EventBits::AddOrderBook>()) {
+                event_handler().on_add_orderbook(symbol);
+            }
         }
 
-        orderbook_at(id) = std::forward<T>(orderbook);
+        auto& slot = orderbook_at(id);
+        slot = std::forward<T>(orderbook);
+
+        // The orderbook might've been created by (or extracted from) another
+        //  engine. Rewire it to this one and index its resting orders.
+        slot.attach(&orders(), &event_handler());
+        slot.for_each_order([this] (OrderIterator order_it) {
+            assert(!orders().contains(order_it->id()) && "Order with the same ID already exists in the matching engine");
+            orders()[order_it->id()] = order_it;
+        });
     }
 
     constexpr void remove_orderbook(Symbol symbol) noexcept {
+        CommandScope command { *this };
         assert(is_symbol_taken(symbol.id) && "No symbol with the given ID exists in the matching engine");
 
         auto& orderbook = orderbook_at(symbol.id);
 
-        event_handler().on_remove_orderbook(orderbook);
+        if constexpr (should_report<handlers::EventBits::RemoveOrderBook>()) {
+            event_handler().on_remove_orderbook(orderbook);
+        }
 
         orderbook.clear();
+        // The readers see an empty book rather than the last quote
+        orderbook.publish_quote();
         orderbook.invalidate();
     }
 
+    // Takes the orderbook out of the engine without clearing it, along with
+    //  the index entries of its orders, so that it can be handed as-is to
+    //  another engine through add_existing_orderbook. Nothing is reported,
+    //  since the book keeps on living, just somewhere else.
+    [[nodiscard]] constexpr OrderBook extract_orderbook(const SymbolId id) noexcept {
+        assert(is_symbol_taken(id) && "No symbol with the given ID exists in the matching engine");
+
+        auto& slot = orderbook_at(id);
+        slot.for_each_order([this] (OrderIterator order_it) {
+            orders().erase(order_it->id());
+        });
+
+        OrderBook orderbook { std::move(slot) };
+        slot = OrderBook { };
+        return orderbook;
+    }
+
+    // See OrderBook::attach_quote
+    constexpr void attach_quote(const SymbolId id, QuoteSlot* quote) noexcept {
+        assert(is_symbol_taken(id) && "No symbol with the given ID exists in the matching engine");
+        orderbook_at(id).attach_quote(quote);
+    }
+
     template <concepts::Order T>
     constexpr void add_order(T&& order) {
+        CommandScope command { *this };
         return resolve_type_and_side_then_call(order, [&]<OrderType type, OrderSide side> {
             return add_order<type, side>(std::forward<T>(order));
         });
@@ -102,6 +245,7 @@ public:
 
     template <OrderType type, OrderSide side, concepts::Order T>
     constexpr void add_order(T&& order) {
+        CommandScope command { *this };
         assert(order.is_valid() && "Order is invalid");
 
         if constexpr (is_market(type)) {
@@ -121,6 +265,87 @@ public:
         }
     }
 
+    /*
+     * Adds an order that was built in a level node of the OrderPool. With
+     *  PooledList levels, orders that rest are linked into their level as-is,
+     *  and the node is freed back to the pool if the order doesn't rest.
+     *  Otherwise, the order is added by value and the node is freed.
+     */
+    constexpr void adopt_order(typename PooledList<Order>::iterator order_it) {
+        CommandScope command { *this };
+        if constexpr (std::is_same_v<LevelQueueDataType, PooledList<Order>>) {
+            return resolve_type_and_side_then_call(*order_it, [&]<OrderType type, OrderSide side> {
+                if constexpr (is_market(type)) {
+                    add_market_order<side>(*order_it);
+                    LevelQueueDataType::dispose(order_it);
+                } else if constexpr (is_limit(type)) {
+                    adopt_limit_order<side>(order_it);
+                } else {
+                    adopt_stop_order<type, side>(order_it);
+                }
+            });
+        } else {
+            add_order(std::move(*order_it));
+            PooledList<Order>::dispose(order_it);
+        }
+    }
+
+    template <OrderSide side>
+    constexpr void adopt_limit_order(OrderIterator order_it) {
+        assert(order_it->is_valid() && "Order is invalid");
+
+        auto& orderbook = orderbook_at(order_it->symbol_id());
+
+        if (is_matching_enabled()) {
+            match_limit_order<side>(orderbook, *order_it);
+        }
+
+        auto& order = *order_it;
+        if (int(!order.is_fully_filled()) & int(!order.is_ioc()) & int(!order.is_fok())) {
+            orderbook.template adopt_order<OrderType::LIMIT, side>(order_it);
+        } else {
+            if constexpr (should_report<handlers::EventBits::RemoveOrder>()) {
+                event_handler().template on_remove_order<OrderType::LIMIT, side>(orderbook, order);
+            }
+            LevelQueueDataType::dispose(order_it);
+        }
+
+        perform_post_order_processing(orderbook);
+    }
+
+    template <OrderType type, OrderSide side>
+    constexpr void adopt_stop_order(OrderIterator order_it) {
+        assert(order_it->is_valid() && "Order is invalid");
+
+        auto& orderbook = orderbook_at(order_it->symbol_id());
+        auto& order = *order_it;
+
+        if constexpr (type == OrderType::TRAILING_STOP) {
+            order.set_stop_price(orderbook.template calculate_trailing_stop_price<side>(order));
+        } else if constexpr (type == OrderType::TRAILING_STOP_LIMIT) {
+            order.set_stop_and_trailing_stop_prices(orderbook.template calculate_trailing_stop_price<side>(order));
+        }
+
+        if (int(is_matching_enabled()) & int(should_trigger<side>(orderbook, order))) {
+            if constexpr (is_market(get_triggered<type>())) {
+                // Never rests, so there's nothing to link
+                trigger_new_stop_order<type, side>(orderbook, std::move(order));
+                LevelQueueDataType::dispose(order_it);
+            } else {
+                order.template mark_triggered<type>();
+                if constexpr (should_report<handlers::EventBits::TriggerStopOrder>()) {
+                    event_handler().template on_trigger_stop_order<type, side>(orderbook, order);
+                }
+                adopt_limit_order<side>(order_it);
+            }
+            return;
+        }
+
+        orderbook.template adopt_order<type, side>(order_it);
+
+        perform_post_order_processing(orderbook);
+    }
+
     template <OrderSide side, concepts::Order T>
     constexpr void add_market_order(T&& order) {
         auto& orderbook = orderbook_at(order.symbol_id());
@@ -128,7 +353,9 @@ public:
         if (is_matching_enabled())
             match_market_order<side>(orderbook, order);
 
-        event_handler().template on_remove_order<OrderType::MARKET, side>(orderbook, order);
+        if constexpr (should_report<handlers::EventBits::RemoveOrder>()) {
+            event_handler().template on_remove_order<OrderType::MARKET, side>(orderbook, order);
+        }
 
         perform_post_order_processing(orderbook);
     }
@@ -255,6 +482,7 @@ public:
 # define ADD_BY_ID_METHOD(OP_NAME) \
     template <typename... Args>                                                                                 \
     constexpr void OP_NAME(const OrderId id, Args&&... args) noexcept {                                         \
+        CommandScope command { *this };                                                                         \
         auto [order_it, orderbook] = get_order_and_orderbook(id);                                               \
                                                                                                                 \
         auto func = [&] <OrderType type, OrderSide side, typename... Args2> (Args2&&... args2) {                \
@@ -293,7 +521,11 @@ public:
         return execute_order<true>(id, quantity, Price::invalid());
     }
 
+    template <typename Self>
+    auto& event_handler(this Self&& self) noexcept { return self._event_handler; }
+
     constexpr void match() noexcept {
+        CommandScope command { *this };
         // TODO store valid orderbook symbol IDs in a set instead of trying all IDs?
         for (auto& orderbook : orderbooks()) {
             if (is_symbol_taken(orderbook.symbol_id())) {
@@ -305,8 +537,21 @@ public:
 
 private:
 
+    // Compile-time, so that nothing is computed for events the handler doesn't want
+    template <handlers::EventMask events>
+    [[nodiscard]] constexpr static bool should_report() noexcept {
+        return handlers::reports<EventHandler>(events);
+    }
+
+    // For the events a trade is made of (see handlers::reports_trade_details)
+    template <handlers::EventMask events>
+    [[nodiscard]] constexpr static bool should_report_trade_detail() noexcept {
+        return should_report<events>() && handlers::reports_trade_details<EventHandler>();
+    }
+
     template <bool use_order_price>
     constexpr void execute_order(const OrderId id, Quantity quantity, Price price) noexcept {
+        CommandScope command { *this };
         auto [order_it, orderbook_ref] = get_order_and_orderbook(id);
         auto& orderbook = orderbook_ref.get();
 
@@ -364,9 +609,7 @@ private:
         #define MATCH_AON(PRICE) \
             Quantity chain_volume = calculate_matching_chain(orderbook);\
             if (chain_volume.value == 0) return;\
-            auto price = PRICE;\
-            execute_matching_chain<OrderSide::BUY>(orderbook, bid_it, bid_level_it, price, chain_volume);\
-            execute_matching_chain<OrderSide::SELL>(orderbook, ask_it, ask_level_it, price, chain_volume);\
+            execute_crossed_chains(orderbook, bid_it, bid_level_it, ask_it, ask_level_it, PRICE, chain_volume);\
 
         while (true) {
             while (int(!orderbook.bids().is_empty()) & int(!orderbook.asks().is_empty())) {
@@ -420,24 +663,38 @@ private:
 
     template <OrderSide executing_side, OrderSide reducing_side, typename T>
     constexpr void match_orders(OrderBook& orderbook, OrderIterator executing_order, T executing_level_it, OrderIterator reducing_order, T reducing_level_it) noexcept {
-        Quantity quantity = executing_order->leaves_quantity();
-        // TODO should the price be of an arbitrary side?
-        Price price = executing_order->price();
+        {
+            TradeScope trades { *this };
+            Quantity quantity = executing_order->leaves_quantity();
+            // TODO should the price be of an arbitrary side?
+            Price price = executing_order->price();
+
+            if constexpr (should_report_trade_detail<handlers::EventBits::MatchOrder>()) {
+                event_handler().template on_match_order<executing_side, reducing_side>(orderbook, *executing_order, *reducing_order);
+            }
 
-        event_handler().template on_match_order<executing_side, reducing_side>(orderbook, *executing_order, *reducing_order);
+            if constexpr (should_report<handlers::EventBits::Trade>()) {
+                if constexpr (executing_side == OrderSide::BUY) {
+                    report_crossed_trade(orderbook, executing_order, executing_level_it, reducing_order, reducing_level_it, quantity, price);
+                } else {
+                    report_crossed_trade(orderbook, reducing_order, reducing_level_it, executing_order, executing_level_it, quantity, price);
+                }
+            }
 
-        // TODO you can pass a template argument stating whether this is an executing
-        //  side or not, and if so, delete it without checking for full execution
-        // TODO ignore the new order_it and level_it?
-        (void)orderbook.template execute_quantity<OrderType::LIMIT, executing_side>(executing_order, executing_level_it, quantity, price);
-        orderbook.reset_matching_prices();
+            // TODO you can pass a template argument stating whether this is an executing
+            //  side or not, and if so, delete it without checking for full execution
+            // TODO ignore the new order_it and level_it?
+            (void)orderbook.template execute_quantity<OrderType::LIMIT, executing_side, true>(executing_order, executing_level_it, quantity, price);
+            orderbook.reset_matching_prices();
 
-        (void)orderbook.template execute_quantity<OrderType::LIMIT, reducing_side >(reducing_order , reducing_level_it , quantity, price);
+            (void)orderbook.template execute_quantity<OrderType::LIMIT, reducing_side , true>(reducing_order , reducing_level_it , quantity, price);
+        }
         perform_post_order_processing(orderbook);
     }
 
     template <OrderSide side>
     constexpr void match_order(OrderBook& orderbook, Order& order) noexcept {
+        TradeScope trades { *this };
 
         // This function doesn't remove an order from its container. The
         //  passed order is standalone, preparing to be added into a level,
@@ -487,13 +744,19 @@ private:
                 // TODO why not order.price()?
                 auto execution_price = other.price();
 
+                if constexpr (should_report<handlers::EventBits::Trade>()) {
+                    report_trade<side>(orderbook, order, order.leaves_quantity(), 0, other, level.size(), quantity, execution_price);
+                }
+
                 // TODO make sure of the order type
                 // This will report the execution of other
-                (void)orderbook.template execute_quantity<OrderType::LIMIT, opposite_side_value>(other_it, level_it, quantity, execution_price);
+                (void)orderbook.template execute_quantity<OrderType::LIMIT, opposite_side_value, true>(other_it, level_it, quantity, execution_price);
                 orderbook.reset_matching_prices();
 
                 order.execute_quantity(quantity);
-                event_handler().template on_execute_order<side>(orderbook, order, quantity, execution_price);
+                if constexpr (should_report_trade_detail<handlers::EventBits::ExecuteOrder>()) {
+                    event_handler().template on_execute_order<side>(orderbook, order, quantity, execution_price);
+                }
                 orderbook.template update_last_and_matching_price<side>(execution_price);
 
                 if (order.is_fully_filled()) {
@@ -529,7 +792,9 @@ private:
             orderbook.template add_order<type, side>(std::move(order));
             return true;
         } else {
-            event_handler().template on_remove_order<OrderType::LIMIT, side>(orderbook, order);
+            if constexpr (should_report<handlers::EventBits::RemoveOrder>()) {
+                event_handler().template on_remove_order<OrderType::LIMIT, side>(orderbook, order);
+            }
             return false;
         }
     }
@@ -543,10 +808,19 @@ private:
         auto& order = *order_it;
         if (int(!order.is_fully_filled()) & int(!order.is_ioc()) & int(!order.is_fok())) {
             auto level_it = orderbook.template get_or_add_level<OrderType::LIMIT, side>(order_it->template key_price<OrderType::LIMIT>());
+            // Linking is reported as adding, the same way unlinking is reported as removing
+            if constexpr (should_report<handlers::EventBits::AddOrder>()) {
+                event_handler().template on_add_order<OrderType::LIMIT, side>(orderbook, order);
+            }
             orderbook.template link_order<OrderType::LIMIT, side>(order_it, level_it);
             return true;
         } else {
-            event_handler().template on_remove_order<OrderType::LIMIT, side>(orderbook, order);
+            if constexpr (should_report<handlers::EventBits::RemoveOrder>()) {
+                event_handler().template on_remove_order<OrderType::LIMIT, side>(orderbook, order);
+            }
+            // The order was only unlinked from its stop level, it's still indexed and owns its node
+            orders().erase(order.id());
+            LevelQueueDataType::dispose(order_it);
             return false;
         }
     }
@@ -654,7 +928,9 @@ private:
 
     template <OrderType type, OrderSide side, typename T>
     constexpr void trigger_stop_order(OrderBook& orderbook, OrderIterator order_it, T level_it) noexcept {
-        event_handler().template on_trigger_stop_order<type, side>(orderbook, *order_it);
+        if constexpr (should_report<handlers::EventBits::TriggerStopOrder>()) {
+            event_handler().template on_trigger_stop_order<type, side>(orderbook, *order_it);
+        }
 
         order_it->template mark_triggered<type>();
         // TODO remove this and have a way to handle triggered stop orders accordingly
@@ -665,9 +941,7 @@ private:
         // TODO call add_market_order?
         match_market_order<side>(orderbook, *order_it);
 
-        // Remove only after we're done using it
-        // Remove the order from its stop order level and create a market
-        event_handler().template on_remove_order<type, side>(orderbook, *order_it);
+        // Remove only after we're done using it. The removal is reported by the orderbook
         orderbook.template remove_order<type, side>(order_it, level_it);
     }
 
@@ -679,7 +953,9 @@ private:
         order_it->template mark_triggered<type>();
         order_it->set_stop_price(Price{ 0 });  // TODO remove this?
 
-        event_handler().template on_trigger_stop_order<type, side>(orderbook, *order_it);
+        if constexpr (should_report<handlers::EventBits::TriggerStopOrder>()) {
+            event_handler().template on_trigger_stop_order<type, side>(orderbook, *order_it);
+        }
 
         match_limit_order<side>(orderbook, *order_it);
 
@@ -805,15 +1081,21 @@ private:
     }
 
     // TODO reorder the price and volume params so that they're consistent
+    // Executes the chain of the side against an aggressor that's not in the book
     template <OrderSide side, typename T>
-    constexpr auto execute_matching_chain(OrderBook& orderbook, OrderIterator order_it, T level_it, Price price, Quantity volume) noexcept {
+    constexpr auto execute_matching_chain(OrderBook& orderbook, Order& aggressor, OrderIterator order_it, T level_it, Price price, Quantity volume) noexcept {
         // The matching chain is already calculated.
         // We don't need to keep checking for boundaries
         while (volume > Quantity { 0 }) {
             auto quantity = calculate_matching_chain_quantity(*order_it, volume);
 
+            // The aggressor is executed as a whole after the chain
+            if constexpr (should_report<handlers::EventBits::Trade>()) {
+                report_trade<opposite_side<side>()>(orderbook, aggressor, volume, 0, *order_it, level_it->second.size(), quantity, price);
+            }
+
             // execute_quantity is likely to delete the order and possibly the level
-            std::tie(order_it, level_it) = orderbook.template execute_quantity<OrderType::LIMIT, side>(order_it, level_it, quantity, price);
+            std::tie(order_it, level_it) = orderbook.template execute_quantity<OrderType::LIMIT, side, true>(order_it, level_it, quantity, price);
             orderbook.reset_matching_prices();
 
             volume -= quantity;
@@ -823,12 +1105,86 @@ private:
     }
 
     template <OrderSide side>
-    constexpr auto execute_matching_chain(OrderBook& orderbook, Price price, Quantity volume) noexcept {
+    constexpr auto execute_matching_chain(OrderBook& orderbook, Order& aggressor, Price price, Quantity volume) noexcept {
         auto& levels = get_side<side>(orderbook);
         auto level_it = levels.begin();
         auto order_it = level_it->second.begin();
 
-        return execute_matching_chain<side>(orderbook, order_it, level_it, price, volume);
+        return execute_matching_chain<side>(orderbook, aggressor, order_it, level_it, price, volume);
+    }
+
+    /*
+     * Executes the chains of both sides (see calculate_matching_chain) against
+     *  each other. Each side ends up executing the same quantities it would've
+     *  if it was executed on its own, but for the handlers that want trades,
+     *  the executions go pair by pair, so that each pair can be reported as a
+     *  trade. The other handlers get the executions side by side, as always.
+     */
+    template <typename T>
+    constexpr void execute_crossed_chains(OrderBook& orderbook, OrderIterator bid_it, T bid_level_it, OrderIterator ask_it, T ask_level_it, const Price price, Quantity volume) noexcept {
+        if constexpr (!should_report<handlers::EventBits::Trade>()) {
+            // The aggressors are only used to report trades
+            auto& bid = *bid_it;
+            auto& ask = *ask_it;
+            execute_matching_chain<OrderSide::BUY>(orderbook, ask, bid_it, bid_level_it, price, volume);
+            execute_matching_chain<OrderSide::SELL>(orderbook, bid, ask_it, ask_level_it, price, volume);
+            return;
+        }
+
+        TradeScope trades { *this };
+
+        auto bid_quantity = calculate_matching_chain_quantity(*bid_it, volume);
+        auto ask_quantity = calculate_matching_chain_quantity(*ask_it, volume);
+
+        while (volume > Quantity { 0 }) {
+            auto quantity = std::min(bid_quantity, ask_quantity);
+
+            if constexpr (should_report<handlers::EventBits::Trade>()) {
+                report_crossed_trade(orderbook, bid_it, bid_level_it, ask_it, ask_level_it, quantity, price);
+            }
+
+            // execute_quantity is likely to delete the order and possibly the level
+            std::tie(bid_it, bid_level_it) = orderbook.template execute_quantity<OrderType::LIMIT, OrderSide::BUY, true>(bid_it, bid_level_it, quantity, price);
+            orderbook.reset_matching_prices();
+            std::tie(ask_it, ask_level_it) = orderbook.template execute_quantity<OrderType::LIMIT, OrderSide::SELL, true>(ask_it, ask_level_it, quantity, price);
+            orderbook.reset_matching_prices();
+
+            volume -= quantity;
+            bid_quantity -= quantity;
+            ask_quantity -= quantity;
+
+            // Both sides run out of volume at the same time, don't look past their chains
+            if (volume == Quantity { 0 }) break;
+            if (bid_quantity == Quantity { 0 }) bid_quantity = calculate_matching_chain_quantity(*bid_it, volume);
+            if (ask_quantity == Quantity { 0 }) ask_quantity = calculate_matching_chain_quantity(*ask_it, volume);
+        }
+    }
+
+    /*
+     * Reported before the trade, while both orders are still in place. An
+     *  aggressor that's not in the book has a level size of 0. The leaves
+     *  of the aggressor are passed separately, since an aggressive chain
+     *  only executes the aggressor after all of its trades.
+     */
+    template <OrderSide aggressor_side>
+    constexpr void report_trade(OrderBook& orderbook, Order& aggressor, const Quantity aggressor_leaves, const size_t aggressor_level_size,
+                                Order& resting, const size_t resting_level_size, const Quantity quantity, const Price price) noexcept {
+        using handlers::TradeBits;
+        auto aggressor_filled = quantity == aggressor_leaves;
+        auto resting_filled = quantity == resting.leaves_quantity();
+        auto flags =
+            uint32_t(aggressor_filled) * TradeBits::AggressorFilled |
+            uint32_t(resting_filled) * TradeBits::RestingFilled |
+            uint32_t(int(aggressor_filled) & int(aggressor_level_size == 1)) * TradeBits::AggressorLevelEmptied |
+            uint32_t(int(resting_filled) & int(resting_level_size == 1)) * TradeBits::RestingLevelEmptied |
+            uint32_t(aggressor_level_size != 0) * TradeBits::Crossed;
+        event_handler().template on_trade<aggressor_side>(orderbook, aggressor, resting, quantity, price, static_cast<handlers::TradeFlags>(flags));
+    }
+
+    // Both orders are in the book, and the buy order is reported as the aggressor
+    template <typename T>
+    constexpr void report_crossed_trade(OrderBook& orderbook, OrderIterator bid_it, T bid_level_it, OrderIterator ask_it, T ask_level_it, const Quantity quantity, const Price price) noexcept {
+        report_trade<OrderSide::BUY>(orderbook, *bid_it, bid_it->leaves_quantity(), bid_level_it->second.size(), *ask_it, ask_level_it->second.size(), quantity, price);
     }
 
     template <OrderSide side>
@@ -873,7 +1229,9 @@ private:
                     //  we get the newly inserted level, or the same level if it's not removed
                     level_it = orderbook.template link_order<OrderType::TRAILING_STOP, opposite>(order_it);
 
-                    event_handler().template on_update_stop_price<opposite>(orderbook, *order_it);
+                    if constexpr (should_report<handlers::EventBits::UpdateStopPrice>()) {
+                        event_handler().template on_update_stop_price<opposite>(orderbook, *order_it);
+                    }
 
                     updated = true;
                 }
@@ -897,6 +1255,9 @@ private:
         }
 
         orderbook.reset_matching_prices();
+
+        // A single, predictable branch when no quote slot is attached
+        orderbook.publish_quote();
     }
 
     template <OrderType type, OrderSide side, typename T>
@@ -923,11 +1284,15 @@ private:
                 order.set_time_in_force(TimeInForce::IOC);
         }
 
-        event_handler().template on_trigger_stop_order<type, side>(orderbook, order);
+        if constexpr (should_report<handlers::EventBits::TriggerStopOrder>()) {
+            event_handler().template on_trigger_stop_order<type, side>(orderbook, order);
+        }
 
         if constexpr (is_market(triggered_type)) {
             match_market_order<side>(orderbook, order);
-            event_handler().template on_remove_order<triggered_type, side>(orderbook, order);
+            if constexpr (should_report<handlers::EventBits::RemoveOrder>()) {
+                event_handler().template on_remove_order<triggered_type, side>(orderbook, order);
+            }
         } else if constexpr (is_limit(triggered_type)) {
             match_limit_order<side>(orderbook, order);
             try_add_limit_order<triggered_type, side>(orderbook, std::move(order));
@@ -944,7 +1309,9 @@ private:
         if (!order.is_fully_filled()) {
             orderbook.template add_order<type, side>(std::forward<T>(order));
         } else {
-            event_handler().template on_remove_order<type, side>(orderbook, order);
+            if constexpr (should_report<handlers::EventBits::RemoveOrder>()) {
+                event_handler().template on_remove_order<type, side>(orderbook, order);
+            }
         }
     }
 
@@ -952,8 +1319,10 @@ private:
     constexpr void try_match_aon(OrderBook& orderbook, Order& order) noexcept {
         auto chain_volume = calculate_matching_chain<opposite_side>(orderbook, order.price(), order.leaves_quantity());
         if (chain_volume == Quantity { 0 }) return;
-        execute_matching_chain<opposite_side>(orderbook, order.price(), chain_volume);
-        event_handler().template on_execute_order<opposite_side>(orderbook, order, order.leaves_quantity(), order.price());
+        execute_matching_chain<opposite_side>(orderbook, order, order.price(), chain_volume);
+        if constexpr (should_report_trade_detail<handlers::EventBits::ExecuteOrder>()) {
+            event_handler().template on_execute_order<opposite_side>(orderbook, order, order.leaves_quantity(), order.price());
+        }
         // TODO remove this
         orderbook.template update_last_and_matching_price<opposite_side>(order.price());
         // Doesn't remove, just marks it as fully filled
@@ -997,14 +1366,15 @@ private:
     template <typename Self>
     constexpr auto& order_by_id(this Self&& self, OrderId id) noexcept { return self.orders()[id]; }
 
-    template <typename Self>
-    auto& event_handler(this Self&& self) noexcept { return self._event_handler; }
-
     template <typename Self>
     auto& orderbooks(this Self&& self) noexcept { return self._orderbooks; }
 
     bool _is_matching_enabled = true;
 
+    // See CommandScope
+    uint64_t _command_sequence = 0;
+    uint32_t _command_depth = 0;
+
     EventHandler _event_handler;
     std::vector<OrderBook> _orderbooks;
 
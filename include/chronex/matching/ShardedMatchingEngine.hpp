@@ -0,0 +1,501 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <variant>
+#include <vector>
+
+#include <chronex/Symbol.hpp>
+
+#include <chronex/concepts/EventHandler.hpp>
+
+#include <chronex/data-structures/SPSCQueue.hpp>
+
+#include <chronex/handlers/EventMask.hpp>
+#include <chronex/handlers/NullEventHandler.hpp>
+#include <chronex/handlers/TradeFlags.hpp>
+
+#include <chronex/matching/Commands.hpp>
+#include <chronex/matching/MatchingEngine.hpp>
+
+#include <chronex/orderbook/OrderPool.hpp>
+
+#include <chronex/utils/Threading.hpp>
+
+namespace chronex {
+
+struct ShardingConfig {
+    size_t shards_count = 1;
+    // Must be a power of two
+    size_t queue_capacity = 1 << 16;
+    // How many commands a shard applies before publishing its progress
+    size_t batch_size = 64;
+    // Shard i is pinned to cores[i] when provided
+    std::vector<size_t> cores { };
+};
+
+/*
+ * The event handler of a shard. Besides reporting everything to the handler
+ *  of the shard, it keeps the IDs of the orders that left the book during
+ *  the current command, so that the shard can report them back to the
+ *  front-end, which then forgets about them. Removals are reported either
+ *  as such, or as part of a trade, for the handlers that ask for trades.
+ */
+template <typename EventHandler>
+class ShardEventHandler : public EventHandler {
+public:
+
+    constexpr static handlers::EventMask event_mask = handlers::event_mask_v<EventHandler> | handlers::EventBits::RemoveOrder;
+
+    // Room for `capacity` removals is made upfront, so that commands that
+    //  remove up to that many orders don't allocate on the shard's thread
+    ShardEventHandler(EventHandler handler, const size_t capacity) : EventHandler(std::move(handler)) {
+        _removed_orders.reserve(capacity);
+    }
+
+    template <OrderType type, OrderSide side, typename T, typename U>
+    auto on_remove_order(T& orderbook, U& order) noexcept {
+        _removed_orders.push_back(order.id());
+        if constexpr (handlers::reports<EventHandler>(handlers::EventBits::RemoveOrder)) {
+            return EventHandler::template on_remove_order<type, side>(orderbook, order);
+        }
+    }
+
+    template <OrderSide side, typename T, typename U, typename Q, typename P, typename F>
+    auto on_trade(T& orderbook, U& aggressor, U& resting, Q quantity, P price, F flags) noexcept {
+        if (flags & handlers::TradeBits::AggressorFilled) _removed_orders.push_back(aggressor.id());
+        if (flags & handlers::TradeBits::RestingFilled) _removed_orders.push_back(resting.id());
+        return EventHandler::template on_trade<side>(orderbook, aggressor, resting, quantity, price, flags);
+    }
+
+    [[nodiscard]] std::vector<OrderId>& removed_orders() noexcept { return _removed_orders; }
+
+private:
+    std::vector<OrderId> _removed_orders;
+};
+
+/*
+ * Matching only has to be serialized per symbol, so this front-end
+ *  partitions the symbols over K independent MatchingEngine instances,
+ *  each running on its own thread and fed through its own SPSC queue.
+ *  Everything here is meant to be called from a single thread (the
+ *  gateway). Each shard owns its books, its order index, and its event
+ *  handler, so the shards never share mutable state with each other.
+ *
+ * Hot symbols can be moved between shards while the engine is running
+ *  (see migrate_orderbook), and the front-end keeps a per-book message
+ *  counter to decide which ones to move.
+ *
+ * Orders leave the books without the front-end knowing (e.g. when they
+ *  are filled), so the shards report the IDs of the orders that left their
+ *  books back to the front-end, through a queue per shard, and the front-end
+ *  drops their routing entries as it goes.
+ *
+ * Each shard stamps the commands it applies with a per-shard sequence
+ *  number. Event handlers that want it (to merge the per-shard streams
+ *  downstream) implement `on_shard_command(shard, sequence)`, which is
+ *  called right before the events of that command are reported.
+ */
+template <
+    concepts::Order Order = Order,
+    concepts::EventHandler<OrderType> EventHandler = handlers::NullEventHandler,
+    template <typename, typename> typename HashMap = unordered_map,
+    typename ListType = ds::LinkedList<Order>
+>
+class ShardedMatchingEngine {
+public:
+
+    using ShardHandler = ShardEventHandler<EventHandler>;
+    using Book = OrderBook<Order, ShardHandler, HashMap, ListType>;
+    using Engine = MatchingEngine<Order, ShardHandler, Book, HashMap>;
+    using Command = commands::Command<Order>;
+    using EventHandlerFactory = std::function<EventHandler(size_t shard)>;
+
+    explicit ShardedMatchingEngine(ShardingConfig config, EventHandlerFactory factory = [](size_t) { return EventHandler{ }; })
+        : _config(std::move(config)) {
+        assert(_config.shards_count > 0 && "There must be at least one shard");
+
+        _shards.reserve(_config.shards_count);
+        for (size_t i = 0; i < _config.shards_count; i++) {
+            _shards.push_back(std::make_unique<Shard>(factory(i), _config.queue_capacity));
+        }
+
+        // Start the workers only after all shards are constructed
+        for (size_t i = 0; i < _shards.size(); i++) {
+            _shards[i]->worker = std::jthread([this, i] (std::stop_token token) { run(token, i); });
+        }
+    }
+
+    ShardedMatchingEngine(const ShardedMatchingEngine&) = delete;
+    ShardedMatchingEngine& operator=(const ShardedMatchingEngine&) = delete;
+
+    ~ShardedMatchingEngine() {
+        // Let the shards finish what's already queued before stopping them
+        wait_until_idle();
+        for (auto& shard : _shards) {
+            shard->worker.request_stop();
+        }
+    }
+
+    [[nodiscard]] size_t shards_count() const noexcept { return _shards.size(); }
+
+    [[nodiscard]] size_t shard_of(const SymbolId id) const noexcept {
+        assert(is_routed(id) && "The symbol is not assigned to any shard");
+        return _symbol_shards[id.value];
+    }
+
+    [[nodiscard]] std::optional<size_t> shard_of(const OrderId id) const noexcept {
+        auto it = _order_symbols.find(id);
+        if (it == _order_symbols.end()) return std::nullopt;
+        return shard_of(it->second.symbol_id);
+    }
+
+    void add_new_orderbook(const Symbol symbol) {
+        add_new_orderbook(symbol, symbol.id.value % shards_count());
+    }
+
+    void add_new_orderbook(const Symbol symbol, const size_t shard) {
+        assert(shard < shards_count() && "Shard index out of range");
+        assert(!is_routed(symbol.id) && "Symbol with the same ID is already assigned to a shard");
+
+        if (_symbol_shards.size() <= symbol.id.value) {
+            _symbol_shards.resize(symbol.id.value + 1, NoShard);
+            _symbol_messages.resize(symbol.id.value + 1, 0);
+        }
+        _symbol_shards[symbol.id.value] = shard;
+
+        submit(shard, commands::AddNewOrderBook{ symbol });
+    }
+
+    /*
+     * Moves a live orderbook, along with its order index entries, to another
+     *  shard. Only this symbol is quiesced: the source shard extracts the
+     *  book when it reaches the request in its queue, while the target shard
+     *  only waits for the hand-off when it reaches the adoption request,
+     *  which is queued before any later command for this symbol. Other
+     *  symbols of the source shard are never paused, and those of the target
+     *  shard wait at most for the source to catch up with the request.
+     */
+    void migrate_orderbook(const SymbolId id, const size_t target) {
+        assert(target < shards_count() && "Shard index out of range");
+        auto source = shard_of(id);
+        if (source == target) return;
+
+        auto handoff = std::make_shared<Handoff>();
+        submit(source, ExtractOrderBook{ id, handoff });
+        _symbol_shards[id.value] = target;
+        submit(target, AdoptOrderBook{ std::move(handoff) });
+    }
+
+    // Number of messages routed to the book since the last reset. Sampling
+    //  this periodically gives the per-book message rates.
+    [[nodiscard]] uint64_t message_count(const SymbolId id) const noexcept {
+        return id.value < _symbol_messages.size() ? _symbol_messages[id.value] : 0;
+    }
+
+    [[nodiscard]] uint64_t shard_message_count(const size_t shard) const noexcept {
+        uint64_t count = 0;
+        for (uint32_t id = 0; id < _symbol_shards.size(); id++) {
+            if (_symbol_shards[id] == shard) count += _symbol_messages[id];
+        }
+        return count;
+    }
+
+    void reset_message_counts() noexcept {
+        std::ranges::fill(_symbol_messages, 0);
+    }
+
+    // The books are cleared without reporting their orders, so they're
+    //  forgotten here. Removing a book is rare enough to scan for them.
+    void remove_orderbook(const Symbol symbol) {
+        auto shard = shard_of(symbol.id);
+        _symbol_shards[symbol.id.value] = NoShard;
+        std::erase_if(_order_symbols, [&] (const auto& entry) { return entry.second.symbol_id == symbol.id; });
+        submit(shard, commands::RemoveOrderBook{ symbol });
+    }
+
+    void add_order(Order&& order) {
+        auto symbol_id = order.symbol_id();
+        add_route(order.id(), symbol_id);
+        ++_symbol_messages[symbol_id.value];
+        submit(shard_of(symbol_id), commands::AddOrder<Order>{ std::move(order) });
+    }
+
+    // The order was built in the installed OrderPool. Only its handle is queued.
+    void adopt_order(const OrderHandle handle) {
+        auto& order = *OrderPool<Order>::installed_iterator(handle);
+        auto symbol_id = order.symbol_id();
+        add_route(order.id(), symbol_id);
+        ++_symbol_messages[symbol_id.value];
+        submit(shard_of(symbol_id), commands::AdoptOrder{ handle });
+    }
+
+    void remove_order(const OrderId id) {
+        route_and_forget(id, commands::RemoveOrder{ id });
+    }
+
+    void reduce_order(const OrderId id, const Quantity quantity) {
+        route(id, commands::ReduceOrder{ id, quantity });
+    }
+
+    void modify_order(const OrderId id, const Price new_price, const Quantity new_quantity) {
+        route(id, commands::ModifyOrder{ id, new_price, new_quantity });
+    }
+
+    void mitigate_order(const OrderId id, const Price new_price, const Quantity new_quantity) {
+        route(id, commands::MitigateOrder{ id, new_price, new_quantity });
+    }
+
+    void replace_order(const OrderId id, Order&& new_order) {
+        auto it = _order_symbols.find(id);
+        if (it == _order_symbols.end()) return;
+
+        auto symbol_id = it->second.symbol_id;
+        assert(symbol_id == new_order.symbol_id() && "Orders can't be replaced with orders of other symbols");
+        // Forgotten before the new one is added, since they can have the same ID
+        _order_symbols.erase(it);
+        add_route(new_order.id(), symbol_id);
+
+        ++_symbol_messages[symbol_id.value];
+        submit(shard_of(symbol_id), commands::ReplaceOrder<Order>{ id, std::move(new_order) });
+    }
+
+    void execute_order(const OrderId id, const Quantity quantity) {
+        route(id, commands::ExecuteOrder{ id, quantity });
+    }
+
+    void execute_order(const OrderId id, const Quantity quantity, const Price price) {
+        route(id, commands::ExecuteOrder{ id, quantity, price });
+    }
+
+    // Blocks until every shard has applied everything submitted so far, and
+    //  reported back the orders that left its books. After this returns, and
+    //  until the next submission, the shard engines can be safely inspected
+    //  from the calling thread.
+    void wait_until_idle() noexcept {
+        for (auto& shard : _shards) {
+            utils::Backoff backoff;
+            while (int(shard->applied.load(std::memory_order_acquire) != shard->submitted) |
+                   int(shard->unreported.load(std::memory_order_acquire) != 0)) {
+                collect_removed_orders();
+                backoff.pause();
+            }
+        }
+        collect_removed_orders();
+    }
+
+    // How many orders the front-end still routes. Orders are only forgotten
+    //  once their shard reports them, so this lags behind the books.
+    [[nodiscard]] size_t routed_orders_count() const noexcept { return _order_symbols.size(); }
+
+    [[nodiscard]] Engine& engine(const size_t shard) noexcept { return _shards[shard]->engine; }
+
+    [[nodiscard]] const Engine& engine(const size_t shard) const noexcept { return _shards[shard]->engine; }
+
+    [[nodiscard]] uint64_t sequence(const size_t shard) const noexcept {
+        return _shards[shard]->applied.load(std::memory_order_acquire);
+    }
+
+private:
+
+    constexpr static size_t NoShard = std::numeric_limits<size_t>::max();
+
+    struct Handoff {
+        std::optional<Book> orderbook { };
+        std::atomic<bool> is_ready { false };
+    };
+
+    struct ExtractOrderBook {
+        SymbolId id;
+        std::shared_ptr<Handoff> handoff;
+    };
+
+    struct AdoptOrderBook {
+        std::shared_ptr<Handoff> handoff;
+    };
+
+    using ShardCommand = std::variant<Command, ExtractOrderBook, AdoptOrderBook>;
+
+    // Stamped with the front-end's sequence of the submission, which orders
+    //  the submissions of all of the shards
+    struct Submission {
+        ShardCommand command;
+        uint64_t sequence;
+    };
+
+    // An order that left the book while applying the submission with the sequence
+    struct RemovedOrder {
+        OrderId id;
+        uint64_t sequence;
+    };
+
+    struct OrderRoute {
+        SymbolId symbol_id;
+        // Of the submission that added the order
+        uint64_t sequence;
+    };
+
+    struct Shard {
+        Shard(EventHandler event_handler, const size_t capacity)
+            : engine(ShardHandler { std::move(event_handler), capacity }), queue(capacity), removed_orders(capacity) { }
+
+        Engine engine;
+        ds::SPSCQueue<Submission> queue;
+        ds::SPSCQueue<RemovedOrder> removed_orders;
+
+        // Written by the worker only
+        alignas(utils::CacheLineSize) std::atomic<uint64_t> applied { 0 };
+        // The removed orders that didn't fit in the queue yet
+        std::atomic<size_t> unreported { 0 };
+
+        // Written by the front-end only
+        alignas(utils::CacheLineSize) uint64_t submitted = 0;
+
+        std::jthread worker;
+    };
+
+    [[nodiscard]] bool is_routed(const SymbolId id) const noexcept {
+        return id.value < _symbol_shards.size() && _symbol_shards[id.value] != NoShard;
+    }
+
+    // Routed before the order is submitted, since the shard can report it
+    //  removed as soon as it's submitted. It's added by the next submission.
+    void add_route(const OrderId id, const SymbolId symbol_id) {
+        _order_symbols.insert_or_assign(id, OrderRoute { symbol_id, _sequence + 1 });
+    }
+
+    void submit(const size_t shard, ShardCommand&& command) {
+        auto& s = *_shards[shard];
+        Submission submission { std::move(command), ++_sequence };
+        // The shard might be waiting for its removed orders to be collected
+        //  before it can go on, so they're collected while waiting for room
+        if (!s.queue.try_push(std::move(submission))) {
+            utils::Backoff backoff;
+            do {
+                collect_removed_orders();
+                backoff.pause();
+            } while (!s.queue.try_push(std::move(submission)));
+        }
+        ++s.submitted;
+
+        if (_sequence % _config.batch_size == 0) collect_removed_orders();
+    }
+
+    /*
+     * Forgets the orders the shards reported as removed. An order is only
+     *  forgotten if it was added before it was removed, since a removal is
+     *  reported after the fact, and the ID might have been reused since.
+     */
+    void collect_removed_orders() {
+        for (auto& shard : _shards) {
+            shard->removed_orders.consume([this] (const RemovedOrder& removed) {
+                auto it = _order_symbols.find(removed.id);
+                if (it != _order_symbols.end() && it->second.sequence <= removed.sequence) {
+                    _order_symbols.erase(it);
+                }
+            });
+        }
+    }
+
+    void route(const OrderId id, Command&& command) {
+        // Unknown orders are dropped here instead of crossing a queue
+        auto it = _order_symbols.find(id);
+        if (it == _order_symbols.end()) return;
+
+        auto symbol_id = it->second.symbol_id;
+        ++_symbol_messages[symbol_id.value];
+        submit(shard_of(symbol_id), std::move(command));
+    }
+
+    void route_and_forget(const OrderId id, Command&& command) {
+        route(id, std::move(command));
+        _order_symbols.erase(id);
+    }
+
+    void run(const std::stop_token& token, const size_t index) {
+        if (index < _config.cores.size()) {
+            utils::pin_current_thread(_config.cores[index]);
+        }
+
+        auto& shard = *_shards[index];
+        auto& engine = shard.engine;
+        auto& removed_orders = engine.event_handler().removed_orders();
+        uint64_t sequence = shard.applied.load(std::memory_order_relaxed);
+
+        // Kept here while the queue back to the front-end is full, so that
+        //  the shard never waits for the front-end
+        std::vector<RemovedOrder> unreported;
+        unreported.reserve(_config.queue_capacity);
+        auto report = [&] {
+            auto reported = std::ranges::find_if_not(unreported, [&] (RemovedOrder& removed) {
+                return shard.removed_orders.try_push(std::move(removed));
+            });
+            unreported.erase(unreported.begin(), reported);
+            shard.unreported.store(unreported.size(), std::memory_order_release);
+        };
+
+        utils::Backoff backoff;
+        while (!token.stop_requested()) {
+            auto count = shard.queue.consume([&] (Submission& submission) {
+                ++sequence;
+                if constexpr (requires { engine.event_handler().on_shard_command(index, sequence); }) {
+                    engine.event_handler().on_shard_command(index, sequence);
+                }
+                apply(engine, std::move(submission.command));
+
+                // Some of them might be back already (e.g. replaced by an order with the same ID)
+                for (auto id : removed_orders) {
+                    if (!engine.has_order(id)) unreported.push_back(RemovedOrder { id, submission.sequence });
+                }
+                removed_orders.clear();
+            }, _config.batch_size);
+
+            if (!unreported.empty()) report();
+
+            if (count == 0) {
+                backoff.pause();
+                continue;
+            }
+
+            backoff.reset();
+            shard.applied.store(sequence, std::memory_order_release);
+        }
+    }
+
+    static void apply(Engine& engine, ShardCommand&& command) {
+        if (auto* cmd = std::get_if<Command>(&command)) {
+            commands::apply(engine, std::move(*cmd));
+        } else if (auto* extract = std::get_if<ExtractOrderBook>(&command)) {
+            extract->handoff->orderbook.emplace(engine.extract_orderbook(extract->id));
+            extract->handoff->is_ready.store(true, std::memory_order_release);
+        } else {
+            auto& handoff = *std::get<AdoptOrderBook>(command).handoff;
+            utils::Backoff backoff;
+            while (!handoff.is_ready.load(std::memory_order_acquire)) {
+                backoff.pause();
+            }
+            engine.add_existing_orderbook(std::move(*handoff.orderbook), false);
+        }
+    }
+
+    ShardingConfig _config;
+
+    std::vector<std::unique_ptr<Shard>> _shards;
+
+    // Front-end routing tables. Cancels only carry the order ID, so
+    //  orders are mapped to their symbol, and the symbol to its shard.
+    std::vector<size_t> _symbol_shards;
+    HashMap<OrderId, OrderRoute> _order_symbols { };
+
+    uint64_t _sequence = 0;
+
+    std::vector<uint64_t> _symbol_messages;
+};
+
+}
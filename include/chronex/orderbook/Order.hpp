@@ -63,6 +63,10 @@ struct Order {
 
     [[nodiscard]] constexpr TrailingDistance trailing_distance() const noexcept { return _trailing_distance; }
 
+    // Orders without an account skip the per-account risk checks
+    [[nodiscard]] constexpr AccountId account_id() const noexcept { return _account_id; }
+    [[nodiscard]] constexpr bool has_account() const noexcept { return account_id() != AccountId::invalid(); }
+
     [[nodiscard]] bool is_valid() const noexcept;
 
     constexpr void set_price(const Price& price) noexcept { _price = price; }
@@ -80,6 +84,8 @@ struct Order {
 
     constexpr void set_time_in_force(TimeInForce time_in_force) noexcept { _time_in_force = time_in_force; }
 
+    constexpr void set_account_id(const AccountId account_id) noexcept { _account_id = account_id; }
+
     constexpr void set_leaves_quantity(const Quantity quantity) noexcept { _leaves_quantity = quantity; }
 
     constexpr void reduce_quantity(const Quantity quantity) noexcept {
@@ -117,7 +123,7 @@ struct Order {
     ~Order() noexcept = default;
 
     constexpr Order clone(uint64_t new_id, uint64_t new_price, uint64_t new_quantity) {
-        return Order(
+        auto order = Order(
             new_id,
             symbol_id().value,
             type(),
@@ -130,6 +136,8 @@ struct Order {
             slippage().value,
             trailing_distance()
         );
+        order.set_account_id(account_id());
+        return order;
     }
 
     // TODO extract common parts, and arrange the parameters and args in a nice way
@@ -237,6 +245,9 @@ private:
     TimeInForce _time_in_force { TimeInForce::GTC };
     // 1-byte padding
 
+    AccountId _account_id = AccountId::invalid();
+    // 4-byte padding
+
     Quantity _leaves_quantity = Quantity::invalid();
     Quantity _filled_quantity = Quantity::invalid();
     Quantity _max_visible_quantity = Quantity::max();
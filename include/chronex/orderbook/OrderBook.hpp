@@ -5,9 +5,11 @@
 
 #include <chronex/Symbol.hpp>
 #include <chronex/orderbook/Order.hpp>
+#include <chronex/orderbook/Quote.hpp>
 
 #include <chronex/orderbook/levels/TrailingStopLevels.hpp>
 
+#include <chronex/handlers/EventMask.hpp>
 #include <chronex/handlers/NullEventHandler.hpp>
 
 namespace chronex {
@@ -31,7 +33,8 @@ using unordered_map = std::unordered_map<Key, Value>;
 template <
     concepts::Order Order = Order,
     concepts::EventHandler<Order> EventHandler = handlers::NullEventHandler,
-    template <typename, typename> typename HashMap = unordered_map
+    template <typename, typename> typename HashMap = unordered_map,
+    typename ListType = ds::LinkedList<Order>
 >
 class OrderBook {
 public:
@@ -41,11 +44,11 @@ public:
 
     // We can use StopLevels or TrailingStopLevels as
     //  well, all have the same OrderIterator type
-    using OrderIterator = typename PriceLevels<Order>::OrderIterator;
-    using ConstOrderIterator = typename PriceLevels<Order>::ConstOrderIterator;
+    using OrderIterator = typename PriceLevels<Order, ListType>::OrderIterator;
+    using ConstOrderIterator = typename PriceLevels<Order, ListType>::ConstOrderIterator;
 
     // TODO remove this
-    using LevelQueueDataType = typename PriceLevels<Order>::LevelQueueDataType;
+    using LevelQueueDataType = typename PriceLevels<Order, ListType>::LevelQueueDataType;
 
     constexpr OrderBook(HashMap<OrderId, OrderIterator>* orders, const Symbol symbol, EventHandler* event_handler) noexcept
         : _price_levels(), _stop_levels(), _trailing_stop_levels(),
@@ -105,7 +108,7 @@ public:
 
         auto level_it = get_or_add_level<type, side>(order.template key_price<type>());
 
-        if constexpr (should_report()) {
+        if constexpr (should_report<handlers::EventBits::AddOrder>()) {
             event_handler().template on_add_order<type, side>(*this, order);
         }
 
@@ -114,15 +117,40 @@ public:
         add_order_to_map(id, order_it);
     }
 
+    // Adds an order that already lives in a level node
+    //  (see OrderPool) by linking the node itself
+    template <OrderType type, OrderSide side>
+    constexpr void adopt_order(OrderIterator order_it) noexcept {
+        assert(!orders().contains(order_it->id()) && "Order with the same ID already exists in the order book");
+
+        auto level_it = get_or_add_level<type, side>(order_it->template key_price<type>());
+
+        if constexpr (should_report<handlers::EventBits::AddOrder>()) {
+            event_handler().template on_add_order<type, side>(*this, *order_it);
+        }
+
+        link_order<type, side>(order_it, level_it);
+
+        add_order_to_map(order_it->id(), order_it);
+    }
+
     template <OrderType type, OrderSide side, typename T>
     constexpr auto reduce_order(OrderIterator order_it, T level_it, Quantity quantity) noexcept {
         if (quantity == Quantity{ 0 }) {
-            event_handler().template on_remove_order<type, side>(*this, *order_it);
-            if (level_it->second.size() == 1) {
-                event_handler().template on_remove_level<type, side>(*this, level_it->first);
+            if constexpr (should_report<handlers::EventBits::RemoveOrder>()) {
+                event_handler().template on_remove_order<type, side>(*this, *order_it);
+            }
+            if constexpr (should_report<handlers::EventBits::RemoveLevel>()) {
+                if (level_it->second.size() == 1) {
+                    event_handler().template on_remove_level<type, side>(*this, level_it->first);
+                }
             }
             return levels<type, side>().remove_order(order_it, level_it);
         } else {
+            // The quantity is the new leaves quantity of the order
+            if constexpr (should_report<handlers::EventBits::ReduceOrder>()) {
+                event_handler().template on_reduce_order<type, side>(*this, *order_it, quantity);
+            }
             return levels<type, side>().reduce_order(order_it, level_it, quantity);
         }
     }
@@ -158,18 +186,23 @@ public:
         return link_order<type, side>(order_it, level);
     }
 
-    template <OrderType type, OrderSide side, typename T>
+    // Trades are reported by the engine, which knows about both of their orders
+    template <OrderType type, OrderSide side, bool is_trade = false, typename T>
     [[nodiscard]] constexpr auto execute_quantity(OrderIterator order_it, T level_it, const Quantity quantity, const Price price) noexcept {
 
         update_last_and_matching_price<side>(price);
 
         auto& [level_price, level] = *level_it;
 
-        event_handler().template on_execute_order<side>(*this, *order_it, quantity, price);
+        if constexpr (should_report_execution<is_trade, handlers::EventBits::ExecuteOrder>()) {
+            event_handler().template on_execute_order<side>(*this, *order_it, quantity, price);
+        }
         // TODO find a better way for knowing if the order is to be deleted
         if (quantity == order_it->leaves_quantity()) {
             // TODO report both execute, then remove if it's fully executed?
-            event_handler().template on_remove_order<type, side>(*this, *order_it);
+            if constexpr (should_report_execution<is_trade, handlers::EventBits::RemoveOrder>()) {
+                event_handler().template on_remove_order<type, side>(*this, *order_it);
+            }
             // The order is fully executed and removed from the level
             orders().erase(order_it->id());
         }
@@ -179,7 +212,9 @@ public:
 
         auto valid_level_it = level_it;
         if (level.is_empty()) {
-            event_handler().template on_remove_level<type, side>(*this, level_price);
+            if constexpr (should_report_execution<is_trade, handlers::EventBits::RemoveLevel>()) {
+                event_handler().template on_remove_level<type, side>(*this, level_price);
+            }
             auto& price_levels = levels<type, side>();
             ++valid_level_it;
             valid_order_it = valid_level_it->second.begin();
@@ -207,7 +242,9 @@ public:
         auto level_it = levels.find(price);
         if (level_it == levels.end()) {
             // Price level doesn't exist and we need to create a new one
-            event_handler().template on_add_level<type, side>(*this, price);
+            if constexpr (should_report<handlers::EventBits::AddLevel>()) {
+                event_handler().template on_add_level<type, side>(*this, price);
+            }
             auto [new_it, success] = levels.add_level(price);
             level_it = new_it;
             assert(success && "Price level already exists, but you think it doesn't!");
@@ -215,6 +252,52 @@ public:
         return level_it;
     }
 
+    // The best limit level that has visible volume, skipping the levels
+    //  of hidden orders only. Returns the end of the side if there's none.
+    template <OrderSide side>
+    [[nodiscard]] constexpr auto best_visible_level() const noexcept {
+        auto& levels = this->template levels<OrderType::LIMIT, side>();
+        auto it = this->template levels<OrderType::LIMIT>().template best<side>();
+        while (int(it != levels.end()) && int(it->second.visible_volume() == Quantity { 0 })) {
+            ++it;
+        }
+        return it;
+    }
+
+    [[nodiscard]] constexpr Quote quote() const noexcept {
+        Quote quote { .last_bid_price = _last_bid_price, .last_ask_price = _last_ask_price };
+        if (auto it = best_visible_level<OrderSide::BUY>(); it != bids().end()) {
+            quote.bid_price = it->first;
+            quote.bid_volume = it->second.visible_volume();
+        }
+        if (auto it = best_visible_level<OrderSide::SELL>(); it != asks().end()) {
+            quote.ask_price = it->first;
+            quote.ask_volume = it->second.visible_volume();
+        }
+        return quote;
+    }
+
+    /*
+     * Makes the book keep the slot up to date with its quote, so that other
+     *  threads can read it (see ds::SeqLock) without going through the
+     *  engine. The slot is owned by the caller and has to outlive the book,
+     *  and nullptr turns the publishing off, which is the default.
+     */
+    constexpr void attach_quote(QuoteSlot* quote) noexcept {
+        _quote = quote;
+        publish_quote();
+    }
+
+    // Stores the quote into the attached slot, if any, only if it has changed,
+    //  so that the readers' copy of the cache line stays valid when it can.
+    constexpr void publish_quote() noexcept {
+        if (_quote == nullptr) return;
+        auto current = quote();
+        if (current != _quote->peek()) {
+            _quote->store(current);
+        }
+    }
+
     template <OrderSide side>
     [[nodiscard]] constexpr Price get_market_price() const noexcept {
         if constexpr (side == OrderSide::BUY) {
@@ -309,6 +392,30 @@ public:
         clear_levels<OrderType::TRAILING_STOP>();
     }
 
+    template <typename Func>
+    constexpr void for_each_order(Func&& func) noexcept {
+        auto visit = [&] <OrderType type, OrderSide side> {
+            for (auto& [_, level] : levels<type, side>()) {
+                for (auto order_it = level.begin(); order_it != level.end(); ++order_it) {
+                    func(OrderIterator { order_it });
+                }
+            }
+        };
+        visit.template operator()<OrderType::LIMIT, OrderSide::BUY>();
+        visit.template operator()<OrderType::LIMIT, OrderSide::SELL>();
+        visit.template operator()<OrderType::STOP, OrderSide::BUY>();
+        visit.template operator()<OrderType::STOP, OrderSide::SELL>();
+        visit.template operator()<OrderType::TRAILING_STOP, OrderSide::BUY>();
+        visit.template operator()<OrderType::TRAILING_STOP, OrderSide::SELL>();
+    }
+
+    // Points the orderbook to the order index and the event handler of the
+    //  matching engine that owns it. Used when a book changes hands.
+    constexpr void attach(HashMap<OrderId, OrderIterator>* orders, EventHandler* event_handler) noexcept {
+        _orders = orders;
+        _event_handler = event_handler;
+    }
+
     [[nodiscard]] constexpr auto& symbol() const noexcept { return _symbol; }
 
     [[nodiscard]] constexpr auto& symbol_id() const noexcept { return symbol().id; }
@@ -332,11 +439,13 @@ private:
         auto& levels = this->template levels<type, side>();
         assert(level_it != levels.end());
 
-        if constexpr (should_report()) {
-            // TODO if unlinking then adding to the same level, no need to remove it then add it again.
-            //  Both for speed and for causing less events
+        // TODO if unlinking then adding to the same level, no need to remove it then add it again.
+        //  Both for speed and for causing less events
+        if constexpr (should_report<handlers::EventBits::RemoveOrder>()) {
             event_handler().template on_remove_order<type, side>(*this, *order_it);
+        }
 
+        if constexpr (should_report<handlers::EventBits::RemoveLevel>()) {
             if (level_it->second.is_empty()) {
                 event_handler().template on_remove_level<type, side>(*this, level_it->first);
             }
@@ -349,7 +458,9 @@ private:
         }
 
         if (level_it->second.is_empty()) {
-            event_handler().template on_remove_level<type, side>(*this, level_it->first);
+            if constexpr (should_report<handlers::EventBits::RemoveLevel>()) {
+                event_handler().template on_remove_level<type, side>(*this, level_it->first);
+            }
             // Is removing levels with total_quantity == 0 an optimization or pessimization?
             // If you're not going to remove it, remember to consider levels with size == 0
             //  non-present, and not count a Levels struct with multiple 0-size levels not empty
@@ -375,13 +486,20 @@ private:
 
     constexpr auto& orders() noexcept { return *_orders; }
 
+    // Use this to help the compiler determine at compile-time that
+    //  there is no need to call the event handler, or to compute
+    //  its arguments. Even though it will probably figure it out for
+    //  empty callbacks, since we're only storing a pointer to the
+    //  handler, there is a possibility that it won't.
+    template <handlers::EventMask events>
     [[nodiscard]] constexpr static bool should_report() noexcept {
-        // Use this to help the compiler determine at compile-time that
-        //  there is no need to call the event handler. Even though it
-        //  will probably figure it out, since we're only storing a pointer
-        //  to the handler, there is a possibility that it won't.
-        // TODO figure out if this is actually useful
-        return !std::is_same_v<EventHandler, handlers::NullEventHandler>;
+        return handlers::reports<EventHandler>(events);
+    }
+
+    // The events of an execution that's part of a trade are its details
+    template <bool is_trade, handlers::EventMask events>
+    [[nodiscard]] constexpr static bool should_report_execution() noexcept {
+        return should_report<events>() && (!is_trade || handlers::reports_trade_details<EventHandler>());
     }
 
     constexpr auto& event_handler() const noexcept {
@@ -389,9 +507,9 @@ private:
         return *_event_handler;
     }
 
-    PriceLevels       <Order> _price_levels;
-    StopLevels        <Order> _stop_levels;
-    TrailingStopLevels<Order> _trailing_stop_levels;
+    PriceLevels       <Order, ListType> _price_levels;
+    StopLevels        <Order, ListType> _stop_levels;
+    TrailingStopLevels<Order, ListType> _trailing_stop_levels;
 
     HashMap<OrderId, OrderIterator>* _orders;
 
@@ -399,6 +517,8 @@ private:
 
     EventHandler* _event_handler;
 
+    QuoteSlot* _quote = nullptr;
+
     Price _last_bid_price = Price::min();
     Price _last_ask_price = Price::max();
 
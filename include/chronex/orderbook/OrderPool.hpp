@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+
+#include <chronex/concepts/Order.hpp>
+
+#include <chronex/data-structures/Slab.hpp>
+
+#include <chronex/orderbook/Order.hpp>
+#include <chronex/orderbook/levels/Level.hpp>
+
+namespace chronex {
+
+// The index of a slot in the OrderPool. This is all that
+//  needs to cross a queue between a producer and the engine.
+struct OrderHandle {
+    uint32_t index;
+    constexpr bool operator==(const OrderHandle &) const noexcept = default;
+};
+
+/*
+ * A pre-allocated slab of level nodes, shared by the producers (gateways,
+ *  decoders, ...) and the engine. A producer builds the order directly in a
+ *  free node and hands the engine only the node's index. If the order rests,
+ *  the engine links the very same node into the level (see
+ *  MatchingEngine::adopt_order), and when the order is done, the node goes
+ *  back to the pool. The engine also takes the nodes of the orders it adds
+ *  by value from here, so nothing is allocated from socket to book as long
+ *  as the pool has free nodes (it falls back to the heap otherwise).
+ *
+ * Only the engines whose levels use PooledList link the nodes as-is. There
+ *  can be one pool per order type at a time, and it must outlive the
+ *  engines and books using it, with all of its nodes given back.
+ */
+template <concepts::Order Order = Order>
+class OrderPool {
+public:
+
+    using ListType = PooledList<Order>;
+    using Node = typename ListType::node_type;
+    using OrderIterator = typename ListType::iterator;
+
+    explicit OrderPool(const uint32_t capacity)
+        : _slab(std::make_unique<ds::Slab<Node>>(capacity)) {
+        ds::SlabAllocator<Node>::install(_slab.get());
+    }
+
+    OrderPool(const OrderPool&) = delete;
+    OrderPool& operator=(const OrderPool&) = delete;
+
+    // The books and the queues must be done with the nodes by now
+    ~OrderPool() {
+        assert(_slab->free_count() == _slab->capacity() && "Uninstalling an OrderPool while its nodes are in use");
+        ds::SlabAllocator<Node>::install(nullptr);
+    }
+
+    [[nodiscard]] uint32_t capacity() const noexcept { return _slab->capacity(); }
+
+    /*
+     * Builds the order in a free node from what `make` returns (e.g. a call
+     *  to Order::limit), without moving it around. Safe to call from any
+     *  number of threads. Returns std::nullopt if the pool is exhausted.
+     */
+    template <typename Func>
+    [[nodiscard]] std::optional<OrderHandle> try_emplace(Func&& make) {
+        auto* node = _slab->try_acquire();
+        if (node == nullptr) return std::nullopt;
+        std::construct_at(node, std::in_place, std::forward<Func>(make));
+        return OrderHandle { _slab->index_of(node) };
+    }
+
+    [[nodiscard]] Order& operator[](const OrderHandle handle) noexcept { return node(handle)->data(); }
+
+    [[nodiscard]] const Order& operator[](const OrderHandle handle) const noexcept { return node(handle)->data(); }
+
+    [[nodiscard]] OrderIterator iterator(const OrderHandle handle) const noexcept { return OrderIterator { node(handle) }; }
+
+    // Gives back an order that was never handed to the engine (e.g. rejected)
+    void release(const OrderHandle handle) noexcept { ListType::dispose(iterator(handle)); }
+
+    // The pool the handles in a process refer to
+    [[nodiscard]] static OrderIterator installed_iterator(const OrderHandle handle) noexcept {
+        auto* slab = ds::SlabAllocator<Node>::installed();
+        assert(slab != nullptr && "No OrderPool is installed");
+        return OrderIterator { slab->at(handle.index) };
+    }
+
+    static void release_installed(const OrderHandle handle) noexcept { ListType::dispose(installed_iterator(handle)); }
+
+private:
+
+    [[nodiscard]] Node* node(const OrderHandle handle) const noexcept { return _slab->at(handle.index); }
+
+    std::unique_ptr<ds::Slab<Node>> _slab;
+};
+
+}
@@ -208,6 +208,11 @@ constexpr bool is_stop(const OrderType type) noexcept {
            (static_cast<uint8_t>(type) & OrderTypeBits::StopLimit);
 }
 
+// Limit orders, and the stop orders that become limit orders when triggered
+constexpr bool has_limit_price(const OrderType type) noexcept {
+    return static_cast<uint8_t>(type) & (OrderTypeBits::Limit | OrderTypeBits::StopLimit);
+}
+
 template <OrderType type>
 [[nodiscard]] constexpr OrderType get_triggered() noexcept {
     if constexpr (type == OrderType::STOP || type == OrderType::TRAILING_STOP) {
@@ -224,6 +229,14 @@ struct OrderId {
 
     static constexpr OrderId invalid() noexcept { return OrderId { std::numeric_limits<decltype(value)>::max() }; }
 };
+
+struct AccountId {
+    uint32_t value;
+    explicit constexpr AccountId(const uint32_t _value) noexcept : value(_value) { }
+    constexpr bool operator==(const AccountId &) const noexcept = default;
+
+    static constexpr AccountId invalid() noexcept { return AccountId { std::numeric_limits<decltype(value)>::max() }; }
+};
 template <OrderSide side>
 static constexpr auto opposite_side() noexcept {
     if constexpr (side == OrderSide::BUY) {
@@ -253,6 +266,13 @@ namespace std {
         }
     };
 
+    template <>
+    struct hash<chronex::AccountId> {
+        size_t operator()(const chronex::AccountId &id) const noexcept {
+            return std::hash<decltype(id.value)>{}(id.value);
+        }
+    };
+
     template <>
     struct hash<chronex::Price> {
         size_t operator()(const chronex::Price &price) const noexcept {
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <chronex/data-structures/SeqLock.hpp>
+
+#include <chronex/orderbook/OrderUtils.hpp>
+
+#include <chronex/utils/Threading.hpp>
+
+namespace chronex {
+
+// The top of a book as seen from outside of the engine. An empty side has the
+//  same price as an empty side of the book (min for bids, max for asks) and
+//  no volume. The last prices are the prices of the last executions on each
+//  side, with the same defaults.
+struct Quote {
+    Price bid_price = Price::min();
+    Quantity bid_volume { 0 };
+    Price ask_price = Price::max();
+    Quantity ask_volume { 0 };
+
+    Price last_bid_price = Price::min();
+    Price last_ask_price = Price::max();
+
+    constexpr bool operator==(const Quote&) const noexcept = default;
+};
+
+// Written by the engine's thread, read by anyone (see OrderBook::attach_quote)
+using QuoteSlot = ds::SeqLock<Quote>;
+
+// The quote and its sequence share a single cache line
+static_assert(sizeof(QuoteSlot) == utils::CacheLineSize);
+
+}
@@ -0,0 +1,244 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include <chronex/Symbol.hpp>
+
+#include <chronex/concepts/Order.hpp>
+
+#include <chronex/handlers/EventRecord.hpp>
+#include <chronex/handlers/NullEventHandler.hpp>
+
+#include <chronex/orderbook/Order.hpp>
+#include <chronex/orderbook/OrderBook.hpp>
+#include <chronex/orderbook/OrderUtils.hpp>
+
+namespace chronex {
+
+/*
+ * Mirrors the orderbooks of a matching engine from the records of its
+ *  events (see handlers::BinaryRingEventHandler and EventBusEventHandler),
+ *  e.g. in another thread or process that serves queries on the books, so
+ *  that the engine doesn't have to. The books are the same OrderBook and
+ *  Levels as the engine's, holding the same orders in the same priority,
+ *  but nothing is ever matched or triggered here: the engine already did
+ *  it, and the records tell how it turned out.
+ *
+ * Applying a record costs a lookup of the order and of its level at most,
+ *  which is less than the engine's operation that reported it, so that a
+ *  single core can keep up with the engine.
+ *
+ * The records have to be all the orderbook and order events (the level
+ *  and match events are skipped), in order, starting from either the start
+ *  of the engine or a snapshot (see handlers::serve_snapshot). Trades
+ *  without their details aren't enough. How the engine's reports map to
+ *  the books:
+ *  - Unlinking an order is reported as removing it, and linking it back as
+ *    adding it, which is how modified and triggered stop limit orders move.
+ *  - A re-priced trailing stop order is reported as removed, then as having
+ *    its stop price updated, which is where it's added back.
+ *  - A triggered stop order leaves its stop level right away. What happens
+ *    to it afterwards happens outside of the books, until it's added again.
+ *  - Executions, reductions, and removals of orders that aren't in a book
+ *    (e.g. of an incoming order) are skipped.
+ */
+template <
+    concepts::Order Order = Order,
+    template <typename, typename> typename HashMap = unordered_map
+>
+class ReplicaOrderBooks {
+public:
+
+    using OrderBook = chronex::OrderBook<Order, handlers::NullEventHandler, HashMap>;
+    using OrderIterator = typename OrderBook::OrderIterator;
+
+    ReplicaOrderBooks() = default;
+
+    // The books point to the order index and the handler of the replica
+    ReplicaOrderBooks(const ReplicaOrderBooks&) = delete;
+    ReplicaOrderBooks& operator=(const ReplicaOrderBooks&) = delete;
+    ReplicaOrderBooks(ReplicaOrderBooks&&) = delete;
+    ReplicaOrderBooks& operator=(ReplicaOrderBooks&&) = delete;
+
+    ~ReplicaOrderBooks() = default;
+
+    void apply(const handlers::EventRecord& record) noexcept {
+        using handlers::EventType;
+        switch (record.event) {
+            case EventType::ADD_NEW_ORDERBOOK:
+            case EventType::ADD_ORDERBOOK:
+                add_orderbook(record);
+                break;
+            case EventType::REMOVE_ORDERBOOK:
+                remove_orderbook(record);
+                break;
+            case EventType::ADD_ORDER:
+                add_order(record, record.type);
+                break;
+            case EventType::REMOVE_ORDER:
+            case EventType::TRIGGER_STOP_ORDER:
+                remove_order(record);
+                break;
+            case EventType::REDUCE_ORDER:
+                reduce_order(record);
+                break;
+            case EventType::EXECUTE_ORDER:
+                execute_order(record);
+                break;
+            case EventType::UPDATE_STOP_PRICE:
+                // Reported after the order is unlinked and linked back at its new stop price
+                remove_order(record);
+                add_order(record, record.order.type);
+                break;
+            default:
+                // Levels follow their orders, and the rest don't change the books
+                break;
+        }
+    }
+
+    void apply(const std::span<const handlers::EventRecord> records) noexcept {
+        for (auto& record : records) {
+            apply(record);
+        }
+    }
+
+    // nullptr if there is no orderbook for the symbol
+    [[nodiscard]] const OrderBook* orderbook(const SymbolId id) const noexcept {
+        if (id.value >= _orderbooks.size() || !_orderbooks[id.value].is_valid()) return nullptr;
+        return &_orderbooks[id.value];
+    }
+
+    // nullptr if the order isn't in any of the books
+    [[nodiscard]] const Order* order(const OrderId id) const noexcept {
+        auto it = _orders.find(id);
+        return it == _orders.end() ? nullptr : &*it->second;
+    }
+
+    [[nodiscard]] size_t orders_count() const noexcept { return _orders.size(); }
+
+    // Drops all of the books, e.g. before starting over from a snapshot
+    void clear() noexcept {
+        for (auto& orderbook : _orderbooks) {
+            orderbook.clear();
+        }
+        _orderbooks.clear();
+    }
+
+    template <typename Func>
+    void for_each_orderbook(Func&& func) const {
+        for (auto& orderbook : _orderbooks) {
+            if (orderbook.is_valid()) {
+                func(orderbook);
+            }
+        }
+    }
+
+private:
+
+    // Calls func with the levels type and side of the order as template arguments
+    template <typename Func>
+    static void resolve_levels_and_side(const OrderType type, const OrderSide side, Func&& func) noexcept {
+        auto resolve_side = [&] <OrderType levels_type> {
+            if (side == OrderSide::BUY) {
+                func.template operator()<levels_type, OrderSide::BUY>();
+            } else {
+                func.template operator()<levels_type, OrderSide::SELL>();
+            }
+        };
+        if (is_limit(type)) {
+            resolve_side.template operator()<OrderType::LIMIT>();
+        } else if (is_trailing(type)) {
+            resolve_side.template operator()<OrderType::TRAILING_STOP>();
+        } else {
+            resolve_side.template operator()<OrderType::STOP>();
+        }
+    }
+
+    // Calls func with the book, the order, and its level, if the order is in a book
+    template <typename Func>
+    void find_order(const handlers::EventRecord& record, Func&& func) noexcept {
+        auto it = _orders.find(OrderId { record.order_id });
+        if (it == _orders.end()) return;
+        auto order_it = it->second;
+        auto& orderbook = _orderbooks[record.symbol_id];
+        resolve_levels_and_side(order_it->type(), order_it->side(), [&] <OrderType type, OrderSide side> {
+            auto level_it = orderbook.template levels<type, side>().find(order_it->template key_price<type>());
+            func.template operator()<type, side>(orderbook, order_it, level_it);
+        });
+    }
+
+    [[nodiscard]] OrderBook* find_orderbook(const uint32_t symbol_id) noexcept {
+        if (symbol_id >= _orderbooks.size() || !_orderbooks[symbol_id].is_valid()) return nullptr;
+        return &_orderbooks[symbol_id];
+    }
+
+    void add_orderbook(const handlers::EventRecord& record) noexcept {
+        if (_orderbooks.size() <= record.symbol_id) {
+            _orderbooks.resize(record.symbol_id + 1);
+        }
+        // A snapshot starts the book over
+        auto& slot = _orderbooks[record.symbol_id];
+        slot.clear();
+        slot = OrderBook { &_orders, Symbol { record.symbol_id, record.symbol_name }, &_event_handler };
+    }
+
+    void remove_orderbook(const handlers::EventRecord& record) noexcept {
+        if (record.symbol_id >= _orderbooks.size()) return;
+        auto& orderbook = _orderbooks[record.symbol_id];
+        orderbook.clear();
+        orderbook.invalidate();
+    }
+
+    void add_order(const handlers::EventRecord& record, const OrderType type) noexcept {
+        auto* orderbook = find_orderbook(record.symbol_id);
+        if (orderbook == nullptr) return;
+        resolve_levels_and_side(type, record.side, [&] <OrderType levels_type, OrderSide side> {
+            orderbook->template add_order<levels_type, side>(handlers::make_order<Order>(record.order, SymbolId { record.symbol_id }));
+        });
+    }
+
+    void remove_order(const handlers::EventRecord& record) noexcept {
+        find_order(record, [] <OrderType type, OrderSide side> (OrderBook& orderbook, OrderIterator order_it, auto level_it) {
+            orderbook.template remove_order<type, side>(order_it, level_it);
+        });
+    }
+
+    void reduce_order(const handlers::EventRecord& record) noexcept {
+        // A reduction to 0 is reported as a removal
+        find_order(record, [&] <OrderType type, OrderSide side> (OrderBook& orderbook, OrderIterator order_it, auto level_it) {
+            (void)orderbook.template reduce_order<type, side>(order_it, level_it, Quantity { record.quantity });
+        });
+    }
+
+    void execute_order(const handlers::EventRecord& record) noexcept {
+        auto price = Price { record.price };
+        auto quantity = Quantity { record.quantity };
+
+        // The engine keeps the last price of both sides of a trade, including the incoming order's
+        if (auto* orderbook = find_orderbook(record.symbol_id); orderbook != nullptr) {
+            if (record.side == OrderSide::BUY) {
+                orderbook->template update_last_price<OrderSide::BUY>(price);
+            } else {
+                orderbook->template update_last_price<OrderSide::SELL>(price);
+            }
+        }
+
+        find_order(record, [&] <OrderType type, OrderSide side> (OrderBook& orderbook, OrderIterator order_it, auto level_it) {
+            if (quantity == order_it->leaves_quantity()) {
+                // The removal that follows is skipped, the order is gone by then
+                orderbook.template remove_order<type, side>(order_it, level_it);
+            } else {
+                (void)orderbook.template levels<type, side>().execute_quantity(order_it, level_it, quantity);
+            }
+        });
+    }
+
+    std::vector<OrderBook> _orderbooks;
+
+    HashMap<OrderId, OrderIterator> _orders { };
+
+    handlers::NullEventHandler _event_handler;
+};
+
+}
@@ -3,6 +3,7 @@
 #include <chronex/orderbook/Order.hpp>
 
 #include <chronex/data-structures/LinkedList.hpp>
+#include <chronex/data-structures/Slab.hpp>
 
 namespace chronex {
 
@@ -108,7 +109,7 @@ private:
         orders.link_node_back(it);
     }
 
-    template <concepts::Order, concepts::UniTypeComparator<Price>>
+    template <concepts::Order, concepts::UniTypeComparator<Price>, typename>
     friend class Levels;
 
     // TODO: experiment with other types including different lists and arrays as well
@@ -118,4 +119,11 @@ private:
     Quantity _hidden_volume = Quantity { 0 };
 };
 
-}
\ No newline at end of file
+// The list of the levels whose nodes come from the installed OrderPool when
+//  there is one, so that orders built by other threads can be linked into
+//  the levels as-is. Opt-in, see MatchingEngine.
+template <
+    concepts::Order Order = Order
+> using PooledList = ds::LinkedList<Order, ds::SlabAllocator>;
+
+}
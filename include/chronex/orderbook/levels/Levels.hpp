@@ -16,11 +16,12 @@ namespace chronex {
 
 template <
     concepts::Order Order,
-    concepts::UniTypeComparator<Price> Comp
+    concepts::UniTypeComparator<Price> Comp,
+    typename ListType = ds::LinkedList<Order>
 >
 class Levels {
 
-    using LevelType = Level<Order>;
+    using LevelType = Level<Order, ListType>;
     using ContainerType = std::map<Price, LevelType, Comp>;
 
     // TODO make everything private so that the levels are not manipulated directly from the matching engine
@@ -166,11 +167,13 @@ private:
 };
 
 template <
-    concepts::Order Order
-> using AscendingLevels  = Levels<Order, std::less<>>;
+    concepts::Order Order,
+    typename ListType = ds::LinkedList<Order>
+> using AscendingLevels  = Levels<Order, std::less<>, ListType>;
 
 template <
-    concepts::Order Order
-> using DescendingLevels = Levels<Order, std::greater<>>;
+    concepts::Order Order,
+    typename ListType = ds::LinkedList<Order>
+> using DescendingLevels = Levels<Order, std::greater<>, ListType>;
 
 }
\ No newline at end of file
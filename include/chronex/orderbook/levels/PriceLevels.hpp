@@ -5,19 +5,20 @@
 namespace chronex {
 
 template <
-    concepts::Order OrderType
+    concepts::Order OrderType,
+    typename ListType = ds::LinkedList<OrderType>
 >
 struct PriceLevels {
 public:
 
     // TODO remove this
-    using LevelQueueDataType = typename DescendingLevels<OrderType>::LevelQueueDataType;
+    using LevelQueueDataType = typename DescendingLevels<OrderType, ListType>::LevelQueueDataType;
 
     PriceLevels() = default;
 
     // Or DescendingLevels. It doesn't matter.
-    using OrderIterator = typename AscendingLevels<OrderType>::OrderIterator;
-    using ConstOrderIterator = typename AscendingLevels<OrderType>::ConstOrderIterator;
+    using OrderIterator = typename AscendingLevels<OrderType, ListType>::OrderIterator;
+    using ConstOrderIterator = typename AscendingLevels<OrderType, ListType>::ConstOrderIterator;
 
     template <typename Self>
     constexpr auto& bids(this Self&& self) noexcept { return self._bids; }
@@ -36,13 +37,13 @@ public:
         }
     }
 
-    template <typename Self, OrderSide side>
-    constexpr auto best(this Self&& self) noexcept { return self.template levels<side>.best(); }
+    template <OrderSide side, typename Self>
+    constexpr auto best(this Self&& self) noexcept { return self.template levels<side>().best(); }
 
 private:
 
-    DescendingLevels<OrderType> _bids;
-    AscendingLevels <OrderType> _asks;
+    DescendingLevels<OrderType, ListType> _bids;
+    AscendingLevels <OrderType, ListType> _asks;
 };
 
 };
\ No newline at end of file
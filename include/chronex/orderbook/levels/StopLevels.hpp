@@ -5,9 +5,10 @@
 namespace chronex {
 
 template <
-    concepts::Order OrderType
+    concepts::Order OrderType,
+    typename ListType = ds::LinkedList<OrderType>
 >
-struct StopLevels : public PriceLevels<OrderType> {
-    using PriceLevels<OrderType>::PriceLevels;
+struct StopLevels : public PriceLevels<OrderType, ListType> {
+    using PriceLevels<OrderType, ListType>::PriceLevels;
 };
 }
\ No newline at end of file
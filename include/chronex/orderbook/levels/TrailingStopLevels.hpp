@@ -5,10 +5,11 @@
 namespace chronex {
 
 template <
-    concepts::Order OrderType
+    concepts::Order OrderType,
+    typename ListType = ds::LinkedList<OrderType>
 >
-struct TrailingStopLevels : public StopLevels<OrderType> {
-    using StopLevels<OrderType>::StopLevels;
+struct TrailingStopLevels : public StopLevels<OrderType, ListType> {
+    using StopLevels<OrderType, ListType>::StopLevels;
 };
 
 }
@@ -0,0 +1,334 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include <chronex/concepts/EventHandler.hpp>
+#include <chronex/concepts/Order.hpp>
+
+#include <chronex/data-structures/SPSCQueue.hpp>
+
+#include <chronex/handlers/EventRecord.hpp>
+
+#include <chronex/matching/Commands.hpp>
+#include <chronex/matching/MatchingEngine.hpp>
+
+#include <chronex/orderbook/OrderPool.hpp>
+
+#include <chronex/utils/Threading.hpp>
+
+namespace chronex::pipeline {
+
+struct StageConfig {
+    // The stage's thread is pinned to this core when provided
+    std::optional<size_t> core { };
+    // How many elements the stage takes off its input ring at once. The
+    //  outputs of a batch are published to the next ring with one store.
+    size_t batch_size = 64;
+};
+
+struct PipelineConfig {
+    // Capacity of each of the rings. Must be a power of two
+    size_t queue_capacity = 1 << 16;
+
+    StageConfig decode { };
+    StageConfig validate { };
+    StageConfig match { };
+    StageConfig publish { };
+};
+
+// The default validation stage. Does the checks
+//  of Order::is_valid, but off the engine's core,
+//  and without asserting (see handlers::is_valid_order).
+template <concepts::Order Order>
+struct OrderValidator {
+    [[nodiscard]] bool operator()(const commands::Command<Order>& command) const noexcept {
+        if (auto* add = std::get_if<commands::AddOrder<Order>>(&command)) {
+            return is_valid(add->order);
+        }
+        if (auto* replace = std::get_if<commands::ReplaceOrder<Order>>(&command)) {
+            return is_valid(replace->order);
+        }
+        if (auto* adopt = std::get_if<commands::AdoptOrder>(&command)) {
+            if (is_valid(*OrderPool<Order>::installed_iterator(adopt->handle))) return true;
+            // Rejected orders never reach the engine to be freed
+            OrderPool<Order>::release_installed(adopt->handle);
+            return false;
+        }
+        return true;
+    }
+
+    [[nodiscard]] static bool is_valid(const Order& order) noexcept {
+        return int(order.id() != OrderId::invalid()) & int(handlers::is_valid_order(order));
+    }
+};
+
+/*
+ * Splits the processing of an order flow into four stages, each running
+ *  on its own thread (and core, if configured), connected by SPSC rings:
+ *
+ *   input --> decode --> validate --> match --> publish
+ *
+ *  - decode:   `decoder(Input&, emit)` turns a raw input (a wire message,
+ *              a frame with several messages, ...) into zero or more
+ *              engine commands by calling `emit(Command&&)`.
+ *  - validate: `validator(Command&)` returns whether the command is
+ *              allowed to reach the engine. Rejected commands are dropped.
+ *  - match:    the only stage that touches the MatchingEngine. Its event
+ *              handler is constructed from a pointer to the events ring,
+ *              and is expected to push (preferably small, POD) events into
+ *              it instead of formatting anything on this core. If the
+ *              handler has a `flush()` member, it's called after each batch,
+ *              which lets it defer its ring commits to once per batch.
+ *  - publish:  `publisher(Event&)` consumes the events.
+ *
+ * submit() is meant to be called from a single thread. The engine can
+ *  only be inspected from the outside after drain() and before the
+ *  next submission.
+ */
+template <
+    typename Input,
+    typename Event,
+    concepts::Order Order,
+    concepts::EventHandler<OrderType> EventHandler,
+    typename Decoder,
+    typename Validator,
+    typename Publisher
+>
+class Pipeline {
+public:
+
+    using Command = commands::Command<Order>;
+    using Engine = MatchingEngine<Order, EventHandler>;
+
+    Pipeline(Decoder decoder, Validator validator, Publisher publisher, PipelineConfig config = { })
+        : _config(std::move(config))
+        , _inputs(_config.queue_capacity)
+        , _decoded(_config.queue_capacity)
+        , _validated(_config.queue_capacity)
+        , _events(_config.queue_capacity)
+        , _engine(EventHandler{ &_events })
+        , _decoder(std::move(decoder))
+        , _validator(std::move(validator))
+        , _publisher(std::move(publisher)) {
+
+        // Started last, since they use all of the above
+        _decode_thread = std::jthread([this] (std::stop_token token) { run_decode(token); });
+        _validate_thread = std::jthread([this] (std::stop_token token) { run_validate(token); });
+        _match_thread = std::jthread([this] (std::stop_token token) { run_match(token); });
+        _publish_thread = std::jthread([this] (std::stop_token token) { run_publish(token); });
+    }
+
+    Pipeline(const Pipeline&) = delete;
+    Pipeline& operator=(const Pipeline&) = delete;
+
+    ~Pipeline() {
+        drain();
+        // Stop in the flow's order, each stage only
+        //  stops after the previous one has stopped
+        _decode_thread.request_stop();
+        _decode_thread.join();
+        _validate_thread.request_stop();
+        _validate_thread.join();
+        _match_thread.request_stop();
+        _match_thread.join();
+        _publish_thread.request_stop();
+        _publish_thread.join();
+    }
+
+    [[nodiscard]] bool try_submit(Input&& input) {
+        if (!_inputs.try_push(std::move(input))) return false;
+        ++_submitted;
+        return true;
+    }
+
+    void submit(Input&& input) {
+        _inputs.push(std::move(input));
+        ++_submitted;
+    }
+
+    // Blocks until everything submitted so far went through all of the stages
+    void drain() const noexcept {
+        wait_until_done(_decode_progress, _submitted);
+        wait_until_done(_validate_progress, _decode_progress.emitted.load(std::memory_order_acquire));
+        wait_until_done(_match_progress, _validate_progress.emitted.load(std::memory_order_acquire));
+
+        // The events of the commands applied so far are all in
+        //  the ring by now, and the publisher only releases the
+        //  slots of a batch after it's done processing it
+        utils::Backoff backoff;
+        while (!_events.is_empty()) {
+            backoff.pause();
+        }
+    }
+
+    [[nodiscard]] uint64_t submitted_count() const noexcept { return _submitted; }
+
+    // Commands that made it through the validation stage
+    [[nodiscard]] uint64_t accepted_count() const noexcept {
+        return _validate_progress.emitted.load(std::memory_order_acquire);
+    }
+
+    // Exact after drain(), might transiently over-count while the validation stage is running
+    [[nodiscard]] uint64_t rejected_count() const noexcept {
+        auto accepted = accepted_count();
+        return _validate_progress.done.load(std::memory_order_acquire) - accepted;
+    }
+
+    [[nodiscard]] Engine& engine() noexcept { return _engine; }
+
+    [[nodiscard]] const Engine& engine() const noexcept { return _engine; }
+
+private:
+
+    // Published by the stage after each batch. `emitted` is stored
+    //  before `done`, so reading `done` first gives a consistent pair.
+    struct alignas(utils::CacheLineSize) Progress {
+        std::atomic<uint64_t> done { 0 };
+        std::atomic<uint64_t> emitted { 0 };
+    };
+
+    static void wait_until_done(const Progress& progress, const uint64_t count) noexcept {
+        utils::Backoff backoff;
+        while (progress.done.load(std::memory_order_acquire) != count) {
+            backoff.pause();
+        }
+    }
+
+    /*
+     * The loop shared by all stages. `process` handles one element
+     *  and returns how many elements it emitted. `end_batch` runs
+     *  before the progress of the batch is published.
+     */
+    template <typename T, typename Process, typename EndBatch>
+    static void run_stage(
+        const std::stop_token& token,
+        ds::SPSCQueue<T>& input,
+        const StageConfig& config,
+        Progress& progress,
+        Process&& process,
+        EndBatch&& end_batch
+    ) {
+        if (config.core.has_value()) {
+            utils::pin_current_thread(*config.core);
+        }
+
+        uint64_t done = 0;
+        uint64_t emitted = 0;
+
+        utils::Backoff backoff;
+        while (!token.stop_requested()) {
+            auto count = input.consume([&] (T& element) {
+                emitted += process(element);
+            }, config.batch_size);
+
+            if (count == 0) {
+                backoff.pause();
+                continue;
+            }
+
+            backoff.reset();
+            end_batch();
+
+            done += count;
+            progress.emitted.store(emitted, std::memory_order_release);
+            progress.done.store(done, std::memory_order_release);
+        }
+    }
+
+    void run_decode(const std::stop_token& token) {
+        run_stage(token, _inputs, _config.decode, _decode_progress, [this] (Input& input) -> uint64_t {
+            uint64_t count = 0;
+            _decoder(input, [this, &count] (Command&& command) {
+                _decoded.emplace_deferred(std::move(command));
+                ++count;
+            });
+            return count;
+        }, [this] { _decoded.commit(); });
+    }
+
+    void run_validate(const std::stop_token& token) {
+        run_stage(token, _decoded, _config.validate, _validate_progress, [this] (Command& command) -> uint64_t {
+            if (!_validator(command)) return 0;
+            _validated.emplace_deferred(std::move(command));
+            return 1;
+        }, [this] { _validated.commit(); });
+    }
+
+    void run_match(const std::stop_token& token) {
+        run_stage(token, _validated, _config.match, _match_progress, [this] (Command& command) -> uint64_t {
+            commands::apply(_engine, std::move(command));
+            return 0;
+        }, [this] {
+            if constexpr (requires { _engine.event_handler().flush(); }) {
+                _engine.event_handler().flush();
+            }
+        });
+    }
+
+    void run_publish(const std::stop_token& token) {
+        run_stage(token, _events, _config.publish, _publish_progress, [this] (Event& event) -> uint64_t {
+            _publisher(event);
+            return 0;
+        }, [] { });
+    }
+
+    PipelineConfig _config;
+
+    ds::SPSCQueue<Input> _inputs;
+    ds::SPSCQueue<Command> _decoded;
+    ds::SPSCQueue<Command> _validated;
+    ds::SPSCQueue<Event> _events;
+
+    // Only touched by the match stage
+    Engine _engine;
+
+    Decoder _decoder;
+    Validator _validator;
+    Publisher _publisher;
+
+    // Written by the submitting thread only
+    uint64_t _submitted = 0;
+
+    Progress _decode_progress;
+    Progress _validate_progress;
+    Progress _match_progress;
+    Progress _publish_progress;
+
+    std::jthread _decode_thread;
+    std::jthread _validate_thread;
+    std::jthread _match_thread;
+    std::jthread _publish_thread;
+};
+
+// Spells out the types that can't be deduced from the stage functions
+template <
+    typename Input,
+    typename Event,
+    concepts::Order Order,
+    concepts::EventHandler<OrderType> EventHandler,
+    typename Decoder,
+    typename Validator,
+    typename Publisher
+>
+auto make_pipeline(Decoder&& decoder, Validator&& validator, Publisher&& publisher, PipelineConfig config = { }) {
+    using P = Pipeline<
+        Input, Event, Order, EventHandler,
+        std::decay_t<Decoder>, std::decay_t<Validator>, std::decay_t<Publisher>
+    >;
+    return std::make_unique<P>(
+        std::forward<Decoder>(decoder),
+        std::forward<Validator>(validator),
+        std::forward<Publisher>(publisher),
+        std::move(config)
+    );
+}
+
+}
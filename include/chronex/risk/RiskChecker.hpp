@@ -0,0 +1,292 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <variant>
+#include <vector>
+
+#include <chronex/Symbol.hpp>
+
+#include <chronex/concepts/Order.hpp>
+
+#include <chronex/matching/Commands.hpp>
+
+#include <chronex/orderbook/Order.hpp>
+#include <chronex/orderbook/OrderPool.hpp>
+#include <chronex/orderbook/OrderUtils.hpp>
+
+namespace chronex::risk {
+
+enum class RiskResult : uint8_t {
+    ACCEPTED,
+    QUANTITY_TOO_LARGE,
+    PRICE_OUTSIDE_COLLAR,
+    NOTIONAL_LIMIT_EXCEEDED,
+    UNKNOWN_ACCOUNT
+};
+
+struct RiskLimits {
+    Quantity max_order_quantity = Quantity::max();
+    // How far (in basis points) a buy can be above the best ask,
+    //  or a sell below the best bid. 0 disables the collars.
+    uint64_t price_collar_bps = 0;
+    // The default limit of each account. Can be overridden per account.
+    uint64_t max_open_notional = std::numeric_limits<uint64_t>::max();
+};
+
+/*
+ * Pre-trade checks for orders that are about to be handed to the matching
+ *  engine: max order size, price collars around the market price, and
+ *  per-account open notional.
+ *
+ * The open notional of an account is the quantity times the limit price of
+ *  its live orders. It's reserved here when an order is accepted, and is
+ *  released as the engine reports fills and removals (see
+ *  handlers::RiskEventHandler). Orders without a limit price (market and
+ *  stop orders) are only checked for size.
+ *
+ * Everything is kept in flat arrays indexed by account and symbol IDs,
+ *  sized upfront, so a check is a handful of loads and at most one atomic
+ *  add, without allocations. check() is meant to be called from a single
+ *  thread, while the releases can come from the engine's thread.
+ */
+template <concepts::Order Order = Order>
+class RiskChecker {
+public:
+
+    RiskChecker(const RiskLimits limits, const size_t accounts_count, const size_t symbols_count)
+        : _limits(limits)
+        , _accounts_count(accounts_count)
+        , _symbols_count(symbols_count)
+        , _notional_limits(accounts_count, limits.max_open_notional)
+        , _open_notional(std::make_unique<std::atomic<uint64_t>[]>(accounts_count))
+        , _reference_prices(std::make_unique<ReferencePrices[]>(symbols_count)) { }
+
+    [[nodiscard]] const RiskLimits& limits() const noexcept { return _limits; }
+
+    void set_notional_limit(const AccountId account, const uint64_t limit) noexcept {
+        assert(account.value < _accounts_count && "Account ID out of range");
+        _notional_limits[account.value] = limit;
+    }
+
+    [[nodiscard]] uint64_t open_notional(const AccountId account) const noexcept {
+        assert(account.value < _accounts_count && "Account ID out of range");
+        return _open_notional[account.value].load(std::memory_order_relaxed);
+    }
+
+    /*
+     * Checks the order against the market prices of the given book. Use this
+     *  when the checks run on the engine's thread, right before add_order.
+     */
+    template <typename OrderBook>
+    [[nodiscard]] RiskResult check(const Order& order, const OrderBook& orderbook) noexcept {
+        return check(
+            order,
+            orderbook.template get_market_price<OrderSide::BUY>(),
+            orderbook.template get_market_price<OrderSide::SELL>()
+        );
+    }
+
+    /*
+     * Checks modifying an order of the given book to a new price and leaves
+     *  quantity, on the engine's thread, right before modify_order. The
+     *  notional the order holds counts towards the new one, so only an
+     *  increase has to fit. Nothing is reserved here: the engine reports the
+     *  modify as a removal then an addition, which moves the notional over.
+     */
+    template <typename OrderBook>
+    [[nodiscard]] RiskResult check_modify(const Order& order, const Price price, const Quantity quantity, const OrderBook& orderbook) const noexcept {
+        if (quantity > _limits.max_order_quantity) {
+            return RiskResult::QUANTITY_TOO_LARGE;
+        }
+
+        if (!is_tracked(order)) {
+            return RiskResult::ACCEPTED;
+        }
+
+        auto bid = orderbook.template get_market_price<OrderSide::BUY>();
+        auto ask = orderbook.template get_market_price<OrderSide::SELL>();
+        if (!is_within_collar(order.is_buy_order(), price, bid, ask)) {
+            return RiskResult::PRICE_OUTSIDE_COLLAR;
+        }
+
+        auto amount = notional(price, quantity);
+        auto held = notional(order.price(), order.leaves_quantity());
+        if (int(amount > held) & int(!fits_notional_limit(order.account_id().value, amount - held))) {
+            return RiskResult::NOTIONAL_LIMIT_EXCEEDED;
+        }
+        return RiskResult::ACCEPTED;
+    }
+
+    /*
+     * Checks the order against the market prices last published for its
+     *  symbol with update_reference_prices. Use this when the checks run on
+     *  a different thread than the engine, and the book can't be read.
+     */
+    [[nodiscard]] RiskResult check(const Order& order) noexcept {
+        auto bid = Price::min();
+        auto ask = Price::max();
+        if (auto symbol = order.symbol_id().value; symbol < _symbols_count) {
+            bid = Price { _reference_prices[symbol].bid.load(std::memory_order_relaxed) };
+            ask = Price { _reference_prices[symbol].ask.load(std::memory_order_relaxed) };
+        }
+        return check(order, bid, ask);
+    }
+
+    template <typename OrderBook>
+    void update_reference_prices(const OrderBook& orderbook) noexcept {
+        auto symbol = orderbook.symbol_id().value;
+        if (symbol >= _symbols_count) return;
+        _reference_prices[symbol].bid.store(orderbook.template get_market_price<OrderSide::BUY>().value, std::memory_order_relaxed);
+        _reference_prices[symbol].ask.store(orderbook.template get_market_price<OrderSide::SELL>().value, std::memory_order_relaxed);
+    }
+
+    void release(const Order& order, const Quantity quantity) noexcept {
+        if (!is_tracked(order)) return;
+        auto amount = notional(order.price(), quantity);
+        if (amount == 0) return;
+        // Saturates, so that orders that bypassed the checks
+        //  can't wrap the counter of their account around
+        auto& open = _open_notional[order.account_id().value];
+        auto current = open.load(std::memory_order_relaxed);
+        while (!open.compare_exchange_weak(current, current - std::min(current, amount), std::memory_order_relaxed)) { }
+    }
+
+    void reserve(const Order& order, const Quantity quantity) noexcept {
+        if (!is_tracked(order)) return;
+        _open_notional[order.account_id().value].fetch_add(notional(order.price(), quantity), std::memory_order_relaxed);
+    }
+
+    // Whether the order counts towards the open notional of an account
+    [[nodiscard]] bool is_tracked(const Order& order) const noexcept {
+        return int(order.has_account()) & int(order.account_id().value < _accounts_count) & int(has_limit_price(order));
+    }
+
+    [[nodiscard]] static bool has_limit_price(const Order& order) noexcept {
+        // Market orders get a price assigned while matching
+        return int(!order.is_market_order()) & int(order.price() != Price::invalid());
+    }
+
+    [[nodiscard]] static uint64_t notional(const Price price, const Quantity quantity) noexcept {
+        uint64_t result;
+        if (__builtin_mul_overflow(price.value, quantity.value, &result)) {
+            return std::numeric_limits<uint64_t>::max();
+        }
+        return result;
+    }
+
+private:
+
+    [[nodiscard]] RiskResult check(const Order& order, const Price bid, const Price ask) noexcept {
+        if (order.leaves_quantity() > _limits.max_order_quantity) {
+            return RiskResult::QUANTITY_TOO_LARGE;
+        }
+
+        if (int(order.has_account()) & int(order.account_id().value >= _accounts_count)) {
+            return RiskResult::UNKNOWN_ACCOUNT;
+        }
+
+        if (!has_limit_price(order)) {
+            return RiskResult::ACCEPTED;
+        }
+
+        if (!is_within_collar(order, bid, ask)) {
+            return RiskResult::PRICE_OUTSIDE_COLLAR;
+        }
+
+        if (!order.has_account()) {
+            return RiskResult::ACCEPTED;
+        }
+
+        // Releases only decrease the counter, so reading then adding is
+        //  safe as long as there is a single thread doing the checks
+        auto account = order.account_id().value;
+        auto amount = notional(order.price(), order.leaves_quantity());
+        if (!fits_notional_limit(account, amount)) {
+            return RiskResult::NOTIONAL_LIMIT_EXCEEDED;
+        }
+
+        _open_notional[account].fetch_add(amount, std::memory_order_relaxed);
+        return RiskResult::ACCEPTED;
+    }
+
+    [[nodiscard]] bool fits_notional_limit(const uint32_t account, const uint64_t amount) const noexcept {
+        auto open = _open_notional[account].load(std::memory_order_relaxed);
+        return amount <= _notional_limits[account] && open <= _notional_limits[account] - amount;
+    }
+
+    [[nodiscard]] bool is_within_collar(const Order& order, const Price bid, const Price ask) const noexcept {
+        return is_within_collar(order.is_buy_order(), order.price(), bid, ask);
+    }
+
+    [[nodiscard]] bool is_within_collar(const bool is_buy, const Price price, const Price bid, const Price ask) const noexcept {
+        if (_limits.price_collar_bps == 0) return true;
+
+        // Only the aggressive direction is collared. Without an opposite
+        //  side there is nothing to compare with.
+        if (is_buy) {
+            if (ask == Price::max()) return true;
+            return price.value <= clipping_add(ask.value, collar_band(ask));
+        } else {
+            if (bid == Price::min()) return true;
+            return price.value >= clipping_sub(bid.value, collar_band(bid));
+        }
+    }
+
+    [[nodiscard]] uint64_t collar_band(const Price reference) const noexcept {
+        // Split to avoid overflowing for big prices
+        auto bps = _limits.price_collar_bps;
+        return reference.value / 10'000 * bps + reference.value % 10'000 * bps / 10'000;
+    }
+
+    struct ReferencePrices {
+        std::atomic<uint64_t> bid { Price::min().value };
+        std::atomic<uint64_t> ask { Price::max().value };
+    };
+
+    RiskLimits _limits;
+
+    size_t _accounts_count;
+    size_t _symbols_count;
+
+    std::vector<uint64_t> _notional_limits;
+    std::unique_ptr<std::atomic<uint64_t>[]> _open_notional;
+
+    std::unique_ptr<ReferencePrices[]> _reference_prices;
+};
+
+/*
+ * Runs the risk checks as the validation stage of a pipeline. Commands that
+ *  carry a new order are checked, the rest are passed through, except for
+ *  modifies: this stage doesn't see the orders in the book, so it can't
+ *  tell whether a modify raises the notional of an order, and refuses them.
+ *  Replacing an order is checked like a new order instead.
+ */
+template <concepts::Order Order = Order>
+struct RiskValidator {
+    [[nodiscard]] bool operator()(commands::Command<Order>& command) const noexcept {
+        if (auto* add = std::get_if<commands::AddOrder<Order>>(&command)) {
+            return risk->check(add->order) == RiskResult::ACCEPTED;
+        }
+        if (auto* replace = std::get_if<commands::ReplaceOrder<Order>>(&command)) {
+            return risk->check(replace->order) == RiskResult::ACCEPTED;
+        }
+        if (int(std::holds_alternative<commands::ModifyOrder>(command)) | int(std::holds_alternative<commands::MitigateOrder>(command))) {
+            return false;
+        }
+        if (auto* adopt = std::get_if<commands::AdoptOrder>(&command)) {
+            if (risk->check(*OrderPool<Order>::installed_iterator(adopt->handle)) == RiskResult::ACCEPTED) return true;
+            OrderPool<Order>::release_installed(adopt->handle);
+            return false;
+        }
+        return true;
+    }
+
+    RiskChecker<Order>* risk;
+};
+
+}
@@ -0,0 +1,603 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <climits>
+#include <sys/epoll.h>
+#include <sys/uio.h>
+
+#include <chronex/concepts/Order.hpp>
+
+#include <chronex/handlers/EventRecord.hpp>
+
+#include <chronex/ipc/Epoll.hpp>
+#include <chronex/ipc/EventBus.hpp>
+#include <chronex/ipc/UnixSocket.hpp>
+
+#include <chronex/orderbook/Order.hpp>
+#include <chronex/orderbook/ReplicaOrderBooks.hpp>
+
+#include <chronex/store/Protocol.hpp>
+
+namespace chronex::store {
+
+struct OrderBooksStoreConfig {
+    // The levels per side of a DEPTH response, at most
+    size_t depth = 10;
+    // The records applied per round, at most, so that the queries aren't starved
+    size_t records_batch = 1 << 14;
+    // A client whose responses pile up past this (e.g. a subscriber that
+    //  doesn't read) is disconnected, rather than buffered for forever
+    size_t max_client_backlog = 16 << 20;
+    // The ready descriptors handled per round, at most
+    size_t events_batch = 256;
+};
+
+/*
+ * Serves the books of a matching engine to local clients, without
+ *  going through the engine: a ReplicaOrderBooks is kept up to date
+ *  from the engine's event bus (see handlers::EventBusEventHandler),
+ *  and queried by the clients over a Unix domain socket (see
+ *  Protocol.hpp). A single thread does both, in rounds (see poll()).
+ *
+ * Serving many clients cheaply:
+ *  - The TOP_OF_BOOK and DEPTH responses of a book are serialized once
+ *    per change of the book, on the first query after the change, and
+ *    sent as they are to every client that asks, straight out of the same
+ *    buffer (a client's iovec points into it).
+ *  - A client gets all of its responses of a round, pushes included,
+ *    with a single sendmsg().
+ *  - Subscribers get a book at most once per round, however many records
+ *    of the book the round applied.
+ *
+ * The store starts from a snapshot of the engine, and starts over from
+ *  another snapshot if it's evicted from the bus, so the engine's thread
+ *  has to serve snapshots (see handlers::serve_snapshot). Until then, the
+ *  books are empty. A snapshot that didn't fit in the bus is refused rather
+ *  than served incomplete, so the bus needs the room for the whole books.
+ */
+template <
+    concepts::Order Order = Order,
+    template <typename, typename> typename HashMap = unordered_map
+>
+class OrderBooksStore {
+
+    using Replica = ReplicaOrderBooks<Order, HashMap>;
+    using Bus = ipc::EventBusReader<handlers::EventRecord>;
+
+    struct Book {
+        // Pre-serialized responses, shared by all of the clients
+        std::vector<std::byte> top;
+        std::vector<std::byte> depth;
+        std::vector<uint32_t> subscribers;
+        // The responses are rebuilt on the first query after a change
+        bool is_stale = true;
+        // The subscribers are yet to get the change
+        bool is_changed = false;
+    };
+
+    // A response, or a part of one, in the buffer of a book or in the client's own responses
+    struct Chunk {
+        // nullptr for the client's own responses, where the data is at the offset
+        const std::byte* data;
+        size_t offset;
+        size_t size;
+    };
+
+    struct Client {
+        Client(ipc::UnixSocket _socket, const uint32_t _slot, const uint32_t _generation) noexcept
+            : socket(std::move(_socket)), slot(_slot), generation(_generation) { }
+
+        [[nodiscard]] uint64_t key() const noexcept { return (uint64_t { generation } << 32) | slot; }
+
+        ipc::UnixSocket socket;
+        uint32_t slot;
+        uint32_t generation;
+
+        // A partial query, waiting for the rest of it
+        std::vector<std::byte> input;
+
+        // The responses of the current round
+        std::vector<Chunk> chunks;
+        std::vector<std::byte> responses;
+
+        // What the socket didn't take yet. Sent before anything else.
+        std::vector<std::byte> backlog;
+        size_t backlog_sent = 0;
+
+        std::vector<uint32_t> subscriptions;
+    };
+
+    constexpr static uint64_t ListenerKey = std::numeric_limits<uint64_t>::max();
+
+public:
+
+    // The path of the socket is replaced if it exists, and removed with the store
+    [[nodiscard]] static std::optional<OrderBooksStore> create(Bus bus, std::string socket_path,
+                                                               OrderBooksStoreConfig config = { }) noexcept {
+        auto listener = ipc::UnixListener::create(std::move(socket_path));
+        if (!listener) return std::nullopt;
+        auto epoll = ipc::Epoll::create();
+        if (!epoll || !epoll->add(listener->fd(), EPOLLIN, ListenerKey)) return std::nullopt;
+        return OrderBooksStore { std::move(bus), std::move(*listener), std::move(*epoll), config };
+    }
+
+    OrderBooksStore(const OrderBooksStore&) = delete;
+    OrderBooksStore& operator=(const OrderBooksStore&) = delete;
+
+    OrderBooksStore(OrderBooksStore&&) noexcept = default;
+    OrderBooksStore& operator=(OrderBooksStore&&) noexcept = default;
+
+    /*
+     * One round: applies the records waiting in the bus, serves the queries
+     *  waiting in the sockets, then pushes the changed books to their
+     *  subscribers and sends out the responses. Waits up to `timeout_ms` for
+     *  a query (or a connection) if there were no records.
+     *
+     * Returns the number of records applied.
+     */
+    size_t poll(const int timeout_ms) {
+        auto applied = catch_up();
+
+        auto count = _epoll.wait(_events, applied != 0 ? 0 : timeout_ms);
+        for (int i = 0; i < count; i++) {
+            auto& event = _events[static_cast<size_t>(i)];
+            if (event.data.u64 == ListenerKey) {
+                accept_clients();
+                continue;
+            }
+            auto* client = find_client(event.data.u64);
+            if (client == nullptr) continue;
+
+            if (event.events & EPOLLOUT) {
+                send_backlog(*client);
+            }
+            if (event.events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                read_queries(*client);
+            }
+        }
+
+        push_changes();
+        send_responses();
+        return applied;
+    }
+
+    [[nodiscard]] const Replica& replica() const noexcept { return *_replica; }
+
+    // The number of engine records the books reflect (see ResponseHeader::position)
+    [[nodiscard]] uint64_t position() const noexcept { return _position; }
+
+    // Whether the books are caught up, or still waiting for a snapshot
+    [[nodiscard]] bool is_synced() const noexcept { return _snapshot_ticket == 0; }
+
+    // The number of times the store was evicted from the bus and started over
+    [[nodiscard]] uint64_t resyncs() const noexcept { return _resyncs; }
+
+    // The number of snapshots refused because they didn't fit in the bus (see try_apply_snapshot)
+    [[nodiscard]] uint64_t truncated_snapshots() const noexcept { return _truncated_snapshots; }
+
+    [[nodiscard]] size_t clients_count() const noexcept { return _clients.size() - _free_slots.size(); }
+
+    [[nodiscard]] const std::string& path() const noexcept { return _listener.path(); }
+
+private:
+
+    OrderBooksStore(Bus bus, ipc::UnixListener listener, ipc::Epoll epoll, const OrderBooksStoreConfig config)
+        : _bus(std::move(bus)), _listener(std::move(listener)), _epoll(std::move(epoll)), _config(config),
+          _replica(std::make_unique<Replica>()), _events(config.events_batch) {
+        _batch.reserve(_config.records_batch);
+        start_sync();
+    }
+
+    // Starts over from a snapshot, keeping the records that come in the meantime
+    void start_sync() {
+        _snapshot_ticket = _bus.request_snapshot();
+        _pending_position = _bus.position();
+        _pending.clear();
+    }
+
+    size_t catch_up() {
+        if (_bus.is_evicted()) {
+            _bus.rejoin();
+            start_sync();
+            ++_resyncs;
+        }
+
+        // Kept aside, to be applied after the snapshot while syncing. A batch
+        //  the writer evicted the store in the middle of isn't handed out.
+        _batch.clear();
+        if (!_bus.consume([this] (const handlers::EventRecord& record) { _batch.push_back(record); }, _config.records_batch)) return 0;
+
+        if (!is_synced()) {
+            // Kept reading while waiting, so that the store isn't evicted again
+            _pending.insert(_pending.end(), _batch.begin(), _batch.end());
+            return try_apply_snapshot();
+        }
+
+        apply(_batch);
+        _position = _bus.position();
+        return _batch.size();
+    }
+
+    size_t try_apply_snapshot() {
+        auto snapshot = _bus.try_read_snapshot(_snapshot_ticket, _snapshot);
+        if (!snapshot) return 0;
+        // A truncated snapshot leaves books out, so the books are left as they were, and
+        //  the store asks for another one, which may fit once the engine's books shrink.
+        //  The records that come in the meantime are kept, as for any other snapshot.
+        if (snapshot->is_truncated) [[unlikely]] {
+            ++_truncated_snapshots;
+            _snapshot_ticket = _bus.request_snapshot();
+            return 0;
+        }
+
+        _replica->clear();
+        for (uint32_t symbol_id = 0; symbol_id < _books.size(); symbol_id++) {
+            touch(symbol_id);
+        }
+        apply(_snapshot);
+
+        // The snapshot already has what was published before its position
+        auto skipped = std::min<size_t>(snapshot->position > _pending_position ? snapshot->position - _pending_position : 0,
+                                        _pending.size());
+        apply(std::span { _pending }.subspan(skipped));
+
+        auto applied = _snapshot.size() + _pending.size() - skipped;
+        _position = _bus.position();
+        _snapshot_ticket = 0;
+        _pending.clear();
+        return applied;
+    }
+
+    void apply(const std::span<const handlers::EventRecord> records) {
+        for (auto& record : records) {
+            if (int(record.event == handlers::EventType::COMMAND_BEGIN) || int(record.event == handlers::EventType::COMMAND_END)) continue;
+            _replica->apply(record);
+            touch(record.symbol_id);
+        }
+    }
+
+    void touch(const uint32_t symbol_id) {
+        if (symbol_id >= _books.size()) {
+            _books.resize(symbol_id + 1);
+        }
+        auto& book = _books[symbol_id];
+        book.is_stale = true;
+        if (!book.is_changed) {
+            book.is_changed = true;
+            _changed.push_back(symbol_id);
+        }
+    }
+
+    // Rebuilds the responses of the book if it changed since they were built
+    Book* fresh_book(const uint32_t symbol_id) {
+        auto* orderbook = _replica->orderbook(SymbolId { symbol_id });
+        if (orderbook == nullptr) return nullptr;
+        auto& book = _books[symbol_id];
+        if (!book.is_stale) return &book;
+        book.is_stale = false;
+
+        auto quote = orderbook->quote();
+        TopOfBook top {
+            .bid_price = quote.bid_price.value,
+            .bid_volume = quote.bid_volume.value,
+            .ask_price = quote.ask_price.value,
+            .ask_volume = quote.ask_volume.value,
+            .last_bid_price = quote.last_bid_price.value,
+            .last_ask_price = quote.last_ask_price.value
+        };
+
+        book.top.clear();
+        append(book.top, header(ResponseType::TOP_OF_BOOK, symbol_id));
+        append(book.top, top);
+        finish(book.top, 0);
+
+        book.depth.clear();
+        append(book.depth, header(ResponseType::DEPTH, symbol_id));
+        append(book.depth, top);
+        auto counts_offset = book.depth.size();
+        append(book.depth, DepthCounts { });
+        auto bids_count = append_levels(book.depth, orderbook->bids());
+        auto asks_count = append_levels(book.depth, orderbook->asks());
+        append_at(book.depth, counts_offset, DepthCounts { .bids_count = bids_count, .asks_count = asks_count });
+        finish(book.depth, 0);
+
+        return &book;
+    }
+
+    template <typename Levels>
+    uint32_t append_levels(std::vector<std::byte>& buffer, const Levels& levels) const {
+        uint32_t count = 0;
+        for (auto it = levels.begin(); it != levels.end() && count < _config.depth; ++it) {
+            auto& [price, level] = *it;
+            if (level.visible_volume() == Quantity { 0 }) continue;
+            append(buffer, DepthLevel { .price = price.value, .visible_volume = level.visible_volume().value, .orders_count = level.size() });
+            ++count;
+        }
+        return count;
+    }
+
+    [[nodiscard]] ResponseHeader header(const ResponseType type, const uint32_t symbol_id, const uint64_t order_id = 0) const noexcept {
+        return ResponseHeader { .size = 0, .symbol_id = symbol_id, .position = _position, .order_id = order_id, .type = type, .padding = { } };
+    }
+
+    template <typename T>
+    static void append(std::vector<std::byte>& buffer, const T& value) {
+        auto offset = buffer.size();
+        buffer.resize(offset + sizeof(T));
+        std::memcpy(buffer.data() + offset, &value, sizeof(T));
+    }
+
+    template <typename T>
+    static void append_at(std::vector<std::byte>& buffer, const size_t offset, const T& value) noexcept {
+        std::memcpy(buffer.data() + offset, &value, sizeof(T));
+    }
+
+    // Sets the size of the response that starts at `offset` and ends at the end of the buffer
+    static void finish(std::vector<std::byte>& buffer, const size_t offset) noexcept {
+        auto size = static_cast<uint32_t>(buffer.size() - offset);
+        std::memcpy(buffer.data() + offset + offsetof(ResponseHeader, size), &size, sizeof(size));
+    }
+
+    void accept_clients() {
+        while (auto socket = _listener.accept()) {
+            uint32_t slot;
+            if (!_free_slots.empty()) {
+                slot = _free_slots.back();
+                _free_slots.pop_back();
+            } else {
+                slot = static_cast<uint32_t>(_clients.size());
+                _clients.emplace_back();
+            }
+            auto client = std::make_unique<Client>(std::move(*socket), slot, ++_generation);
+            if (!_epoll.add(client->socket.fd(), EPOLLIN, client->key())) {
+                _free_slots.push_back(slot);
+                continue;
+            }
+            _clients[slot] = std::move(client);
+        }
+    }
+
+    // nullptr if the client is gone, even if another one took its slot since
+    [[nodiscard]] Client* find_client(const uint64_t key) const noexcept {
+        auto slot = static_cast<uint32_t>(key);
+        if (slot >= _clients.size() || _clients[slot] == nullptr || _clients[slot]->key() != key) return nullptr;
+        return _clients[slot].get();
+    }
+
+    void disconnect(Client& client) {
+        auto slot = client.slot;
+        (void)_epoll.remove(client.socket.fd());
+        for (auto symbol_id : client.subscriptions) {
+            std::erase(_books[symbol_id].subscribers, slot);
+        }
+        _clients[slot].reset();
+        _free_slots.push_back(slot);
+    }
+
+    void read_queries(Client& client) {
+        std::array<std::byte, 64 * sizeof(Query)> buffer;
+        while (true) {
+            auto received = client.socket.recv(buffer);
+            if (received > 0) {
+                client.input.insert(client.input.end(), buffer.begin(), buffer.begin() + received);
+                continue;
+            }
+            if (received == -1 && errno == EINTR) continue;
+            if (received == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            // Gone, or broken
+            disconnect(client);
+            return;
+        }
+
+        size_t offset = 0;
+        for (; client.input.size() - offset >= sizeof(Query); offset += sizeof(Query)) {
+            Query query;
+            std::memcpy(&query, client.input.data() + offset, sizeof(Query));
+            handle(client, query);
+        }
+        client.input.erase(client.input.begin(), client.input.begin() + static_cast<ptrdiff_t>(offset));
+    }
+
+    void handle(Client& client, const Query& query) {
+        switch (query.type) {
+            case QueryType::SUBSCRIBE:
+                if (_replica->orderbook(SymbolId { query.symbol_id }) != nullptr &&
+                    std::find(client.subscriptions.begin(), client.subscriptions.end(), query.symbol_id) == client.subscriptions.end()) {
+                    client.subscriptions.push_back(query.symbol_id);
+                    _books[query.symbol_id].subscribers.push_back(client.slot);
+                }
+                respond_with_book(client, query.symbol_id, &Book::depth);
+                break;
+            case QueryType::UNSUBSCRIBE:
+                if (std::erase(client.subscriptions, query.symbol_id) != 0) {
+                    std::erase(_books[query.symbol_id].subscribers, client.slot);
+                }
+                respond(client, header(ResponseType::UNSUBSCRIBED, query.symbol_id));
+                break;
+            case QueryType::TOP_OF_BOOK:
+                respond_with_book(client, query.symbol_id, &Book::top);
+                break;
+            case QueryType::DEPTH:
+                respond_with_book(client, query.symbol_id, &Book::depth);
+                break;
+            case QueryType::ORDER_STATUS:
+                if (auto* order = _replica->order(OrderId { query.order_id }); order != nullptr) {
+                    respond(client, header(ResponseType::ORDER_STATUS, order->symbol_id().value, query.order_id),
+                            handlers::make_order_record(*order));
+                } else {
+                    respond(client, header(ResponseType::UNKNOWN_ORDER, query.symbol_id, query.order_id));
+                }
+                break;
+            default:
+                respond(client, header(ResponseType::BAD_QUERY, query.symbol_id));
+                break;
+        }
+    }
+
+    void respond_with_book(Client& client, const uint32_t symbol_id, std::vector<std::byte> Book::* response) {
+        auto* book = fresh_book(symbol_id);
+        if (book == nullptr) {
+            respond(client, header(ResponseType::UNKNOWN_SYMBOL, symbol_id));
+            return;
+        }
+        auto& buffer = book->*response;
+        add_chunk(client, Chunk { .data = buffer.data(), .offset = 0, .size = buffer.size() });
+    }
+
+    // A response of the client's own
+    template <typename... Body>
+    void respond(Client& client, const ResponseHeader& response_header, const Body&... body) {
+        auto offset = client.responses.size();
+        append(client.responses, response_header);
+        (append(client.responses, body), ...);
+        finish(client.responses, offset);
+        add_chunk(client, Chunk { .data = nullptr, .offset = offset, .size = client.responses.size() - offset });
+    }
+
+    void add_chunk(Client& client, const Chunk chunk) {
+        if (client.chunks.empty()) {
+            _pending_clients.push_back(client.key());
+        }
+        client.chunks.push_back(chunk);
+    }
+
+    void push_changes() {
+        for (auto symbol_id : _changed) {
+            auto& book = _books[symbol_id];
+            book.is_changed = false;
+            for (auto slot : book.subscribers) {
+                respond_with_book(*_clients[slot], symbol_id, &Book::depth);
+            }
+        }
+        _changed.clear();
+    }
+
+    [[nodiscard]] static std::span<const std::byte> bytes(const Client& client, const Chunk& chunk) noexcept {
+        auto* data = chunk.data != nullptr ? chunk.data : client.responses.data();
+        return { data + chunk.offset, chunk.size };
+    }
+
+    void send_responses() {
+        for (auto key : _pending_clients) {
+            // Gone in the middle of the round
+            auto* client = find_client(key);
+            if (client == nullptr) continue;
+            send_chunks(*client);
+            client->chunks.clear();
+            client->responses.clear();
+            if (client->backlog.size() - client->backlog_sent > _config.max_client_backlog) {
+                disconnect(*client);
+            }
+        }
+        _pending_clients.clear();
+    }
+
+    // Sends as much as the socket takes, with as few syscalls as possible. The rest is kept in the backlog.
+    void send_chunks(Client& client) {
+        size_t index = 0;
+        // Of the first chunk that's not fully sent
+        size_t sent_of_chunk = 0;
+
+        // Anything new has to wait for the backlog, to keep the responses in order
+        if (client.backlog.empty()) {
+            while (index < client.chunks.size()) {
+                _iovecs.clear();
+                for (auto i = index; i < client.chunks.size() && _iovecs.size() < IOV_MAX; i++) {
+                    auto data = bytes(client, client.chunks[i]);
+                    if (i == index) data = data.subspan(sent_of_chunk);
+                    _iovecs.push_back(iovec { const_cast<std::byte*>(data.data()), data.size() });
+                }
+
+                auto sent = client.socket.send(_iovecs);
+                if (sent == -1) {
+                    if (errno == EINTR) continue;
+                    // Either full (EAGAIN) or broken. A broken socket is noticed by the next read.
+                    break;
+                }
+
+                auto remaining = static_cast<size_t>(sent);
+                while (index < client.chunks.size() && remaining >= client.chunks[index].size - sent_of_chunk) {
+                    remaining -= client.chunks[index].size - sent_of_chunk;
+                    sent_of_chunk = 0;
+                    ++index;
+                }
+                sent_of_chunk += remaining;
+            }
+        }
+
+        if (index == client.chunks.size()) return;
+
+        // The buffers of the books are rebuilt in later rounds, so the rest is copied
+        if (client.backlog.empty()) {
+            (void)_epoll.modify(client.socket.fd(), EPOLLIN | EPOLLOUT, client.key());
+        }
+        for (; index < client.chunks.size(); index++) {
+            auto data = bytes(client, client.chunks[index]).subspan(sent_of_chunk);
+            client.backlog.insert(client.backlog.end(), data.begin(), data.end());
+            sent_of_chunk = 0;
+        }
+    }
+
+    void send_backlog(Client& client) {
+        while (client.backlog_sent < client.backlog.size()) {
+            auto sent = client.socket.send(std::span { client.backlog }.subspan(client.backlog_sent));
+            if (sent == -1) {
+                if (errno == EINTR) continue;
+                return;
+            }
+            client.backlog_sent += static_cast<size_t>(sent);
+        }
+        client.backlog.clear();
+        client.backlog_sent = 0;
+        (void)_epoll.modify(client.socket.fd(), EPOLLIN, client.key());
+    }
+
+    Bus _bus;
+    ipc::UnixListener _listener;
+    ipc::Epoll _epoll;
+    OrderBooksStoreConfig _config;
+
+    // Not movable, since the books point to its order index
+    std::unique_ptr<Replica> _replica;
+    uint64_t _position = 0;
+
+    // Syncing from a snapshot
+    uint64_t _snapshot_ticket = 0;
+    std::vector<handlers::EventRecord> _snapshot;
+    // The records that came while waiting for the snapshot, from _pending_position on
+    std::vector<handlers::EventRecord> _pending;
+    uint64_t _pending_position = 0;
+    uint64_t _resyncs = 0;
+    uint64_t _truncated_snapshots = 0;
+
+    std::vector<handlers::EventRecord> _batch;
+
+    // By symbol ID
+    std::vector<Book> _books;
+    std::vector<uint32_t> _changed;
+
+    // By slot. A slot is reused once its client is gone, with a new generation.
+    std::vector<std::unique_ptr<Client>> _clients;
+    std::vector<uint32_t> _free_slots;
+    uint32_t _generation = 0;
+    // The keys of the clients with responses in the current round
+    std::vector<uint64_t> _pending_clients;
+
+    std::vector<epoll_event> _events;
+    std::vector<iovec> _iovecs;
+};
+
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+#include <chronex/handlers/EventRecord.hpp>
+
+namespace chronex::store {
+
+/*
+ * The wire protocol of the orderbooks store. Everything is fixed-size,
+ *  trivially copyable, and in the host's byte order, since the clients
+ *  are local (Unix domain sockets).
+ *
+ * Clients send Query structs back to back, and the store answers each of
+ *  them with a response, in order. A response is a ResponseHeader followed
+ *  by a body whose layout depends on the type. Responses to subscriptions
+ *  are pushed (as DEPTH responses) whenever the book changes, in between
+ *  the responses to the queries.
+ */
+
+enum class QueryType : uint8_t {
+    // Pushes the depth of the book after every change to it, starting with the current one
+    SUBSCRIBE,
+    UNSUBSCRIBE,
+    TOP_OF_BOOK,
+    DEPTH,
+    ORDER_STATUS,
+};
+
+struct Query {
+    QueryType type;
+    uint8_t padding[3];
+    uint32_t symbol_id;
+    // Only for ORDER_STATUS
+    uint64_t order_id;
+};
+
+enum class ResponseType : uint8_t {
+    // Body: TopOfBook
+    TOP_OF_BOOK,
+    // Body: TopOfBook, DepthCounts, then bids_count bids and asks_count asks (DepthLevel)
+    DEPTH,
+    // Body: handlers::OrderRecord
+    ORDER_STATUS,
+    // Unsubscribing, no body
+    UNSUBSCRIBED,
+    // No body. The symbol has no book.
+    UNKNOWN_SYMBOL,
+    // No body. The order isn't in any book (never was, or was filled or removed).
+    UNKNOWN_ORDER,
+    // No body. The query type is unknown.
+    BAD_QUERY,
+};
+
+struct ResponseHeader {
+    // Of the whole response, header included
+    uint32_t size;
+    uint32_t symbol_id;
+    // The number of engine records the books reflect, so that
+    //  responses can be told apart in time and compared across stores
+    uint64_t position;
+    // For ORDER_STATUS and UNKNOWN_ORDER
+    uint64_t order_id;
+    ResponseType type;
+    uint8_t padding[7];
+};
+
+// The prices of an empty side are the same as the engine's (see Quote)
+struct TopOfBook {
+    uint64_t bid_price;
+    uint64_t bid_volume;
+    uint64_t ask_price;
+    uint64_t ask_volume;
+    uint64_t last_bid_price;
+    uint64_t last_ask_price;
+};
+
+struct DepthCounts {
+    uint32_t bids_count;
+    uint32_t asks_count;
+};
+
+// A level with visible volume. Levels of hidden orders only are left out.
+struct DepthLevel {
+    uint64_t price;
+    uint64_t visible_volume;
+    // Hidden orders included
+    uint64_t orders_count;
+};
+
+static_assert(std::is_trivially_copyable_v<Query>);
+static_assert(std::is_trivially_copyable_v<ResponseHeader>);
+static_assert(sizeof(Query) == 16);
+static_assert(sizeof(ResponseHeader) == 32);
+
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <chronex/ipc/UnixSocket.hpp>
+
+#include <chronex/store/Protocol.hpp>
+
+namespace chronex::store {
+
+/*
+ * A blocking client of an OrderBooksStore, e.g. for tools, tests, and load
+ *  tests. Queries can be sent ahead (pipelined), and their responses are
+ *  received in the same order, with the pushes of the subscriptions in
+ *  between.
+ */
+class StoreClient {
+public:
+
+    [[nodiscard]] static std::optional<StoreClient> connect(const std::string& path) noexcept {
+        auto socket = ipc::UnixSocket::connect(path);
+        if (!socket) return std::nullopt;
+        return StoreClient { std::move(*socket) };
+    }
+
+    [[nodiscard]] bool send(const Query& query) const noexcept {
+        return _socket.send_all(std::as_bytes(std::span { &query, 1 }));
+    }
+
+    [[nodiscard]] bool send(const QueryType type, const uint32_t symbol_id, const uint64_t order_id = 0) const noexcept {
+        return send(Query { .type = type, .padding = { }, .symbol_id = symbol_id, .order_id = order_id });
+    }
+
+    /*
+     * Blocks until the next response, and keeps its body until the next
+     *  call (see body()). Empty if the store is gone.
+     */
+    [[nodiscard]] std::optional<ResponseHeader> receive() {
+        ResponseHeader header;
+        if (!_socket.recv_all(std::as_writable_bytes(std::span { &header, 1 }))) return std::nullopt;
+        if (header.size < sizeof(ResponseHeader)) return std::nullopt;
+        _body.resize(header.size - sizeof(ResponseHeader));
+        if (!_socket.recv_all(_body)) return std::nullopt;
+        return header;
+    }
+
+    [[nodiscard]] std::span<const std::byte> body() const noexcept { return _body; }
+
+    // The body of the last response as a T, e.g. TopOfBook or handlers::OrderRecord
+    template <typename T>
+    [[nodiscard]] T body_as(const size_t offset = 0) const noexcept {
+        T value;
+        std::memcpy(&value, _body.data() + offset, sizeof(T));
+        return value;
+    }
+
+    [[nodiscard]] DepthCounts depth_counts() const noexcept { return body_as<DepthCounts>(sizeof(TopOfBook)); }
+
+    // Bids first, then asks, as counted by depth_counts()
+    [[nodiscard]] DepthLevel depth_level(const size_t index) const noexcept {
+        return body_as<DepthLevel>(sizeof(TopOfBook) + sizeof(DepthCounts) + index * sizeof(DepthLevel));
+    }
+
+    [[nodiscard]] const ipc::UnixSocket& socket() const noexcept { return _socket; }
+
+private:
+
+    explicit StoreClient(ipc::UnixSocket socket) noexcept : _socket(std::move(socket)) { }
+
+    ipc::UnixSocket _socket;
+    std::vector<std::byte> _body;
+};
+
+}
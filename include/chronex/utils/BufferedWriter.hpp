@@ -0,0 +1,202 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <sys/uio.h>
+
+#include <chronex/utils/Threading.hpp>
+
+namespace chronex::utils {
+
+struct BufferedWriterConfig {
+    size_t buffer_size = 1 << 20;
+    // 2 is plain double buffering. More buffers absorb longer stalls of the file.
+    size_t buffers_count = 2;
+    // The writer thread is pinned to this core when provided
+    std::optional<size_t> core { };
+};
+
+/*
+ * Moves the writes to a file descriptor off the producing thread. The
+ *  producer fills a pre-allocated buffer in place, and only when it's full
+ *  (or flushed) hands it to a writer thread and moves on to the next free
+ *  buffer. The writer writes all of the buffers handed to it so far with a
+ *  single writev.
+ *
+ * The producer only waits when all of the buffers are waiting to be
+ *  written, and both threads sleep (instead of spinning) while waiting,
+ *  since the writer spends most of its time blocked in the kernel anyway.
+ *
+ * A failed write is sticky: its errno is kept (see error()), and nothing is
+ *  written anymore, so that the file doesn't get a gap in the middle.
+ *
+ * Single producer. The file descriptor is not owned.
+ */
+class BufferedWriter {
+public:
+
+    explicit BufferedWriter(const int fd, BufferedWriterConfig config = { })
+        : _fd(fd), _config(std::move(config)), _buffers(_config.buffers_count), _sizes(_config.buffers_count) {
+        assert(_config.buffers_count >= 2 && "BufferedWriter needs at least two buffers");
+        for (auto& buffer : _buffers) {
+            buffer = std::make_unique_for_overwrite<char[]>(_config.buffer_size);
+        }
+        _current = _buffers[0].get();
+        _thread = std::jthread([this] { run(); });
+    }
+
+    BufferedWriter(const BufferedWriter&) = delete;
+    BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+    ~BufferedWriter() {
+        flush();
+        _stopping.store(true, std::memory_order_release);
+        // An empty buffer, to wake the writer up in case it's sleeping
+        hand_off();
+        _thread.join();
+    }
+
+    [[nodiscard]] size_t buffer_size() const noexcept { return _config.buffer_size; }
+
+    // Space for at least `size` bytes. What's written
+    //  there is only kept once it's passed to advance().
+    [[nodiscard]] char* reserve(const size_t size) noexcept {
+        assert(size <= _config.buffer_size && "Reserving more than a buffer can hold");
+        if (_config.buffer_size - _used < size) {
+            hand_off();
+        }
+        return _current + _used;
+    }
+
+    void advance(const size_t size) noexcept {
+        assert(_used + size <= _config.buffer_size && "Advancing past the end of the buffer");
+        _used += size;
+    }
+
+    // Hands what's buffered so far to the writer, without waiting for it to be
+    //  written. Returns false if a write has failed so far.
+    bool flush() noexcept {
+        if (_used != 0) {
+            hand_off();
+        }
+        return error() == 0;
+    }
+
+    // Blocks until everything buffered so far is written. Returns false if it wasn't.
+    bool sync() noexcept {
+        flush();
+        wait_until_written(_produced.load(std::memory_order_relaxed));
+        return error() == 0;
+    }
+
+    // The errno of the first failed write, 0 if none has failed
+    [[nodiscard]] int error() const noexcept { return _error.load(std::memory_order_acquire); }
+
+private:
+
+    void hand_off() noexcept {
+        auto produced = _produced.load(std::memory_order_relaxed);
+        _sizes[produced % _buffers.size()] = _used;
+        _produced.store(produced + 1, std::memory_order_release);
+        _produced.notify_one();
+
+        // The next buffer is free once the writer is done with
+        //  whatever was handed to it a full round of buffers ago
+        wait_until_written(produced + 1 - (_buffers.size() - 1));
+        _current = _buffers[(produced + 1) % _buffers.size()].get();
+        _used = 0;
+    }
+
+    void wait_until_written(const uint64_t count) const noexcept {
+        auto written = _written.load(std::memory_order_acquire);
+        while (static_cast<int64_t>(count - written) > 0) {
+            _written.wait(written, std::memory_order_acquire);
+            written = _written.load(std::memory_order_acquire);
+        }
+    }
+
+    void run() noexcept {
+        if (_config.core.has_value()) {
+            pin_current_thread(*_config.core);
+        }
+
+        std::vector<iovec> iovecs(_buffers.size());
+        uint64_t written = 0;
+        while (true) {
+            auto produced = _produced.load(std::memory_order_acquire);
+            if (produced == written) {
+                // Stopping is set after the last flush, so check again for what it flushed
+                if (_stopping.load(std::memory_order_acquire) && _produced.load(std::memory_order_acquire) == written) return;
+                _produced.wait(written, std::memory_order_acquire);
+                continue;
+            }
+
+            auto count = static_cast<size_t>(produced - written);
+            for (size_t i = 0; i < count; i++) {
+                auto index = (written + i) % _buffers.size();
+                iovecs[i] = iovec { _buffers[index].get(), _sizes[index] };
+            }
+            if (error() == 0) {
+                write_all(iovecs.data(), count);
+            }
+
+            written = produced;
+            _written.store(written, std::memory_order_release);
+            _written.notify_one();
+        }
+    }
+
+    void write_all(iovec* iov, size_t count) noexcept {
+        while (count != 0) {
+            auto result = ::writev(_fd, iov, static_cast<int>(count));
+            if (result < 0) {
+                if (errno == EINTR) continue;
+                _error.store(errno, std::memory_order_release);
+                return;
+            }
+
+            // Skip what was fully written, and resume the partially written buffer
+            auto remaining = static_cast<size_t>(result);
+            while (count != 0 && remaining >= iov->iov_len) {
+                remaining -= iov->iov_len;
+                ++iov;
+                --count;
+            }
+            if (count != 0) {
+                iov->iov_base = static_cast<char*>(iov->iov_base) + remaining;
+                iov->iov_len -= remaining;
+            }
+        }
+    }
+
+    int _fd;
+    BufferedWriterConfig _config;
+
+    std::vector<std::unique_ptr<char[]>> _buffers;
+    // Written by the producer before handing a buffer off
+    std::vector<size_t> _sizes;
+
+    // Producer-owned
+    char* _current = nullptr;
+    size_t _used = 0;
+
+    // Buffers handed off, and buffers written, since the start
+    alignas(CacheLineSize) std::atomic<uint64_t> _produced { 0 };
+    alignas(CacheLineSize) std::atomic<uint64_t> _written { 0 };
+    std::atomic<bool> _stopping { false };
+    // Only set by the writer
+    std::atomic<int> _error { 0 };
+
+    std::jthread _thread;
+};
+
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <string>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace chronex::utils {
+
+/*
+ * A file mapped read-only into the address space of the process, e.g. for
+ *  replaying a recorded feed or a command log without copying it into a
+ *  buffer first. The kernel is told that the file is read front to back,
+ *  so it reads ahead of the parser.
+ *
+ * The factory returns nothing on failure, and errno tells why.
+ */
+class MappedFile {
+public:
+
+    [[nodiscard]] static std::optional<MappedFile> open(const std::string& path) noexcept {
+        auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd == -1) return std::nullopt;
+        struct stat status { };
+        if (::fstat(fd, &status) == -1) {
+            ::close(fd);
+            return std::nullopt;
+        }
+        auto size = static_cast<size_t>(status.st_size);
+        // Empty files can't be mapped, and have nothing to map anyway
+        if (size == 0) {
+            ::close(fd);
+            return MappedFile { nullptr, 0 };
+        }
+        auto* data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        // The mapping stays valid after the descriptor is closed
+        ::close(fd);
+        if (data == MAP_FAILED) return std::nullopt;
+        ::madvise(data, size, MADV_SEQUENTIAL);
+        return MappedFile { static_cast<const std::byte*>(data), size };
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept
+        : _data(std::exchange(other._data, nullptr)),
+          _size(std::exchange(other._size, 0)) { }
+
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            release();
+            _data = std::exchange(other._data, nullptr);
+            _size = std::exchange(other._size, 0);
+        }
+        return *this;
+    }
+
+    ~MappedFile() noexcept { release(); }
+
+    [[nodiscard]] std::span<const std::byte> bytes() const noexcept { return { _data, _size }; }
+    [[nodiscard]] const std::byte* data() const noexcept { return _data; }
+    [[nodiscard]] size_t size() const noexcept { return _size; }
+
+private:
+
+    MappedFile(const std::byte* data, const size_t size) noexcept : _data(data), _size(size) { }
+
+    void release() noexcept {
+        if (_data != nullptr) {
+            ::munmap(const_cast<std::byte*>(_data), _size);
+            _data = nullptr;
+        }
+    }
+
+    const std::byte* _data = nullptr;
+    size_t _size = 0;
+};
+
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace chronex::utils {
+
+constexpr size_t CacheLineSize = 64;
+
+inline void cpu_relax() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+// Spin for a while before giving up the core. Dedicated cores never reach
+//  the yield, but oversubscribed machines (CI, laptops) still make progress.
+class Backoff {
+public:
+    void pause() noexcept {
+        if (_spins < MaxSpins) {
+            ++_spins;
+            cpu_relax();
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    void reset() noexcept { _spins = 0; }
+
+private:
+    constexpr static uint32_t MaxSpins = 1024;
+    uint32_t _spins = 0;
+};
+
+// Returns false if pinning is not supported or failed. Callers are
+//  expected to treat this as a hint rather than a hard requirement.
+inline bool pin_current_thread(const size_t core) noexcept {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)core;
+    return false;
+#endif
+}
+
+}
@@ -0,0 +1,99 @@
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <chronex/data-structures/SPSCQueue.hpp>
+
+using namespace chronex::ds;
+
+TEST(SPSCQueueTest, PushAndPopInOrder) {
+    SPSCQueue<int> queue(4);
+    EXPECT_TRUE(queue.is_empty());
+    EXPECT_EQ(queue.front(), nullptr);
+
+    EXPECT_TRUE(queue.try_push(1));
+    EXPECT_TRUE(queue.try_push(2));
+    EXPECT_EQ(queue.size(), 2);
+
+    ASSERT_NE(queue.front(), nullptr);
+    EXPECT_EQ(*queue.front(), 1);
+    queue.pop();
+    EXPECT_EQ(*queue.front(), 2);
+    queue.pop();
+    EXPECT_TRUE(queue.is_empty());
+}
+
+TEST(SPSCQueueTest, RejectsWhenFull) {
+    SPSCQueue<int> queue(2);
+    EXPECT_TRUE(queue.try_push(1));
+    EXPECT_TRUE(queue.try_push(2));
+    EXPECT_FALSE(queue.try_push(3));
+    queue.pop();
+    EXPECT_TRUE(queue.try_push(3));
+}
+
+TEST(SPSCQueueTest, ConsumeInBatches) {
+    SPSCQueue<int> queue(8);
+    for (int i = 0; i < 6; i++) {
+        EXPECT_TRUE(queue.try_push(int { i }));
+    }
+
+    std::vector<int> seen;
+    EXPECT_EQ(queue.consume([&](int& x) { seen.push_back(x); }, 4), 4);
+    EXPECT_EQ(queue.consume([&](int& x) { seen.push_back(x); }, 4), 2);
+    EXPECT_EQ(queue.consume([&](int& x) { seen.push_back(x); }, 4), 0);
+    EXPECT_EQ(seen, (std::vector<int> { 0, 1, 2, 3, 4, 5 }));
+}
+
+TEST(SPSCQueueTest, DeferredElementsAreInvisibleUntilCommitted) {
+    SPSCQueue<int> queue(4);
+    EXPECT_TRUE(queue.try_emplace_deferred(1));
+    EXPECT_TRUE(queue.try_emplace_deferred(2));
+    EXPECT_EQ(queue.front(), nullptr);
+
+    queue.commit();
+    EXPECT_EQ(queue.size(), 2);
+    EXPECT_EQ(*queue.front(), 1);
+
+    // Uncommitted elements still take space
+    EXPECT_TRUE(queue.try_emplace_deferred(3));
+    EXPECT_TRUE(queue.try_emplace_deferred(4));
+    EXPECT_FALSE(queue.try_emplace_deferred(5));
+    queue.commit();
+    EXPECT_EQ(queue.size(), 4);
+}
+
+TEST(SPSCQueueTest, MoveOnlyElementsAreDestroyed) {
+    auto counter = std::make_shared<int>(0);
+    {
+        SPSCQueue<std::shared_ptr<int>> queue(4);
+        queue.push(std::shared_ptr<int> { counter });
+        queue.push(std::shared_ptr<int> { counter });
+        EXPECT_EQ(counter.use_count(), 3);
+    }
+    EXPECT_EQ(counter.use_count(), 1);
+}
+
+TEST(SPSCQueueTest, ProducerConsumerThreads) {
+    constexpr uint64_t count = 10'000;
+    SPSCQueue<uint64_t> queue(64);
+
+    std::thread producer([&] {
+        for (uint64_t i = 0; i < count; i++) {
+            queue.push(uint64_t { i });
+        }
+    });
+
+    uint64_t expected = 0;
+    while (expected < count) {
+        queue.consume([&](uint64_t& x) {
+            EXPECT_EQ(x, expected);
+            ++expected;
+        }, 16);
+    }
+
+    producer.join();
+    EXPECT_TRUE(queue.is_empty());
+}
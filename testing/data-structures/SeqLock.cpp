@@ -0,0 +1,65 @@
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <chronex/data-structures/SeqLock.hpp>
+
+using namespace chronex::ds;
+
+namespace {
+
+// Every field is the same, so a torn read is easy to tell
+struct Words {
+    uint64_t a, b, c, d, e;
+};
+
+}
+
+TEST(SeqLockTest, LoadsTheLastStore) {
+    SeqLock<Words> lock;
+    EXPECT_EQ(lock.sequence(), 0);
+    EXPECT_EQ(lock.load().a, 0);
+
+    lock.store(Words { 1, 2, 3, 4, 5 });
+    EXPECT_EQ(lock.sequence(), 2);
+    auto value = lock.try_load();
+    ASSERT_TRUE(value.has_value());
+    EXPECT_EQ(value->a, 1);
+    EXPECT_EQ(value->e, 5);
+    EXPECT_EQ(lock.peek().c, 3);
+}
+
+TEST(SeqLockTest, ReadersNeverSeeATornValue) {
+    SeqLock<Words> lock;
+    constexpr uint64_t StoresCount = 200'000;
+    std::atomic<bool> done { false };
+    std::atomic<uint64_t> torn { 0 };
+
+    std::vector<std::jthread> readers;
+    for (int i = 0; i < 3; i++) {
+        readers.emplace_back([&] {
+            uint64_t last = 0;
+            while (!done.load(std::memory_order_acquire)) {
+                auto value = lock.load();
+                if (int(value.a != value.b) | int(value.a != value.c) | int(value.a != value.d) |
+                    int(value.a != value.e) | int(value.a < last)) {
+                    torn.fetch_add(1, std::memory_order_relaxed);
+                }
+                last = value.a;
+            }
+        });
+    }
+
+    for (uint64_t i = 1; i <= StoresCount; i++) {
+        lock.store(Words { i, i, i, i, i });
+    }
+    done.store(true, std::memory_order_release);
+    readers.clear();
+
+    EXPECT_EQ(torn.load(), 0);
+    EXPECT_EQ(lock.load().a, StoresCount);
+    EXPECT_EQ(lock.sequence(), 2 * StoresCount);
+}
@@ -0,0 +1,85 @@
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <chronex/data-structures/Slab.hpp>
+
+using namespace chronex::ds;
+
+TEST(SlabTest, AcquireUntilExhausted) {
+    Slab<int> slab(3);
+    std::set<int*> slots;
+    for (int i = 0; i < 3; i++) {
+        auto* slot = slab.try_acquire();
+        ASSERT_NE(slot, nullptr);
+        EXPECT_TRUE(slab.owns(slot));
+        EXPECT_EQ(slab.at(slab.index_of(slot)), slot);
+        slots.insert(slot);
+    }
+    EXPECT_EQ(slots.size(), 3);
+    EXPECT_EQ(slab.try_acquire(), nullptr);
+    EXPECT_EQ(slab.free_count(), 0);
+
+    slab.release(*slots.begin());
+    EXPECT_EQ(slab.free_count(), 1);
+    EXPECT_EQ(slab.try_acquire(), *slots.begin());
+}
+
+TEST(SlabTest, DoesntOwnOtherMemory) {
+    Slab<int> slab(4);
+    int other = 0;
+    EXPECT_FALSE(slab.owns(&other));
+    EXPECT_FALSE(slab.owns(slab.at(3) + 1));
+}
+
+TEST(SlabTest, AllocatorFallsBackToTheHeap) {
+    Slab<int> slab(1);
+    SlabAllocator<int>::install(&slab);
+
+    SlabAllocator<int> allocator;
+    auto* a = allocator.allocate(1);
+    auto* b = allocator.allocate(1);
+    EXPECT_TRUE(slab.owns(a));
+    EXPECT_FALSE(slab.owns(b));
+
+    allocator.deallocate(a, 1);
+    allocator.deallocate(b, 1);
+    EXPECT_EQ(slab.try_acquire(), a);
+    slab.release(a);
+
+    SlabAllocator<int>::install(nullptr);
+}
+
+TEST(SlabTest, ConcurrentAcquireAndRelease) {
+    constexpr uint32_t capacity = 64;
+    constexpr int rounds = 10'000;
+    Slab<int> slab(capacity);
+
+    auto work = [&slab] (int id) {
+        for (int i = 0; i < rounds; i++) {
+            auto* slot = slab.try_acquire();
+            if (slot == nullptr) continue;
+            // Nobody else must be holding the same slot
+            *slot = id;
+            std::this_thread::yield();
+            EXPECT_EQ(*slot, id);
+            slab.release(slot);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; i++) {
+        threads.emplace_back(work, i);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // Everything was given back
+    for (uint32_t i = 0; i < capacity; i++) {
+        EXPECT_NE(slab.try_acquire(), nullptr);
+    }
+    EXPECT_EQ(slab.try_acquire(), nullptr);
+}
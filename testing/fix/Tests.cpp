@@ -0,0 +1,265 @@
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <chronex/fix/FixEncoder.hpp>
+#include <chronex/fix/FixParser.hpp>
+#include <chronex/handlers/ExecutionReportEventHandler.hpp>
+#include <chronex/matching/MatchingEngine.hpp>
+
+using namespace chronex;
+using namespace chronex::fix;
+
+namespace {
+
+// Frames a body written with '|' as the delimiter
+std::string make_message(std::string body) {
+    for (auto& c : body) if (c == '|') c = Soh;
+    auto message = std::string { BeginString } + "9=" + std::to_string(body.size()) + Soh + body;
+    char trailer[8];
+    std::snprintf(trailer, sizeof(trailer), "10=%03u", unsigned { checksum(message.data(), message.data() + message.size()) });
+    return message + trailer + Soh;
+}
+
+std::optional<uint32_t> symbol_id_of(const std::string_view symbol) {
+    if (symbol == "AAPL") return 0;
+    if (symbol == "MSFT") return 1;
+    return std::nullopt;
+}
+
+std::optional<gateway::Request> request_of(const std::string& body, const uint32_t price_decimals = 2) {
+    auto message = make_message(body);
+    Message parsed;
+    auto result = parse_message(message, parsed);
+    if (result.status != ParseStatus::COMPLETE) return std::nullopt;
+    return make_request(parsed, symbol_id_of, price_decimals);
+}
+
+// All of the fields of a message, by tag
+std::map<int, std::string> fields_of(const std::string_view message) {
+    std::map<int, std::string> result;
+    size_t begin = 0;
+    while (begin < message.size()) {
+        auto end = message.find(Soh, begin);
+        auto field = message.substr(begin, end - begin);
+        auto equals = field.find('=');
+        result[std::stoi(std::string { field.substr(0, equals) })] = field.substr(equals + 1);
+        begin = end + 1;
+    }
+    return result;
+}
+
+}
+
+TEST(FixTest, ScansForDelimitersAndSumsLikeAByteLoop) {
+    // Every length and alignment around the chunks of the scanner
+    std::string buffer;
+    for (int i = 0; i < 100; i++) buffer += (i * 7 % 5 == 0) ? Soh : char('a' + i % 26);
+    for (size_t begin = 0; begin < 20; begin++) {
+        for (size_t end = begin; end <= buffer.size(); end++) {
+            std::vector<const char*> expected;
+            uint64_t sum = 0;
+            for (size_t i = begin; i < end; i++) {
+                if (buffer[i] == Soh) expected.push_back(buffer.data() + i);
+                sum += static_cast<uint8_t>(buffer[i]);
+            }
+            std::vector<const char*> found;
+            DelimiterScanner scanner { buffer.data() + begin, buffer.data() + end };
+            while (auto delimiter = scanner.next()) found.push_back(delimiter);
+            ASSERT_EQ(found, expected);
+            ASSERT_EQ(checksum(buffer.data() + begin, buffer.data() + end), static_cast<uint8_t>(sum));
+        }
+    }
+}
+
+TEST(FixTest, ParsesFramedMessagesWithoutCopying) {
+    auto first = make_message("35=D|49=CLIENT|56=CHRONEX|34=7|11=1|55=AAPL|54=1|38=100|40=2|44=100.25|5000=ignored|");
+    auto second = make_message("35=F|34=8|11=2|41=1|55=AAPL|54=1|");
+    auto stream = first + second;
+
+    Message message;
+    auto result = parse_message(stream, message);
+    ASSERT_EQ(result.status, ParseStatus::COMPLETE);
+    EXPECT_EQ(result.size, first.size());
+    EXPECT_EQ(message.msg_type, "D");
+    EXPECT_EQ(message.msg_seq_num, "7");
+    EXPECT_EQ(message.sender_comp_id, "CLIENT");
+    EXPECT_EQ(message.price, "100.25");
+    EXPECT_TRUE(message.stop_px.empty());
+    // Views into the buffer
+    EXPECT_EQ(message.symbol.data(), stream.data() + stream.find("AAPL"));
+
+    result = parse_message(std::string_view { stream }.substr(first.size()), message);
+    ASSERT_EQ(result.status, ParseStatus::COMPLETE);
+    EXPECT_EQ(result.size, second.size());
+    EXPECT_EQ(message.msg_type, "F");
+    EXPECT_EQ(message.orig_cl_ord_id, "1");
+
+    // Any prefix of a message is incomplete
+    for (size_t size = 0; size < first.size(); size++) {
+        ASSERT_EQ(parse_message(std::string_view { first }.substr(0, size), message).status, ParseStatus::INCOMPLETE) << size;
+    }
+
+    auto expect_malformed = [&] (std::string text) {
+        EXPECT_EQ(parse_message(text, message).status, ParseStatus::MALFORMED) << text;
+    };
+    auto corrupted = first;
+    corrupted[first.find("100.25")] = '2';
+    expect_malformed(corrupted);
+    expect_malformed("8=FIX.4.2" + first.substr(9));
+    expect_malformed(make_message("11=1|35=D|"));
+    expect_malformed(make_message("35=D|11=1"));
+    expect_malformed(make_message("35=D|x1=1|"));
+    expect_malformed(make_message("35=D|=1|"));
+    expect_malformed(make_message("35=D|11|"));
+    expect_malformed(std::string { BeginString } + "9=1234567");
+}
+
+TEST(FixTest, MakesRequestsOfOrderEntryMessages) {
+    auto request = request_of("35=D|11=1|55=MSFT|54=2|38=100|40=2|44=100.5|59=1|111=10|");
+    ASSERT_TRUE(request.has_value());
+    EXPECT_EQ(request->type, gateway::RequestType::NEW_ORDER);
+    EXPECT_EQ(request->order_type, OrderType::LIMIT);
+    EXPECT_EQ(request->side, OrderSide::SELL);
+    EXPECT_EQ(request->time_in_force, TimeInForce::GTC);
+    EXPECT_EQ(request->symbol_id, 1);
+    EXPECT_EQ(request->order_id, 1);
+    EXPECT_EQ(request->price, 10050);
+    EXPECT_EQ(request->quantity, 100);
+    EXPECT_EQ(request->max_visible_quantity, 10);
+
+    // Market orders are IOC unless told otherwise
+    request = request_of("35=D|11=2|55=AAPL|54=1|38=5|40=1|");
+    ASSERT_TRUE(request.has_value());
+    EXPECT_EQ(request->order_type, OrderType::MARKET);
+    EXPECT_EQ(request->time_in_force, TimeInForce::IOC);
+    EXPECT_EQ(request->max_visible_quantity, Quantity::max().value);
+
+    request = request_of("35=D|11=3|55=AAPL|54=1|38=5|40=4|44=101|99=100|59=4|");
+    ASSERT_TRUE(request.has_value());
+    EXPECT_EQ(request->order_type, OrderType::STOP_LIMIT);
+    EXPECT_EQ(request->time_in_force, TimeInForce::FOK);
+    EXPECT_EQ(request->price, 10100);
+    EXPECT_EQ(request->stop_price, 10000);
+
+    request = request_of("35=D|11=4|55=AAPL|54=2|38=5|40=3|99=99.5|18=a|211=-1.5|");
+    ASSERT_TRUE(request.has_value());
+    EXPECT_EQ(request->order_type, OrderType::TRAILING_STOP);
+    EXPECT_EQ(request->stop_price, 9950);
+    EXPECT_EQ(request->trailing_distance, 150);
+
+    request = request_of("35=D|11=5|55=AAPL|54=1|38=5|40=2|44=1|18=G|");
+    ASSERT_TRUE(request.has_value());
+    EXPECT_EQ(request->time_in_force, TimeInForce::AON);
+
+    request = request_of("35=F|11=60|41=5|55=AAPL|54=1|");
+    ASSERT_TRUE(request.has_value());
+    EXPECT_EQ(request->type, gateway::RequestType::CANCEL);
+    EXPECT_EQ(request->order_id, 5);
+
+    request = request_of("35=G|11=6|41=5|55=AAPL|54=1|38=7|40=2|44=2|");
+    ASSERT_TRUE(request.has_value());
+    EXPECT_EQ(request->type, gateway::RequestType::REPLACE);
+    EXPECT_EQ(request->order_id, 5);
+    EXPECT_EQ(request->new_order_id, 6);
+    EXPECT_EQ(request->price, 200);
+    EXPECT_EQ(request->quantity, 7);
+
+    request = request_of("35=q|11=7|530=1|55=MSFT|");
+    ASSERT_TRUE(request.has_value());
+    EXPECT_EQ(request->type, gateway::RequestType::MASS_CANCEL);
+    EXPECT_EQ(request->symbol_id, 1);
+    EXPECT_EQ(request_of("35=q|11=7|530=7|")->symbol_id, gateway::AllSymbols);
+
+    // The fields don't make a request
+    EXPECT_FALSE(request_of("35=D|11=X1|55=AAPL|54=1|38=5|40=2|44=1|").has_value());
+    EXPECT_FALSE(request_of("35=D|11=1|55=IBM|54=1|38=5|40=2|44=1|").has_value());
+    EXPECT_FALSE(request_of("35=D|11=1|55=AAPL|54=1|38=5|40=2|44=1.001|").has_value());
+    EXPECT_FALSE(request_of("35=D|11=1|55=AAPL|54=1|38=5|40=2|44=1|59=6|").has_value());
+    EXPECT_FALSE(request_of("35=D|11=1|55=AAPL|54=1|38=5|40=2|44=1|18=a|211=1|").has_value());
+    EXPECT_FALSE(request_of("35=D|11=1|55=AAPL|54=1|40=2|44=1|").has_value());
+    EXPECT_FALSE(request_of("35=q|530=3|").has_value());
+    EXPECT_FALSE(request_of("35=0|").has_value());
+
+    EXPECT_EQ(parse_decimal("1.500", 1), 15);
+    EXPECT_EQ(parse_decimal(".5", 2), 50);
+    EXPECT_EQ(parse_decimal("7", 3), 7000);
+    EXPECT_FALSE(parse_decimal(".", 2).has_value());
+    EXPECT_FALSE(parse_decimal("1.5", 0).has_value());
+    EXPECT_FALSE(parse_decimal("99999999999999999", 4).has_value());
+}
+
+TEST(FixTest, EncodesTheExecutionReportsOfTheEngine) {
+    std::array<handlers::ExecutionReport, 16> reports;
+    MatchingEngine<Order, handlers::ExecutionReportEventHandler> engine { handlers::ExecutionReportEventHandler { reports } };
+    engine.add_new_orderbook(Symbol { 0, "AAPL" });
+    engine.add_order(Order::sell_limit(1, 0, 10025, 10));
+    engine.add_order(Order::buy_limit(2, 0, 10050, 4));
+    auto handled = engine.event_handler().reports();
+    ASSERT_EQ(handled.size(), 2);
+
+    ExecutionReportEncoder encoder { EncoderConfig { .sender_comp_id = "CHRONEX", .target_comp_id = "CLIENT", .price_decimals = 2 } };
+    std::array<char, 1024> buffer;
+    size_t size = 0;
+    for (auto& report : handled) {
+        auto written = encoder.encode(std::span { buffer }.subspan(size), report, "AAPL");
+        ASSERT_GT(written, 0);
+        size += written;
+    }
+    EXPECT_EQ(encoder.next_sequence(), 3);
+
+    // What's encoded parses back
+    std::string_view stream { buffer.data(), size };
+    Message message;
+    auto result = parse_message(stream, message);
+    ASSERT_EQ(result.status, ParseStatus::COMPLETE);
+    auto rest = fields_of(stream.substr(0, result.size));
+    EXPECT_EQ(rest[35], "8");
+    EXPECT_EQ(rest[49], "CHRONEX");
+    EXPECT_EQ(rest[56], "CLIENT");
+    EXPECT_EQ(rest[34], "1");
+    EXPECT_EQ(rest[52].size(), 21);
+    EXPECT_EQ(rest[37], "1");
+    EXPECT_EQ(rest[150], "0");
+    EXPECT_EQ(rest[39], "0");
+    EXPECT_EQ(rest[54], "2");
+    EXPECT_EQ(rest[40], "2");
+    EXPECT_EQ(rest[151], "10");
+    EXPECT_EQ(rest.count(31), 0);
+
+    stream.remove_prefix(result.size);
+    result = parse_message(stream, message);
+    ASSERT_EQ(result.status, ParseStatus::COMPLETE);
+    EXPECT_EQ(result.size, stream.size());
+    auto fill = fields_of(stream);
+    EXPECT_EQ(fill[34], "2");
+    EXPECT_EQ(fill[37], "2");
+    EXPECT_EQ(fill[150], "F");
+    EXPECT_EQ(fill[39], "2");
+    EXPECT_EQ(fill[32], "4");
+    EXPECT_EQ(fill[31], "100.25");
+    EXPECT_EQ(fill[151], "0");
+    EXPECT_EQ(fill[6], "0.00");
+
+    // The resting order was partially filled
+    auto resting = resting_side(handled[1], engine.order_at(OrderId { 1 })->leaves_quantity().value);
+    size = encoder.encode(buffer, resting, "AAPL", OrderTotals { .cum_quantity = 4, .avg_price = 5 });
+    auto other_side = fields_of(std::string_view { buffer.data(), size });
+    EXPECT_EQ(other_side[37], "1");
+    EXPECT_EQ(other_side[54], "2");
+    EXPECT_EQ(other_side[39], "1");
+    EXPECT_EQ(other_side[151], "6");
+    EXPECT_EQ(other_side[14], "4");
+    EXPECT_EQ(other_side[6], "0.05");
+
+    // Nothing is written, nor counted, if it doesn't fit
+    EXPECT_EQ(encoder.encode(std::span { buffer }.first(64), resting, "AAPL"), 0);
+    EXPECT_EQ(encoder.next_sequence(), 4);
+}
@@ -0,0 +1,339 @@
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include <chronex/gateway/Gateway.hpp>
+#include <chronex/gateway/GatewayClient.hpp>
+
+using namespace chronex;
+using namespace chronex::gateway;
+using handlers::ExecutionReportType;
+
+namespace {
+
+// Unique per process, so that test runs don't step on each other
+std::string socket_path(const std::string& test) {
+    return "/tmp/chronex-gateway-test-" + test + "-" + std::to_string(::getpid()) + ".sock";
+}
+
+std::optional<Gateway<>> make_gateway(const std::string& test) {
+    auto gateway = Gateway<>::create(socket_path(test));
+    if (gateway) {
+        gateway->engine().add_new_orderbook(Symbol { 0, "A" });
+        gateway->engine().add_new_orderbook(Symbol { 1, "B" });
+    }
+    return gateway;
+}
+
+Request limit(const uint64_t id, const uint32_t symbol_id, const OrderSide side, const uint64_t price, const uint64_t quantity,
+              const TimeInForce tif = TimeInForce::GTC) {
+    return Request {
+        .type = RequestType::NEW_ORDER,
+        .order_type = OrderType::LIMIT,
+        .side = side,
+        .time_in_force = tif,
+        .symbol_id = symbol_id,
+        .order_id = id,
+        .new_order_id = 0,
+        .price = price,
+        .stop_price = 0,
+        .quantity = quantity,
+        .max_visible_quantity = Quantity::max().value,
+        .trailing_distance = 0,
+        .trailing_step = 0
+    };
+}
+
+Request request(const RequestType type, const uint64_t id, const uint32_t symbol_id = 0) {
+    auto result = limit(id, symbol_id, OrderSide::BUY, 0, 0);
+    result.type = type;
+    return result;
+}
+
+// Once to accept the sessions that are new, then once to read their requests
+void poll(Gateway<>& gateway) {
+    (void)gateway.poll(0);
+    (void)gateway.poll(0);
+}
+
+void send(Gateway<>& gateway, GatewayClient& client, const Request& request) {
+    ASSERT_TRUE(client.send(request));
+    poll(gateway);
+}
+
+}
+
+TEST(GatewayTest, ReportsToBothSessionsOfATrade) {
+    auto gateway = make_gateway("trade");
+    ASSERT_TRUE(gateway.has_value());
+    auto seller = GatewayClient::connect(gateway->path());
+    auto buyer = GatewayClient::connect(gateway->path());
+    ASSERT_TRUE(seller.has_value());
+    ASSERT_TRUE(buyer.has_value());
+
+    send(*gateway, *seller, limit(1, 0, OrderSide::SELL, 100, 10));
+    EXPECT_EQ(gateway->sessions_count(), 2);
+    auto response = seller->receive();
+    ASSERT_TRUE(response.has_value());
+    EXPECT_EQ(response->type, ResponseType::EXECUTION_REPORT);
+    EXPECT_EQ(response->sequence, 1);
+    EXPECT_EQ(response->report.type, ExecutionReportType::REST);
+    EXPECT_EQ(response->report.order_id, 1);
+    EXPECT_EQ(response->report.quantity, 10);
+
+    send(*gateway, *buyer, limit(2, 0, OrderSide::BUY, 100, 4));
+    for (auto* client : { &*buyer, &*seller }) {
+        response = client->receive();
+        ASSERT_TRUE(response.has_value());
+        EXPECT_EQ(response->report.type, ExecutionReportType::FILL);
+        EXPECT_EQ(response->report.order_id, 2);
+        EXPECT_EQ(response->report.other_order_id, 1);
+        EXPECT_EQ(response->report.price, 100);
+        EXPECT_EQ(response->report.quantity, 4);
+        EXPECT_EQ(response->report.leaves_quantity, 0);
+    }
+    EXPECT_EQ(response->sequence, 2);
+    EXPECT_EQ(gateway->engine().order_at(OrderId { 1 })->leaves_quantity().value, 6);
+}
+
+TEST(GatewayTest, RejectsWhatTheEngineWouldAssertOn) {
+    auto gateway = make_gateway("rejects");
+    ASSERT_TRUE(gateway.has_value());
+    auto client = GatewayClient::connect(gateway->path());
+    auto other = GatewayClient::connect(gateway->path());
+    ASSERT_TRUE(client.has_value());
+    ASSERT_TRUE(other.has_value());
+
+    auto expect_reject = [&] (GatewayClient& session, const Request& request, const RejectReason reason, const uint64_t order_id) {
+        send(*gateway, session, request);
+        auto response = session.receive();
+        ASSERT_TRUE(response.has_value());
+        EXPECT_EQ(response->type, ResponseType::REJECT);
+        EXPECT_EQ(response->reason, reason);
+        EXPECT_EQ(response->report.order_id, order_id);
+    };
+
+    send(*gateway, *client, limit(1, 0, OrderSide::BUY, 100, 10));
+    ASSERT_EQ(client->receive()->report.type, ExecutionReportType::REST);
+
+    expect_reject(*client, limit(2, 7, OrderSide::BUY, 100, 10), RejectReason::UNKNOWN_SYMBOL, 2);
+    expect_reject(*client, limit(1, 0, OrderSide::BUY, 100, 10), RejectReason::DUPLICATE_ORDER_ID, 1);
+    expect_reject(*client, limit(2, 0, OrderSide::BUY, 100, 0), RejectReason::INVALID_ORDER, 2);
+
+    auto market = limit(2, 0, OrderSide::SELL, 0, 10);
+    market.order_type = OrderType::MARKET;
+    expect_reject(*client, market, RejectReason::INVALID_ORDER, 2);
+
+    auto stop = limit(2, 0, OrderSide::SELL, 0, 10, TimeInForce::AON);
+    stop.order_type = OrderType::STOP;
+    stop.stop_price = 90;
+    expect_reject(*client, stop, RejectReason::INVALID_ORDER, 2);
+
+    auto trailing = limit(2, 0, OrderSide::SELL, 0, 10);
+    trailing.order_type = OrderType::TRAILING_STOP;
+    trailing.stop_price = 90;
+    trailing.trailing_distance = 5;
+    trailing.trailing_step = 5;
+    expect_reject(*client, trailing, RejectReason::INVALID_ORDER, 2);
+
+    auto unknown = limit(2, 0, OrderSide::SELL, 100, 10);
+    unknown.order_type = static_cast<OrderType>(0);
+    expect_reject(*client, unknown, RejectReason::INVALID_ORDER, 2);
+
+    // Only the session that entered an order can touch it
+    expect_reject(*other, request(RequestType::CANCEL, 1), RejectReason::UNKNOWN_ORDER, 1);
+    expect_reject(*client, request(RequestType::CANCEL, 42), RejectReason::UNKNOWN_ORDER, 42);
+    expect_reject(*client, request(static_cast<RequestType>(100), 1), RejectReason::BAD_REQUEST, 1);
+
+    // Modifies and replaces are bound the same way as new orders
+    auto modify = request(RequestType::MODIFY, 1);
+    modify.price = 100;
+    modify.quantity = Quantity::invalid().value;
+    expect_reject(*client, modify, RejectReason::INVALID_ORDER, 1);
+    auto replace = request(RequestType::REPLACE, 1);
+    replace.new_order_id = 2;
+    replace.price = 100;
+    replace.quantity = Quantity::invalid().value;
+    expect_reject(*client, replace, RejectReason::INVALID_ORDER, 2);
+
+    EXPECT_EQ(gateway->rejects_count(), 12);
+    EXPECT_TRUE(gateway->engine().has_order(OrderId { 1 }));
+}
+
+TEST(GatewayTest, CancelsModifiesAndReplaces) {
+    auto gateway = make_gateway("amend");
+    ASSERT_TRUE(gateway.has_value());
+    auto client = GatewayClient::connect(gateway->path());
+    ASSERT_TRUE(client.has_value());
+
+    // A batch of requests, with a single send
+    std::vector<Request> batch {
+        limit(1, 0, OrderSide::BUY, 100, 10),
+        limit(2, 0, OrderSide::BUY, 99, 10),
+        limit(3, 1, OrderSide::BUY, 99, 10),
+        limit(4, 1, OrderSide::SELL, 120, 10)
+    };
+    ASSERT_TRUE(client->send(batch));
+    poll(*gateway);
+    EXPECT_EQ(gateway->requests_count(), 4);
+    for (uint64_t i = 1; i <= 4; i++) {
+        auto response = client->receive();
+        ASSERT_TRUE(response.has_value());
+        EXPECT_EQ(response->sequence, i);
+        EXPECT_EQ(response->report.order_id, i);
+        EXPECT_EQ(response->report.type, ExecutionReportType::REST);
+    }
+
+    send(*gateway, *client, request(RequestType::CANCEL, 1));
+    auto response = client->receive();
+    EXPECT_EQ(response->report.type, ExecutionReportType::CANCEL);
+    EXPECT_EQ(response->report.quantity, 10);
+    EXPECT_FALSE(gateway->engine().has_order(OrderId { 1 }));
+
+    // Moved by taking the order out of the book and back in
+    auto modify = request(RequestType::MODIFY, 2);
+    modify.price = 98;
+    modify.quantity = 5;
+    send(*gateway, *client, modify);
+    EXPECT_EQ(client->receive()->report.type, ExecutionReportType::CANCEL);
+    response = client->receive();
+    EXPECT_EQ(response->report.type, ExecutionReportType::REST);
+    EXPECT_EQ(response->report.price, 98);
+    EXPECT_EQ(response->report.quantity, 5);
+
+    auto replace = request(RequestType::REPLACE, 2);
+    replace.new_order_id = 5;
+    replace.price = 97;
+    replace.quantity = 7;
+    send(*gateway, *client, replace);
+    response = client->receive();
+    EXPECT_EQ(response->report.type, ExecutionReportType::CANCEL);
+    EXPECT_EQ(response->report.order_id, 2);
+    response = client->receive();
+    EXPECT_EQ(response->report.type, ExecutionReportType::REST);
+    EXPECT_EQ(response->report.order_id, 5);
+    EXPECT_EQ(response->report.price, 97);
+
+    send(*gateway, *client, request(RequestType::MASS_CANCEL, 0, 1));
+    for (int i = 0; i < 2; i++) {
+        response = client->receive();
+        EXPECT_EQ(response->report.type, ExecutionReportType::CANCEL);
+        EXPECT_EQ(response->report.symbol_id, 1);
+    }
+    response = client->receive();
+    EXPECT_EQ(response->type, ResponseType::MASS_CANCEL_DONE);
+    EXPECT_EQ(response->report.quantity, 2);
+    EXPECT_TRUE(gateway->engine().has_order(OrderId { 5 }));
+    EXPECT_FALSE(gateway->engine().has_order(OrderId { 3 }));
+}
+
+TEST(GatewayTest, OrdersThatDontRestAreCancelled) {
+    auto gateway = make_gateway("leftover");
+    ASSERT_TRUE(gateway.has_value());
+    auto client = GatewayClient::connect(gateway->path());
+    ASSERT_TRUE(client.has_value());
+
+    auto market = limit(1, 0, OrderSide::BUY, 0, 10, TimeInForce::IOC);
+    market.order_type = OrderType::MARKET;
+    send(*gateway, *client, market);
+    auto response = client->receive();
+    ASSERT_TRUE(response.has_value());
+    EXPECT_EQ(response->report.type, ExecutionReportType::CANCEL);
+    EXPECT_EQ(response->report.order_id, 1);
+    EXPECT_EQ(response->report.quantity, 10);
+
+    // Partially filled, then the rest is cancelled
+    send(*gateway, *client, limit(2, 0, OrderSide::SELL, 100, 4));
+    EXPECT_EQ(client->receive()->report.type, ExecutionReportType::REST);
+    send(*gateway, *client, limit(3, 0, OrderSide::BUY, 100, 10, TimeInForce::IOC));
+    response = client->receive();
+    EXPECT_EQ(response->report.type, ExecutionReportType::FILL);
+    EXPECT_EQ(response->report.leaves_quantity, 6);
+    response = client->receive();
+    EXPECT_EQ(response->report.type, ExecutionReportType::CANCEL);
+    EXPECT_EQ(response->report.order_id, 3);
+    EXPECT_EQ(response->report.quantity, 6);
+}
+
+TEST(GatewayTest, StopLimitOrdersKeepTheirLimitPrice) {
+    auto gateway = make_gateway("stop-limit");
+    ASSERT_TRUE(gateway.has_value());
+    auto client = GatewayClient::connect(gateway->path());
+    ASSERT_TRUE(client.has_value());
+
+    // A market to stay away from, so that the order isn't triggered right away
+    send(*gateway, *client, limit(1, 0, OrderSide::BUY, 90, 1));
+    send(*gateway, *client, limit(2, 0, OrderSide::SELL, 100, 1));
+    (void)client->receive();
+    (void)client->receive();
+
+    auto stop_limit = limit(3, 0, OrderSide::BUY, 105, 10, TimeInForce::AON);
+    stop_limit.order_type = OrderType::STOP_LIMIT;
+    stop_limit.stop_price = 110;
+    send(*gateway, *client, stop_limit);
+    auto response = client->receive();
+    ASSERT_TRUE(response.has_value());
+    EXPECT_EQ(response->type, ResponseType::EXECUTION_REPORT);
+    EXPECT_EQ(response->report.type, ExecutionReportType::REST);
+
+    ASSERT_TRUE(gateway->engine().has_order(OrderId { 3 }));
+    auto order = gateway->engine().order_at(OrderId { 3 });
+    EXPECT_EQ(order->price().value, 105);
+    EXPECT_EQ(order->stop_price().value, 110);
+}
+
+TEST(GatewayTest, CancelsTheOrdersOfDisconnectedSessions) {
+    auto gateway = make_gateway("disconnect");
+    ASSERT_TRUE(gateway.has_value());
+    auto client = GatewayClient::connect(gateway->path());
+    ASSERT_TRUE(client.has_value());
+
+    send(*gateway, *client, limit(1, 0, OrderSide::BUY, 100, 10));
+    ASSERT_TRUE(gateway->engine().has_order(OrderId { 1 }));
+
+    client.reset();
+    poll(*gateway);
+    EXPECT_EQ(gateway->sessions_count(), 0);
+    EXPECT_FALSE(gateway->engine().has_order(OrderId { 1 }));
+
+    // The ID is free again
+    auto next = GatewayClient::connect(gateway->path());
+    ASSERT_TRUE(next.has_value());
+    send(*gateway, *next, limit(1, 0, OrderSide::BUY, 100, 10));
+    EXPECT_EQ(next->receive()->report.type, ExecutionReportType::REST);
+}
+
+TEST(GatewayTest, OrdersOfRemovedBooksAreForgotten) {
+    auto gateway = make_gateway("removed-books");
+    ASSERT_TRUE(gateway.has_value());
+    auto client = GatewayClient::connect(gateway->path());
+    ASSERT_TRUE(client.has_value());
+
+    send(*gateway, *client, limit(1, 0, OrderSide::BUY, 100, 10));
+    send(*gateway, *client, limit(2, 1, OrderSide::BUY, 100, 10));
+    send(*gateway, *client, limit(3, 1, OrderSide::BUY, 99, 10));
+    for (int i = 0; i < 3; i++) {
+        EXPECT_EQ(client->receive()->report.type, ExecutionReportType::REST);
+    }
+
+    // Removed behind the gateway's back, without reports
+    gateway->engine().remove_orderbook(Symbol { 0, "A" });
+    send(*gateway, *client, request(RequestType::CANCEL, 1));
+    EXPECT_EQ(client->receive()->reason, RejectReason::UNKNOWN_ORDER);
+
+    gateway->remove_orderbook(Symbol { 1, "B" });
+    send(*gateway, *client, request(RequestType::MASS_CANCEL, 0, AllSymbols));
+    auto response = client->receive();
+    ASSERT_TRUE(response.has_value());
+    EXPECT_EQ(response->type, ResponseType::MASS_CANCEL_DONE);
+    EXPECT_EQ(response->report.quantity, 0);
+
+    // Nothing left to cancel on disconnect either
+    client.reset();
+    poll(*gateway);
+    EXPECT_EQ(gateway->sessions_count(), 0);
+}
@@ -0,0 +1,104 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <set>
+#include <variant>
+
+#include <gtest/gtest.h>
+
+#include <chronex/generator/OrderFlowGenerator.hpp>
+#include <chronex/matching/CommandFile.hpp>
+#include <chronex/matching/Commands.hpp>
+#include <chronex/matching/MatchingEngine.hpp>
+
+using namespace chronex;
+using namespace chronex::generator;
+
+TEST(GeneratorTest, TheSameSeedGeneratesTheSameFlow) {
+    GeneratorConfig config;
+    config.seed = 7;
+    OrderFlowGenerator<> first { config };
+    OrderFlowGenerator<> second { config };
+    config.seed = 8;
+    OrderFlowGenerator<> other { config };
+
+    size_t differences = 0;
+    for (int i = 0; i < 10'000; i++) {
+        auto record = commands::make_command_record(first.next(), first.timestamp());
+        auto same = commands::make_command_record(second.next(), second.timestamp());
+        auto different = commands::make_command_record(other.next(), other.timestamp());
+        ASSERT_EQ(std::memcmp(&record, &same, sizeof(record)), 0) << "At command " << i;
+        differences += std::memcmp(&record, &different, sizeof(record)) != 0;
+    }
+    EXPECT_EQ(first.commands_count(), 10'000);
+    // The books are the same for both, only their timestamps differ
+    EXPECT_GT(differences, 9'900);
+}
+
+TEST(GeneratorTest, TheFlowHasEveryKindOfOrderAndRunsOnTheEngine) {
+    GeneratorConfig config;
+    config.symbols_count = 4;
+    config.max_live_orders = 256;
+    config.arrivals_per_second = 1'000'000;
+    OrderFlowGenerator<> generator { config };
+
+    MatchingEngine<> engine;
+    std::set<OrderType> types;
+    std::set<TimeInForce> times_in_force;
+    size_t icebergs = 0, absolute_trailing = 0, percentage_trailing = 0;
+    size_t cancels = 0, replaces = 0, modifies = 0, applied = 0;
+    constexpr size_t count = 200'000;
+    uint64_t last_timestamp = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        auto command = generator.next();
+        EXPECT_GE(generator.timestamp(), last_timestamp);
+        last_timestamp = generator.timestamp();
+
+        if (i < config.symbols_count) {
+            ASSERT_TRUE(std::holds_alternative<commands::AddNewOrderBook>(command));
+            EXPECT_EQ(std::get<commands::AddNewOrderBook>(command).symbol.id, SymbolId { uint32_t(i) });
+        } else if (auto* add = std::get_if<commands::AddOrder<>>(&command)) {
+            auto& order = add->order;
+            EXPECT_TRUE(order.is_valid());
+            // Fresh IDs only
+            EXPECT_FALSE(engine.has_order(order.id()));
+            EXPECT_LT(order.symbol_id().value, config.symbols_count);
+            EXPECT_EQ(order.leaves_quantity().value % config.lot_size, 0);
+            types.insert(order.type());
+            times_in_force.insert(order.time_in_force());
+            icebergs += order.is_iceberg();
+            if (order.trailing_distance().is_valid()) {
+                absolute_trailing += order.trailing_distance().is_absolute();
+                percentage_trailing += order.trailing_distance().is_percentage();
+            }
+        } else {
+            cancels += std::holds_alternative<commands::RemoveOrder>(command);
+            replaces += std::holds_alternative<commands::ReplaceOrder<>>(command);
+            modifies += std::holds_alternative<commands::ModifyOrder>(command);
+        }
+        applied += commands::apply(engine, std::move(command));
+    }
+
+    EXPECT_EQ(types, (std::set { OrderType::MARKET, OrderType::LIMIT, OrderType::STOP, OrderType::STOP_LIMIT,
+                                 OrderType::TRAILING_STOP, OrderType::TRAILING_STOP_LIMIT }));
+    EXPECT_EQ(times_in_force, (std::set { TimeInForce::IOC, TimeInForce::FOK, TimeInForce::GTC, TimeInForce::AON }));
+    EXPECT_GT(icebergs, 0);
+    EXPECT_GT(absolute_trailing, 0);
+    EXPECT_GT(percentage_trailing, 0);
+
+    // Roughly the configured ratios. The cancels include the ones that make room for new orders.
+    EXPECT_NEAR(double(replaces) / count, config.replace_ratio, 0.01);
+    EXPECT_NEAR(double(modifies) / count, config.modify_ratio, 0.01);
+    EXPECT_GT(double(cancels) / count, config.cancel_ratio - 0.01);
+    // Some commands are about orders that were filled in the meantime, but most aren't
+    EXPECT_GT(applied, count * 2 / 3);
+
+    // A million arrivals a second, on average
+    EXPECT_NEAR(double(last_timestamp) / count, 1'000, 20);
+
+    // Nothing rests beyond what's tracked, since the oldest are cancelled to make room
+    size_t live_orders = 0;
+    for (uint64_t id = 1; id <= count; id++) live_orders += engine.has_order(OrderId { id });
+    EXPECT_LE(live_orders, config.symbols_count * config.max_live_orders);
+}
@@ -0,0 +1,807 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include <chronex/handlers/BinaryRingEventHandler.hpp>
+#include <chronex/handlers/BufferedTextEventHandler.hpp>
+#include <chronex/handlers/CommandFlushingEventHandler.hpp>
+#include <chronex/handlers/CompositeEventHandler.hpp>
+#include <chronex/handlers/ExecutionReportEventHandler.hpp>
+#include <chronex/handlers/MarketByPriceEventHandler.hpp>
+#include <chronex/handlers/TopOfBookEventHandler.hpp>
+#include <chronex/matching/MatchingEngine.hpp>
+#include <chronex/handlers/StreamEventHandler.hpp>
+
+namespace chronex::handlers {
+
+namespace {
+
+using Engine = MatchingEngine<Order, BinaryRingEventHandler>;
+
+std::vector<EventRecord> drain(BinaryRingEventHandler::Ring& ring) {
+    std::vector<EventRecord> records;
+    (void)ring.consume([&records] (EventRecord& record) { records.push_back(record); });
+    return records;
+}
+
+const EventRecord* find(const std::vector<EventRecord>& records, EventType event, uint64_t order_id) {
+    auto it = std::find_if(records.begin(), records.end(), [&] (const EventRecord& record) {
+        return record.event == event && record.order_id == order_id;
+    });
+    return it == records.end() ? nullptr : &*it;
+}
+
+struct StringStreamFunc {
+    std::ostream& operator()() const {
+        static std::stringstream stream;
+        return stream;
+    }
+};
+
+// Goes through every kind of event
+template <typename Engine>
+void run_scenario(Engine& engine, const uint32_t symbol_id) {
+    constexpr uint64_t step = 100;
+    auto id = [&, next = uint64_t { symbol_id } * step] () mutable { return ++next; };
+
+    engine.add_new_orderbook(Symbol { symbol_id, "GOOG" });
+
+    auto resting = id();
+    engine.add_order(Order::buy_limit(resting, symbol_id, 100, 20));
+    engine.add_order(Order::sell_limit(id(), symbol_id, 200, 20));
+    engine.add_order(Order::sell_market(id(), symbol_id, 10));
+    engine.add_order(Order::buy_market(id(), symbol_id, 10));
+
+    engine.add_order(Order::trailing_buy_stop(id(), symbol_id, 1000, 10, TrailingDistance::from_percentage_units(10, 5)));
+    engine.add_order(Order::trailing_sell_stop_limit(id(), symbol_id, 0, 10, 10, TrailingDistance::from_percentage_units(-1000, -500)));
+    engine.modify_order(OrderId { resting }, Price { 120 }, Quantity { 20 });
+    engine.add_order(Order::sell_stop(id(), symbol_id, 150, 5));
+    engine.add_order(Order::buy_stop_limit(id(), symbol_id, 50, 60, 5));
+
+    engine.execute_order(OrderId { resting }, Quantity { 3 }, Price { 120 });
+    engine.reduce_order(OrderId { resting }, Quantity { 2 });
+    engine.replace_order(OrderId { resting }, Order::limit(id(), symbol_id, OrderSide::SELL, 42, 100));
+
+    engine.disable_matching();
+    engine.add_order(Order::buy_limit(id(), symbol_id, 300, 7));
+    engine.add_order(Order::sell_limit(id(), symbol_id, 290, 4));
+    engine.enable_matching();
+
+    engine.remove_orderbook(Symbol { symbol_id, "GOOG" });
+}
+
+// Records which handler saw which order being added
+struct AddedOrdersHandler : NullEventHandler {
+    explicit AddedOrdersHandler(std::vector<std::pair<int, uint64_t>>* log = nullptr, int tag = 0) : added(log), name(tag) { }
+
+    template <OrderType, OrderSide, typename T, typename U>
+    void on_add_order(T&, U& order) noexcept { added->emplace_back(name, order.id().value); }
+
+    std::vector<std::pair<int, uint64_t>>* added;
+    int name;
+};
+
+// Only wants to know about the levels, like a top-of-book publisher would
+struct LevelsOnlyHandler : NullEventHandler {
+    constexpr static EventMask event_mask = EventBits::Levels;
+
+    template <OrderType, OrderSide, typename T, typename U>
+    void on_add_level(T&, U&) noexcept { ++levels; }
+    template <OrderType, OrderSide, typename T, typename U>
+    void on_add_order(T&, U&) noexcept { ++orders; }
+
+    int levels = 0;
+    int orders = 0;
+};
+
+// Wants the trades, and the removals that are not part of them
+template <EventMask details = EventBits::None>
+struct TradesHandler : NullEventHandler {
+    constexpr static EventMask event_mask = EventBits::Trade | EventBits::RemoveOrder | EventBits::ExecuteOrder | details;
+
+    struct Trade {
+        OrderSide side;
+        uint64_t aggressor_id;
+        uint64_t resting_id;
+        uint64_t quantity;
+        uint64_t price;
+        TradeFlags flags;
+    };
+
+    template <OrderSide side, typename T, typename U, typename Q, typename P, typename F>
+    void on_trade(T&, U& aggressor, U& resting, Q quantity, P price, F flags) noexcept {
+        trades.push_back(Trade { side, aggressor.id().value, resting.id().value, quantity.value, price.value, flags });
+    }
+    template <OrderType, OrderSide, typename T, typename U>
+    void on_remove_order(T&, U&) noexcept { ++removals; }
+    template <OrderSide, typename T, typename U, typename V, typename P>
+    void on_execute_order(T&, U&, V, P) noexcept { ++executions; }
+
+    std::vector<Trade> trades;
+    int removals = 0;
+    int executions = 0;
+};
+
+// Logs the executions and removals of the orders
+struct ExecutionsHandler : NullEventHandler {
+    constexpr static EventMask event_mask = EventBits::ExecuteOrder | EventBits::RemoveOrder;
+
+    template <OrderSide, typename T, typename U, typename V, typename P>
+    void on_execute_order(T&, U& order, V quantity, P) noexcept {
+        log.push_back("execute " + std::to_string(order.id().value) + " " + std::to_string(quantity.value));
+    }
+    template <OrderType, OrderSide, typename T, typename U>
+    void on_remove_order(T&, U& order) noexcept { log.push_back("remove " + std::to_string(order.id().value)); }
+
+    std::vector<std::string> log;
+};
+
+// Logs the commands, and the orders added in between
+struct CommandsHandler : NullEventHandler {
+    constexpr static EventMask event_mask = EventBits::Commands | EventBits::AddOrder;
+
+    void on_command_begin(const uint64_t sequence) noexcept { log.push_back("begin " + std::to_string(sequence)); }
+    void on_command_end(const uint64_t sequence) noexcept { log.push_back("end " + std::to_string(sequence)); }
+    template <OrderType, OrderSide, typename T, typename U>
+    void on_add_order(T&, U& order) noexcept { log.push_back("add " + std::to_string(order.id().value)); }
+
+    std::vector<std::string> log;
+};
+
+std::string read_file(std::FILE* file) {
+    std::string content;
+    std::rewind(file);
+    char buffer[4096];
+    while (auto count = std::fread(buffer, 1, sizeof(buffer), file)) {
+        content.append(buffer, count);
+    }
+    return content;
+}
+
+}
+
+TEST(BinaryRingEventHandlerTest, RecordsAreInvisibleUntilFlushed) {
+    BinaryRingEventHandler::Ring ring { 64 };
+    Engine engine { BinaryRingEventHandler { &ring } };
+
+    engine.add_new_orderbook(Symbol { 3, "ABC" });
+    EXPECT_TRUE(ring.is_empty());
+
+    engine.event_handler().flush();
+    auto records = drain(ring);
+    ASSERT_EQ(records.size(), 1);
+    EXPECT_EQ(records[0].event, EventType::ADD_NEW_ORDERBOOK);
+    EXPECT_EQ(records[0].symbol_id, 3);
+    EXPECT_STREQ(records[0].symbol_name, "ABC");
+}
+
+TEST(BinaryRingEventHandlerTest, OrderEvents) {
+    BinaryRingEventHandler::Ring ring { 64 };
+    Engine engine { BinaryRingEventHandler { &ring } };
+    engine.add_new_orderbook(Symbol { 0, "A" });
+
+    // Matching orders that are both in the book reports on_match_order
+    engine.disable_matching();
+    auto resting = Order::buy_limit(1, 0, 100, 10, TimeInForce::GTC, 4);
+    resting.set_account_id(AccountId { 7 });
+    engine.add_order(std::move(resting));
+    engine.add_order(Order::sell_limit(2, 0, 100, 3));
+    engine.enable_matching();
+    engine.event_handler().flush();
+    auto records = drain(ring);
+
+    auto* add = find(records, EventType::ADD_ORDER, 1);
+    ASSERT_NE(add, nullptr);
+    EXPECT_EQ(add->type, OrderType::LIMIT);
+    EXPECT_EQ(add->side, OrderSide::BUY);
+    EXPECT_EQ(add->order.id, 1);
+    EXPECT_EQ(add->order.price, 100);
+    EXPECT_EQ(add->order.leaves_quantity, 10);
+    EXPECT_EQ(add->order.max_visible_quantity, 4);
+    EXPECT_EQ(add->order.account_id, 7);
+    EXPECT_EQ(add->order.time_in_force, TimeInForce::GTC);
+
+    auto level = std::find_if(records.begin(), records.end(), [] (const EventRecord& record) {
+        return record.event == EventType::ADD_LEVEL;
+    });
+    ASSERT_NE(level, records.end());
+    EXPECT_EQ(level->price, 100);
+
+    auto* resting_execution = find(records, EventType::EXECUTE_ORDER, 1);
+    ASSERT_NE(resting_execution, nullptr);
+    EXPECT_EQ(resting_execution->quantity, 3);
+    EXPECT_EQ(resting_execution->price, 100);
+    EXPECT_NE(find(records, EventType::EXECUTE_ORDER, 2), nullptr);
+
+    auto match = std::find_if(records.begin(), records.end(), [] (const EventRecord& record) {
+        return record.event == EventType::MATCH_ORDER;
+    });
+    ASSERT_NE(match, records.end());
+    EXPECT_EQ(match->side, OrderSide::SELL);
+    EXPECT_EQ(match->other_side, OrderSide::BUY);
+    EXPECT_EQ(match->order_id, 2);
+    EXPECT_EQ(match->other_order_id, 1);
+
+    engine.remove_order(OrderId { 1 });
+    engine.event_handler().flush();
+    records = drain(ring);
+    auto* remove = find(records, EventType::REMOVE_ORDER, 1);
+    ASSERT_NE(remove, nullptr);
+    EXPECT_EQ(remove->quantity, 7);
+}
+
+TEST(BinaryRingEventHandlerTest, ConsumerDrainsOnItsOwnThread) {
+    // Small enough for the engine to wait on the consumer
+    BinaryRingEventHandler::Ring ring { 8 };
+    Engine engine { BinaryRingEventHandler { &ring } };
+    engine.add_new_orderbook(Symbol { 0, "A" });
+
+    uint64_t adds = 0;
+    uint64_t total = 0;
+    {
+        BinaryRingConsumer consumer { &ring, [&] (EventRecord& record) {
+            adds += record.event == EventType::ADD_ORDER;
+            ++total;
+        } };
+
+        constexpr uint64_t count = 1000;
+        for (uint64_t i = 1; i <= count; i++) {
+            engine.add_order(Order::buy_limit(i, 0, 100 + i % 10, 1));
+            engine.event_handler().flush();
+        }
+    }
+
+    EXPECT_EQ(adds, 1000);
+    EXPECT_GT(total, adds);
+    EXPECT_TRUE(ring.is_empty());
+}
+
+TEST(BufferedTextEventHandlerTest, SameOutputAsStreamEventHandler) {
+    constexpr uint32_t symbols = 20;
+
+    MatchingEngine<Order, StreamEventHandler<StringStreamFunc>> stream_engine;
+    for (uint32_t i = 0; i < symbols; i++) {
+        run_scenario(stream_engine, i);
+    }
+    auto expected = static_cast<std::stringstream&>(StringStreamFunc{ }()).str();
+
+    auto* file = std::tmpfile();
+    ASSERT_NE(file, nullptr);
+    {
+        // Small buffers, so that they fill up and get handed off many times
+        MatchingEngine<Order, BufferedTextEventHandler> engine {
+            BufferedTextEventHandler { fileno(file), { .buffer_size = 512, .buffers_count = 3 } }
+        };
+        for (uint32_t i = 0; i < symbols; i++) {
+            run_scenario(engine, i);
+        }
+        engine.event_handler().sync();
+        EXPECT_EQ(read_file(file), expected);
+
+        engine.add_new_orderbook(Symbol { symbols, "LAST" });
+    }
+
+    // The rest is written on destruction
+    EXPECT_EQ(read_file(file), expected + "add_new_orderbook\tLAST\n");
+    std::fclose(file);
+}
+
+TEST(BufferedTextEventHandlerTest, WriteErrorsAreReported) {
+    auto* file = std::tmpfile();
+    ASSERT_NE(file, nullptr);
+    auto fd = ::dup(fileno(file));
+    ASSERT_GE(fd, 0);
+    ::close(fd);
+
+    MatchingEngine<Order, BufferedTextEventHandler> engine { BufferedTextEventHandler { fd, { .buffer_size = 512 } } };
+    engine.add_new_orderbook(Symbol { 0, "A" });
+    EXPECT_FALSE(engine.event_handler().sync());
+    EXPECT_EQ(engine.event_handler().error(), EBADF);
+
+    // Sticky, even when there's nothing new to write
+    EXPECT_FALSE(engine.event_handler().flush());
+    std::fclose(file);
+}
+
+TEST(CompositeEventHandlerTest, ForwardsToEveryHandlerInOrder) {
+    std::vector<std::pair<int, uint64_t>> added;
+    BinaryRingEventHandler::Ring ring { 64 };
+    using Handler = CompositeEventHandler<AddedOrdersHandler, BinaryRingEventHandler, AddedOrdersHandler>;
+    MatchingEngine<Order, Handler> engine {
+        Handler { AddedOrdersHandler { &added, 1 }, BinaryRingEventHandler { &ring }, AddedOrdersHandler { &added, 2 } }
+    };
+
+    engine.add_new_orderbook(Symbol { 0, "A" });
+    engine.add_order(Order::buy_limit(1, 0, 100, 10));
+    engine.add_order(Order::buy_limit(2, 0, 101, 10));
+
+    std::vector<std::pair<int, uint64_t>> expected { { 1, 1 }, { 2, 1 }, { 1, 2 }, { 2, 2 } };
+    EXPECT_EQ(added, expected);
+
+    // flush() reaches the ring handler
+    EXPECT_TRUE(ring.is_empty());
+    engine.event_handler().flush();
+    auto records = drain(ring);
+    EXPECT_NE(find(records, EventType::ADD_ORDER, 1), nullptr);
+    EXPECT_NE(find(records, EventType::ADD_ORDER, 2), nullptr);
+    EXPECT_EQ(engine.event_handler().get<1>().ring(), &ring);
+}
+
+TEST(CompositeEventHandlerTest, CallbacksNoHandlerImplementsAreNoOps) {
+    using Nulls = CompositeEventHandler<NullEventHandler, NullEventHandler>;
+    using Mixed = CompositeEventHandler<NullEventHandler, AddedOrdersHandler>;
+    using Nested = CompositeEventHandler<Nulls, NullEventHandler>;
+
+    int orderbook = 0;
+    auto order = Order::buy_limit(1, 0, 100, 10);
+    using NullsResult = decltype(std::declval<Nulls&>().on_add_order<OrderType::LIMIT, OrderSide::BUY>(orderbook, order));
+    using MixedResult = decltype(std::declval<Mixed&>().on_add_order<OrderType::LIMIT, OrderSide::BUY>(orderbook, order));
+    using MixedRemoveResult = decltype(std::declval<Mixed&>().on_remove_order<OrderType::LIMIT, OrderSide::BUY>(orderbook, order));
+    using NestedResult = decltype(std::declval<Nested&>().on_add_order<OrderType::LIMIT, OrderSide::BUY>(orderbook, order));
+
+    static_assert(is_no_op_v<NullsResult>);
+    static_assert(!is_no_op_v<MixedResult>);
+    static_assert(is_no_op_v<MixedRemoveResult>);
+    static_assert(is_no_op_v<NestedResult>);
+    SUCCEED();
+}
+
+TEST(EventMaskTest, OnlyTheEventsInTheMaskAreReported) {
+    static_assert(event_mask_v<NullEventHandler> == EventBits::None);
+    static_assert(event_mask_v<BinaryRingEventHandler> == EventBits::All);
+    static_assert(event_mask_v<AddedOrdersHandler> == EventBits::All);
+    static_assert(event_mask_v<CompositeEventHandler<NullEventHandler, LevelsOnlyHandler>> == EventBits::Levels);
+
+    MatchingEngine<Order, LevelsOnlyHandler> engine;
+    engine.add_new_orderbook(Symbol { 0, "A" });
+    engine.add_order(Order::buy_limit(1, 0, 100, 10));
+    engine.add_order(Order::buy_limit(2, 0, 100, 10));
+    engine.add_order(Order::buy_limit(3, 0, 101, 10));
+
+    EXPECT_EQ(engine.event_handler().levels, 2);
+    EXPECT_EQ(engine.event_handler().orders, 0);
+}
+
+TEST(MarketByPriceEventHandlerTest, OneUpdatePerTouchedLevel) {
+    std::vector<PriceLevelUpdate> updates;
+    auto collect = [&updates] (const PriceLevelUpdate& update) { updates.push_back(update); };
+    using Handler = MarketByPriceEventHandler<decltype(collect)>;
+    MatchingEngine<Order, Handler> engine { Handler { collect } };
+    engine.add_new_orderbook(Symbol { 0, "A" });
+
+    // 20 orders on 3 levels
+    for (uint64_t i = 0; i < 20; i++) {
+        engine.add_order(Order::sell_limit(i + 1, 0, 100 + i % 3, 10));
+    }
+    engine.event_handler().flush();
+    ASSERT_EQ(updates.size(), 3);
+    EXPECT_EQ(updates[2].sequence, 3);
+    for (auto& update : updates) {
+        EXPECT_EQ(update.side, OrderSide::SELL);
+        EXPECT_EQ(update.orders_count, update.price == 100 ? 7 : (update.price == 101 ? 7 : 6));
+        EXPECT_EQ(update.visible_volume, update.orders_count * 10);
+    }
+
+    // A single sweep through all of them
+    updates.clear();
+    engine.add_order(Order::buy_limit(100, 0, 102, 200));
+    engine.event_handler().flush();
+    ASSERT_EQ(updates.size(), 3);
+    for (auto& update : updates) {
+        EXPECT_EQ(update.orders_count, 0);
+        EXPECT_EQ(update.visible_volume, 0);
+    }
+    EXPECT_EQ(updates[0].sequence, 4);
+    EXPECT_EQ(updates[2].sequence, 6);
+}
+
+TEST(MarketByPriceEventHandlerTest, UnchangedLevelsAreNotPublished) {
+    std::vector<PriceLevelUpdate> updates;
+    auto collect = [&updates] (const PriceLevelUpdate& update) { updates.push_back(update); };
+    using Handler = MarketByPriceEventHandler<decltype(collect)>;
+    MatchingEngine<Order, Handler> engine { Handler { collect } };
+    engine.add_new_orderbook(Symbol { 0, "A" });
+
+    // Added and removed within the same flush
+    engine.add_order(Order::buy_limit(1, 0, 100, 10));
+    engine.remove_order(OrderId { 1 });
+    // Hidden orders add to the count only
+    engine.add_order(Order::buy_limit(2, 0, 99, 10, TimeInForce::GTC, 0));
+    // Stop orders are not visible
+    engine.add_order(Order::buy_stop(3, 0, 500, 10));
+    engine.event_handler().flush();
+
+    ASSERT_EQ(updates.size(), 1);
+    EXPECT_EQ(updates[0].price, 99);
+    EXPECT_EQ(updates[0].side, OrderSide::BUY);
+    EXPECT_EQ(updates[0].orders_count, 1);
+    EXPECT_EQ(updates[0].visible_volume, 0);
+
+    updates.clear();
+    engine.remove_orderbook(Symbol { 0, "A" });
+    ASSERT_EQ(updates.size(), 1);
+    EXPECT_EQ(updates[0].price, 99);
+    EXPECT_EQ(updates[0].orders_count, 0);
+}
+
+TEST(TopOfBookEventHandlerTest, PublishedOnlyWhenTheTopChanges) {
+    std::vector<TopOfBook> tops;
+    auto collect = [&tops] (const TopOfBook& top) { tops.push_back(top); };
+    using Handler = TopOfBookEventHandler<decltype(collect)>;
+    MatchingEngine<Order, Handler> engine { Handler { collect } };
+    engine.add_new_orderbook(Symbol { 0, "A" });
+
+    engine.add_order(Order::buy_limit(1, 0, 100, 10));
+    engine.add_order(Order::sell_limit(2, 0, 105, 20));
+    engine.event_handler().flush();
+    // One record for both commands
+    ASSERT_EQ(tops.size(), 1);
+    EXPECT_EQ(tops[0].sequence, 1);
+    EXPECT_EQ(tops[0].bid_price, 100);
+    EXPECT_EQ(tops[0].bid_volume, 10);
+    EXPECT_EQ(tops[0].ask_price, 105);
+    EXPECT_EQ(tops[0].ask_volume, 20);
+
+    // Behind the top
+    engine.add_order(Order::buy_limit(3, 0, 99, 10));
+    engine.add_order(Order::sell_limit(4, 0, 106, 10));
+    // Hidden orders don't make a top
+    engine.add_order(Order::buy_limit(5, 0, 101, 10, TimeInForce::GTC, 0));
+    engine.event_handler().flush();
+    EXPECT_EQ(tops.size(), 1);
+
+    // Partially filling the best ask
+    engine.add_order(Order::buy_limit(6, 0, 105, 5));
+    engine.event_handler().flush();
+    ASSERT_EQ(tops.size(), 2);
+    EXPECT_EQ(tops[1].sequence, 2);
+    EXPECT_EQ(tops[1].ask_price, 105);
+    EXPECT_EQ(tops[1].ask_volume, 15);
+    EXPECT_EQ(tops[1].bid_price, 100);
+
+    // Removing the best bid
+    engine.remove_order(OrderId { 1 });
+    engine.event_handler().flush();
+    ASSERT_EQ(tops.size(), 3);
+    EXPECT_EQ(tops[2].bid_price, 99);
+    EXPECT_EQ(tops[2].bid_volume, 10);
+
+    auto& top = engine.event_handler().top(SymbolId { 0 });
+    EXPECT_EQ(top.sequence, 3);
+    EXPECT_EQ(top.bid_price, 99);
+    EXPECT_EQ(engine.event_handler().top(SymbolId { 1 }).sequence, 0);
+}
+
+TEST(TopOfBookEventHandlerTest, EmptySidesAndRemovedBooks) {
+    std::vector<TopOfBook> tops;
+    auto collect = [&tops] (const TopOfBook& top) { tops.push_back(top); };
+    using Handler = TopOfBookEventHandler<decltype(collect)>;
+    MatchingEngine<Order, Handler> engine { Handler { collect } };
+    engine.add_new_orderbook(Symbol { 0, "A" });
+    engine.add_new_orderbook(Symbol { 1, "B" });
+
+    engine.add_order(Order::sell_limit(1, 1, 50, 10));
+    engine.add_order(Order::sell_limit(2, 1, 51, 10));
+    engine.event_handler().flush();
+    ASSERT_EQ(tops.size(), 1);
+    EXPECT_EQ(tops[0].symbol_id, 1);
+    EXPECT_EQ(tops[0].bid_price, 0);
+    EXPECT_EQ(tops[0].bid_volume, 0);
+    EXPECT_EQ(tops[0].ask_price, 50);
+
+    // Sweeping both levels empties the side
+    tops.clear();
+    engine.add_order(Order::buy_limit(3, 1, 51, 20));
+    engine.event_handler().flush();
+    ASSERT_EQ(tops.size(), 1);
+    EXPECT_EQ(tops[0].ask_price, 0);
+    EXPECT_EQ(tops[0].ask_volume, 0);
+    EXPECT_EQ(tops[0].bid_price, 0);
+
+    tops.clear();
+    engine.add_order(Order::buy_limit(4, 1, 40, 10));
+    engine.event_handler().flush();
+    engine.remove_orderbook(Symbol { 1, "B" });
+    ASSERT_EQ(tops.size(), 2);
+    EXPECT_EQ(tops[1].bid_price, 0);
+    EXPECT_EQ(tops[1].bid_volume, 0);
+    EXPECT_EQ(tops[1].sequence, 4);
+}
+
+TEST(TradeEventTest, OneEventPerTrade) {
+    MatchingEngine<Order, TradesHandler<>> engine;
+    engine.add_new_orderbook(Symbol { 0, "A" });
+    engine.add_order(Order::sell_limit(1, 0, 100, 10));
+    engine.add_order(Order::sell_limit(2, 0, 100, 10));
+    engine.add_order(Order::sell_limit(3, 0, 101, 10));
+
+    engine.add_order(Order::buy_limit(4, 0, 101, 25));
+    auto& handler = engine.event_handler();
+    ASSERT_EQ(handler.trades.size(), 3);
+    EXPECT_EQ(handler.trades[0].side, OrderSide::BUY);
+    EXPECT_EQ(handler.trades[0].aggressor_id, 4);
+    EXPECT_EQ(handler.trades[0].resting_id, 1);
+    EXPECT_EQ(handler.trades[0].flags, TradeBits::RestingFilled);
+    EXPECT_EQ(handler.trades[1].flags, TradeBits::RestingFilled | TradeBits::RestingLevelEmptied);
+    EXPECT_EQ(handler.trades[2].resting_id, 3);
+    EXPECT_EQ(handler.trades[2].quantity, 5);
+    EXPECT_EQ(handler.trades[2].price, 101);
+    EXPECT_EQ(handler.trades[2].flags, TradeBits::AggressorFilled);
+    // Neither the executions nor the removals of the filled orders, but
+    //  the aggressor is still reported as done
+    EXPECT_EQ(handler.executions, 0);
+    EXPECT_EQ(handler.removals, 1);
+
+    // Not a trade
+    engine.execute_order(OrderId { 3 }, Quantity { 5 });
+    EXPECT_EQ(handler.trades.size(), 3);
+    EXPECT_EQ(handler.executions, 1);
+    EXPECT_EQ(handler.removals, 2);
+}
+
+TEST(TradeEventTest, DetailsOnRequest) {
+    MatchingEngine<Order, TradesHandler<EventBits::TradeDetails>> engine;
+    engine.add_new_orderbook(Symbol { 0, "A" });
+    engine.add_order(Order::sell_limit(1, 0, 100, 10));
+    engine.add_order(Order::buy_limit(2, 0, 100, 10));
+
+    auto& handler = engine.event_handler();
+    ASSERT_EQ(handler.trades.size(), 1);
+    EXPECT_EQ(handler.trades[0].flags, TradeBits::AggressorFilled | TradeBits::RestingFilled | TradeBits::RestingLevelEmptied);
+    EXPECT_EQ(handler.executions, 2);
+    EXPECT_EQ(handler.removals, 2);
+}
+
+TEST(TradeEventTest, CrossedOrders) {
+    MatchingEngine<Order, TradesHandler<>> engine;
+    engine.add_new_orderbook(Symbol { 0, "A" });
+    engine.disable_matching();
+    engine.add_order(Order::sell_limit(1, 0, 100, 10));
+    engine.add_order(Order::buy_limit(2, 0, 101, 30));
+    // A chain of all-or-none orders
+    engine.add_order(Order::sell_limit(3, 0, 100, 20, TimeInForce::AON));
+    engine.add_order(Order::buy_limit(4, 0, 100, 5));
+    engine.enable_matching();
+
+    auto& handler = engine.event_handler();
+    ASSERT_EQ(handler.trades.size(), 2);
+    for (auto& trade : handler.trades) {
+        EXPECT_EQ(trade.side, OrderSide::BUY);
+        EXPECT_EQ(trade.aggressor_id, 2);
+        EXPECT_TRUE(trade.flags & TradeBits::Crossed);
+    }
+    EXPECT_EQ(handler.trades[0].resting_id, 1);
+    EXPECT_EQ(handler.trades[0].quantity, 10);
+    EXPECT_EQ(handler.trades[0].flags, TradeBits::Crossed | TradeBits::RestingFilled);
+    EXPECT_EQ(handler.trades[1].resting_id, 3);
+    EXPECT_EQ(handler.trades[1].quantity, 20);
+    EXPECT_EQ(handler.trades[1].flags, TradeBits::Crossed | TradeBits::AggressorFilled | TradeBits::AggressorLevelEmptied |
+                                       TradeBits::RestingFilled | TradeBits::RestingLevelEmptied);
+    EXPECT_EQ(handler.executions, 0);
+}
+
+TEST(TradeEventTest, CrossedChainsAreExecutedSideBySideWithoutTrades) {
+    MatchingEngine<Order, ExecutionsHandler> engine;
+    engine.add_new_orderbook(Symbol { 0, "A" });
+    engine.disable_matching();
+    engine.add_order(Order::buy_limit(1, 0, 100, 20, TimeInForce::AON));
+    engine.add_order(Order::sell_limit(2, 0, 100, 10));
+    engine.add_order(Order::sell_limit(3, 0, 100, 10));
+    engine.enable_matching();
+
+    // The whole buy chain, then the whole sell chain
+    std::vector<std::string> expected { "execute 1 20", "remove 1", "execute 2 10", "remove 2", "execute 3 10", "remove 3" };
+    EXPECT_EQ(engine.event_handler().log, expected);
+}
+
+TEST(TradeEventTest, CompositesKeepTheDetailsForTheOtherHandlers) {
+    using Composite = CompositeEventHandler<TradesHandler<>, AddedOrdersHandler>;
+    static_assert(reports<Composite>(EventBits::Trade));
+    static_assert(reports<Composite>(EventBits::TradeDetails));
+    static_assert(!reports<CompositeEventHandler<TradesHandler<>, NullEventHandler>>(EventBits::TradeDetails));
+    static_assert(!reports<CompositeEventHandler<NullEventHandler, LevelsOnlyHandler>>(EventBits::TradeDetails));
+
+    std::vector<std::pair<int, uint64_t>> added;
+    MatchingEngine<Order, Composite> engine { Composite { TradesHandler<> { }, AddedOrdersHandler { &added } } };
+    engine.add_new_orderbook(Symbol { 0, "A" });
+    engine.add_order(Order::sell_limit(1, 0, 100, 10));
+    engine.add_order(Order::buy_limit(2, 0, 100, 10));
+    EXPECT_EQ(engine.event_handler().get<0>().trades.size(), 1);
+    // The details don't reach the trades handler, only the removal of the filled aggressor does
+    EXPECT_EQ(engine.event_handler().get<0>().executions, 0);
+    EXPECT_EQ(engine.event_handler().get<0>().removals, 1);
+    EXPECT_EQ(added.size(), 1);
+}
+
+TEST(TradeEventTest, CompositeMembersOnlyGetTheirOwnEvents) {
+    using Composite = CompositeEventHandler<TradesHandler<>, TradesHandler<EventBits::TradeDetails>, LevelsOnlyHandler>;
+    static_assert(reports<Composite>(EventBits::TradeScope));
+    static_assert(!reports<CompositeEventHandler<TradesHandler<>, NullEventHandler>>(EventBits::TradeScope));
+
+    MatchingEngine<Order, Composite> engine;
+    engine.add_new_orderbook(Symbol { 0, "A" });
+    engine.add_order(Order::sell_limit(1, 0, 100, 10));
+    engine.add_order(Order::sell_limit(2, 0, 101, 10));
+    // Sweeps both levels, and the rest of it is cancelled
+    engine.add_order(Order::buy_limit(3, 0, 101, 30, TimeInForce::IOC));
+    // Not a trade
+    engine.add_order(Order::buy_limit(4, 0, 90, 10));
+    engine.remove_order(OrderId { 4 });
+
+    auto& trades = engine.event_handler().get<0>();
+    auto& details = engine.event_handler().get<1>();
+    auto& levels = engine.event_handler().get<2>();
+    EXPECT_EQ(trades.trades.size(), 2);
+    EXPECT_EQ(details.trades.size(), 2);
+
+    // The trades, the aggressor's cancellation, and the removal of order 4
+    EXPECT_EQ(trades.executions, 0);
+    EXPECT_EQ(trades.removals, 2);
+    // The details of both trades as well
+    EXPECT_EQ(details.executions, 4);
+    EXPECT_EQ(details.removals, 4);
+
+    EXPECT_EQ(levels.levels, 3);
+    EXPECT_EQ(levels.orders, 0);
+}
+
+TEST(CommandEventsTest, EventsAreBracketedByTheirCommand) {
+    MatchingEngine<Order, CommandsHandler> engine;
+    engine.add_new_orderbook(Symbol { 0, "A" });
+    engine.add_order(Order::buy_limit(1, 0, 100, 10));
+    // Calls remove_order and add_order, but it's still a single command
+    engine.replace_order(OrderId { 1 }, Order::buy_limit(2, 0, 101, 10));
+    engine.disable_matching();
+    engine.enable_matching();
+
+    std::vector<std::string> expected {
+        "begin 1", "end 1",
+        "begin 2", "add 1", "end 2",
+        "begin 3", "add 2", "end 3",
+        "begin 4", "end 4"
+    };
+    EXPECT_EQ(engine.event_handler().log, expected);
+}
+
+TEST(CommandEventsTest, FlushingOncePerCommand) {
+    using Handler = CommandFlushingEventHandler<BinaryRingEventHandler>;
+    static_assert(reports<Handler>(EventBits::Commands));
+
+    BinaryRingEventHandler::Ring ring { 64 };
+    MatchingEngine<Order, Handler> engine { Handler { BinaryRingEventHandler { &ring } } };
+    engine.add_new_orderbook(Symbol { 0, "A" });
+    engine.add_order(Order::sell_limit(1, 0, 100, 10));
+    engine.add_order(Order::buy_limit(2, 0, 100, 10));
+
+    // Visible without flushing by hand
+    auto records = drain(ring);
+    ASSERT_GE(records.size(), 6);
+    for (size_t i = 0; i < records.size(); i++) {
+        EXPECT_EQ(records[i].sequence, i + 1);
+    }
+    EXPECT_EQ(records.front().event, EventType::COMMAND_BEGIN);
+    EXPECT_EQ(records.front().order_id, 1);
+    EXPECT_EQ(records.back().event, EventType::COMMAND_END);
+    EXPECT_EQ(records.back().order_id, 3);
+    auto commands = std::count_if(records.begin(), records.end(), [] (const EventRecord& record) {
+        return record.event == EventType::COMMAND_BEGIN;
+    });
+    EXPECT_EQ(commands, 3);
+
+    // Conflated per command
+    std::vector<PriceLevelUpdate> updates;
+    auto collect = [&updates] (const PriceLevelUpdate& update) { updates.push_back(update); };
+    using MarketByPrice = CommandFlushingEventHandler<MarketByPriceEventHandler<decltype(collect)>>;
+    MatchingEngine<Order, MarketByPrice> mbp_engine { MarketByPrice { MarketByPriceEventHandler<decltype(collect)> { collect } } };
+    mbp_engine.add_new_orderbook(Symbol { 0, "A" });
+    mbp_engine.add_order(Order::sell_limit(1, 0, 100, 10));
+    mbp_engine.add_order(Order::sell_limit(2, 0, 100, 10));
+    ASSERT_EQ(updates.size(), 2);
+    EXPECT_EQ(updates[1].visible_volume, 20);
+}
+
+TEST(ExecutionReportEventHandlerTest, ReportsOfACommand) {
+    std::array<ExecutionReport, 8> buffer;
+    MatchingEngine<Order, ExecutionReportEventHandler> engine { ExecutionReportEventHandler { buffer } };
+    auto& handler = engine.event_handler();
+    engine.add_new_orderbook(Symbol { 0, "A" });
+    engine.add_order(Order::sell_limit(1, 0, 100, 10));
+    engine.add_order(Order::sell_limit(2, 0, 101, 10));
+    // Triggered right away, with nothing to match against
+    engine.add_order(Order::sell_stop(3, 0, 99, 5));
+    ASSERT_EQ(handler.take(), 4);
+    EXPECT_EQ(buffer[0].type, ExecutionReportType::REST);
+    EXPECT_EQ(buffer[0].order_type, OrderType::LIMIT);
+    EXPECT_EQ(buffer[2].type, ExecutionReportType::TRIGGER);
+    EXPECT_EQ(buffer[2].order_type, OrderType::STOP);
+    EXPECT_EQ(buffer[3].type, ExecutionReportType::CANCEL);
+    EXPECT_EQ(buffer[3].order_type, OrderType::MARKET);
+
+    engine.add_order(Order::buy_limit(4, 0, 101, 25, TimeInForce::IOC));
+    auto reports = handler.reports();
+    ASSERT_EQ(reports.size(), 3);
+    EXPECT_EQ(reports[0].type, ExecutionReportType::FILL);
+    EXPECT_EQ(reports[0].order_id, 4);
+    EXPECT_EQ(reports[0].other_order_id, 1);
+    EXPECT_EQ(reports[0].quantity, 10);
+    EXPECT_EQ(reports[0].leaves_quantity, 15);
+    EXPECT_EQ(reports[0].flags, TradeBits::RestingFilled | TradeBits::RestingLevelEmptied);
+    EXPECT_EQ(reports[1].other_order_id, 2);
+    EXPECT_EQ(reports[1].price, 101);
+    EXPECT_EQ(reports[1].leaves_quantity, 5);
+    // The rest of the IOC order
+    EXPECT_EQ(reports[2].type, ExecutionReportType::CANCEL);
+    EXPECT_EQ(reports[2].order_id, 4);
+    EXPECT_EQ(reports[2].quantity, 5);
+    EXPECT_EQ(handler.take(), 3);
+
+    engine.add_order(Order::buy_limit(5, 0, 98, 10));
+    engine.execute_order(OrderId { 5 }, Quantity { 4 });
+    engine.remove_order(OrderId { 5 });
+    reports = handler.reports();
+    ASSERT_EQ(reports.size(), 3);
+    EXPECT_EQ(reports[1].type, ExecutionReportType::FILL);
+    EXPECT_EQ(reports[1].other_order_id, 0);
+    EXPECT_EQ(reports[1].quantity, 4);
+    EXPECT_EQ(reports[1].leaves_quantity, 6);
+    EXPECT_EQ(reports[2].type, ExecutionReportType::CANCEL);
+    EXPECT_EQ(reports[2].quantity, 6);
+}
+
+TEST(ExecutionReportEventHandlerTest, FullFillsByHandAreNotCancelled) {
+    std::array<ExecutionReport, 4> buffer;
+    MatchingEngine<Order, ExecutionReportEventHandler> engine { ExecutionReportEventHandler { buffer } };
+    auto& handler = engine.event_handler();
+    engine.add_new_orderbook(Symbol { 0, "A" });
+    engine.add_order(Order::buy_limit(1, 0, 98, 10));
+    ASSERT_EQ(handler.take(), 1);
+
+    engine.execute_order(OrderId { 1 }, Quantity { 10 });
+    ASSERT_EQ(handler.size(), 1);
+    EXPECT_EQ(buffer[0].type, ExecutionReportType::FILL);
+    EXPECT_EQ(buffer[0].quantity, 10);
+    EXPECT_EQ(buffer[0].leaves_quantity, 0);
+
+    // A partial fill doesn't hide the cancel of the rest, even when the rest is as much as the fill
+    engine.add_order(Order::buy_limit(2, 0, 98, 10));
+    engine.execute_order(OrderId { 2 }, Quantity { 5 });
+    engine.remove_order(OrderId { 2 });
+    auto reports = handler.reports();
+    ASSERT_EQ(reports.size(), 4);
+    EXPECT_EQ(reports[2].type, ExecutionReportType::FILL);
+    EXPECT_EQ(reports[2].leaves_quantity, 5);
+    EXPECT_EQ(reports[3].type, ExecutionReportType::CANCEL);
+    EXPECT_EQ(reports[3].order_id, 2);
+    EXPECT_EQ(reports[3].quantity, 5);
+}
+
+TEST(ExecutionReportEventHandlerTest, ReportsThatDontFitAreDropped) {
+    std::array<ExecutionReport, 2> buffer;
+    MatchingEngine<Order, ExecutionReportEventHandler> engine { ExecutionReportEventHandler { buffer } };
+    auto& handler = engine.event_handler();
+    engine.add_new_orderbook(Symbol { 0, "A" });
+    for (uint64_t i = 1; i <= 5; i++) {
+        engine.add_order(Order::sell_limit(i, 0, 100, 10));
+    }
+    EXPECT_EQ(handler.size(), 2);
+    EXPECT_EQ(handler.dropped(), 3);
+    EXPECT_EQ(buffer[1].order_id, 2);
+
+    std::array<ExecutionReport, 4> larger;
+    handler.reset(larger);
+    engine.add_order(Order::buy_market(6, 0, 50));
+    EXPECT_EQ(handler.size(), 4);
+    EXPECT_EQ(handler.dropped(), 1);
+    EXPECT_EQ(larger[3].other_order_id, 4);
+}
+
+}
@@ -0,0 +1,299 @@
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include <chronex/handlers/CommandFlushingEventHandler.hpp>
+#include <chronex/handlers/EventBusEventHandler.hpp>
+#include <chronex/ipc/EventBus.hpp>
+#include <chronex/matching/MatchingEngine.hpp>
+
+using namespace chronex;
+using namespace chronex::handlers;
+using namespace chronex::ipc;
+
+namespace {
+
+// Unique per process, so that test runs don't step on each other
+std::string bus_name(const std::string& test) {
+    return "/chronex-test-" + test + "-" + std::to_string(::getpid());
+}
+
+std::vector<uint64_t> drain(EventBusReader<uint64_t>& reader) {
+    std::vector<uint64_t> values;
+    reader.consume([&] (const uint64_t value) { values.push_back(value); });
+    return values;
+}
+
+}
+
+TEST(EventBusTest, EveryReaderGetsEveryRecordAfterItJoined) {
+    auto writer = EventBusWriter<uint64_t>::create(bus_name("fanout"), 8);
+    ASSERT_TRUE(writer.has_value());
+
+    auto first = EventBusReader<uint64_t>::open(writer->name());
+    ASSERT_TRUE(first.has_value());
+    writer->emplace(1);
+    writer->emplace(2);
+
+    auto second = EventBusReader<uint64_t>::open(writer->name());
+    ASSERT_TRUE(second.has_value());
+    EXPECT_EQ(writer->readers_count(), 2);
+    EXPECT_EQ(second->available(), 0);
+
+    writer->emplace(3);
+    EXPECT_EQ(drain(*first), (std::vector<uint64_t> { 1, 2, 3 }));
+    EXPECT_EQ(drain(*second), (std::vector<uint64_t> { 3 }));
+    EXPECT_EQ(first->position(), 3);
+
+    second.reset();
+    EXPECT_EQ(writer->readers_count(), 1);
+}
+
+TEST(EventBusTest, DeferredRecordsAreInvisibleUntilCommitted) {
+    auto writer = EventBusWriter<uint64_t>::create(bus_name("deferred"), 8);
+    ASSERT_TRUE(writer.has_value());
+    auto reader = EventBusReader<uint64_t>::open(writer->name());
+    ASSERT_TRUE(reader.has_value());
+
+    EXPECT_TRUE(writer->try_emplace_deferred(1));
+    EXPECT_EQ(reader->available(), 0);
+    EXPECT_TRUE(drain(*reader).empty());
+    writer->commit();
+    EXPECT_EQ(reader->available(), 1);
+    EXPECT_EQ(drain(*reader), (std::vector<uint64_t> { 1 }));
+    EXPECT_EQ(reader->available(), 0);
+}
+
+TEST(EventBusTest, SlotsAreReusedOnceEveryReaderIsDoneWithThem) {
+    auto writer = EventBusWriter<uint64_t>::create(bus_name("slowest"), 4);
+    ASSERT_TRUE(writer.has_value());
+
+    // Nobody to wait for
+    for (uint64_t i = 0; i < 10; i++) {
+        EXPECT_TRUE(writer->try_emplace(i));
+    }
+
+    auto fast = EventBusReader<uint64_t>::open(writer->name());
+    auto slow = EventBusReader<uint64_t>::open(writer->name());
+    ASSERT_TRUE(fast.has_value() && slow.has_value());
+    for (uint64_t i = 0; i < 3; i++) {
+        EXPECT_TRUE(writer->try_emplace(i));
+    }
+    EXPECT_EQ(drain(*fast).size(), 3);
+    EXPECT_EQ(slow->consume([] (uint64_t) { }, 1), 1);
+    // Uses the slot the slow reader is done with
+    EXPECT_TRUE(writer->try_emplace(3));
+    EXPECT_TRUE(writer->try_emplace(4));
+    EXPECT_EQ(writer->evictions(), 0);
+    EXPECT_FALSE(slow->is_evicted());
+    EXPECT_EQ(drain(*slow), (std::vector<uint64_t> { 1, 2, 3, 4 }));
+}
+
+TEST(EventBusTest, ReadersThatFallBehindAreEvicted) {
+    auto writer = EventBusWriter<uint64_t>::create(bus_name("evicted"), 4);
+    ASSERT_TRUE(writer.has_value());
+    auto fast = EventBusReader<uint64_t>::open(writer->name());
+    auto slow = EventBusReader<uint64_t>::open(writer->name());
+    ASSERT_TRUE(fast.has_value() && slow.has_value());
+
+    for (uint64_t i = 0; i < 4; i++) {
+        EXPECT_TRUE(writer->try_emplace(i));
+    }
+    EXPECT_EQ(drain(*fast).size(), 4);
+
+    // The writer never waits for the slow reader
+    EXPECT_TRUE(writer->try_emplace(4));
+    EXPECT_EQ(writer->evictions(), 1);
+    EXPECT_EQ(writer->readers_count(), 1);
+    EXPECT_TRUE(slow->is_evicted());
+    EXPECT_FALSE(fast->is_evicted());
+    // Nothing is handed out, not even what's left of the records it missed
+    auto handed_out = false;
+    EXPECT_FALSE(slow->consume([&] (uint64_t) { handed_out = true; }).has_value());
+    EXPECT_FALSE(handed_out);
+    EXPECT_EQ(drain(*fast), (std::vector<uint64_t> { 4 }));
+
+    slow->rejoin();
+    EXPECT_FALSE(slow->is_evicted());
+    EXPECT_EQ(slow->position(), 5);
+    EXPECT_TRUE(writer->try_emplace(5));
+    EXPECT_EQ(drain(*slow), (std::vector<uint64_t> { 5 }));
+}
+
+TEST(EventBusTest, Snapshots) {
+    auto writer = EventBusWriter<uint64_t>::create(bus_name("snapshots"), 4, 2, 3);
+    ASSERT_TRUE(writer.has_value());
+    auto reader = EventBusReader<uint64_t>::open(writer->name());
+    ASSERT_TRUE(reader.has_value());
+    EXPECT_FALSE(writer->is_snapshot_requested());
+
+    std::vector<uint64_t> records;
+    auto ticket = reader->request_snapshot();
+    EXPECT_TRUE(writer->is_snapshot_requested());
+    EXPECT_FALSE(reader->try_read_snapshot(ticket, records).has_value());
+
+    // Pending records are published before the snapshot is taken
+    EXPECT_TRUE(writer->try_emplace_deferred(7));
+    writer->begin_snapshot();
+    EXPECT_TRUE(writer->add_to_snapshot(10));
+    EXPECT_TRUE(writer->add_to_snapshot(20));
+    writer->end_snapshot();
+    EXPECT_FALSE(writer->is_snapshot_requested());
+
+    auto snapshot = reader->try_read_snapshot(ticket, records);
+    ASSERT_TRUE(snapshot.has_value());
+    EXPECT_EQ(snapshot->position, 1);
+    EXPECT_FALSE(snapshot->is_truncated);
+    EXPECT_EQ(records, (std::vector<uint64_t> { 10, 20 }));
+
+    ticket = reader->request_snapshot();
+    writer->begin_snapshot();
+    for (uint64_t i = 0; i < 3; i++) {
+        EXPECT_TRUE(writer->add_to_snapshot(i));
+    }
+    EXPECT_FALSE(writer->add_to_snapshot(3));
+    writer->end_snapshot();
+    snapshot = reader->try_read_snapshot(ticket, records);
+    ASSERT_TRUE(snapshot.has_value());
+    EXPECT_TRUE(snapshot->is_truncated);
+    EXPECT_EQ(records.size(), 3);
+}
+
+TEST(EventBusTest, OpeningFails) {
+    EXPECT_FALSE(EventBusReader<uint64_t>::open(bus_name("missing")).has_value());
+
+    auto writer = EventBusWriter<uint64_t>::create(bus_name("full"), 4, 1);
+    ASSERT_TRUE(writer.has_value());
+    // Records of a different size
+    EXPECT_FALSE(EventBusReader<uint32_t>::open(writer->name()).has_value());
+
+    auto reader = EventBusReader<uint64_t>::open(writer->name());
+    ASSERT_TRUE(reader.has_value());
+    // No cursors left
+    EXPECT_FALSE(EventBusReader<uint64_t>::open(writer->name()).has_value());
+}
+
+TEST(EventBusTest, ReadersInOtherProcesses) {
+    constexpr uint64_t Count = 100'000;
+    constexpr int ReadersCount = 3;
+
+    auto writer = EventBusWriter<uint64_t>::create(bus_name("processes"), 1024);
+    ASSERT_TRUE(writer.has_value());
+
+    std::vector<pid_t> children;
+    for (int i = 0; i < ReadersCount; i++) {
+        auto pid = ::fork();
+        ASSERT_NE(pid, -1);
+        if (pid == 0) {
+            auto reader = EventBusReader<uint64_t>::open(writer->name());
+            if (!reader) ::_exit(2);
+            uint64_t expected = 0;
+            bool in_order = true;
+            while (expected != Count) {
+                reader->consume([&] (const uint64_t value) { in_order &= value == expected++; });
+            }
+            ::_exit(in_order ? 0 : 1);
+        }
+        children.push_back(pid);
+    }
+
+    // The readers only get what's published after they join
+    while (writer->readers_count() != ReadersCount) {
+        utils::cpu_relax();
+    }
+    for (uint64_t i = 0; i < Count; i++) {
+        // Slower readers would be evicted
+        while (i - writer->slowest_position() == writer->capacity()) {
+            utils::cpu_relax();
+        }
+        writer->emplace(i);
+    }
+    EXPECT_EQ(writer->evictions(), 0);
+
+    for (auto pid : children) {
+        int status = 0;
+        ASSERT_EQ(::waitpid(pid, &status, 0), pid);
+        ASSERT_TRUE(WIFEXITED(status));
+        EXPECT_EQ(WEXITSTATUS(status), 0);
+    }
+}
+
+TEST(EventBusTest, EngineEvents) {
+    using Handler = CommandFlushingEventHandler<EventBusEventHandler>;
+
+    auto writer = EventBusWriter<EventRecord>::create(bus_name("engine"), 64);
+    ASSERT_TRUE(writer.has_value());
+    auto reader = EventBusReader<EventRecord>::open(writer->name());
+    ASSERT_TRUE(reader.has_value());
+
+    MatchingEngine<Order, Handler> engine { Handler { EventBusEventHandler { &*writer } } };
+    engine.add_new_orderbook(Symbol { 0, "A" });
+    engine.add_order(Order::sell_limit(1, 0, 100, 10));
+
+    std::vector<EventRecord> records;
+    reader->consume([&] (const EventRecord& record) { records.push_back(record); });
+    ASSERT_EQ(records.size(), 7);
+    EXPECT_EQ(records[0].event, EventType::COMMAND_BEGIN);
+    EXPECT_EQ(records[1].event, EventType::ADD_NEW_ORDERBOOK);
+    EXPECT_STREQ(records[1].symbol_name, "A");
+    EXPECT_EQ(records[4].event, EventType::ADD_LEVEL);
+    EXPECT_EQ(records[5].event, EventType::ADD_ORDER);
+    EXPECT_EQ(records[5].order.leaves_quantity, 10);
+    EXPECT_EQ(records[6].sequence, 7);
+}
+
+TEST(EventBusTest, EngineSnapshotAfterEviction) {
+    using Handler = CommandFlushingEventHandler<EventBusEventHandler>;
+
+    auto writer = EventBusWriter<EventRecord>::create(bus_name("recovery"), 8, 2, 64);
+    ASSERT_TRUE(writer.has_value());
+    auto reader = EventBusReader<EventRecord>::open(writer->name());
+    ASSERT_TRUE(reader.has_value());
+
+    MatchingEngine<Order, Handler> engine { Handler { EventBusEventHandler { &*writer } } };
+    engine.add_new_orderbook(Symbol { 0, "A" });
+    for (uint64_t i = 1; i <= 4; i++) {
+        engine.add_order(Order::buy_limit(i, 0, 100 - i, 10));
+    }
+    ASSERT_TRUE(reader->is_evicted());
+
+    reader->rejoin();
+    auto ticket = reader->request_snapshot();
+    // Published after the reader joined again, but before the snapshot
+    engine.add_order(Order::sell_limit(5, 0, 110, 10));
+    serve_snapshot(engine, *writer);
+    engine.remove_order(OrderId { 1 });
+
+    std::vector<EventRecord> snapshot_records;
+    auto snapshot = reader->try_read_snapshot(ticket, snapshot_records);
+    ASSERT_TRUE(snapshot.has_value());
+    EXPECT_FALSE(snapshot->is_truncated);
+    ASSERT_EQ(snapshot_records.size(), 6);
+    EXPECT_EQ(snapshot_records[0].event, EventType::ADD_ORDERBOOK);
+    EXPECT_STREQ(snapshot_records[0].symbol_name, "A");
+    // Best bid first
+    EXPECT_EQ(snapshot_records[1].order_id, 1);
+    EXPECT_EQ(snapshot_records[4].order_id, 4);
+    EXPECT_EQ(snapshot_records[5].order_id, 5);
+    EXPECT_EQ(snapshot_records[5].side, OrderSide::SELL);
+
+    // The incrementals to apply on top of the snapshot
+    std::vector<EventRecord> records;
+    reader->consume([&] (const EventRecord& record) {
+        if (record.sequence > snapshot->position) records.push_back(record);
+    });
+    ASSERT_FALSE(records.empty());
+    EXPECT_EQ(records.front().sequence, snapshot->position + 1);
+    EXPECT_EQ(records.front().event, EventType::COMMAND_BEGIN);
+    auto removal = std::find_if(records.begin(), records.end(), [] (const EventRecord& record) {
+        return record.event == EventType::REMOVE_ORDER;
+    });
+    ASSERT_NE(removal, records.end());
+    EXPECT_EQ(removal->order_id, 1);
+}
@@ -0,0 +1,303 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include <chronex/itch/BookBuilder.hpp>
+#include <chronex/itch/ItchParser.hpp>
+#include <chronex/matching/MatchingEngine.hpp>
+#include <chronex/utils/MappedFile.hpp>
+
+using namespace chronex;
+using namespace chronex::itch;
+
+namespace {
+
+// Writes messages the way the feed has them: length-prefixed, big-endian
+class Feed {
+public:
+
+    Feed& stock_directory(const uint16_t locate, const std::string_view stock) {
+        begin('R', locate);
+        text(stock, 8);
+        put<uint8_t>('Q');
+        put<uint8_t>('N');
+        put<uint32_t>(100);
+        // The rest of the flags, and the ETP leverage factor
+        text("", 14);
+        return end(39);
+    }
+
+    Feed& add_order(const uint16_t locate, const uint64_t reference, const char side, const uint32_t shares,
+                    const std::string_view stock, const uint32_t price, const std::string_view attribution = { }) {
+        begin(attribution.empty() ? 'A' : 'F', locate);
+        put<uint64_t>(reference);
+        put<uint8_t>(static_cast<uint8_t>(side));
+        put<uint32_t>(shares);
+        text(stock, 8);
+        put<uint32_t>(price);
+        if (!attribution.empty()) text(attribution, 4);
+        return end(attribution.empty() ? 36 : 40);
+    }
+
+    Feed& executed(const uint16_t locate, const uint64_t reference, const uint32_t shares) {
+        begin('E', locate);
+        put<uint64_t>(reference);
+        put<uint32_t>(shares);
+        put<uint64_t>(42);
+        return end(31);
+    }
+
+    Feed& executed_with_price(const uint16_t locate, const uint64_t reference, const uint32_t shares, const uint32_t price) {
+        begin('C', locate);
+        put<uint64_t>(reference);
+        put<uint32_t>(shares);
+        put<uint64_t>(43);
+        put<uint8_t>('Y');
+        put<uint32_t>(price);
+        return end(36);
+    }
+
+    Feed& cancel(const uint16_t locate, const uint64_t reference, const uint32_t shares) {
+        begin('X', locate);
+        put<uint64_t>(reference);
+        put<uint32_t>(shares);
+        return end(23);
+    }
+
+    Feed& remove(const uint16_t locate, const uint64_t reference) {
+        begin('D', locate);
+        put<uint64_t>(reference);
+        return end(19);
+    }
+
+    Feed& replace(const uint16_t locate, const uint64_t reference, const uint64_t new_reference, const uint32_t shares,
+                  const uint32_t price) {
+        begin('U', locate);
+        put<uint64_t>(reference);
+        put<uint64_t>(new_reference);
+        put<uint32_t>(shares);
+        put<uint32_t>(price);
+        return end(35);
+    }
+
+    // A system event, which isn't decoded
+    Feed& system_event() {
+        begin('S', 0);
+        put<uint8_t>('O');
+        return end(12);
+    }
+
+    // Any bytes, e.g. a message with the wrong length
+    Feed& raw(const std::vector<uint8_t>& bytes) {
+        for (auto byte : bytes) bytes_.push_back(static_cast<std::byte>(byte));
+        return *this;
+    }
+
+    [[nodiscard]] const std::vector<std::byte>& bytes() const noexcept { return bytes_; }
+
+private:
+
+    template <typename T>
+    void put(const T value) {
+        for (int shift = int(sizeof(T) - 1) * 8; shift >= 0; shift -= 8) {
+            bytes_.push_back(static_cast<std::byte>((uint64_t { value } >> shift) & 0xFF));
+        }
+    }
+
+    void text(const std::string_view value, const size_t size) {
+        for (size_t i = 0; i < size; i++) put<uint8_t>(static_cast<uint8_t>(i < value.size() ? value[i] : ' '));
+    }
+
+    void begin(const char type, const uint16_t locate) {
+        _start = bytes_.size();
+        put<uint16_t>(0);
+        put<uint8_t>(static_cast<uint8_t>(type));
+        put<uint16_t>(locate);
+        put<uint16_t>(7);
+        // A timestamp of 6 bytes
+        put<uint16_t>(1);
+        put<uint32_t>(2);
+    }
+
+    Feed& end(const size_t length) {
+        auto written = bytes_.size() - _start - 2;
+        EXPECT_EQ(written, length);
+        bytes_[_start] = static_cast<std::byte>(written >> 8);
+        bytes_[_start + 1] = static_cast<std::byte>(written & 0xFF);
+        return *this;
+    }
+
+    std::vector<std::byte> bytes_;
+    size_t _start = 0;
+};
+
+// Keeps what it's handed
+struct Recorder {
+    void on_stock_directory(const StockDirectory& message) { directories.push_back(message); }
+    void on_add_order(const AddOrder& message) { adds.push_back(message); }
+    void on_order_executed(const OrderExecuted& message) { executions.push_back(message); }
+    void on_order_executed(const OrderExecutedWithPrice& message) { priced_executions.push_back(message); }
+    void on_order_replace(const OrderReplace& message) { replaces.push_back(message); }
+
+    std::vector<StockDirectory> directories;
+    std::vector<AddOrder> adds;
+    std::vector<OrderExecuted> executions;
+    std::vector<OrderExecutedWithPrice> priced_executions;
+    std::vector<OrderReplace> replaces;
+};
+
+}
+
+TEST(ItchTest, DecodesTheMessagesTheHandlerHasMethodsFor) {
+    Feed feed;
+    feed.stock_directory(3, "AAPL")
+        .system_event()
+        .add_order(3, 1'000'000'000'001, 'B', 100, "AAPL", 1'502'500)
+        .add_order(3, 2, 'S', 50, "AAPL", 1'503'000, "MPID")
+        .executed(3, 2, 20)
+        .executed_with_price(3, 1, 30, 1'502'400)
+        // No method for these, so they are only counted
+        .cancel(3, 1, 10)
+        .remove(3, 2)
+        .replace(3, 1, 4, 70, 1'502'600);
+
+    Recorder recorder;
+    auto result = parse_messages(feed.bytes(), recorder);
+    EXPECT_FALSE(result.is_malformed);
+    EXPECT_EQ(result.size, feed.bytes().size());
+    EXPECT_EQ(result.messages_count, 9);
+
+    ASSERT_EQ(recorder.directories.size(), 1);
+    EXPECT_EQ(recorder.directories[0].header.stock_locate, 3);
+    EXPECT_EQ(recorder.directories[0].header.tracking_number, 7);
+    EXPECT_EQ(recorder.directories[0].header.timestamp, (uint64_t { 1 } << 32) | 2);
+    EXPECT_EQ(std::string_view(recorder.directories[0].stock.data(), 8), "AAPL    ");
+    EXPECT_EQ(recorder.directories[0].round_lot_size, 100);
+
+    ASSERT_EQ(recorder.adds.size(), 2);
+    EXPECT_EQ(recorder.adds[0].order_reference, 1'000'000'000'001);
+    EXPECT_EQ(recorder.adds[0].side, OrderSide::BUY);
+    EXPECT_EQ(recorder.adds[0].shares, 100);
+    EXPECT_EQ(recorder.adds[0].price, 1'502'500);
+    EXPECT_EQ(recorder.adds[1].side, OrderSide::SELL);
+    EXPECT_EQ(std::string_view(recorder.adds[1].attribution.data(), 4), "MPID");
+
+    ASSERT_EQ(recorder.executions.size(), 1);
+    EXPECT_EQ(recorder.executions[0].executed_shares, 20);
+    EXPECT_EQ(recorder.executions[0].match_number, 42);
+    ASSERT_EQ(recorder.priced_executions.size(), 1);
+    EXPECT_TRUE(recorder.priced_executions[0].is_printable);
+    EXPECT_EQ(recorder.priced_executions[0].price, 1'502'400);
+
+    ASSERT_EQ(recorder.replaces.size(), 1);
+    EXPECT_EQ(recorder.replaces[0].original_order_reference, 1);
+    EXPECT_EQ(recorder.replaces[0].new_order_reference, 4);
+    EXPECT_EQ(recorder.replaces[0].shares, 70);
+
+    // Cut short, the last message waits for the rest of it
+    Recorder partial;
+    result = parse_messages(std::span { feed.bytes() }.first(feed.bytes().size() - 1), partial);
+    EXPECT_FALSE(result.is_malformed);
+    EXPECT_EQ(result.messages_count, 8);
+    EXPECT_EQ(result.size, feed.bytes().size() - 37);
+    EXPECT_TRUE(partial.replaces.empty());
+
+    // An add order of the wrong length
+    Feed malformed;
+    malformed.system_event().raw({ 0, 3, 'A', 0, 0 });
+    result = parse_messages(malformed.bytes(), partial);
+    EXPECT_TRUE(result.is_malformed);
+    EXPECT_EQ(result.messages_count, 1);
+    EXPECT_EQ(result.size, 14);
+}
+
+TEST(ItchTest, BuildsBooksFromAMappedFile) {
+    Feed feed;
+    feed.stock_directory(1, "MSFT")
+        .add_order(1, 10, 'B', 100, "MSFT", 1000)
+        .add_order(1, 11, 'B', 50, "MSFT", 1000)
+        .add_order(1, 12, 'S', 40, "MSFT", 990)
+        // Crossed, and left that way, since the feed does the matching
+        .executed(1, 10, 30)
+        .executed_with_price(1, 11, 50, 999)
+        .cancel(1, 12, 15)
+        .replace(1, 10, 13, 20, 1001)
+        // No directory message for this one, and a name that doesn't fit a Symbol
+        .add_order(2, 20, 'S', 5, "ABCDEFGH", 2000)
+        .remove(2, 20)
+        // Orders from before the recording
+        .executed(1, 99, 1)
+        .remove(1, 98);
+
+    auto path = "/tmp/chronex-itch-test-" + std::to_string(::getpid()) + ".itch";
+    auto file = std::fopen(path.c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    ASSERT_EQ(std::fwrite(feed.bytes().data(), 1, feed.bytes().size(), file), feed.bytes().size());
+    std::fclose(file);
+    auto mapped = utils::MappedFile::open(path);
+    ::unlink(path.c_str());
+    ASSERT_TRUE(mapped.has_value());
+    ASSERT_EQ(mapped->size(), feed.bytes().size());
+
+    MatchingEngine<> engine;
+    BookBuilder builder { engine };
+    auto result = builder.replay(mapped->bytes());
+    EXPECT_FALSE(result.is_malformed);
+    EXPECT_EQ(result.size, mapped->size());
+    EXPECT_EQ(builder.messages_count(), 12);
+    EXPECT_EQ(builder.orderbooks_count(), 2);
+    EXPECT_EQ(builder.unknown_orders_count(), 2);
+    EXPECT_FALSE(engine.is_matching_enabled());
+
+    EXPECT_FALSE(engine.has_order(OrderId { 10 }));
+    EXPECT_FALSE(engine.has_order(OrderId { 11 }));
+    EXPECT_FALSE(engine.has_order(OrderId { 20 }));
+    ASSERT_TRUE(engine.has_order(OrderId { 12 }));
+    EXPECT_EQ(engine.order_at(OrderId { 12 })->leaves_quantity().value, 25);
+    ASSERT_TRUE(engine.has_order(OrderId { 13 }));
+    EXPECT_EQ(engine.order_at(OrderId { 13 })->leaves_quantity().value, 20);
+    EXPECT_EQ(engine.order_at(OrderId { 13 })->side(), OrderSide::BUY);
+
+    auto quote = engine.orderbook_at(SymbolId { 1 }).quote();
+    EXPECT_EQ(quote.bid_price.value, 1001);
+    EXPECT_EQ(quote.bid_volume.value, 20);
+    EXPECT_EQ(quote.ask_price.value, 990);
+    EXPECT_EQ(quote.ask_volume.value, 25);
+
+    EXPECT_STREQ(engine.orderbook_at(SymbolId { 1 }).symbol().name, "MSFT");
+    EXPECT_STREQ(engine.orderbook_at(SymbolId { 2 }).symbol().name, "ABCDEFG");
+}
+
+TEST(ItchTest, OrdersCancelledInFullAreRemoved) {
+    Feed feed;
+    feed.stock_directory(1, "MSFT")
+        .add_order(1, 10, 'B', 100, "MSFT", 1000)
+        .add_order(1, 11, 'B', 50, "MSFT", 999)
+        .cancel(1, 10, 100)
+        // More than what's left
+        .cancel(1, 11, 80)
+        // Gone, like any other removed order
+        .executed(1, 10, 1)
+        .add_order(1, 10, 'S', 20, "MSFT", 1005);
+
+    MatchingEngine<> engine;
+    BookBuilder builder { engine };
+    auto result = builder.replay(feed.bytes());
+    EXPECT_FALSE(result.is_malformed);
+    EXPECT_EQ(builder.unknown_orders_count(), 1);
+
+    EXPECT_FALSE(engine.has_order(OrderId { 11 }));
+    ASSERT_TRUE(engine.has_order(OrderId { 10 }));
+    EXPECT_EQ(engine.order_at(OrderId { 10 })->side(), OrderSide::SELL);
+
+    auto& orderbook = engine.orderbook_at(SymbolId { 1 });
+    EXPECT_TRUE(orderbook.bids().is_empty());
+    EXPECT_EQ(orderbook.quote().ask_volume.value, 20);
+}
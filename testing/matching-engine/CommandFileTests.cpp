@@ -0,0 +1,206 @@
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include <chronex/matching/CommandFile.hpp>
+#include <chronex/matching/Commands.hpp>
+#include <chronex/matching/MatchingEngine.hpp>
+
+namespace chronex {
+
+namespace {
+
+std::string temp_path(const char* name) {
+    return "/tmp/chronex-" + std::string { name } + "-" + std::to_string(::getpid()) + ".bin";
+}
+
+// A bit of everything the engine takes, over two books
+std::vector<commands::Command<>> some_commands() {
+    using namespace commands;
+    // Orders are move-only, so the commands can't come from an initializer list
+    std::vector<Command<>> result;
+    result.push_back(AddNewOrderBook { Symbol { 0, "AAPL" } });
+    result.push_back(AddNewOrderBook { Symbol { 1, "MSFTXYZ" } });
+    result.push_back(AddOrder<> { Order::sell_limit(1, 0, 101, 10) });
+    result.push_back(AddOrder<> { Order::sell_limit(2, 0, 102, 30, TimeInForce::GTC, 10) });
+    result.push_back(AddOrder<> { Order::buy_limit(3, 0, 99, 20) });
+    result.push_back(AddOrder<> { Order::buy_stop_limit(4, 0, 102, 103, 5) });
+    result.push_back(AddOrder<> { Order::trailing_sell_stop(5, 0, 95, 7, TrailingDistance::from_price(Price { 4 }, Price { 1 })) });
+    result.push_back(AddOrder<> { Order::buy_limit(6, 1, 50, 100) });
+    result.push_back(ReduceOrder { OrderId { 6 }, Quantity { 60 } });
+    result.push_back(ModifyOrder { OrderId { 3 }, Price { 100 }, Quantity { 25 } });
+    result.push_back(MitigateOrder { OrderId { 2 }, Price { 102 }, Quantity { 20 } });
+    result.push_back(ReplaceOrder<> { OrderId { 6 }, Order::buy_limit(7, 1, 51, 40) });
+    result.push_back(ExecuteOrder { OrderId { 3 }, Quantity { 5 } });
+    result.push_back(ExecuteOrder { OrderId { 7 }, Quantity { 10 }, Price { 52 } });
+    // Crosses the ask at 101, filling order 1, and triggers the stop-limit
+    result.push_back(AddOrder<> { Order::buy_market(8, 0, 15) });
+    // Filled already
+    result.push_back(RemoveOrder { OrderId { 1 } });
+    // Never added
+    result.push_back(RemoveOrder { OrderId { 42 } });
+    result.push_back(Match { });
+    result.push_back(RemoveOrderBook { Symbol { 1, "MSFTXYZ" } });
+    return result;
+}
+
+}
+
+TEST(CommandFileTest, RecordsRebuildTheCommands) {
+    for (auto& command : some_commands()) {
+        auto record = commands::make_command_record(command, 7);
+        EXPECT_EQ(record.timestamp, 7);
+        auto rebuilt = commands::make_command<Order>(record);
+        ASSERT_TRUE(rebuilt.has_value());
+        ASSERT_EQ(rebuilt->index(), command.index());
+        // The records of the rebuilt commands are the same, field by field
+        auto again = commands::make_command_record(*rebuilt, 7);
+        EXPECT_EQ(std::memcmp(&record, &again, sizeof(record)), 0) << "Command type " << int(record.type);
+    }
+
+    auto record = commands::make_command_record(commands::Command<> {
+        commands::AddOrder<> { Order::buy_stop_limit(4, 3, 102, 103, 5, TimeInForce::FOK, 2) } });
+    EXPECT_EQ(record.type, commands::CommandType::ADD_ORDER);
+    EXPECT_EQ(record.symbol_id, 3);
+    auto order = std::get<commands::AddOrder<>>(*commands::make_command<Order>(record)).order;
+    EXPECT_EQ(order.type(), OrderType::STOP_LIMIT);
+    EXPECT_EQ(order.symbol_id(), SymbolId { 3 });
+    EXPECT_EQ(order.stop_price(), Price { 102 });
+    EXPECT_EQ(order.price(), Price { 103 });
+    EXPECT_EQ(order.time_in_force(), TimeInForce::FOK);
+    EXPECT_EQ(order.max_visible_quantity(), Quantity { 2 });
+
+    // Executions at the order's own price keep the invalid price
+    record = commands::make_command_record(commands::Command<> { commands::ExecuteOrder { OrderId { 1 }, Quantity { 2 } } });
+    EXPECT_EQ(std::get<commands::ExecuteOrder>(*commands::make_command<Order>(record)).price, Price::invalid());
+
+    // A name that isn't null-terminated is cut
+    record = commands::CommandRecord { };
+    record.type = commands::CommandType::ADD_NEW_ORDERBOOK;
+    std::memcpy(record.symbol_name, "ABCDEFGH", 8);
+    EXPECT_STREQ(std::get<commands::AddNewOrderBook>(*commands::make_command<Order>(record)).symbol.name, "ABCDEFG");
+
+    record.type = static_cast<commands::CommandType>(200);
+    EXPECT_FALSE(commands::make_command<Order>(record).has_value());
+}
+
+TEST(CommandFileTest, BadOrdersAreDropped) {
+    MatchingEngine<> engine;
+    size_t applied = 0;
+    auto replay = [&] (const commands::CommandRecord& record) {
+        auto command = commands::make_command<Order>(record);
+        applied += command.has_value() && commands::apply(engine, std::move(*command));
+    };
+    replay(commands::make_command_record(commands::Command<> { commands::AddNewOrderBook { Symbol { 0, "A" } } }));
+    replay(commands::make_command_record(commands::Command<> { commands::AddOrder<> { Order::buy_limit(1, 0, 100, 10) } }));
+    replay(commands::make_command_record(commands::Command<> { commands::AddOrder<> { Order::buy_limit(2, 0, 99, 10) } }));
+    ASSERT_EQ(applied, 3);
+
+    // Refused by the engine's asserts only
+    auto record = commands::make_command_record(commands::Command<> { commands::AddOrder<> { Order::buy_limit(3, 0, 98, 10) } });
+    record.order.leaves_quantity = 0;
+    EXPECT_FALSE(commands::make_command<Order>(record).has_value());
+    record.order.leaves_quantity = 10;
+    record.order.id = OrderId::invalid().value;
+    EXPECT_FALSE(commands::make_command<Order>(record).has_value());
+    record = commands::make_command_record(commands::Command<> {
+        commands::ReplaceOrder<> { OrderId { 1 }, Order::buy_limit(3, 0, 98, 10) } });
+    record.order.price = Price::invalid().value;
+    EXPECT_FALSE(commands::make_command<Order>(record).has_value());
+
+    // IDs of live orders
+    replay(commands::make_command_record(commands::Command<> { commands::AddOrder<> { Order::sell_limit(1, 0, 200, 5) } }));
+    replay(commands::make_command_record(commands::Command<> {
+        commands::ReplaceOrder<> { OrderId { 1 }, Order::buy_limit(2, 0, 101, 5) } }));
+    EXPECT_EQ(applied, 3);
+    EXPECT_EQ(engine.order_at(OrderId { 1 })->price(), Price { 100 });
+    EXPECT_EQ(engine.order_at(OrderId { 2 })->price(), Price { 99 });
+
+    // Its own ID is free once it's removed
+    replay(commands::make_command_record(commands::Command<> {
+        commands::ReplaceOrder<> { OrderId { 1 }, Order::buy_limit(1, 0, 101, 5) } }));
+    EXPECT_EQ(applied, 4);
+    EXPECT_EQ(engine.order_at(OrderId { 1 })->price(), Price { 101 });
+}
+
+TEST(CommandFileTest, ReplayingAFileRebuildsTheBooks) {
+    auto path = temp_path("commands");
+    {
+        auto writer = commands::CommandFileWriter::create(path);
+        ASSERT_TRUE(writer.has_value());
+        uint64_t timestamp = 0;
+        for (auto& command : some_commands()) {
+            writer->write(command, ++timestamp);
+        }
+        EXPECT_EQ(writer->records_count(), some_commands().size());
+    }
+    // Cut in the middle of a record, as if the capturing process was killed
+    {
+        auto file = std::fopen(path.c_str(), "ab");
+        ASSERT_NE(file, nullptr);
+        std::fputs("partial", file);
+        std::fclose(file);
+    }
+
+    auto file = commands::CommandFile::open(path);
+    ::unlink(path.c_str());
+    ASSERT_TRUE(file.has_value());
+    auto records = file->records();
+    ASSERT_EQ(records.size(), some_commands().size());
+    EXPECT_EQ(records.front().timestamp, 1);
+    EXPECT_EQ(records.back().timestamp, records.size());
+
+    MatchingEngine<> expected;
+    size_t expected_applied = 0;
+    for (auto& command : some_commands()) {
+        expected_applied += commands::apply(expected, std::move(command));
+    }
+    MatchingEngine<> replayed;
+    size_t applied = 0;
+    for (auto& record : records) {
+        applied += commands::apply(replayed, *commands::make_command<Order>(record));
+    }
+    EXPECT_EQ(applied, expected_applied);
+    // The removals of the order the market order filled, and of the one that never was
+    EXPECT_EQ(applied, records.size() - 2);
+
+    EXPECT_FALSE(replayed.has_orderbook(SymbolId { 1 }));
+    for (auto id : { 1, 2, 3, 4, 5, 6, 7, 8 }) {
+        ASSERT_EQ(replayed.has_order(OrderId { uint64_t(id) }), expected.has_order(OrderId { uint64_t(id) })) << id;
+        if (!expected.has_order(OrderId { uint64_t(id) })) continue;
+        EXPECT_EQ(replayed.order_at(OrderId { uint64_t(id) })->leaves_quantity(),
+                  expected.order_at(OrderId { uint64_t(id) })->leaves_quantity()) << id;
+    }
+    auto quote = replayed.orderbook_at(SymbolId { 0 }).quote();
+    auto expected_quote = expected.orderbook_at(SymbolId { 0 }).quote();
+    EXPECT_EQ(quote.bid_price, expected_quote.bid_price);
+    EXPECT_EQ(quote.bid_volume, expected_quote.bid_volume);
+    EXPECT_EQ(quote.ask_price, expected_quote.ask_price);
+    EXPECT_EQ(quote.ask_volume, expected_quote.ask_volume);
+    EXPECT_EQ(replayed.orderbook_at(SymbolId { 0 }).symbol().name, std::string { "AAPL" });
+
+    // Not a command file
+    auto other = temp_path("not-commands");
+    {
+        auto other_file = std::fopen(other.c_str(), "wb");
+        ASSERT_NE(other_file, nullptr);
+        std::fputs("8=FIX.4.4\x01" "9=5\x01", other_file);
+        std::fclose(other_file);
+    }
+    errno = 0;
+    EXPECT_FALSE(commands::CommandFile::open(other).has_value());
+    EXPECT_EQ(errno, EINVAL);
+    ::unlink(other.c_str());
+
+    EXPECT_FALSE(commands::CommandFile::open(other).has_value());
+    EXPECT_EQ(errno, ENOENT);
+}
+
+}
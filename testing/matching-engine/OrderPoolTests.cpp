@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+
+#include <chronex/matching/Commands.hpp>
+#include <chronex/matching/MatchingEngine.hpp>
+#include <chronex/orderbook/OrderPool.hpp>
+
+namespace chronex {
+
+namespace {
+
+using PooledEngine = MatchingEngine<Order, handlers::NullEventHandler, OrderBook<Order, handlers::NullEventHandler, unordered_map, PooledList<>>>;
+
+// Fills the pool's free slots, then gives them back, to tell how many are free
+size_t free_slots(OrderPool<>& pool) {
+    std::vector<OrderHandle> handles;
+    while (auto handle = pool.try_emplace([] { return Order::buy_limit(0, 0, 1, 1); })) {
+        handles.push_back(*handle);
+    }
+    for (auto handle : handles) {
+        pool.release(handle);
+    }
+    return handles.size();
+}
+
+}
+
+TEST(OrderPoolTest, RestingOrdersKeepTheirNode) {
+    OrderPool<> pool { 8 };
+    PooledEngine engine;
+    engine.add_new_orderbook(Symbol { 0, "A" });
+
+    auto handle = pool.try_emplace([] { return Order::buy_limit(1, 0, 100, 10); });
+    ASSERT_TRUE(handle.has_value());
+    auto* node_order = &pool[*handle];
+    engine.adopt_order(pool.iterator(*handle));
+
+    ASSERT_TRUE(engine.has_order(OrderId { 1 }));
+    auto& orderbook = engine.orderbook_at(SymbolId { 0 });
+    EXPECT_EQ(&*orderbook.bids().best()->second.begin(), node_order);
+    EXPECT_EQ(orderbook.bids().best()->second.visible_volume(), Quantity { 10 });
+    EXPECT_EQ(free_slots(pool), 7);
+
+    // Fully executing it returns the node to the pool
+    engine.add_order(Order::sell_limit(2, 0, 100, 10));
+    EXPECT_FALSE(engine.has_order(OrderId { 1 }));
+    EXPECT_EQ(free_slots(pool), 8);
+}
+
+TEST(OrderPoolTest, NonRestingOrdersAreFreed) {
+    OrderPool<> pool { 8 };
+    PooledEngine engine;
+    engine.add_new_orderbook(Symbol { 0, "A" });
+    engine.add_order(Order::sell_limit(1, 0, 100, 5));
+
+    auto ioc = pool.try_emplace([] { return Order::buy_limit(2, 0, 100, 10, TimeInForce::IOC); });
+    engine.adopt_order(pool.iterator(*ioc));
+    EXPECT_FALSE(engine.has_order(OrderId { 1 }));
+    EXPECT_FALSE(engine.has_order(OrderId { 2 }));
+
+    auto market = pool.try_emplace([] { return Order::buy_market(3, 0, 10); });
+    engine.adopt_order(pool.iterator(*market));
+    EXPECT_FALSE(engine.has_order(OrderId { 3 }));
+
+    EXPECT_EQ(free_slots(pool), 8);
+}
+
+TEST(OrderPoolTest, AdoptCommandsCarryOnlyTheHandle) {
+    OrderPool<> pool { 4 };
+    PooledEngine engine;
+    engine.add_new_orderbook(Symbol { 0, "A" });
+
+    auto handle = pool.try_emplace([] { return Order::sell_limit(1, 0, 100, 10); });
+    commands::Command<Order> command = commands::AdoptOrder{ *handle };
+    EXPECT_TRUE(commands::apply(engine, std::move(command)));
+    EXPECT_TRUE(engine.has_order(OrderId { 1 }));
+
+    engine.remove_order(OrderId { 1 });
+    EXPECT_EQ(free_slots(pool), 4);
+}
+
+TEST(OrderPoolTest, EngineAllocationsComeFromThePool) {
+    OrderPool<> pool { 2 };
+    PooledEngine engine;
+    engine.add_new_orderbook(Symbol { 0, "A" });
+
+    engine.add_order(Order::buy_limit(1, 0, 100, 10));
+    EXPECT_EQ(free_slots(pool), 1);
+    engine.add_order(Order::buy_limit(2, 0, 99, 10));
+    // Exhausted, falls back to the heap
+    engine.add_order(Order::buy_limit(3, 0, 98, 10));
+    EXPECT_EQ(free_slots(pool), 0);
+
+    engine.remove_order(OrderId { 1 });
+    engine.remove_order(OrderId { 3 });
+    EXPECT_EQ(free_slots(pool), 1);
+}
+
+TEST(OrderPoolTest, StopOrdersKeepTheirNode) {
+    OrderPool<> pool { 8 };
+    PooledEngine engine;
+    engine.add_new_orderbook(Symbol { 0, "A" });
+    engine.add_order(Order::sell_limit(1, 0, 100, 10));
+    engine.add_order(Order::buy_limit(2, 0, 100, 1));
+    EXPECT_EQ(free_slots(pool), 7);
+
+    // Waits in its stop level, in the node it was built in
+    auto stop = pool.try_emplace([] { return Order::buy_stop_limit(3, 0, 110, 120, 5); });
+    auto* node_order = &pool[*stop];
+    engine.adopt_order(pool.iterator(*stop));
+    ASSERT_TRUE(engine.has_order(OrderId { 3 }));
+    EXPECT_EQ(&*engine.order_at(OrderId { 3 }), node_order);
+    EXPECT_EQ(free_slots(pool), 6);
+
+    // Triggered right away, then rests as a limit order in the same node
+    auto triggered = pool.try_emplace([] { return Order::buy_stop_limit(4, 0, 100, 90, 5); });
+    node_order = &pool[*triggered];
+    engine.adopt_order(pool.iterator(*triggered));
+    ASSERT_TRUE(engine.has_order(OrderId { 4 }));
+    EXPECT_EQ(&*engine.order_at(OrderId { 4 }), node_order);
+    EXPECT_EQ(engine.orderbook_at(SymbolId { 0 }).bids().best()->first, Price { 90 });
+
+    // Triggered right away into a market order, which never rests
+    auto market = pool.try_emplace([] { return Order::buy_stop(5, 0, 100, 2); });
+    engine.adopt_order(pool.iterator(*market));
+    EXPECT_FALSE(engine.has_order(OrderId { 5 }));
+    EXPECT_EQ(free_slots(pool), 5);
+}
+
+TEST(OrderPoolTest, EnginesWithoutPooledLevelsCopyTheOrders) {
+    OrderPool<> pool { 4 };
+    MatchingEngine<> engine;
+    engine.add_new_orderbook(Symbol { 0, "A" });
+
+    auto handle = pool.try_emplace([] { return Order::sell_limit(1, 0, 100, 10); });
+    engine.adopt_order(pool.iterator(*handle));
+    EXPECT_TRUE(engine.has_order(OrderId { 1 }));
+    EXPECT_EQ(free_slots(pool), 4);
+}
+
+}
@@ -0,0 +1,242 @@
+#include <gtest/gtest.h>
+
+#include <chronex/matching/ShardedMatchingEngine.hpp>
+
+namespace chronex {
+
+namespace {
+
+struct CommandCountingEventHandler {
+    size_t shard = 0;
+    uint64_t last_sequence = 0;
+    uint64_t orders_added = 0;
+
+    void on_shard_command(size_t s, uint64_t sequence) noexcept {
+        EXPECT_EQ(s, shard);
+        EXPECT_EQ(sequence, last_sequence + 1);
+        last_sequence = sequence;
+    }
+
+    template <typename T> void on_add_new_orderbook(T&) const noexcept { }
+    template <typename T> void on_add_orderbook(T&) const noexcept { }
+    template <typename T> void on_remove_orderbook(T&) const noexcept { }
+    template <OrderType, OrderSide, typename T, typename U> void on_add_level(T&, U&) const noexcept { }
+    template <OrderType, OrderSide, typename T, typename U> void on_remove_level(T&, U&) const noexcept { }
+    template <OrderType, OrderSide, typename T, typename U> void on_add_order(T&, U&) noexcept { ++orders_added; }
+    template <OrderType, OrderSide, typename T, typename U> void on_remove_order(T&, U&) const noexcept { }
+    template <OrderType, OrderSide, typename T, typename U, typename Q> void on_reduce_order(T&, U&, Q&) const noexcept { }
+    template <OrderSide, typename T, typename U, typename V, typename P> void on_execute_order(T&, U&, V, P) const noexcept { }
+    template <OrderSide, OrderSide, typename T, typename U, typename V> void on_match_order(T&, U&, V&) const noexcept { }
+    template <OrderSide, typename T, typename U> void on_update_stop_price(T&, U&) const noexcept { }
+    template <OrderType, OrderSide, typename T, typename U> void on_trigger_stop_order(T&, U&) const noexcept { }
+};
+
+struct TradeCountingEventHandler : handlers::NullEventHandler {
+    constexpr static handlers::EventMask event_mask = handlers::EventBits::Trade;
+
+    size_t trades = 0;
+
+    template <OrderSide, typename T, typename U, typename Q, typename P, typename F>
+    void on_trade(T&, U&, U&, Q, P, F) noexcept { ++trades; }
+};
+
+}
+
+TEST(ShardedMatchingEngineTest, SymbolsArePartitionedAcrossShards) {
+    ShardedMatchingEngine<> engine { ShardingConfig { .shards_count = 4, .queue_capacity = 1024 } };
+
+    for (uint32_t i = 0; i < 8; i++) {
+        engine.add_new_orderbook(Symbol { i, "SYM" });
+    }
+
+    for (uint32_t i = 0; i < 8; i++) {
+        engine.add_order(Order::buy_limit(i, i, 100, 10));
+        engine.add_order(Order::sell_limit(100 + i, i, 110, 10));
+    }
+
+    engine.wait_until_idle();
+
+    for (uint32_t i = 0; i < 8; i++) {
+        auto shard = engine.shard_of(SymbolId { i });
+        EXPECT_EQ(shard, i % 4);
+        EXPECT_EQ(engine.shard_of(OrderId { i }), shard);
+        EXPECT_TRUE(engine.engine(shard).has_order(OrderId { i }));
+        EXPECT_TRUE(engine.engine(shard).has_order(OrderId { 100 + i }));
+        EXPECT_FALSE(engine.engine((shard + 1) % 4).has_order(OrderId { i }));
+    }
+}
+
+TEST(ShardedMatchingEngineTest, CancelsAreRoutedByOrderId) {
+    ShardedMatchingEngine<> engine { ShardingConfig { .shards_count = 2, .queue_capacity = 1024 } };
+    engine.add_new_orderbook(Symbol { 0, "A" });
+    engine.add_new_orderbook(Symbol { 1, "B" });
+
+    engine.add_order(Order::buy_limit(1, 0, 100, 10));
+    engine.add_order(Order::buy_limit(2, 1, 100, 10));
+    engine.remove_order(OrderId { 2 });
+    // Unknown orders are dropped by the front-end
+    engine.remove_order(OrderId { 42 });
+    engine.wait_until_idle();
+
+    EXPECT_TRUE(engine.engine(0).has_order(OrderId { 1 }));
+    EXPECT_FALSE(engine.engine(1).has_order(OrderId { 2 }));
+    EXPECT_FALSE(engine.shard_of(OrderId { 2 }).has_value());
+    EXPECT_EQ(engine.sequence(0), 2);
+    EXPECT_EQ(engine.sequence(1), 3);
+}
+
+TEST(ShardedMatchingEngineTest, MatchingHappensWithinTheShard) {
+    ShardedMatchingEngine<> engine { ShardingConfig { .shards_count = 2, .queue_capacity = 1024 } };
+    engine.add_new_orderbook(Symbol { 1, "A" });
+
+    engine.add_order(Order::buy_limit(1, 1, 100, 10));
+    engine.add_order(Order::sell_limit(2, 1, 100, 4));
+    engine.reduce_order(OrderId { 2 }, Quantity { 1 });  // Already filled, dropped by the shard
+    engine.wait_until_idle();
+
+    auto& shard = engine.engine(1);
+    EXPECT_TRUE(shard.has_order(OrderId { 1 }));
+    EXPECT_FALSE(shard.has_order(OrderId { 2 }));
+    EXPECT_EQ(shard.order_at(OrderId { 1 })->leaves_quantity(), Quantity { 6 });
+}
+
+TEST(ShardedMatchingEngineTest, PerShardCommandSequences) {
+    using Engine = ShardedMatchingEngine<Order, CommandCountingEventHandler>;
+    Engine engine { ShardingConfig { .shards_count = 3, .queue_capacity = 256 }, [](size_t shard) {
+        return CommandCountingEventHandler { .shard = shard };
+    } };
+
+    for (uint32_t i = 0; i < 3; i++) {
+        engine.add_new_orderbook(Symbol { i, "SYM" });
+    }
+    for (uint64_t id = 0; id < 300; id++) {
+        engine.add_order(Order::buy_limit(id, static_cast<uint32_t>(id % 3), 100 + id, 1));
+    }
+    engine.wait_until_idle();
+
+    for (size_t shard = 0; shard < 3; shard++) {
+        auto& handler = engine.engine(shard).event_handler();
+        EXPECT_EQ(handler.last_sequence, 101);
+        EXPECT_EQ(handler.orders_added, 100);
+        EXPECT_EQ(engine.sequence(shard), 101);
+    }
+}
+
+TEST(ShardedMatchingEngineTest, MigrateOrderBookBetweenShards) {
+    ShardedMatchingEngine<> engine { ShardingConfig { .shards_count = 2, .queue_capacity = 1024 } };
+    engine.add_new_orderbook(Symbol { 0, "HOT" });
+    engine.add_new_orderbook(Symbol { 2, "COLD" });
+    engine.add_new_orderbook(Symbol { 1, "OTHER" });
+
+    engine.add_order(Order::buy_limit(1, 0, 100, 10));
+    engine.add_order(Order::sell_limit(2, 0, 110, 10));
+    engine.add_order(Order::buy_stop(3, 0, 120, 5));
+    engine.add_order(Order::buy_limit(4, 2, 100, 10));
+    engine.add_order(Order::buy_limit(5, 1, 100, 10));
+    EXPECT_EQ(engine.message_count(SymbolId { 0 }), 3);
+    EXPECT_EQ(engine.shard_message_count(0), 4);
+    EXPECT_EQ(engine.shard_message_count(1), 1);
+
+    engine.migrate_orderbook(SymbolId { 0 }, 1);
+    EXPECT_EQ(engine.shard_of(SymbolId { 0 }), 1);
+    EXPECT_EQ(engine.shard_of(OrderId { 1 }), 1);
+
+    // Commands queued right after the migration go to the new shard
+    engine.add_order(Order::sell_limit(6, 0, 100, 4));
+    engine.reduce_order(OrderId { 2 }, Quantity { 7 });
+    engine.wait_until_idle();
+
+    auto& source = engine.engine(0);
+    auto& target = engine.engine(1);
+
+    EXPECT_FALSE(source.has_order(OrderId { 1 }));
+    EXPECT_FALSE(source.has_order(OrderId { 3 }));
+    EXPECT_TRUE(source.has_order(OrderId { 4 }));
+    EXPECT_EQ(target.order_at(OrderId { 1 })->leaves_quantity(), Quantity { 6 });
+    EXPECT_EQ(target.order_at(OrderId { 2 })->leaves_quantity(), Quantity { 7 });
+    EXPECT_TRUE(target.has_order(OrderId { 3 }));
+    EXPECT_TRUE(target.has_order(OrderId { 5 }));
+    EXPECT_EQ(target.orderbook_at(SymbolId { 0 }).symbol().name, std::string_view { "HOT" });
+
+    // And the books keep on matching on the new shard
+    engine.add_order(Order::buy_limit(7, 0, 110, 7));
+    engine.wait_until_idle();
+    EXPECT_FALSE(target.has_order(OrderId { 2 }));
+
+    engine.reset_message_counts();
+    EXPECT_EQ(engine.message_count(SymbolId { 0 }), 0);
+}
+
+TEST(ShardedMatchingEngineTest, CrossMigrationsDoNotDeadlock) {
+    ShardedMatchingEngine<> engine { ShardingConfig { .shards_count = 2, .queue_capacity = 64 } };
+    engine.add_new_orderbook(Symbol { 0, "A" });
+    engine.add_new_orderbook(Symbol { 1, "B" });
+
+    for (uint64_t i = 0; i < 100; i++) {
+        engine.add_order(Order::buy_limit(2 * i, 0, 100 + i, 1));
+        engine.add_order(Order::buy_limit(2 * i + 1, 1, 100 + i, 1));
+        engine.migrate_orderbook(SymbolId { 0 }, (i + 1) % 2);
+        engine.migrate_orderbook(SymbolId { 1 }, i % 2);
+    }
+    engine.wait_until_idle();
+
+    auto& a = engine.engine(engine.shard_of(SymbolId { 0 }));
+    auto& b = engine.engine(engine.shard_of(SymbolId { 1 }));
+    for (uint64_t i = 0; i < 100; i++) {
+        EXPECT_TRUE(a.has_order(OrderId { 2 * i }));
+        EXPECT_TRUE(b.has_order(OrderId { 2 * i + 1 }));
+    }
+}
+
+TEST(ShardedMatchingEngineTest, OrdersThatLeaveTheBooksAreForgotten) {
+    ShardedMatchingEngine<> engine { ShardingConfig { .shards_count = 2, .queue_capacity = 64, .batch_size = 4 } };
+    engine.add_new_orderbook(Symbol { 0, "A" });
+    engine.add_new_orderbook(Symbol { 1, "B" });
+
+    // Filled, by an order that doesn't rest either
+    for (uint64_t i = 0; i < 100; i++) {
+        engine.add_order(Order::buy_limit(2 * i, static_cast<uint32_t>(i % 2), 100, 1));
+        engine.add_order(Order::sell_market(2 * i + 1, static_cast<uint32_t>(i % 2), 1));
+    }
+    // A replacement with the same ID is still routed
+    engine.add_order(Order::buy_limit(1000, 0, 100, 10));
+    engine.replace_order(OrderId { 1000 }, Order::buy_limit(1000, 0, 101, 10));
+    // A reused ID isn't forgotten because of the removal of the earlier order
+    engine.add_order(Order::buy_limit(1001, 0, 100, 10));
+    engine.remove_order(OrderId { 1001 });
+    engine.add_order(Order::buy_limit(1001, 1, 100, 10));
+    engine.wait_until_idle();
+
+    EXPECT_FALSE(engine.shard_of(OrderId { 0 }).has_value());
+    EXPECT_FALSE(engine.shard_of(OrderId { 199 }).has_value());
+    EXPECT_EQ(engine.shard_of(OrderId { 1000 }), 0);
+    EXPECT_EQ(engine.shard_of(OrderId { 1001 }), 1);
+    EXPECT_EQ(engine.routed_orders_count(), 2);
+
+    engine.remove_order(OrderId { 1000 });
+    engine.wait_until_idle();
+    EXPECT_FALSE(engine.engine(0).has_order(OrderId { 1000 }));
+
+    // The orders of a removed book are forgotten with it
+    engine.remove_orderbook(Symbol { 1, "B" });
+    EXPECT_EQ(engine.routed_orders_count(), 0);
+}
+
+TEST(ShardedMatchingEngineTest, FilledOrdersAreForgottenWithTradeHandlers) {
+    using Engine = ShardedMatchingEngine<Order, TradeCountingEventHandler>;
+    Engine engine { ShardingConfig { .shards_count = 1, .queue_capacity = 64 } };
+    engine.add_new_orderbook(Symbol { 0, "A" });
+
+    engine.add_order(Order::buy_limit(1, 0, 100, 5));
+    engine.add_order(Order::buy_limit(2, 0, 100, 5));
+    engine.add_order(Order::sell_limit(3, 0, 100, 7));
+    engine.wait_until_idle();
+
+    EXPECT_EQ(engine.engine(0).event_handler().trades, 2);
+    EXPECT_FALSE(engine.shard_of(OrderId { 1 }).has_value());
+    EXPECT_FALSE(engine.shard_of(OrderId { 3 }).has_value());
+    EXPECT_EQ(engine.shard_of(OrderId { 2 }), 0);
+    EXPECT_EQ(engine.routed_orders_count(), 1);
+}
+
+}
@@ -911,4 +911,37 @@ TEST_F(MatchingEngineTest, ComplexOrderbookInteractions) {
     EXPECT_EQ(stop_orders_volume(matching_engine.orderbook_at(SymbolId{0})), std::make_pair(0, 0));
 }
 
+TEST_F(MatchingEngineTest, QuoteSlot) {
+    QuoteSlot slot;
+    matching_engine.attach_quote(SymbolId{0}, &slot);
+    // Nothing changed, so nothing was stored
+    EXPECT_EQ(slot.sequence(), 0);
+    EXPECT_EQ(slot.load(), Quote{});
+
+    matching_engine.add_order(Order::buy_limit(1, 0, 100, 10));
+    matching_engine.add_order(Order::sell_limit(2, 0, 105, 20));
+    // Hidden orders are not quoted
+    matching_engine.add_order(Order::buy_limit(3, 0, 102, 10, TimeInForce::GTC, 0));
+    EXPECT_EQ(slot.sequence(), 4);
+    auto quote = slot.load();
+    EXPECT_EQ(quote.bid_price, Price{100});
+    EXPECT_EQ(quote.bid_volume, Quantity{10});
+    EXPECT_EQ(quote.ask_price, Price{105});
+    EXPECT_EQ(quote.ask_volume, Quantity{20});
+    EXPECT_EQ(quote.last_bid_price, Price::min());
+    EXPECT_EQ(quote.last_ask_price, Price::max());
+
+    matching_engine.add_order(Order::buy_limit(4, 0, 105, 5));
+    quote = slot.load();
+    EXPECT_EQ(quote.ask_volume, Quantity{15});
+    EXPECT_EQ(quote.last_bid_price, Price{105});
+    EXPECT_EQ(quote.last_ask_price, Price{105});
+
+    matching_engine.remove_orderbook(symbol);
+    quote = slot.load();
+    EXPECT_EQ(quote.bid_price, Price::min());
+    EXPECT_EQ(quote.ask_price, Price::max());
+    EXPECT_EQ(quote.ask_volume, Quantity{0});
+}
+
 }
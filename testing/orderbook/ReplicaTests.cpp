@@ -0,0 +1,201 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <chronex/handlers/BinaryRingEventHandler.hpp>
+#include <chronex/matching/MatchingEngine.hpp>
+#include <chronex/orderbook/ReplicaOrderBooks.hpp>
+
+namespace chronex {
+
+namespace {
+
+using handlers::BinaryRingEventHandler;
+using handlers::EventRecord;
+
+using Engine = MatchingEngine<Order, BinaryRingEventHandler>;
+
+// An engine, and a replica that's fed the records of its events
+struct Mirror {
+    Mirror() : ring(1 << 12), engine(BinaryRingEventHandler { &ring }) { }
+
+    void sync() {
+        engine.event_handler().flush();
+        (void)ring.consume([this] (EventRecord& record) { replica.apply(record); });
+    }
+
+    BinaryRingEventHandler::Ring ring;
+    Engine engine;
+    ReplicaOrderBooks<> replica;
+};
+
+template <OrderType type, OrderSide side, typename T, typename U>
+void expect_same_levels(T& expected, U& actual) {
+    auto& expected_levels = expected.template levels<type, side>();
+    auto& actual_levels = actual.template levels<type, side>();
+    ASSERT_EQ(actual_levels.orders_count(), expected_levels.orders_count());
+
+    auto actual_it = actual_levels.begin();
+    for (auto& [price, level] : expected_levels) {
+        ASSERT_NE(actual_it, actual_levels.end());
+        EXPECT_EQ(actual_it->first.value, price.value);
+        EXPECT_EQ(actual_it->second.visible_volume().value, level.visible_volume().value);
+        EXPECT_EQ(actual_it->second.hidden_volume().value, level.hidden_volume().value);
+        ASSERT_EQ(actual_it->second.size(), level.size());
+
+        // Same orders, in the same priority
+        auto order_it = actual_it->second.begin();
+        for (auto& order : level) {
+            EXPECT_EQ(order_it->id().value, order.id().value);
+            EXPECT_EQ(order_it->type(), order.type());
+            EXPECT_EQ(order_it->leaves_quantity().value, order.leaves_quantity().value);
+            EXPECT_EQ(order_it->filled_quantity().value, order.filled_quantity().value);
+            EXPECT_EQ(order_it->price().value, order.price().value);
+            EXPECT_EQ(order_it->stop_price().value, order.stop_price().value);
+            ++order_it;
+        }
+        ++actual_it;
+    }
+    EXPECT_EQ(actual_it, actual_levels.end());
+}
+
+void expect_same_books(Mirror& mirror, const SymbolId id) {
+    auto& expected = mirror.engine.orderbook_at(id);
+    auto* actual = mirror.replica.orderbook(id);
+    ASSERT_NE(actual, nullptr);
+    expect_same_levels<OrderType::LIMIT, OrderSide::BUY>(expected, *actual);
+    expect_same_levels<OrderType::LIMIT, OrderSide::SELL>(expected, *actual);
+    expect_same_levels<OrderType::STOP, OrderSide::BUY>(expected, *actual);
+    expect_same_levels<OrderType::STOP, OrderSide::SELL>(expected, *actual);
+    expect_same_levels<OrderType::TRAILING_STOP, OrderSide::BUY>(expected, *actual);
+    expect_same_levels<OrderType::TRAILING_STOP, OrderSide::SELL>(expected, *actual);
+    EXPECT_TRUE(actual->quote() == expected.quote());
+}
+
+}
+
+TEST(ReplicaOrderBooksTest, MirrorsEveryKindOfEvent) {
+    Mirror mirror;
+    auto& engine = mirror.engine;
+    const SymbolId symbol { 1 };
+
+    auto step = [&] {
+        mirror.sync();
+        expect_same_books(mirror, symbol);
+    };
+
+    engine.add_new_orderbook(Symbol { symbol, "GOOG" });
+    step();
+
+    // Resting, iceberg, and partially filled orders
+    engine.add_order(Order::buy_limit(1, 1, 100, 20));
+    engine.add_order(Order::buy_limit(2, 1, 100, 30, TimeInForce::GTC, 5));
+    engine.add_order(Order::sell_limit(3, 1, 110, 10));
+    engine.add_order(Order::sell_limit(4, 1, 105, 8));
+    step();
+    engine.add_order(Order::sell_market(5, 1, 25));
+    step();
+    engine.add_order(Order::buy_limit(6, 1, 107, 10));
+    step();
+
+    // Executed, reduced, modified, replaced, and removed by hand
+    engine.execute_order(OrderId { 2 }, Quantity { 3 }, Price { 100 });
+    engine.reduce_order(OrderId { 2 }, Quantity { 10 });
+    engine.modify_order(OrderId { 3 }, Price { 112 }, Quantity { 6 });
+    engine.replace_order(OrderId { 6 }, Order::buy_limit(7, 1, 101, 4));
+    engine.remove_order(OrderId { 7 });
+    step();
+
+    // Stop orders, triggered when added and when the market moves
+    engine.add_order(Order::sell_stop(8, 1, 90, 5));
+    engine.add_order(Order::buy_stop_limit(9, 1, 111, 113, 20));
+    engine.add_order(Order::buy_stop(10, 1, 2000, 1));
+    step();
+    engine.add_order(Order::buy_market(11, 1, 1));
+    step();
+    ASSERT_NE(mirror.replica.order(OrderId { 9 }), nullptr);
+    EXPECT_EQ(mirror.replica.order(OrderId { 9 })->type(), OrderType::LIMIT);
+
+    // Trailing stop orders, then trades on both sides
+    engine.add_order(Order::trailing_buy_stop(12, 1, 1000, 10, TrailingDistance::from_price(Price { 20 }, Price { 1 })));
+    engine.add_order(Order::trailing_sell_stop_limit(13, 1, 10, 12, 10, TrailingDistance::from_price(Price { 30 }, Price { 1 })));
+    step();
+    engine.add_order(Order::sell_limit(14, 1, 95, 15));
+    engine.add_order(Order::buy_limit(15, 1, 115, 10));
+    step();
+
+    EXPECT_EQ(mirror.replica.orders_count(), engine.orderbook_at(symbol).template levels<OrderType::LIMIT>().bids().orders_count() +
+                                             engine.orderbook_at(symbol).template levels<OrderType::LIMIT>().asks().orders_count() +
+                                             engine.orderbook_at(symbol).template levels<OrderType::STOP>().bids().orders_count() +
+                                             engine.orderbook_at(symbol).template levels<OrderType::STOP>().asks().orders_count() +
+                                             engine.orderbook_at(symbol).template levels<OrderType::TRAILING_STOP>().bids().orders_count() +
+                                             engine.orderbook_at(symbol).template levels<OrderType::TRAILING_STOP>().asks().orders_count());
+
+    engine.remove_orderbook(Symbol { symbol, "GOOG" });
+    mirror.sync();
+    EXPECT_EQ(mirror.replica.orderbook(symbol), nullptr);
+    EXPECT_EQ(mirror.replica.orders_count(), 0);
+}
+
+TEST(ReplicaOrderBooksTest, KeepsUpWithAnOrderFlow) {
+    Mirror mirror;
+    auto& engine = mirror.engine;
+    engine.add_new_orderbook(Symbol { 0, "A" });
+    engine.add_new_orderbook(Symbol { 1, "B" });
+
+    std::mt19937 random { 42 };
+    auto between = [&] (const uint64_t min, const uint64_t max) {
+        return std::uniform_int_distribution<uint64_t> { min, max }(random);
+    };
+
+    uint64_t next_id = 0;
+    for (int i = 0; i < 5000; ++i) {
+        auto symbol = static_cast<uint32_t>(between(0, 1));
+        auto side = between(0, 1) == 0 ? OrderSide::BUY : OrderSide::SELL;
+        auto price = between(95, 105);
+        auto quantity = between(1, 10);
+        auto existing = OrderId { between(1, next_id + 1) };
+
+        switch (between(0, 9)) {
+            case 0: case 1: case 2:
+                engine.add_order(Order::limit(++next_id, symbol, side, price, quantity));
+                break;
+            case 3:
+                engine.add_order(Order::limit(++next_id, symbol, side, price, quantity * 3, TimeInForce::GTC, 2));
+                break;
+            case 4:
+                engine.add_order(Order::market(++next_id, symbol, side, quantity));
+                break;
+            case 5:
+                if (between(0, 1) == 0) {
+                    engine.add_order(Order::stop(++next_id, symbol, side, price, quantity));
+                } else {
+                    engine.add_order(Order::stop_limit(++next_id, symbol, side, price, between(95, 105), quantity));
+                }
+                break;
+            case 6:
+                engine.add_order(Order::trailing_stop(++next_id, symbol, side, side == OrderSide::BUY ? 1000 : 1, quantity,
+                                                      TrailingDistance::from_price(Price { between(2, 5) }, Price { 1 })));
+                break;
+            case 7:
+                if (engine.has_order(existing)) engine.remove_order(existing);
+                break;
+            case 8:
+                if (engine.has_order(existing)) engine.reduce_order(existing, Quantity { 1 });
+                break;
+            default:
+                if (engine.has_order(existing)) engine.modify_order(existing, Price { price }, Quantity { quantity });
+                break;
+        }
+
+        mirror.sync();
+        expect_same_books(mirror, SymbolId { symbol });
+        if (HasFailure()) {
+            FAIL() << "The replica diverged after command " << i;
+        }
+    }
+}
+
+}
@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <chronex/handlers/NullEventHandler.hpp>
+#include <chronex/pipeline/Pipeline.hpp>
+
+namespace chronex::pipeline {
+
+namespace {
+
+// What a wire message would be decoded from
+struct RawMessage {
+    uint64_t id;
+    uint32_t symbol;
+    OrderSide side;
+    uint64_t price;
+    uint64_t quantity;
+};
+
+struct Execution {
+    OrderId id;
+    Quantity quantity;
+};
+
+struct ExecutionEventHandler : handlers::NullEventHandler {
+    explicit ExecutionEventHandler(ds::SPSCQueue<Execution>* queue) : events(queue) { }
+
+    template <OrderSide, typename T, typename U, typename V, typename P>
+    void on_execute_order(T&, U& order, V quantity, P) noexcept {
+        events->emplace_deferred(Execution { order.id(), quantity });
+    }
+
+    void flush() noexcept { events->commit(); }
+
+    ds::SPSCQueue<Execution>* events;
+};
+
+auto decode(RawMessage& message, auto&& emit) {
+    emit(commands::AddOrder<Order>{ Order::limit(message.id, message.symbol, message.side, message.price, message.quantity) });
+}
+
+auto make_test_pipeline(std::vector<Execution>& executions, PipelineConfig config = { .queue_capacity = 64 }) {
+    return make_pipeline<RawMessage, Execution, Order, ExecutionEventHandler>(
+        [] (RawMessage& message, auto&& emit) { decode(message, emit); },
+        OrderValidator<Order>{ },
+        [&executions] (Execution& execution) { executions.push_back(execution); },
+        std::move(config)
+    );
+}
+
+}
+
+TEST(PipelineTest, CommandsFlowThroughAllStages) {
+    std::vector<Execution> executions;
+    auto pipeline = make_test_pipeline(executions);
+    pipeline->engine().add_new_orderbook(Symbol { 0, "A" });
+
+    pipeline->submit(RawMessage { 1, 0, OrderSide::BUY, 100, 10 });
+    pipeline->submit(RawMessage { 2, 0, OrderSide::SELL, 100, 4 });
+    pipeline->drain();
+
+    EXPECT_TRUE(pipeline->engine().has_order(OrderId { 1 }));
+    EXPECT_FALSE(pipeline->engine().has_order(OrderId { 2 }));
+    ASSERT_EQ(executions.size(), 2);
+    EXPECT_EQ(executions[0].quantity, Quantity { 4 });
+    EXPECT_EQ(executions[1].quantity, Quantity { 4 });
+}
+
+TEST(PipelineTest, InvalidOrdersDontReachTheEngine) {
+    std::vector<Execution> executions;
+    auto pipeline = make_test_pipeline(executions);
+    pipeline->engine().add_new_orderbook(Symbol { 0, "A" });
+
+    pipeline->submit(RawMessage { 1, 0, OrderSide::BUY, 100, 10 });
+    // Zero quantity
+    pipeline->submit(RawMessage { 2, 0, OrderSide::SELL, 100, 0 });
+    pipeline->drain();
+
+    EXPECT_EQ(pipeline->accepted_count(), 1);
+    EXPECT_EQ(pipeline->rejected_count(), 1);
+    EXPECT_FALSE(pipeline->engine().has_order(OrderId { 2 }));
+    EXPECT_TRUE(executions.empty());
+}
+
+TEST(PipelineTest, OrdersTheEngineAssertsOnAreRejected) {
+    // Without asserting, in debug builds as well
+    OrderValidator<Order> validator;
+    auto accepts = [&] (Order order) {
+        return validator(commands::Command<Order> { commands::AddOrder<Order> { std::move(order) } });
+    };
+
+    EXPECT_TRUE(accepts(Order::buy_limit(1, 0, 100, 10)));
+
+    auto market = Order::buy_market(2, 0, 10);
+    market.set_time_in_force(TimeInForce::GTC);
+    EXPECT_FALSE(accepts(std::move(market)));
+    EXPECT_FALSE(accepts(Order::sell_stop(3, 0, 90, 10, TimeInForce::AON)));
+    EXPECT_FALSE(accepts(Order::trailing_sell_stop(4, 0, 90, 10, TrailingDistance::from_price(Price { 5 }, Price { 5 }))));
+    EXPECT_FALSE(accepts(Order::buy_limit(5, 0, Price::invalid().value, 10)));
+    EXPECT_FALSE(accepts(Order::buy_limit(OrderId::invalid().value, 0, 100, 10)));
+}
+
+TEST(PipelineTest, FlowLargerThanTheRings) {
+    std::vector<Execution> executions;
+    auto pipeline = make_test_pipeline(executions, PipelineConfig {
+        .queue_capacity = 16,
+        .decode = { .batch_size = 4 },
+        .validate = { .batch_size = 8 },
+    });
+    pipeline->engine().add_new_orderbook(Symbol { 0, "A" });
+
+    constexpr uint64_t count = 1000;
+    for (uint64_t i = 0; i < count; i++) {
+        auto side = i % 2 == 0 ? OrderSide::BUY : OrderSide::SELL;
+        pipeline->submit(RawMessage { i + 1, 0, side, 100, 1 });
+    }
+    pipeline->drain();
+
+    EXPECT_EQ(pipeline->accepted_count(), count);
+    EXPECT_EQ(executions.size(), count);
+    for (uint64_t i = 0; i < count; i++) {
+        EXPECT_FALSE(pipeline->engine().has_order(OrderId { i + 1 }));
+    }
+}
+
+}
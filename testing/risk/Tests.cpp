@@ -0,0 +1,219 @@
+#include <gtest/gtest.h>
+
+#include <chronex/handlers/RiskEventHandler.hpp>
+#include <chronex/matching/MatchingEngine.hpp>
+#include <chronex/risk/RiskChecker.hpp>
+
+namespace chronex::risk {
+
+namespace {
+
+using Engine = MatchingEngine<Order, handlers::RiskEventHandler<>>;
+
+Order with_account(Order order, uint32_t account) {
+    order.set_account_id(AccountId { account });
+    return order;
+}
+
+// Checks, then adds to the engine if accepted, the way a risk stage would
+RiskResult submit(RiskChecker<>& risk, Engine& engine, Order order) {
+    auto result = risk.check(order, engine.orderbook_at(order.symbol_id()));
+    if (result == RiskResult::ACCEPTED) {
+        engine.add_order(std::move(order));
+    }
+    return result;
+}
+
+}
+
+TEST(RiskCheckerTest, OrderSize) {
+    RiskChecker<> risk { RiskLimits { .max_order_quantity = Quantity { 100 } }, 4, 4 };
+    Engine engine { handlers::RiskEventHandler<>{ &risk } };
+    engine.add_new_orderbook(Symbol { 0, "A" });
+
+    EXPECT_EQ(submit(risk, engine, Order::buy_limit(1, 0, 10, 101)), RiskResult::QUANTITY_TOO_LARGE);
+    EXPECT_EQ(submit(risk, engine, Order::buy_limit(2, 0, 10, 100)), RiskResult::ACCEPTED);
+    EXPECT_EQ(submit(risk, engine, Order::sell_market(3, 0, 101)), RiskResult::QUANTITY_TOO_LARGE);
+    EXPECT_FALSE(engine.has_order(OrderId { 1 }));
+}
+
+TEST(RiskCheckerTest, PriceCollars) {
+    RiskChecker<> risk { RiskLimits { .price_collar_bps = 500 }, 4, 4 };
+    Engine engine { handlers::RiskEventHandler<>{ &risk } };
+    engine.add_new_orderbook(Symbol { 0, "A" });
+
+    // Nothing to compare with yet
+    EXPECT_EQ(submit(risk, engine, Order::sell_limit(1, 0, 10'000, 10)), RiskResult::ACCEPTED);
+    // Published at the end of the command that added it
+    EXPECT_EQ(risk.check(Order::buy_limit(10, 0, 10'501, 1)), RiskResult::PRICE_OUTSIDE_COLLAR);
+    EXPECT_EQ(submit(risk, engine, Order::buy_limit(2, 0, 9'000, 10)), RiskResult::ACCEPTED);
+
+    // Only checked, so that the book doesn't move
+    auto& orderbook = engine.orderbook_at(SymbolId { 0 });
+    EXPECT_EQ(risk.check(Order::buy_limit(3, 0, 10'501, 1), orderbook), RiskResult::PRICE_OUTSIDE_COLLAR);
+    EXPECT_EQ(risk.check(Order::buy_limit(4, 0, 10'500, 1), orderbook), RiskResult::ACCEPTED);
+    EXPECT_EQ(risk.check(Order::sell_limit(5, 0, 8'549, 1), orderbook), RiskResult::PRICE_OUTSIDE_COLLAR);
+    EXPECT_EQ(risk.check(Order::sell_limit(6, 0, 8'550, 1), orderbook), RiskResult::ACCEPTED);
+    // Passive prices are never collared
+    EXPECT_EQ(risk.check(Order::buy_limit(7, 0, 1, 1), orderbook), RiskResult::ACCEPTED);
+
+    // The reference prices published by the handler give the same answers
+    EXPECT_EQ(risk.check(Order::buy_limit(8, 0, 10'501, 1)), RiskResult::PRICE_OUTSIDE_COLLAR);
+    EXPECT_EQ(risk.check(Order::sell_limit(9, 0, 8'550, 1)), RiskResult::ACCEPTED);
+}
+
+TEST(RiskCheckerTest, OpenNotionalLimit) {
+    RiskChecker<> risk { RiskLimits { .max_open_notional = 1'000 }, 4, 4 };
+    Engine engine { handlers::RiskEventHandler<>{ &risk } };
+    engine.add_new_orderbook(Symbol { 0, "A" });
+
+    EXPECT_EQ(submit(risk, engine, with_account(Order::buy_limit(1, 0, 100, 6), 1)), RiskResult::ACCEPTED);
+    EXPECT_EQ(risk.open_notional(AccountId { 1 }), 600);
+    EXPECT_EQ(submit(risk, engine, with_account(Order::buy_limit(2, 0, 100, 5), 1)), RiskResult::NOTIONAL_LIMIT_EXCEEDED);
+    // Other accounts have their own counters
+    EXPECT_EQ(submit(risk, engine, with_account(Order::buy_limit(3, 0, 100, 5), 2)), RiskResult::ACCEPTED);
+    EXPECT_EQ(submit(risk, engine, with_account(Order::buy_limit(4, 0, 100, 5), 9)), RiskResult::UNKNOWN_ACCOUNT);
+
+    engine.remove_order(OrderId { 1 });
+    EXPECT_EQ(risk.open_notional(AccountId { 1 }), 0);
+    EXPECT_EQ(submit(risk, engine, with_account(Order::buy_limit(2, 0, 100, 5), 1)), RiskResult::ACCEPTED);
+
+    risk.set_notional_limit(AccountId { 1 }, 2'000);
+    EXPECT_EQ(submit(risk, engine, with_account(Order::buy_limit(5, 0, 100, 15), 1)), RiskResult::ACCEPTED);
+    EXPECT_EQ(risk.open_notional(AccountId { 1 }), 2'000);
+}
+
+TEST(RiskCheckerTest, FillsReleaseNotional) {
+    RiskChecker<> risk { RiskLimits { }, 4, 4 };
+    Engine engine { handlers::RiskEventHandler<>{ &risk } };
+    engine.add_new_orderbook(Symbol { 0, "A" });
+
+    ASSERT_EQ(submit(risk, engine, with_account(Order::buy_limit(1, 0, 100, 10), 1)), RiskResult::ACCEPTED);
+    ASSERT_EQ(submit(risk, engine, with_account(Order::buy_limit(2, 0, 99, 10), 1)), RiskResult::ACCEPTED);
+    EXPECT_EQ(risk.open_notional(AccountId { 1 }), 1'990);
+
+    // Fully executed aggressor, partially executed resting order
+    ASSERT_EQ(submit(risk, engine, with_account(Order::sell_limit(3, 0, 100, 4), 2)), RiskResult::ACCEPTED);
+    EXPECT_EQ(risk.open_notional(AccountId { 1 }), 1'590);
+    EXPECT_EQ(risk.open_notional(AccountId { 2 }), 0);
+
+    // Partially executed aggressor that rests, fully executed resting orders
+    ASSERT_EQ(submit(risk, engine, with_account(Order::sell_limit(4, 0, 99, 20), 2)), RiskResult::ACCEPTED);
+    EXPECT_EQ(risk.open_notional(AccountId { 1 }), 0);
+    EXPECT_EQ(risk.open_notional(AccountId { 2 }), 396);
+
+    // Manual executions
+    engine.execute_order(OrderId { 4 }, Quantity { 1 });
+    EXPECT_EQ(risk.open_notional(AccountId { 2 }), 297);
+    engine.execute_order(OrderId { 4 }, Quantity { 3 });
+    EXPECT_EQ(risk.open_notional(AccountId { 2 }), 0);
+}
+
+TEST(RiskCheckerTest, ModifiedAndTriggeredOrdersKeepTheirNotional) {
+    RiskChecker<> risk { RiskLimits { }, 4, 4 };
+    Engine engine { handlers::RiskEventHandler<>{ &risk } };
+    engine.add_new_orderbook(Symbol { 0, "A" });
+
+    ASSERT_EQ(submit(risk, engine, with_account(Order::buy_limit(1, 0, 100, 10), 1)), RiskResult::ACCEPTED);
+    engine.modify_order(OrderId { 1 }, Price { 90 }, Quantity { 5 });
+    EXPECT_EQ(risk.open_notional(AccountId { 1 }), 450);
+
+    ASSERT_EQ(submit(risk, engine, with_account(Order::sell_stop_limit(2, 0, 95, 110, 10), 2)), RiskResult::ACCEPTED);
+    EXPECT_EQ(risk.open_notional(AccountId { 2 }), 1'100);
+
+    // Trades at 92 trigger the sell stop-limit, which then rests at 110
+    ASSERT_EQ(submit(risk, engine, Order::sell_limit(3, 0, 92, 1)), RiskResult::ACCEPTED);
+    ASSERT_EQ(submit(risk, engine, Order::buy_limit(4, 0, 92, 1)), RiskResult::ACCEPTED);
+    EXPECT_TRUE(engine.has_order(OrderId { 2 }));
+    EXPECT_EQ(risk.open_notional(AccountId { 2 }), 1'100);
+
+    engine.remove_order(OrderId { 2 });
+    EXPECT_EQ(risk.open_notional(AccountId { 2 }), 0);
+    engine.remove_order(OrderId { 1 });
+    EXPECT_EQ(risk.open_notional(AccountId { 1 }), 0);
+}
+
+TEST(RiskCheckerTest, ReducedOrdersReleaseNotional) {
+    RiskChecker<> risk { RiskLimits { }, 4, 4 };
+    Engine engine { handlers::RiskEventHandler<>{ &risk } };
+    engine.add_new_orderbook(Symbol { 0, "A" });
+
+    ASSERT_EQ(submit(risk, engine, with_account(Order::buy_limit(1, 0, 100, 10), 1)), RiskResult::ACCEPTED);
+    engine.reduce_order(OrderId { 1 }, Quantity { 4 });
+    EXPECT_EQ(risk.open_notional(AccountId { 1 }), 400);
+    engine.reduce_order(OrderId { 1 }, Quantity { 0 });
+    EXPECT_EQ(risk.open_notional(AccountId { 1 }), 0);
+}
+
+TEST(RiskCheckerTest, SeveralUnlinkedOrdersKeepTheirNotional) {
+    RiskChecker<> risk { RiskLimits { }, 4, 4 };
+    Engine engine { handlers::RiskEventHandler<>{ &risk } };
+    engine.add_new_orderbook(Symbol { 0, "A" });
+    auto& orderbook = engine.orderbook_at(SymbolId { 0 });
+
+    auto first = with_account(Order::buy_limit(1, 0, 100, 10), 1);
+    auto second = with_account(Order::buy_limit(2, 0, 50, 10), 1);
+    ASSERT_EQ(risk.check(first, orderbook), RiskResult::ACCEPTED);
+    ASSERT_EQ(risk.check(second, orderbook), RiskResult::ACCEPTED);
+
+    // Both unlinked before either is linked back, as in a cascade
+    handlers::RiskEventHandler<> handler { &risk };
+    handler.on_remove_order<OrderType::LIMIT, OrderSide::BUY>(orderbook, first);
+    handler.on_remove_order<OrderType::LIMIT, OrderSide::BUY>(orderbook, second);
+    EXPECT_EQ(risk.open_notional(AccountId { 1 }), 0);
+    second.set_leaves_quantity(Quantity { 5 });
+    handler.on_add_order<OrderType::LIMIT, OrderSide::BUY>(orderbook, second);
+    handler.on_add_order<OrderType::LIMIT, OrderSide::BUY>(orderbook, first);
+    EXPECT_EQ(risk.open_notional(AccountId { 1 }), 1'250);
+
+    // Removals that aren't followed by the order in the same command are final
+    handler.on_remove_order<OrderType::LIMIT, OrderSide::BUY>(orderbook, first);
+    handler.on_command_end(1);
+    handler.on_add_order<OrderType::LIMIT, OrderSide::BUY>(orderbook, first);
+    EXPECT_EQ(risk.open_notional(AccountId { 1 }), 250);
+}
+
+TEST(RiskCheckerTest, RemovedOrderBooksReleaseNotional) {
+    RiskChecker<> risk { RiskLimits { .max_open_notional = 1'000 }, 4, 4 };
+    Engine engine { handlers::RiskEventHandler<>{ &risk } };
+    engine.add_new_orderbook(Symbol { 0, "A" });
+    engine.add_new_orderbook(Symbol { 1, "B" });
+
+    ASSERT_EQ(submit(risk, engine, with_account(Order::buy_limit(1, 0, 100, 4), 1)), RiskResult::ACCEPTED);
+    ASSERT_EQ(submit(risk, engine, with_account(Order::sell_limit(2, 0, 200, 2), 1)), RiskResult::ACCEPTED);
+    ASSERT_EQ(submit(risk, engine, with_account(Order::buy_limit(3, 1, 100, 1), 1)), RiskResult::ACCEPTED);
+    EXPECT_EQ(risk.open_notional(AccountId { 1 }), 900);
+
+    // Only the orders of the removed book give their notional back
+    engine.remove_orderbook(Symbol { 0, "A" });
+    EXPECT_EQ(risk.open_notional(AccountId { 1 }), 100);
+    EXPECT_EQ(submit(risk, engine, with_account(Order::buy_limit(4, 1, 100, 9), 1)), RiskResult::ACCEPTED);
+}
+
+TEST(RiskCheckerTest, ModifiesAreCheckedForTheirIncrease) {
+    RiskChecker<> risk { RiskLimits { .max_open_notional = 1'000 }, 4, 4 };
+    Engine engine { handlers::RiskEventHandler<>{ &risk } };
+    engine.add_new_orderbook(Symbol { 0, "A" });
+    auto& orderbook = engine.orderbook_at(SymbolId { 0 });
+
+    ASSERT_EQ(submit(risk, engine, with_account(Order::buy_limit(1, 0, 100, 6), 1)), RiskResult::ACCEPTED);
+    auto& order = *engine.order_at(OrderId { 1 });
+
+    // The 600 the order holds count towards the new notional
+    EXPECT_EQ(risk.check_modify(order, Price { 100 }, Quantity { 10 }, orderbook), RiskResult::ACCEPTED);
+    EXPECT_EQ(risk.check_modify(order, Price { 100 }, Quantity { 11 }, orderbook), RiskResult::NOTIONAL_LIMIT_EXCEEDED);
+    EXPECT_EQ(risk.check_modify(order, Price { 200 }, Quantity { 6 }, orderbook), RiskResult::NOTIONAL_LIMIT_EXCEEDED);
+    EXPECT_EQ(risk.check_modify(order, Price { 50 }, Quantity { 6 }, orderbook), RiskResult::ACCEPTED);
+
+    engine.modify_order(OrderId { 1 }, Price { 100 }, Quantity { 10 });
+    EXPECT_EQ(risk.open_notional(AccountId { 1 }), 1'000);
+
+    // The validation stage can't see the orders, so it refuses modifies
+    RiskValidator<> validator { &risk };
+    commands::Command<> modify = commands::ModifyOrder { OrderId { 1 }, Price { 50 }, Quantity { 1 } };
+    commands::Command<> mitigate = commands::MitigateOrder { OrderId { 1 }, Price { 50 }, Quantity { 1 } };
+    EXPECT_FALSE(validator(modify));
+    EXPECT_FALSE(validator(mitigate));
+}
+
+}
@@ -0,0 +1,243 @@
+#include <cstdint>
+#include <string>
+
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include <chronex/handlers/CommandFlushingEventHandler.hpp>
+#include <chronex/handlers/EventBusEventHandler.hpp>
+#include <chronex/ipc/EventBus.hpp>
+#include <chronex/matching/MatchingEngine.hpp>
+#include <chronex/store/OrderBooksStore.hpp>
+#include <chronex/store/StoreClient.hpp>
+
+using namespace chronex;
+using namespace chronex::handlers;
+using namespace chronex::ipc;
+using namespace chronex::store;
+
+namespace {
+
+using Handler = CommandFlushingEventHandler<EventBusEventHandler>;
+using Engine = MatchingEngine<Order, Handler>;
+
+// Unique per process, so that test runs don't step on each other
+std::string unique_name(const std::string& test) {
+    return "chronex-store-test-" + test + "-" + std::to_string(::getpid());
+}
+
+// An engine publishing to a bus, and a store reading from it
+struct Harness {
+    explicit Harness(const std::string& test, const size_t capacity = 1 << 10, const size_t snapshot_capacity = 1 << 10) {
+        writer = EventBusWriter<EventRecord>::create("/" + unique_name(test), capacity, 1, snapshot_capacity);
+        auto reader = EventBusReader<EventRecord>::open(writer->name());
+        engine = std::make_unique<Engine>(Handler { EventBusEventHandler { &*writer } });
+        store = OrderBooksStore<>::create(std::move(*reader), "/tmp/" + unique_name(test) + ".sock");
+    }
+
+    // The store answers the snapshot request it made when it was created
+    void sync() {
+        for (int i = 0; i < 100 && !store->is_synced(); i++) {
+            serve_snapshot(*engine, *writer);
+            (void)store->poll(0);
+        }
+        (void)store->poll(0);
+    }
+
+    std::optional<EventBusWriter<EventRecord>> writer;
+    std::unique_ptr<Engine> engine;
+    std::optional<OrderBooksStore<>> store;
+};
+
+std::optional<ResponseHeader> query(Harness& harness, StoreClient& client, const QueryType type,
+                                    const uint32_t symbol_id, const uint64_t order_id = 0) {
+    if (!client.send(type, symbol_id, order_id)) return std::nullopt;
+    // Once to accept the client if it's new, then once to read its query
+    (void)harness.store->poll(0);
+    (void)harness.store->poll(0);
+    return client.receive();
+}
+
+}
+
+TEST(OrderBooksStoreTest, AnswersQueriesFromTheBooksOfTheEngine) {
+    Harness harness { "queries" };
+    auto& engine = *harness.engine;
+    engine.add_new_orderbook(Symbol { 1, "GOOG" });
+    engine.add_order(Order::buy_limit(1, 1, 100, 10));
+    engine.add_order(Order::buy_limit(2, 1, 100, 5));
+    engine.add_order(Order::buy_limit(3, 1, 99, 7));
+    engine.add_order(Order::sell_limit(4, 1, 105, 3));
+    // Hidden orders only, left out of the depth
+    engine.add_order(Order::sell_limit(5, 1, 104, 10, TimeInForce::GTC, 0));
+
+    // The records before the store joined come from the snapshot
+    harness.sync();
+    ASSERT_TRUE(harness.store->is_synced());
+    engine.add_order(Order::sell_limit(6, 1, 106, 4));
+    (void)harness.store->poll(0);
+    EXPECT_EQ(harness.store->position(), harness.writer->published());
+
+    auto client = StoreClient::connect(harness.store->path());
+    ASSERT_TRUE(client.has_value());
+
+    auto response = query(harness, *client, QueryType::TOP_OF_BOOK, 1);
+    ASSERT_TRUE(response.has_value());
+    EXPECT_EQ(response->type, ResponseType::TOP_OF_BOOK);
+    EXPECT_EQ(response->symbol_id, 1);
+    EXPECT_EQ(response->position, harness.writer->published());
+    auto top = client->body_as<store::TopOfBook>();
+    EXPECT_EQ(top.bid_price, 100);
+    EXPECT_EQ(top.bid_volume, 15);
+    EXPECT_EQ(top.ask_price, 105);
+    EXPECT_EQ(top.ask_volume, 3);
+
+    response = query(harness, *client, QueryType::DEPTH, 1);
+    ASSERT_TRUE(response.has_value());
+    EXPECT_EQ(response->type, ResponseType::DEPTH);
+    auto counts = client->depth_counts();
+    ASSERT_EQ(counts.bids_count, 2);
+    ASSERT_EQ(counts.asks_count, 2);
+    EXPECT_EQ(client->depth_level(0).price, 100);
+    EXPECT_EQ(client->depth_level(0).orders_count, 2);
+    EXPECT_EQ(client->depth_level(1).price, 99);
+    EXPECT_EQ(client->depth_level(2).price, 105);
+    EXPECT_EQ(client->depth_level(3).price, 106);
+    EXPECT_EQ(client->depth_level(3).visible_volume, 4);
+
+    response = query(harness, *client, QueryType::ORDER_STATUS, 0, 2);
+    ASSERT_TRUE(response.has_value());
+    EXPECT_EQ(response->type, ResponseType::ORDER_STATUS);
+    EXPECT_EQ(response->symbol_id, 1);
+    EXPECT_EQ(response->order_id, 2);
+    EXPECT_EQ(client->body_as<OrderRecord>().leaves_quantity, 5);
+
+    EXPECT_EQ(query(harness, *client, QueryType::ORDER_STATUS, 0, 42)->type, ResponseType::UNKNOWN_ORDER);
+    EXPECT_EQ(query(harness, *client, QueryType::DEPTH, 7)->type, ResponseType::UNKNOWN_SYMBOL);
+    EXPECT_EQ(query(harness, *client, static_cast<QueryType>(100), 1)->type, ResponseType::BAD_QUERY);
+}
+
+TEST(OrderBooksStoreTest, PipelinedQueriesAreAnsweredInOrder) {
+    Harness harness { "pipelined" };
+    harness.engine->add_new_orderbook(Symbol { 0, "A" });
+    harness.engine->add_order(Order::buy_limit(1, 0, 10, 1));
+    harness.sync();
+
+    auto client = StoreClient::connect(harness.store->path());
+    ASSERT_TRUE(client.has_value());
+    for (uint64_t i = 0; i < 100; i++) {
+        ASSERT_TRUE(client->send(i % 2 == 0 ? QueryType::TOP_OF_BOOK : QueryType::ORDER_STATUS, 0, 1));
+    }
+    (void)harness.store->poll(0);
+    (void)harness.store->poll(0);
+
+    for (uint64_t i = 0; i < 100; i++) {
+        auto response = client->receive();
+        ASSERT_TRUE(response.has_value());
+        EXPECT_EQ(response->type, i % 2 == 0 ? ResponseType::TOP_OF_BOOK : ResponseType::ORDER_STATUS);
+    }
+}
+
+TEST(OrderBooksStoreTest, PushesChangesToSubscribers) {
+    Harness harness { "subscriptions" };
+    auto& engine = *harness.engine;
+    engine.add_new_orderbook(Symbol { 0, "A" });
+    engine.add_new_orderbook(Symbol { 1, "B" });
+    harness.sync();
+
+    auto subscriber = StoreClient::connect(harness.store->path());
+    auto other = StoreClient::connect(harness.store->path());
+    ASSERT_TRUE(subscriber.has_value());
+    ASSERT_TRUE(other.has_value());
+
+    // The current depth comes right away
+    auto response = query(harness, *subscriber, QueryType::SUBSCRIBE, 0);
+    ASSERT_TRUE(response.has_value());
+    EXPECT_EQ(response->type, ResponseType::DEPTH);
+    EXPECT_EQ(subscriber->depth_counts().bids_count, 0);
+    EXPECT_EQ(query(harness, *other, QueryType::SUBSCRIBE, 0)->type, ResponseType::DEPTH);
+    EXPECT_EQ(harness.store->clients_count(), 2);
+
+    // A single push for all of the changes of the round
+    engine.add_order(Order::buy_limit(1, 0, 10, 1));
+    engine.add_order(Order::buy_limit(2, 0, 11, 1));
+    // Not subscribed to
+    engine.add_order(Order::buy_limit(3, 1, 11, 1));
+    (void)harness.store->poll(0);
+    for (auto* client : { &*subscriber, &*other }) {
+        response = client->receive();
+        ASSERT_TRUE(response.has_value());
+        EXPECT_EQ(response->type, ResponseType::DEPTH);
+        EXPECT_EQ(response->symbol_id, 0);
+        ASSERT_EQ(client->depth_counts().bids_count, 2);
+        EXPECT_EQ(client->depth_level(0).price, 11);
+    }
+
+    EXPECT_EQ(query(harness, *other, QueryType::UNSUBSCRIBE, 0)->type, ResponseType::UNSUBSCRIBED);
+    engine.remove_order(OrderId { 1 });
+    (void)harness.store->poll(0);
+    response = subscriber->receive();
+    ASSERT_TRUE(response.has_value());
+    EXPECT_EQ(subscriber->depth_counts().bids_count, 1);
+
+    // Nothing was pushed to the other client, so the next response is the answer to its query
+    EXPECT_EQ(query(harness, *other, QueryType::TOP_OF_BOOK, 1)->symbol_id, 1);
+
+    // Subscribers are dropped along with their clients
+    subscriber.reset();
+    engine.remove_order(OrderId { 2 });
+    (void)harness.store->poll(0);
+    (void)harness.store->poll(0);
+    EXPECT_EQ(harness.store->clients_count(), 1);
+}
+
+TEST(OrderBooksStoreTest, StartsOverFromASnapshotWhenEvicted) {
+    Harness harness { "eviction", 16 };
+    auto& engine = *harness.engine;
+    engine.add_new_orderbook(Symbol { 0, "A" });
+    harness.sync();
+
+    // Far more than the bus holds, without the store reading
+    for (uint64_t i = 1; i <= 20; i++) {
+        engine.add_order(Order::buy_limit(i, 0, 100 + i, 1));
+    }
+    engine.remove_order(OrderId { 20 });
+    harness.sync();
+    EXPECT_EQ(harness.store->resyncs(), 1);
+    harness.sync();
+    ASSERT_TRUE(harness.store->is_synced());
+    EXPECT_EQ(harness.store->replica().orders_count(), 19);
+
+    auto client = StoreClient::connect(harness.store->path());
+    ASSERT_TRUE(client.has_value());
+    auto response = query(harness, *client, QueryType::TOP_OF_BOOK, 0);
+    ASSERT_TRUE(response.has_value());
+    EXPECT_EQ(client->body_as<store::TopOfBook>().bid_price, 119);
+}
+
+TEST(OrderBooksStoreTest, TruncatedSnapshotsAreRefused) {
+    // Room for the book and 2 of its orders
+    Harness harness { "truncated", 1 << 10, 3 };
+    auto& engine = *harness.engine;
+    engine.add_new_orderbook(Symbol { 0, "A" });
+    for (uint64_t i = 1; i <= 4; i++) {
+        engine.add_order(Order::buy_limit(i, 0, 100 + i, 1));
+    }
+
+    harness.sync();
+    EXPECT_FALSE(harness.store->is_synced());
+    EXPECT_GE(harness.store->truncated_snapshots(), 1);
+    EXPECT_EQ(harness.store->replica().orderbook(SymbolId { 0 }), nullptr);
+    EXPECT_EQ(harness.store->replica().orders_count(), 0);
+
+    // Fits once the book shrinks, and the records kept in the meantime are applied on top
+    engine.remove_order(OrderId { 1 });
+    engine.remove_order(OrderId { 2 });
+    harness.sync();
+    ASSERT_TRUE(harness.store->is_synced());
+    engine.add_order(Order::sell_limit(5, 0, 110, 1));
+    (void)harness.store->poll(0);
+    EXPECT_EQ(harness.store->replica().orders_count(), 3);
+    EXPECT_EQ(harness.store->position(), harness.writer->published());
+}